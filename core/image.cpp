@@ -35,12 +35,20 @@
 #include "core/io/resource_loader.h"
 #include "core/math/math_funcs.h"
 #include "core/os/copymem.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
 #include "core/print_string.h"
+#include "core/safe_refcount.h"
 
 #include "thirdparty/misc/hq2x.h"
 
 #include <stdio.h>
 
+#if !defined(NO_IMAGE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define IMAGE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
 const char *Image::format_names[Image::FORMAT_MAX] = {
 	"Lum8", //luminance
 	"LumAlpha8", //luminance-alpha
@@ -365,14 +373,68 @@ int Image::get_mipmap_count() const {
 		return 0;
 }
 
+// Pixel kernels only write destination rows in [p_from_row, p_to_row), so
+// large images can be split in bands and processed on the ThreadWorkPool.
+typedef void (*ImageRowFunc)(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row);
+
+enum {
+	IMAGE_BAND_MIN_PIXELS = 16384, // Smaller bands cost more to dispatch than they save
+	IMAGE_BAND_MAX_COUNT = 64
+};
+
+struct _ImageRowBands {
+
+	ImageRowFunc func;
+	const uint8_t *src;
+	uint8_t *dst;
+	uint32_t src_width;
+	uint32_t src_height;
+	uint32_t dst_width;
+	uint32_t dst_height;
+	uint32_t rows_per_band;
+
+	void process_band(uint32_t p_band, void *p_userdata) {
+
+		uint32_t from = p_band * rows_per_band;
+		uint32_t to = MIN(from + rows_per_band, dst_height);
+		func(src, dst, src_width, src_height, dst_width, dst_height, from, to);
+	}
+};
+
+static void _process_rows(ImageRowFunc p_func, const uint8_t *p_src, uint8_t *p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+
+	uint32_t rows_per_band = MAX(IMAGE_BAND_MIN_PIXELS / MAX(p_dst_width, 1u), 1u);
+	rows_per_band = MAX(rows_per_band, (p_dst_height + IMAGE_BAND_MAX_COUNT - 1) / IMAGE_BAND_MAX_COUNT);
+	uint32_t band_count = (p_dst_height + rows_per_band - 1) / rows_per_band;
+
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+
+	if (!pool || band_count <= 1) {
+		p_func(p_src, p_dst, p_src_width, p_src_height, p_dst_width, p_dst_height, 0, p_dst_height);
+		return;
+	}
+
+	_ImageRowBands bands;
+	bands.func = p_func;
+	bands.src = p_src;
+	bands.dst = p_dst;
+	bands.src_width = p_src_width;
+	bands.src_height = p_src_height;
+	bands.dst_width = p_dst_width;
+	bands.dst_height = p_dst_height;
+	bands.rows_per_band = rows_per_band;
+
+	pool->do_work(band_count, &bands, &_ImageRowBands::process_band, (void *)NULL);
+}
+
 //using template generates perfectly optimized code due to constant expression reduction and unused variable removal present in all compilers
 template <uint32_t read_bytes, bool read_alpha, uint32_t write_bytes, bool write_alpha, bool read_gray, bool write_gray>
-static void _convert(int p_width, int p_height, const uint8_t *p_src, uint8_t *p_dst) {
+static void _convert(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_width, uint32_t p_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
 	uint32_t max_bytes = MAX(read_bytes, write_bytes);
 
-	for (int y = 0; y < p_height; y++) {
-		for (int x = 0; x < p_width; x++) {
+	for (uint32_t y = p_from_row; y < p_to_row; y++) {
+		for (uint32_t x = 0; x < p_width; x++) {
 
 			const uint8_t *rofs = &p_src[((y * p_width) + x) * (read_bytes + (read_alpha ? 1 : 0))];
 			uint8_t *wofs = &p_dst[((y * p_width) + x) * (write_bytes + (write_alpha ? 1 : 0))];
@@ -412,6 +474,20 @@ static void _convert(int p_width, int p_height, const uint8_t *p_src, uint8_t *p
 	}
 }
 
+struct _PixelConvertRows {
+
+	const Image *src;
+	Image *dst;
+
+	void convert_row(uint32_t p_row, void *p_userdata) {
+
+		int w = src->get_width();
+		for (int i = 0; i < w; i++) {
+			dst->set_pixel(i, p_row, src->get_pixel(i, p_row));
+		}
+	}
+};
+
 void Image::convert(Format p_new_format) {
 
 	if (data.size() == 0)
@@ -432,10 +508,16 @@ void Image::convert(Format p_new_format) {
 		lock();
 		new_img.lock();
 
-		for (int i = 0; i < width; i++) {
-			for (int j = 0; j < height; j++) {
+		_PixelConvertRows rows;
+		rows.src = this;
+		rows.dst = &new_img;
 
-				new_img.set_pixel(i, j, get_pixel(i, j));
+		ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+		if (pool && width * height >= IMAGE_BAND_MIN_PIXELS) {
+			pool->do_work(height, &rows, &_PixelConvertRows::convert_row, (void *)NULL);
+		} else {
+			for (int i = 0; i < height; i++) {
+				rows.convert_row(i, NULL);
 			}
 		}
 
@@ -463,36 +545,36 @@ void Image::convert(Format p_new_format) {
 
 	switch (conversion_type) {
 
-		case FORMAT_L8 | (FORMAT_LA8 << 8): _convert<1, false, 1, true, true, true>(width, height, rptr, wptr); break;
-		case FORMAT_L8 | (FORMAT_R8 << 8): _convert<1, false, 1, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_L8 | (FORMAT_RG8 << 8): _convert<1, false, 2, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_L8 | (FORMAT_RGB8 << 8): _convert<1, false, 3, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_L8 | (FORMAT_RGBA8 << 8): _convert<1, false, 3, true, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_LA8 | (FORMAT_L8 << 8): _convert<1, true, 1, false, true, true>(width, height, rptr, wptr); break;
-		case FORMAT_LA8 | (FORMAT_R8 << 8): _convert<1, true, 1, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_LA8 | (FORMAT_RG8 << 8): _convert<1, true, 2, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_LA8 | (FORMAT_RGB8 << 8): _convert<1, true, 3, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_LA8 | (FORMAT_RGBA8 << 8): _convert<1, true, 3, true, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_R8 | (FORMAT_L8 << 8): _convert<1, false, 1, false, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_R8 | (FORMAT_LA8 << 8): _convert<1, false, 1, true, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_R8 | (FORMAT_RG8 << 8): _convert<1, false, 2, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_R8 | (FORMAT_RGB8 << 8): _convert<1, false, 3, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_R8 | (FORMAT_RGBA8 << 8): _convert<1, false, 3, true, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RG8 | (FORMAT_L8 << 8): _convert<2, false, 1, false, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RG8 | (FORMAT_LA8 << 8): _convert<2, false, 1, true, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RG8 | (FORMAT_R8 << 8): _convert<2, false, 1, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RG8 | (FORMAT_RGB8 << 8): _convert<2, false, 3, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RG8 | (FORMAT_RGBA8 << 8): _convert<2, false, 3, true, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGB8 | (FORMAT_L8 << 8): _convert<3, false, 1, false, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RGB8 | (FORMAT_LA8 << 8): _convert<3, false, 1, true, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RGB8 | (FORMAT_R8 << 8): _convert<3, false, 1, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGB8 | (FORMAT_RG8 << 8): _convert<3, false, 2, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGB8 | (FORMAT_RGBA8 << 8): _convert<3, false, 3, true, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGBA8 | (FORMAT_L8 << 8): _convert<3, true, 1, false, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RGBA8 | (FORMAT_LA8 << 8): _convert<3, true, 1, true, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RGBA8 | (FORMAT_R8 << 8): _convert<3, true, 1, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGBA8 | (FORMAT_RG8 << 8): _convert<3, true, 2, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGBA8 | (FORMAT_RGB8 << 8): _convert<3, true, 3, false, false, false>(width, height, rptr, wptr); break;
+		case FORMAT_L8 | (FORMAT_LA8 << 8): _process_rows(_convert<1, false, 1, true, true, true>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_L8 | (FORMAT_R8 << 8): _process_rows(_convert<1, false, 1, false, true, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_L8 | (FORMAT_RG8 << 8): _process_rows(_convert<1, false, 2, false, true, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_L8 | (FORMAT_RGB8 << 8): _process_rows(_convert<1, false, 3, false, true, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_L8 | (FORMAT_RGBA8 << 8): _process_rows(_convert<1, false, 3, true, true, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_LA8 | (FORMAT_L8 << 8): _process_rows(_convert<1, true, 1, false, true, true>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_LA8 | (FORMAT_R8 << 8): _process_rows(_convert<1, true, 1, false, true, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_LA8 | (FORMAT_RG8 << 8): _process_rows(_convert<1, true, 2, false, true, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_LA8 | (FORMAT_RGB8 << 8): _process_rows(_convert<1, true, 3, false, true, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_LA8 | (FORMAT_RGBA8 << 8): _process_rows(_convert<1, true, 3, true, true, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_R8 | (FORMAT_L8 << 8): _process_rows(_convert<1, false, 1, false, false, true>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_R8 | (FORMAT_LA8 << 8): _process_rows(_convert<1, false, 1, true, false, true>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_R8 | (FORMAT_RG8 << 8): _process_rows(_convert<1, false, 2, false, false, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_R8 | (FORMAT_RGB8 << 8): _process_rows(_convert<1, false, 3, false, false, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_R8 | (FORMAT_RGBA8 << 8): _process_rows(_convert<1, false, 3, true, false, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RG8 | (FORMAT_L8 << 8): _process_rows(_convert<2, false, 1, false, false, true>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RG8 | (FORMAT_LA8 << 8): _process_rows(_convert<2, false, 1, true, false, true>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RG8 | (FORMAT_R8 << 8): _process_rows(_convert<2, false, 1, false, false, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RG8 | (FORMAT_RGB8 << 8): _process_rows(_convert<2, false, 3, false, false, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RG8 | (FORMAT_RGBA8 << 8): _process_rows(_convert<2, false, 3, true, false, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RGB8 | (FORMAT_L8 << 8): _process_rows(_convert<3, false, 1, false, false, true>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RGB8 | (FORMAT_LA8 << 8): _process_rows(_convert<3, false, 1, true, false, true>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RGB8 | (FORMAT_R8 << 8): _process_rows(_convert<3, false, 1, false, false, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RGB8 | (FORMAT_RG8 << 8): _process_rows(_convert<3, false, 2, false, false, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RGB8 | (FORMAT_RGBA8 << 8): _process_rows(_convert<3, false, 3, true, false, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RGBA8 | (FORMAT_L8 << 8): _process_rows(_convert<3, true, 1, false, false, true>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RGBA8 | (FORMAT_LA8 << 8): _process_rows(_convert<3, true, 1, true, false, true>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RGBA8 | (FORMAT_R8 << 8): _process_rows(_convert<3, true, 1, false, false, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RGBA8 | (FORMAT_RG8 << 8): _process_rows(_convert<3, true, 2, false, false, false>, rptr, wptr, width, height, width, height); break;
+		case FORMAT_RGBA8 | (FORMAT_RGB8 << 8): _process_rows(_convert<3, true, 3, false, false, false>, rptr, wptr, width, height, width, height); break;
 	}
 
 	r.release();
@@ -526,7 +608,7 @@ static double _bicubic_interp_kernel(double x) {
 }
 
 template <int CC, class T>
-static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
 	// get source image size
 	int width = p_src_width;
@@ -542,7 +624,7 @@ static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_
 	int xmax = width - 1;
 	// temporary pointer
 
-	for (uint32_t y = 0; y < p_dst_height; y++) {
+	for (uint32_t y = p_from_row; y < p_to_row; y++) {
 		// Y coordinates
 		oy = (double)y * yfac - 0.5f;
 		oy1 = (int)oy;
@@ -610,7 +692,7 @@ static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_
 }
 
 template <int CC, class T>
-static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
 	enum {
 		FRAC_BITS = 8,
@@ -619,7 +701,7 @@ static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict
 
 	};
 
-	for (uint32_t i = 0; i < p_dst_height; i++) {
+	for (uint32_t i = p_from_row; i < p_to_row; i++) {
 
 		uint32_t src_yofs_up_fp = (i * p_src_height * FRAC_LEN / p_dst_height);
 		uint32_t src_yofs_frac = src_yofs_up_fp & FRAC_MASK;
@@ -701,9 +783,9 @@ static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict
 }
 
 template <int CC, class T>
-static void _scale_nearest(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+static void _scale_nearest(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
-	for (uint32_t i = 0; i < p_dst_height; i++) {
+	for (uint32_t i = p_from_row; i < p_to_row; i++) {
 
 		uint32_t src_yofs = i * p_src_height / p_dst_height;
 		uint32_t y_ofs = src_yofs * p_src_width * CC;
@@ -732,120 +814,131 @@ static float _lanczos(float p_x) {
 }
 
 template <int CC, class T>
-static void _scale_lanczos(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+static void _scale_lanczos_horizontal(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
+
+	// First pass: p_dst is a float buffer with the destination width and the source height
 
 	int32_t src_width = p_src_width;
-	int32_t src_height = p_src_height;
-	int32_t dst_height = p_dst_height;
 	int32_t dst_width = p_dst_width;
 
-	uint32_t buffer_size = src_height * dst_width * CC;
-	float *buffer = memnew_arr(float, buffer_size); // Store the first pass in a buffer
-
-	{ // FIRST PASS (horizontal)
-
-		float x_scale = float(src_width) / float(dst_width);
+	float x_scale = float(src_width) / float(dst_width);
 
-		float scale_factor = MAX(x_scale, 1); // A larger kernel is required only when downscaling
-		int32_t half_kernel = LANCZOS_TYPE * scale_factor;
+	float scale_factor = MAX(x_scale, 1); // A larger kernel is required only when downscaling
+	int32_t half_kernel = LANCZOS_TYPE * scale_factor;
 
-		float *kernel = memnew_arr(float, half_kernel * 2);
+	float *kernel = memnew_arr(float, half_kernel * 2);
 
-		for (int32_t buffer_x = 0; buffer_x < dst_width; buffer_x++) {
+	for (int32_t buffer_x = 0; buffer_x < dst_width; buffer_x++) {
 
-			float src_real_x = buffer_x * x_scale;
-			int32_t src_x = src_real_x;
+		float src_real_x = buffer_x * x_scale;
+		int32_t src_x = src_real_x;
 
-			int32_t start_x = MAX(0, src_x - half_kernel + 1);
-			int32_t end_x = MIN(src_width - 1, src_x + half_kernel);
+		int32_t start_x = MAX(0, src_x - half_kernel + 1);
+		int32_t end_x = MIN(src_width - 1, src_x + half_kernel);
 
-			// Create the kernel used by all the pixels of the column
-			for (int32_t target_x = start_x; target_x <= end_x; target_x++)
-				kernel[target_x - start_x] = _lanczos((src_real_x - target_x) / scale_factor);
+		// Create the kernel used by all the pixels of the column
+		for (int32_t target_x = start_x; target_x <= end_x; target_x++)
+			kernel[target_x - start_x] = _lanczos((src_real_x - target_x) / scale_factor);
 
-			for (int32_t buffer_y = 0; buffer_y < src_height; buffer_y++) {
+		for (int32_t buffer_y = p_from_row; buffer_y < int32_t(p_to_row); buffer_y++) {
 
-				float pixel[CC] = { 0 };
-				float weight = 0;
+			float pixel[CC] = { 0 };
+			float weight = 0;
 
-				for (int32_t target_x = start_x; target_x <= end_x; target_x++) {
+			for (int32_t target_x = start_x; target_x <= end_x; target_x++) {
 
-					float lanczos_val = kernel[target_x - start_x];
-					weight += lanczos_val;
+				float lanczos_val = kernel[target_x - start_x];
+				weight += lanczos_val;
 
-					const T *__restrict src_data = ((const T *)p_src) + (buffer_y * src_width + target_x) * CC;
+				const T *__restrict src_data = ((const T *)p_src) + (buffer_y * src_width + target_x) * CC;
 
-					for (uint32_t i = 0; i < CC; i++) {
-						if (sizeof(T) == 2) //half float
-							pixel[i] += Math::half_to_float(src_data[i]) * lanczos_val;
-						else
-							pixel[i] += src_data[i] * lanczos_val;
-					}
+				for (uint32_t i = 0; i < CC; i++) {
+					if (sizeof(T) == 2) //half float
+						pixel[i] += Math::half_to_float(src_data[i]) * lanczos_val;
+					else
+						pixel[i] += src_data[i] * lanczos_val;
 				}
+			}
 
-				float *dst_data = ((float *)buffer) + (buffer_y * dst_width + buffer_x) * CC;
+			float *dst_data = ((float *)p_dst) + (buffer_y * dst_width + buffer_x) * CC;
 
-				for (uint32_t i = 0; i < CC; i++)
-					dst_data[i] = pixel[i] / weight; // Normalize the sum of all the samples
-			}
+			for (uint32_t i = 0; i < CC; i++)
+				dst_data[i] = pixel[i] / weight; // Normalize the sum of all the samples
 		}
+	}
 
-		memdelete_arr(kernel);
-	} // End of first pass
+	memdelete_arr(kernel);
+}
 
-	{ // SECOND PASS (vertical + result)
+template <int CC, class T>
+static void _scale_lanczos_vertical(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
-		float y_scale = float(src_height) / float(dst_height);
+	// Second pass: p_src is the float buffer written by the first one
 
-		float scale_factor = MAX(y_scale, 1);
-		int32_t half_kernel = LANCZOS_TYPE * scale_factor;
+	int32_t src_height = p_src_height;
+	int32_t dst_height = p_dst_height;
+	int32_t dst_width = p_dst_width;
 
-		float *kernel = memnew_arr(float, half_kernel * 2);
+	float y_scale = float(src_height) / float(dst_height);
 
-		for (int32_t dst_y = 0; dst_y < dst_height; dst_y++) {
+	float scale_factor = MAX(y_scale, 1);
+	int32_t half_kernel = LANCZOS_TYPE * scale_factor;
 
-			float buffer_real_y = dst_y * y_scale;
-			int32_t buffer_y = buffer_real_y;
+	float *kernel = memnew_arr(float, half_kernel * 2);
 
-			int32_t start_y = MAX(0, buffer_y - half_kernel + 1);
-			int32_t end_y = MIN(src_height - 1, buffer_y + half_kernel);
+	for (int32_t dst_y = p_from_row; dst_y < int32_t(p_to_row); dst_y++) {
 
-			for (int32_t target_y = start_y; target_y <= end_y; target_y++)
-				kernel[target_y - start_y] = _lanczos((buffer_real_y - target_y) / scale_factor);
+		float buffer_real_y = dst_y * y_scale;
+		int32_t buffer_y = buffer_real_y;
 
-			for (int32_t dst_x = 0; dst_x < dst_width; dst_x++) {
+		int32_t start_y = MAX(0, buffer_y - half_kernel + 1);
+		int32_t end_y = MIN(src_height - 1, buffer_y + half_kernel);
 
-				float pixel[CC] = { 0 };
-				float weight = 0;
+		for (int32_t target_y = start_y; target_y <= end_y; target_y++)
+			kernel[target_y - start_y] = _lanczos((buffer_real_y - target_y) / scale_factor);
 
-				for (int32_t target_y = start_y; target_y <= end_y; target_y++) {
+		for (int32_t dst_x = 0; dst_x < dst_width; dst_x++) {
 
-					float lanczos_val = kernel[target_y - start_y];
-					weight += lanczos_val;
+			float pixel[CC] = { 0 };
+			float weight = 0;
 
-					float *buffer_data = ((float *)buffer) + (target_y * dst_width + dst_x) * CC;
+			for (int32_t target_y = start_y; target_y <= end_y; target_y++) {
 
-					for (uint32_t i = 0; i < CC; i++)
-						pixel[i] += buffer_data[i] * lanczos_val;
-				}
+				float lanczos_val = kernel[target_y - start_y];
+				weight += lanczos_val;
 
-				T *dst_data = ((T *)p_dst) + (dst_y * dst_width + dst_x) * CC;
+				const float *buffer_data = ((const float *)p_src) + (target_y * dst_width + dst_x) * CC;
 
-				for (uint32_t i = 0; i < CC; i++) {
-					pixel[i] /= weight;
-
-					if (sizeof(T) == 1) //byte
-						dst_data[i] = CLAMP(Math::fast_ftoi(pixel[i]), 0, 255);
-					else if (sizeof(T) == 2) //half float
-						dst_data[i] = Math::make_half_float(pixel[i]);
-					else // float
-						dst_data[i] = pixel[i];
-				}
+				for (uint32_t i = 0; i < CC; i++)
+					pixel[i] += buffer_data[i] * lanczos_val;
+			}
+
+			T *dst_data = ((T *)p_dst) + (dst_y * dst_width + dst_x) * CC;
+
+			for (uint32_t i = 0; i < CC; i++) {
+				pixel[i] /= weight;
+
+				if (sizeof(T) == 1) //byte
+					dst_data[i] = CLAMP(Math::fast_ftoi(pixel[i]), 0, 255);
+				else if (sizeof(T) == 2) //half float
+					dst_data[i] = Math::make_half_float(pixel[i]);
+				else // float
+					dst_data[i] = pixel[i];
 			}
 		}
+	}
+
+	memdelete_arr(kernel);
+}
 
-		memdelete_arr(kernel);
-	} // End of second pass
+template <int CC, class T>
+static void _scale_lanczos(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+
+	uint32_t buffer_size = p_src_height * p_dst_width * CC;
+	float *buffer = memnew_arr(float, buffer_size); // Store the first pass in a buffer
+
+	_process_rows(_scale_lanczos_horizontal<CC, T>, p_src, (uint8_t *)buffer, p_src_width, p_src_height, p_dst_width, p_src_height);
+	_process_rows(_scale_lanczos_vertical<CC, T>, (const uint8_t *)buffer, p_dst, p_dst_width, p_src_height, p_dst_width, p_dst_height);
 
 	memdelete_arr(buffer);
 }
@@ -946,25 +1039,25 @@ void Image::resize(int p_width, int p_height, Interpolation p_interpolation) {
 
 			if (format >= FORMAT_L8 && format <= FORMAT_RGBA8) {
 				switch (get_format_pixel_size(format)) {
-					case 1: _scale_nearest<1, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 2: _scale_nearest<2, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 3: _scale_nearest<3, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 4: _scale_nearest<4, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 1: _process_rows(_scale_nearest<1, uint8_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 2: _process_rows(_scale_nearest<2, uint8_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 3: _process_rows(_scale_nearest<3, uint8_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 4: _process_rows(_scale_nearest<4, uint8_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
 				}
 			} else if (format >= FORMAT_RF && format <= FORMAT_RGBAF) {
 				switch (get_format_pixel_size(format)) {
-					case 4: _scale_nearest<1, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 8: _scale_nearest<2, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 12: _scale_nearest<3, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 16: _scale_nearest<4, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 4: _process_rows(_scale_nearest<1, float>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 8: _process_rows(_scale_nearest<2, float>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 12: _process_rows(_scale_nearest<3, float>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 16: _process_rows(_scale_nearest<4, float>, r_ptr, w_ptr, width, height, p_width, p_height); break;
 				}
 
 			} else if (format >= FORMAT_RH && format <= FORMAT_RGBAH) {
 				switch (get_format_pixel_size(format)) {
-					case 2: _scale_nearest<1, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 4: _scale_nearest<2, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 6: _scale_nearest<3, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 8: _scale_nearest<4, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 2: _process_rows(_scale_nearest<1, uint16_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 4: _process_rows(_scale_nearest<2, uint16_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 6: _process_rows(_scale_nearest<3, uint16_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 8: _process_rows(_scale_nearest<4, uint16_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
 				}
 			}
 
@@ -1010,24 +1103,24 @@ void Image::resize(int p_width, int p_height, Interpolation p_interpolation) {
 
 				if (format >= FORMAT_L8 && format <= FORMAT_RGBA8) {
 					switch (get_format_pixel_size(format)) {
-						case 1: _scale_bilinear<1, uint8_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 2: _scale_bilinear<2, uint8_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 3: _scale_bilinear<3, uint8_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 4: _scale_bilinear<4, uint8_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 1: _process_rows(_scale_bilinear<1, uint8_t>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 2: _process_rows(_scale_bilinear<2, uint8_t>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 3: _process_rows(_scale_bilinear<3, uint8_t>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 4: _process_rows(_scale_bilinear<4, uint8_t>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
 					}
 				} else if (format >= FORMAT_RF && format <= FORMAT_RGBAF) {
 					switch (get_format_pixel_size(format)) {
-						case 4: _scale_bilinear<1, float>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 8: _scale_bilinear<2, float>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 12: _scale_bilinear<3, float>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 16: _scale_bilinear<4, float>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 4: _process_rows(_scale_bilinear<1, float>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 8: _process_rows(_scale_bilinear<2, float>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 12: _process_rows(_scale_bilinear<3, float>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 16: _process_rows(_scale_bilinear<4, float>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
 					}
 				} else if (format >= FORMAT_RH && format <= FORMAT_RGBAH) {
 					switch (get_format_pixel_size(format)) {
-						case 2: _scale_bilinear<1, uint16_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 4: _scale_bilinear<2, uint16_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 6: _scale_bilinear<3, uint16_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 8: _scale_bilinear<4, uint16_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 2: _process_rows(_scale_bilinear<1, uint16_t>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 4: _process_rows(_scale_bilinear<2, uint16_t>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 6: _process_rows(_scale_bilinear<3, uint16_t>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 8: _process_rows(_scale_bilinear<4, uint16_t>, src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
 					}
 				}
 			}
@@ -1043,24 +1136,24 @@ void Image::resize(int p_width, int p_height, Interpolation p_interpolation) {
 
 			if (format >= FORMAT_L8 && format <= FORMAT_RGBA8) {
 				switch (get_format_pixel_size(format)) {
-					case 1: _scale_cubic<1, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 2: _scale_cubic<2, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 3: _scale_cubic<3, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 4: _scale_cubic<4, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 1: _process_rows(_scale_cubic<1, uint8_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 2: _process_rows(_scale_cubic<2, uint8_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 3: _process_rows(_scale_cubic<3, uint8_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 4: _process_rows(_scale_cubic<4, uint8_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
 				}
 			} else if (format >= FORMAT_RF && format <= FORMAT_RGBAF) {
 				switch (get_format_pixel_size(format)) {
-					case 4: _scale_cubic<1, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 8: _scale_cubic<2, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 12: _scale_cubic<3, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 16: _scale_cubic<4, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 4: _process_rows(_scale_cubic<1, float>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 8: _process_rows(_scale_cubic<2, float>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 12: _process_rows(_scale_cubic<3, float>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 16: _process_rows(_scale_cubic<4, float>, r_ptr, w_ptr, width, height, p_width, p_height); break;
 				}
 			} else if (format >= FORMAT_RH && format <= FORMAT_RGBAH) {
 				switch (get_format_pixel_size(format)) {
-					case 2: _scale_cubic<1, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 4: _scale_cubic<2, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 6: _scale_cubic<3, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 8: _scale_cubic<4, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 2: _process_rows(_scale_cubic<1, uint16_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 4: _process_rows(_scale_cubic<2, uint16_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 6: _process_rows(_scale_cubic<3, uint16_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 8: _process_rows(_scale_cubic<4, uint16_t>, r_ptr, w_ptr, width, height, p_width, p_height); break;
 				}
 			}
 		} break;
@@ -1285,25 +1378,85 @@ bool Image::_can_modify(Format p_format) const {
 	return p_format <= FORMAT_RGBE9995;
 }
 
+// Averages 2x2 blocks of four channel pixels, returns how many destination pixels were written
+template <class Component>
+static _FORCE_INLINE_ uint32_t _average_4_rgba_row(const Component *p_up, const Component *p_down, Component *p_dst, uint32_t p_count) {
+
+	return 0;
+}
+
+#ifdef IMAGE_SIMD_SSE2
+
+static _FORCE_INLINE_ uint32_t _average_4_rgba_row(const uint8_t *p_up, const uint8_t *p_down, uint8_t *p_dst, uint32_t p_count) {
+
+	// Same rounding as average_4_uint8, two destination pixels at a time
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i two = _mm_set1_epi16(2);
+
+	uint32_t done = 0;
+	for (; done + 2 <= p_count; done += 2) {
+
+		__m128i up = _mm_loadu_si128((const __m128i *)(p_up + done * 8));
+		__m128i down = _mm_loadu_si128((const __m128i *)(p_down + done * 8));
+
+		__m128i left = _mm_add_epi16(_mm_unpacklo_epi8(up, zero), _mm_unpacklo_epi8(down, zero));
+		__m128i right = _mm_add_epi16(_mm_unpackhi_epi8(up, zero), _mm_unpackhi_epi8(down, zero));
+		__m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(left, right), _mm_unpackhi_epi64(left, right));
+
+		sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+		_mm_storel_epi64((__m128i *)(p_dst + done * 4), _mm_packus_epi16(sum, sum));
+	}
+
+	return done;
+}
+
+static _FORCE_INLINE_ uint32_t _average_4_rgba_row(const float *p_up, const float *p_down, float *p_dst, uint32_t p_count) {
+
+	// Same operation order as average_4_float, so results match bit for bit
+	const __m128 quarter = _mm_set1_ps(0.25f);
+
+	for (uint32_t i = 0; i < p_count; i++) {
+
+		__m128 sum = _mm_add_ps(_mm_loadu_ps(p_up + i * 8), _mm_loadu_ps(p_up + i * 8 + 4));
+		sum = _mm_add_ps(sum, _mm_loadu_ps(p_down + i * 8));
+		sum = _mm_add_ps(sum, _mm_loadu_ps(p_down + i * 8 + 4));
+		_mm_storeu_ps(p_dst + i * 4, _mm_mul_ps(sum, quarter));
+	}
+
+	return p_count;
+}
+
+#endif
+
 template <class Component, int CC, bool renormalize,
 		void (*average_func)(Component &, const Component &, const Component &, const Component &, const Component &),
 		void (*renormalize_func)(Component *)>
-static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint32_t p_width, uint32_t p_height) {
+static void _generate_po2_mipmap(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_width, uint32_t p_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
 	//fast power of 2 mipmap generation
 	uint32_t dst_w = MAX(p_width >> 1, 1);
-	uint32_t dst_h = MAX(p_height >> 1, 1);
 
 	int right_step = (p_width == 1) ? 0 : CC;
 	int down_step = (p_height == 1) ? 0 : (p_width * CC);
 
-	for (uint32_t i = 0; i < dst_h; i++) {
+	const Component *src = reinterpret_cast<const Component *>(p_src);
+	Component *dst = reinterpret_cast<Component *>(p_dst);
+
+	for (uint32_t i = p_from_row; i < p_to_row; i++) {
 
-		const Component *rup_ptr = &p_src[i * 2 * down_step];
+		const Component *rup_ptr = &src[i * 2 * down_step];
 		const Component *rdown_ptr = rup_ptr + down_step;
-		Component *dst_ptr = &p_dst[i * dst_w * CC];
+		Component *dst_ptr = &dst[i * dst_w * CC];
 		uint32_t count = dst_w;
 
+		if (CC == 4 && !renormalize && right_step && down_step) {
+			uint32_t done = _average_4_rgba_row(rup_ptr, rdown_ptr, dst_ptr, count);
+			rup_ptr += done * CC * 2;
+			rdown_ptr += done * CC * 2;
+			dst_ptr += done * CC;
+			count -= done;
+		}
+
 		while (count--) {
 
 			for (int j = 0; j < CC; j++) {
@@ -1401,23 +1554,23 @@ void Image::shrink_x2() {
 			switch (format) {
 
 				case FORMAT_L8:
-				case FORMAT_R8: _generate_po2_mipmap<uint8_t, 1, false, Image::average_4_uint8, Image::renormalize_uint8>(r.ptr(), w.ptr(), width, height); break;
-				case FORMAT_LA8: _generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>(r.ptr(), w.ptr(), width, height); break;
-				case FORMAT_RG8: _generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>(r.ptr(), w.ptr(), width, height); break;
-				case FORMAT_RGB8: _generate_po2_mipmap<uint8_t, 3, false, Image::average_4_uint8, Image::renormalize_uint8>(r.ptr(), w.ptr(), width, height); break;
-				case FORMAT_RGBA8: _generate_po2_mipmap<uint8_t, 4, false, Image::average_4_uint8, Image::renormalize_uint8>(r.ptr(), w.ptr(), width, height); break;
-
-				case FORMAT_RF: _generate_po2_mipmap<float, 1, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(r.ptr()), reinterpret_cast<float *>(w.ptr()), width, height); break;
-				case FORMAT_RGF: _generate_po2_mipmap<float, 2, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(r.ptr()), reinterpret_cast<float *>(w.ptr()), width, height); break;
-				case FORMAT_RGBF: _generate_po2_mipmap<float, 3, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(r.ptr()), reinterpret_cast<float *>(w.ptr()), width, height); break;
-				case FORMAT_RGBAF: _generate_po2_mipmap<float, 4, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(r.ptr()), reinterpret_cast<float *>(w.ptr()), width, height); break;
-
-				case FORMAT_RH: _generate_po2_mipmap<uint16_t, 1, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(r.ptr()), reinterpret_cast<uint16_t *>(w.ptr()), width, height); break;
-				case FORMAT_RGH: _generate_po2_mipmap<uint16_t, 2, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(r.ptr()), reinterpret_cast<uint16_t *>(w.ptr()), width, height); break;
-				case FORMAT_RGBH: _generate_po2_mipmap<uint16_t, 3, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(r.ptr()), reinterpret_cast<uint16_t *>(w.ptr()), width, height); break;
-				case FORMAT_RGBAH: _generate_po2_mipmap<uint16_t, 4, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(r.ptr()), reinterpret_cast<uint16_t *>(w.ptr()), width, height); break;
-
-				case FORMAT_RGBE9995: _generate_po2_mipmap<uint32_t, 1, false, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>(reinterpret_cast<const uint32_t *>(r.ptr()), reinterpret_cast<uint32_t *>(w.ptr()), width, height); break;
+				case FORMAT_R8: _process_rows(_generate_po2_mipmap<uint8_t, 1, false, Image::average_4_uint8, Image::renormalize_uint8>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+				case FORMAT_LA8: _process_rows(_generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+				case FORMAT_RG8: _process_rows(_generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+				case FORMAT_RGB8: _process_rows(_generate_po2_mipmap<uint8_t, 3, false, Image::average_4_uint8, Image::renormalize_uint8>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+				case FORMAT_RGBA8: _process_rows(_generate_po2_mipmap<uint8_t, 4, false, Image::average_4_uint8, Image::renormalize_uint8>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+
+				case FORMAT_RF: _process_rows(_generate_po2_mipmap<float, 1, false, Image::average_4_float, Image::renormalize_float>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+				case FORMAT_RGF: _process_rows(_generate_po2_mipmap<float, 2, false, Image::average_4_float, Image::renormalize_float>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+				case FORMAT_RGBF: _process_rows(_generate_po2_mipmap<float, 3, false, Image::average_4_float, Image::renormalize_float>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+				case FORMAT_RGBAF: _process_rows(_generate_po2_mipmap<float, 4, false, Image::average_4_float, Image::renormalize_float>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+
+				case FORMAT_RH: _process_rows(_generate_po2_mipmap<uint16_t, 1, false, Image::average_4_half, Image::renormalize_half>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+				case FORMAT_RGH: _process_rows(_generate_po2_mipmap<uint16_t, 2, false, Image::average_4_half, Image::renormalize_half>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+				case FORMAT_RGBH: _process_rows(_generate_po2_mipmap<uint16_t, 3, false, Image::average_4_half, Image::renormalize_half>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+				case FORMAT_RGBAH: _process_rows(_generate_po2_mipmap<uint16_t, 4, false, Image::average_4_half, Image::renormalize_half>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
+
+				case FORMAT_RGBE9995: _process_rows(_generate_po2_mipmap<uint32_t, 1, false, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>, r.ptr(), w.ptr(), width, height, width / 2, height / 2); break;
 				default: {
 				}
 			}
@@ -1491,67 +1644,67 @@ Error Image::generate_mipmaps(bool p_renormalize) {
 		switch (format) {
 
 			case FORMAT_L8:
-			case FORMAT_R8: _generate_po2_mipmap<uint8_t, 1, false, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h); break;
+			case FORMAT_R8: _process_rows(_generate_po2_mipmap<uint8_t, 1, false, Image::average_4_uint8, Image::renormalize_uint8>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h); break;
 			case FORMAT_LA8:
-			case FORMAT_RG8: _generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h); break;
+			case FORMAT_RG8: _process_rows(_generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h); break;
 			case FORMAT_RGB8:
 				if (p_renormalize)
-					_generate_po2_mipmap<uint8_t, 3, true, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<uint8_t, 3, true, Image::average_4_uint8, Image::renormalize_uint8>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				else
-					_generate_po2_mipmap<uint8_t, 3, false, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<uint8_t, 3, false, Image::average_4_uint8, Image::renormalize_uint8>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 
 				break;
 			case FORMAT_RGBA8:
 				if (p_renormalize)
-					_generate_po2_mipmap<uint8_t, 4, true, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<uint8_t, 4, true, Image::average_4_uint8, Image::renormalize_uint8>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				else
-					_generate_po2_mipmap<uint8_t, 4, false, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<uint8_t, 4, false, Image::average_4_uint8, Image::renormalize_uint8>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				break;
 			case FORMAT_RF:
-				_generate_po2_mipmap<float, 1, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
+				_process_rows(_generate_po2_mipmap<float, 1, false, Image::average_4_float, Image::renormalize_float>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				break;
 			case FORMAT_RGF:
-				_generate_po2_mipmap<float, 2, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
+				_process_rows(_generate_po2_mipmap<float, 2, false, Image::average_4_float, Image::renormalize_float>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				break;
 			case FORMAT_RGBF:
 				if (p_renormalize)
-					_generate_po2_mipmap<float, 3, true, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<float, 3, true, Image::average_4_float, Image::renormalize_float>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				else
-					_generate_po2_mipmap<float, 3, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<float, 3, false, Image::average_4_float, Image::renormalize_float>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 
 				break;
 			case FORMAT_RGBAF:
 				if (p_renormalize)
-					_generate_po2_mipmap<float, 4, true, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<float, 4, true, Image::average_4_float, Image::renormalize_float>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				else
-					_generate_po2_mipmap<float, 4, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<float, 4, false, Image::average_4_float, Image::renormalize_float>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 
 				break;
 			case FORMAT_RH:
-				_generate_po2_mipmap<uint16_t, 1, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
+				_process_rows(_generate_po2_mipmap<uint16_t, 1, false, Image::average_4_half, Image::renormalize_half>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				break;
 			case FORMAT_RGH:
-				_generate_po2_mipmap<uint16_t, 2, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
+				_process_rows(_generate_po2_mipmap<uint16_t, 2, false, Image::average_4_half, Image::renormalize_half>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				break;
 			case FORMAT_RGBH:
 				if (p_renormalize)
-					_generate_po2_mipmap<uint16_t, 3, true, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<uint16_t, 3, true, Image::average_4_half, Image::renormalize_half>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				else
-					_generate_po2_mipmap<uint16_t, 3, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<uint16_t, 3, false, Image::average_4_half, Image::renormalize_half>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 
 				break;
 			case FORMAT_RGBAH:
 				if (p_renormalize)
-					_generate_po2_mipmap<uint16_t, 4, true, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<uint16_t, 4, true, Image::average_4_half, Image::renormalize_half>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				else
-					_generate_po2_mipmap<uint16_t, 4, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<uint16_t, 4, false, Image::average_4_half, Image::renormalize_half>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 
 				break;
 			case FORMAT_RGBE9995:
 				if (p_renormalize)
-					_generate_po2_mipmap<uint32_t, 1, true, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>(reinterpret_cast<const uint32_t *>(&wp[prev_ofs]), reinterpret_cast<uint32_t *>(&wp[ofs]), prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<uint32_t, 1, true, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 				else
-					_generate_po2_mipmap<uint32_t, 1, false, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>(reinterpret_cast<const uint32_t *>(&wp[prev_ofs]), reinterpret_cast<uint32_t *>(&wp[ofs]), prev_w, prev_h);
+					_process_rows(_generate_po2_mipmap<uint32_t, 1, false, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 
 				break;
 			default: {
@@ -1960,8 +2113,119 @@ Error Image::decompress() {
 	return OK;
 }
 
+struct _CompressBlockRowsJob {
+
+	struct Task {
+		int level;
+		int level_count; // more than one for grouped small levels, which are compressed whole
+		int from_row;
+		int to_row;
+	};
+
+	const Image::CompressBlockLevel *levels;
+	const Task *tasks;
+	Image::CompressBlockRowsFunc func;
+	void *userdata;
+
+	void process_task(uint32_t p_index, void *p_unused) {
+
+		const Task &t = tasks[p_index];
+		if (t.level_count == 1) {
+			func(levels[t.level], t.from_row, t.to_row, userdata);
+			return;
+		}
+
+		for (int i = t.level; i < t.level + t.level_count; i++) {
+			func(levels[i], 0, MAX((levels[i].height + 3) / 4, 1), userdata);
+		}
+	}
+};
+
+void Image::compress_block_rows(const Vector<CompressBlockLevel> &p_levels, CompressBlockRowsFunc p_func, void *p_userdata) {
+
+	enum {
+		MIN_BLOCKS_PER_TASK = 256
+	};
+
+	// Large levels are split in ranges of block rows, consecutive small levels share a task
+	Vector<_CompressBlockRowsJob::Task> tasks;
+	int grouped_blocks = 0; // blocks in the last task, while it holds whole small levels
+
+	for (int i = 0; i < p_levels.size(); i++) {
+
+		int block_columns = MAX((p_levels[i].width + 3) / 4, 1);
+		int block_rows = MAX((p_levels[i].height + 3) / 4, 1);
+		int blocks = block_columns * block_rows;
+
+		if (blocks < MIN_BLOCKS_PER_TASK) {
+
+			if (grouped_blocks > 0 && grouped_blocks + blocks <= MIN_BLOCKS_PER_TASK) {
+				tasks.write[tasks.size() - 1].level_count++;
+				grouped_blocks += blocks;
+			} else {
+				_CompressBlockRowsJob::Task t;
+				t.level = i;
+				t.level_count = 1;
+				t.from_row = 0;
+				t.to_row = block_rows;
+				tasks.push_back(t);
+				grouped_blocks = blocks;
+			}
+			continue;
+		}
+
+		grouped_blocks = 0;
+		int rows_per_task = MAX(MIN_BLOCKS_PER_TASK / block_columns, 1);
+
+		for (int row = 0; row < block_rows; row += rows_per_task) {
+
+			_CompressBlockRowsJob::Task t;
+			t.level = i;
+			t.level_count = 1;
+			t.from_row = row;
+			t.to_row = MIN(row + rows_per_task, block_rows);
+			tasks.push_back(t);
+		}
+	}
+
+	_CompressBlockRowsJob job;
+	job.levels = p_levels.ptr();
+	job.tasks = tasks.ptr();
+	job.func = p_func;
+	job.userdata = p_userdata;
+
+	if (ThreadWorkPool::get_singleton()) {
+		ThreadWorkPool::get_singleton()->do_work(tasks.size(), &job, &_CompressBlockRowsJob::process_task, (void *)NULL);
+	} else {
+		for (int i = 0; i < tasks.size(); i++) {
+			job.process_task(i, NULL);
+		}
+	}
+}
+
+// Throughput per target format, accumulated over every call to compress()
+static volatile uint64_t _compress_pixels[Image::FORMAT_MAX] = {};
+static volatile uint64_t _compress_usec[Image::FORMAT_MAX] = {};
+static volatile uint64_t _compress_count[Image::FORMAT_MAX] = {};
+
+void Image::print_compress_stats() {
+
+	for (int i = 0; i < FORMAT_MAX; i++) {
+
+		if (_compress_count[i] == 0)
+			continue;
+
+		double seconds = MAX(_compress_usec[i], (uint64_t)1) / 1000000.0;
+		print_line(String(format_names[i]) + ": " + itos(_compress_count[i]) + " images, " + rtos(_compress_pixels[i] / 1000000.0) + " Mpixels in " + rtos(seconds) + " s (" + rtos(_compress_pixels[i] / 1000000.0 / seconds) + " Mpixels/s)");
+	}
+}
+
 Error Image::compress(CompressMode p_mode, CompressSource p_source, float p_lossy_quality) {
 
+	Format source_format = format;
+	uint64_t pixels = uint64_t(width) * height;
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+
 	switch (p_mode) {
 
 		case COMPRESS_S3TC: {
@@ -1996,6 +2260,16 @@ Error Image::compress(CompressMode p_mode, CompressSource p_source, float p_loss
 		} break;
 	}
 
+	if (format != source_format) {
+
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+		atomic_add(&_compress_pixels[format], pixels);
+		atomic_add(&_compress_usec[format], usec);
+		atomic_increment(&_compress_count[format]);
+
+		print_verbose("Compressed " + itos(width) + "x" + itos(height) + (mipmaps ? " with mipmaps" : "") + " to " + get_format_name(format) + " in " + itos(usec / 1000) + " msec (" + rtos(double(pixels) / MAX(usec, (uint64_t)1)) + " Mpixels/s)");
+	}
+
 	return OK;
 }
 
@@ -2953,40 +3227,79 @@ void Image::bumpmap_to_normalmap(float bump_scale) {
 	data = result_image;
 }
 
+static const uint8_t _srgb2lin[256] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10, 10, 11, 11, 11, 12, 12, 13, 13, 13, 14, 14, 15, 15, 16, 16, 16, 17, 17, 18, 18, 19, 19, 20, 20, 21, 22, 22, 23, 23, 24, 24, 25, 26, 26, 27, 27, 28, 29, 29, 30, 31, 31, 32, 33, 33, 34, 35, 36, 36, 37, 38, 38, 39, 40, 41, 42, 42, 43, 44, 45, 46, 47, 47, 48, 49, 50, 51, 52, 53, 54, 55, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 70, 71, 72, 73, 74, 75, 76, 77, 78, 80, 81, 82, 83, 84, 85, 87, 88, 89, 90, 92, 93, 94, 95, 97, 98, 99, 101, 102, 103, 105, 106, 107, 109, 110, 112, 113, 114, 116, 117, 119, 120, 122, 123, 125, 126, 128, 129, 131, 132, 134, 135, 137, 139, 140, 142, 144, 145, 147, 148, 150, 152, 153, 155, 157, 159, 160, 162, 164, 166, 167, 169, 171, 173, 175, 176, 178, 180, 182, 184, 186, 188, 190, 192, 193, 195, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 218, 220, 222, 224, 226, 228, 230, 232, 235, 237, 239, 241, 243, 245, 248, 250, 252 };
+
+template <int CC>
+static void _srgb_to_linear_rows(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
+
+	uint8_t *ptr = &p_dst[p_from_row * p_dst_width * CC];
+	uint8_t *end = &p_dst[p_to_row * p_dst_width * CC];
+
+	for (; ptr < end; ptr += CC) {
+
+		ptr[0] = _srgb2lin[ptr[0]];
+		ptr[1] = _srgb2lin[ptr[1]];
+		ptr[2] = _srgb2lin[ptr[2]];
+	}
+}
+
 void Image::srgb_to_linear() {
 
 	if (data.size() == 0)
 		return;
 
-	static const uint8_t srgb2lin[256] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10, 10, 11, 11, 11, 12, 12, 13, 13, 13, 14, 14, 15, 15, 16, 16, 16, 17, 17, 18, 18, 19, 19, 20, 20, 21, 22, 22, 23, 23, 24, 24, 25, 26, 26, 27, 27, 28, 29, 29, 30, 31, 31, 32, 33, 33, 34, 35, 36, 36, 37, 38, 38, 39, 40, 41, 42, 42, 43, 44, 45, 46, 47, 47, 48, 49, 50, 51, 52, 53, 54, 55, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 70, 71, 72, 73, 74, 75, 76, 77, 78, 80, 81, 82, 83, 84, 85, 87, 88, 89, 90, 92, 93, 94, 95, 97, 98, 99, 101, 102, 103, 105, 106, 107, 109, 110, 112, 113, 114, 116, 117, 119, 120, 122, 123, 125, 126, 128, 129, 131, 132, 134, 135, 137, 139, 140, 142, 144, 145, 147, 148, 150, 152, 153, 155, 157, 159, 160, 162, 164, 166, 167, 169, 171, 173, 175, 176, 178, 180, 182, 184, 186, 188, 190, 192, 193, 195, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 218, 220, 222, 224, 226, 228, 230, 232, 235, 237, 239, 241, 243, 245, 248, 250, 252 };
-
 	ERR_FAIL_COND(format != FORMAT_RGB8 && format != FORMAT_RGBA8);
 
-	if (format == FORMAT_RGBA8) {
+	PoolVector<uint8_t>::Write wp = data.write();
+	unsigned char *data_ptr = wp.ptr();
 
-		int len = data.size() / 4;
-		PoolVector<uint8_t>::Write wp = data.write();
-		unsigned char *data_ptr = wp.ptr();
+	int mipmap_count = get_mipmap_count();
 
-		for (int i = 0; i < len; i++) {
+	for (int i = 0; i <= mipmap_count; i++) {
+
+		int ofs, w, h;
+		_get_mipmap_offset_and_size(i, ofs, w, h);
 
-			data_ptr[(i << 2) + 0] = srgb2lin[data_ptr[(i << 2) + 0]];
-			data_ptr[(i << 2) + 1] = srgb2lin[data_ptr[(i << 2) + 1]];
-			data_ptr[(i << 2) + 2] = srgb2lin[data_ptr[(i << 2) + 2]];
+		if (format == FORMAT_RGBA8) {
+			_process_rows(_srgb_to_linear_rows<4>, &data_ptr[ofs], &data_ptr[ofs], w, h, w, h);
+		} else {
+			_process_rows(_srgb_to_linear_rows<3>, &data_ptr[ofs], &data_ptr[ofs], w, h, w, h);
 		}
+	}
+}
 
-	} else if (format == FORMAT_RGB8) {
+static void _premultiply_alpha_rows(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
-		int len = data.size() / 3;
-		PoolVector<uint8_t>::Write wp = data.write();
-		unsigned char *data_ptr = wp.ptr();
+	uint8_t *ptr = &p_dst[p_from_row * p_dst_width * 4];
+	uint8_t *end = &p_dst[p_to_row * p_dst_width * 4];
 
-		for (int i = 0; i < len; i++) {
+#ifdef IMAGE_SIMD_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
 
-			data_ptr[(i * 3) + 0] = srgb2lin[data_ptr[(i * 3) + 0]];
-			data_ptr[(i * 3) + 1] = srgb2lin[data_ptr[(i * 3) + 1]];
-			data_ptr[(i * 3) + 2] = srgb2lin[data_ptr[(i * 3) + 2]];
-		}
+	for (; ptr + 16 <= end; ptr += 16) {
+
+		__m128i pixels = _mm_loadu_si128((const __m128i *)ptr);
+
+		__m128i lo = _mm_unpacklo_epi8(pixels, zero);
+		__m128i hi = _mm_unpackhi_epi8(pixels, zero);
+		__m128i lo_alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m128i hi_alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+		lo = _mm_srli_epi16(_mm_mullo_epi16(lo, lo_alpha), 8);
+		hi = _mm_srli_epi16(_mm_mullo_epi16(hi, hi_alpha), 8);
+
+		__m128i result = _mm_packus_epi16(lo, hi);
+		result = _mm_or_si128(_mm_and_si128(result, rgb_mask), _mm_andnot_si128(rgb_mask, pixels)); // Keep the original alpha
+		_mm_storeu_si128((__m128i *)ptr, result);
+	}
+#endif
+
+	for (; ptr < end; ptr += 4) {
+
+		ptr[0] = (uint16_t(ptr[0]) * uint16_t(ptr[3])) >> 8;
+		ptr[1] = (uint16_t(ptr[1]) * uint16_t(ptr[3])) >> 8;
+		ptr[2] = (uint16_t(ptr[2]) * uint16_t(ptr[3])) >> 8;
 	}
 }
 
@@ -3001,16 +3314,7 @@ void Image::premultiply_alpha() {
 	PoolVector<uint8_t>::Write wp = data.write();
 	unsigned char *data_ptr = wp.ptr();
 
-	for (int i = 0; i < height; i++) {
-		for (int j = 0; j < width; j++) {
-
-			uint8_t *ptr = &data_ptr[(i * width + j) * 4];
-
-			ptr[0] = (uint16_t(ptr[0]) * uint16_t(ptr[3])) >> 8;
-			ptr[1] = (uint16_t(ptr[1]) * uint16_t(ptr[3])) >> 8;
-			ptr[2] = (uint16_t(ptr[2]) * uint16_t(ptr[3])) >> 8;
-		}
-	}
+	_process_rows(_premultiply_alpha_rows, data_ptr, data_ptr, width, height, width, height);
 }
 
 void Image::fix_alpha_edges() {
@@ -348,6 +348,21 @@ public:
 	DetectChannels get_detected_channels();
 	void optimize_channels();
 
+	// Block compressors describe each mipmap level and get called back with
+	// ranges of 4 pixel high block rows, spread over the ThreadWorkPool.
+	struct CompressBlockLevel {
+		const uint8_t *src;
+		uint8_t *dst;
+		int width;
+		int height;
+		int dst_row_pitch; // bytes per row of blocks
+	};
+
+	typedef void (*CompressBlockRowsFunc)(const CompressBlockLevel &p_level, int p_from_row, int p_to_row, void *p_userdata);
+
+	static void compress_block_rows(const Vector<CompressBlockLevel> &p_levels, CompressBlockRowsFunc p_func, void *p_userdata);
+	static void print_compress_stats();
+
 	Color get_pixelv(const Point2 &p_src) const;
 	Color get_pixel(int p_x, int p_y) const;
 	void set_pixelv(const Point2 &p_dst, const Color &p_color);
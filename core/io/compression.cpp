@@ -187,6 +187,180 @@ int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p
 	ERR_FAIL_V(-1);
 }
 
+class CompressionStreamZlib : public Compression::Stream {
+
+	z_stream strm;
+	bool initialized;
+	bool compress;
+	bool ended;
+
+public:
+	Error init(Compression::Mode p_mode, bool p_compress) {
+
+		int window_bits = p_mode == Compression::MODE_DEFLATE ? 15 : 15 + 16;
+
+		strm.zalloc = zipio_alloc;
+		strm.zfree = zipio_free;
+		strm.opaque = Z_NULL;
+		strm.avail_in = 0;
+		strm.next_in = Z_NULL;
+
+		int err;
+		if (p_compress) {
+			int level = p_mode == Compression::MODE_DEFLATE ? Compression::zlib_level : Compression::gzip_level;
+			err = deflateInit2(&strm, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY);
+		} else {
+			err = inflateInit2(&strm, window_bits);
+		}
+		ERR_FAIL_COND_V(err != Z_OK, FAILED);
+
+		initialized = true;
+		compress = p_compress;
+		return OK;
+	}
+
+	virtual Error process(const uint8_t *p_src, int &r_src_size, uint8_t *p_dst, int &r_dst_size, bool p_finish) {
+
+		if (ended) {
+			r_src_size = 0;
+			r_dst_size = 0;
+			return ERR_FILE_EOF;
+		}
+
+		strm.avail_in = r_src_size;
+		strm.next_in = (Bytef *)p_src;
+		strm.avail_out = r_dst_size;
+		strm.next_out = p_dst;
+
+		int err = compress ? deflate(&strm, p_finish ? Z_FINISH : Z_NO_FLUSH) : inflate(&strm, Z_NO_FLUSH);
+
+		r_src_size -= strm.avail_in;
+		r_dst_size -= strm.avail_out;
+
+		if (err == Z_STREAM_END) {
+			ended = true;
+			return ERR_FILE_EOF;
+		}
+		// Z_BUF_ERROR only means no progress was possible (no input, or no room for output)
+		ERR_FAIL_COND_V(err != Z_OK && err != Z_BUF_ERROR, ERR_FILE_CORRUPT);
+		return OK;
+	}
+
+	CompressionStreamZlib() {
+
+		initialized = false;
+		compress = false;
+		ended = false;
+	}
+
+	virtual ~CompressionStreamZlib() {
+
+		if (!initialized)
+			return;
+
+		if (compress) {
+			deflateEnd(&strm);
+		} else {
+			inflateEnd(&strm);
+		}
+	}
+};
+
+class CompressionStreamZstd : public Compression::Stream {
+
+	ZSTD_CCtx *cctx;
+	ZSTD_DCtx *dctx;
+	bool ended;
+
+public:
+	virtual Error process(const uint8_t *p_src, int &r_src_size, uint8_t *p_dst, int &r_dst_size, bool p_finish) {
+
+		if (ended) {
+			r_src_size = 0;
+			r_dst_size = 0;
+			return ERR_FILE_EOF;
+		}
+
+		ZSTD_inBuffer in = { p_src, (size_t)r_src_size, 0 };
+		ZSTD_outBuffer out = { p_dst, (size_t)r_dst_size, 0 };
+
+		size_t ret;
+		if (cctx) {
+			ret = ZSTD_compressStream2(cctx, &out, &in, p_finish ? ZSTD_e_end : ZSTD_e_continue);
+		} else {
+			ret = ZSTD_decompressStream(dctx, &out, &in);
+		}
+
+		r_src_size = in.pos;
+		r_dst_size = out.pos;
+
+		ERR_FAIL_COND_V(ZSTD_isError(ret), ERR_FILE_CORRUPT);
+
+		// Zero means the frame is complete and fully flushed
+		if (ret == 0 && (dctx || (p_finish && in.pos == in.size))) {
+			ended = true;
+			return ERR_FILE_EOF;
+		}
+		return OK;
+	}
+
+	CompressionStreamZstd(bool p_compress) {
+
+		cctx = NULL;
+		dctx = NULL;
+		ended = false;
+
+		if (p_compress) {
+			cctx = ZSTD_createCCtx();
+			ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, Compression::zstd_level);
+			if (Compression::zstd_long_distance_matching) {
+				ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, 1);
+				ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, Compression::zstd_window_log_size);
+			}
+		} else {
+			dctx = ZSTD_createDCtx();
+			if (Compression::zstd_long_distance_matching) {
+				ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, Compression::zstd_window_log_size);
+			}
+		}
+	}
+
+	virtual ~CompressionStreamZstd() {
+
+		if (cctx)
+			ZSTD_freeCCtx(cctx);
+		if (dctx)
+			ZSTD_freeDCtx(dctx);
+	}
+};
+
+Compression::Stream *Compression::create_stream(Mode p_mode, bool p_compress) {
+
+	switch (p_mode) {
+		case MODE_FASTLZ: {
+
+			ERR_EXPLAIN("FastLZ has no stream format.");
+			ERR_FAIL_V(NULL);
+		} break;
+		case MODE_DEFLATE:
+		case MODE_GZIP: {
+
+			CompressionStreamZlib *stream = memnew(CompressionStreamZlib);
+			if (stream->init(p_mode, p_compress) != OK) {
+				memdelete(stream);
+				return NULL;
+			}
+			return stream;
+		} break;
+		case MODE_ZSTD: {
+
+			return memnew(CompressionStreamZstd(p_compress));
+		} break;
+	}
+
+	ERR_FAIL_V(NULL);
+}
+
 int Compression::zlib_level = Z_DEFAULT_COMPRESSION;
 int Compression::gzip_level = Z_DEFAULT_COMPRESSION;
 int Compression::zstd_level = 3;
@@ -31,6 +31,7 @@
 #ifndef COMPRESSION_H
 #define COMPRESSION_H
 
+#include "core/error_list.h"
 #include "core/typedefs.h"
 
 class Compression {
@@ -53,6 +54,20 @@ public:
 	static int get_max_compressed_buffer_size(int p_src_size, Mode p_mode = MODE_ZSTD);
 	static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
 
+	// Incremental compression or decompression, for data that is not available (or doesn't fit in memory) at once.
+	// Output is compatible with the one-shot functions. MODE_FASTLZ has no stream format and is not supported.
+	class Stream {
+	public:
+		// Consumes up to r_src_size bytes from p_src and writes up to r_dst_size bytes to p_dst, both are updated with
+		// the amount actually consumed and written. When compressing, p_finish ends the stream after the given input.
+		// Returns ERR_FILE_EOF once the end of the stream was written (compressing) or reached (decompressing).
+		virtual Error process(const uint8_t *p_src, int &r_src_size, uint8_t *p_dst, int &r_dst_size, bool p_finish = false) = 0;
+
+		virtual ~Stream() {}
+	};
+
+	static Stream *create_stream(Mode p_mode, bool p_compress); // free with memdelete
+
 	Compression();
 };
 
@@ -30,6 +30,8 @@
 
 #include "file_access_compressed.h"
 
+#include "core/io/marshalls.h"
+#include "core/os/thread_work_pool.h"
 #include "core/print_string.h"
 
 void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_mode, int p_block_size) {
@@ -64,6 +66,7 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 	cmode = (Compression::Mode)f->get_32();
 	block_size = f->get_32();
 	read_total = f->get_32();
+	ERR_FAIL_COND_V(block_size == 0, ERR_FILE_CORRUPT);
 	int bc = (read_total / block_size) + 1;
 	int acc_ofs = f->get_position() + bc * 4;
 	int max_bs = 0;
@@ -86,13 +89,119 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 	read_block_count = bc;
 	read_block_size = read_blocks.size() == 1 ? read_total : block_size;
 
-	Compression::decompress(buffer.ptrw(), read_block_size, comp_buffer.ptr(), read_blocks[0].csize, cmode);
+	int ret = Compression::decompress(buffer.ptrw(), read_block_size, comp_buffer.ptr(), read_blocks[0].csize, cmode);
+	ERR_FAIL_COND_V(ret < 0, ERR_FILE_CORRUPT);
 	read_block = 0;
 	read_pos = 0;
 
 	return OK;
 }
 
+struct _CompressBlocksJob {
+
+	struct Block {
+		const uint8_t *src;
+		uint32_t size;
+		Vector<uint8_t> data;
+		bool failed;
+	};
+
+	Compression::Mode mode;
+	Block *blocks;
+
+	void compress_block(uint32_t p_index, void *p_userdata) {
+
+		Block &b = blocks[p_index];
+		b.data.resize(Compression::get_max_compressed_buffer_size(b.size, mode));
+		int s = Compression::compress(b.data.ptrw(), b.src, b.size, mode);
+		b.failed = s < 0;
+		b.data.resize(MAX(s, 0));
+	}
+};
+
+Error FileAccessCompressed::compress_buffers(const String &p_magic, Compression::Mode p_mode, uint32_t p_block_size, const uint8_t *const *p_src, const uint32_t *p_src_size, Vector<uint8_t> *r_dst, int p_count) {
+
+	CharString mgc = p_magic.ascii();
+	ERR_FAIL_COND_V(mgc.length() != 4, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(p_block_size == 0, ERR_INVALID_PARAMETER);
+
+	// Same block layout as close(), which always has a last (possibly empty) block
+	Vector<_CompressBlocksJob::Block> blocks;
+	for (int i = 0; i < p_count; i++) {
+
+		int bc = (p_src_size[i] / p_block_size) + 1;
+		for (int j = 0; j < bc; j++) {
+
+			_CompressBlocksJob::Block b;
+			b.src = p_src[i] + j * p_block_size;
+			b.size = j == (bc - 1) ? p_src_size[i] % p_block_size : p_block_size;
+			b.failed = false;
+			blocks.push_back(b);
+		}
+	}
+
+	_CompressBlocksJob job;
+	job.mode = p_mode;
+	job.blocks = blocks.ptrw();
+
+	if (ThreadWorkPool::get_singleton()) {
+		ThreadWorkPool::get_singleton()->do_work(blocks.size(), &job, &_CompressBlocksJob::compress_block, (void *)NULL);
+	} else {
+		for (int i = 0; i < blocks.size(); i++) {
+			job.compress_block(i, NULL);
+		}
+	}
+
+	Error err = OK;
+	int block_ofs = 0;
+	for (int i = 0; i < p_count; i++) {
+
+		int bc = (p_src_size[i] / p_block_size) + 1;
+
+		bool failed = false;
+		int size = 16 + bc * 4 + 4;
+		for (int j = 0; j < bc; j++) {
+			failed = failed || blocks[block_ofs + j].failed;
+			size += blocks[block_ofs + j].data.size();
+		}
+
+		if (failed) {
+			// Leave the output empty rather than writing a file with missing blocks
+			r_dst[i].clear();
+			block_ofs += bc;
+			err = ERR_CANT_CREATE;
+			continue;
+		}
+
+		r_dst[i].resize(size);
+		uint8_t *w = r_dst[i].ptrw();
+
+		copymem(w, mgc.get_data(), 4);
+		encode_uint32(p_mode, &w[4]);
+		encode_uint32(p_block_size, &w[8]);
+		encode_uint32(p_src_size[i], &w[12]);
+		w += 16;
+
+		for (int j = 0; j < bc; j++) {
+			encode_uint32(blocks[block_ofs + j].data.size(), w);
+			w += 4;
+		}
+		for (int j = 0; j < bc; j++) {
+			const Vector<uint8_t> &data = blocks[block_ofs + j].data;
+			copymem(w, data.ptr(), data.size());
+			w += data.size();
+		}
+		copymem(w, mgc.get_data(), 4); //magic at the end too
+
+		block_ofs += bc;
+	}
+
+	if (err != OK) {
+		ERR_PRINT("Failed to compress one or more blocks.");
+	}
+	return err;
+}
+
 Error FileAccessCompressed::_open(const String &p_path, int p_mode_flags) {
 
 	ERR_FAIL_COND_V(p_mode_flags == READ_WRITE, ERR_UNAVAILABLE);
@@ -131,7 +240,12 @@ Error FileAccessCompressed::_open(const String &p_path, int p_mode_flags) {
 			return ERR_FILE_UNRECOGNIZED;
 		}
 
-		open_after_magic(f);
+		Error err = open_after_magic(f);
+		if (err != OK) {
+			memdelete(f);
+			f = NULL;
+			return err;
+		}
 	}
 
 	return OK;
@@ -144,37 +258,14 @@ void FileAccessCompressed::close() {
 	if (writing) {
 		//save block table and all compressed blocks
 
-		CharString mgc = magic.utf8();
-		f->store_buffer((const uint8_t *)mgc.get_data(), mgc.length()); //write header 4
-		f->store_32(cmode); //write compression mode 4
-		f->store_32(block_size); //write block size 4
-		f->store_32(write_max); //max amount of data written 4
-		int bc = (write_max / block_size) + 1;
-
-		for (int i = 0; i < bc; i++) {
-			f->store_32(0); //compressed sizes, will update later
+		//header, block table and all blocks, compressed in parallel
+		const uint8_t *src = write_ptr;
+		Vector<uint8_t> data;
+		Error err = compress_buffers(magic, cmode, block_size, &src, &write_max, &data, 1);
+		if (err == OK) {
+			f->store_buffer(data.ptr(), data.size());
 		}
 
-		Vector<int> block_sizes;
-		for (int i = 0; i < bc; i++) {
-
-			int bl = i == (bc - 1) ? write_max % block_size : block_size;
-			uint8_t *bp = &write_ptr[i * block_size];
-
-			Vector<uint8_t> cblock;
-			cblock.resize(Compression::get_max_compressed_buffer_size(bl, cmode));
-			int s = Compression::compress(cblock.ptrw(), bp, bl, cmode);
-
-			f->store_buffer(cblock.ptr(), s);
-			block_sizes.push_back(s);
-		}
-
-		f->seek(16); //ok write block sizes
-		for (int i = 0; i < bc; i++)
-			f->store_32(block_sizes[i]);
-		f->seek_end();
-		f->store_buffer((const uint8_t *)mgc.get_data(), mgc.length()); //magic at the end too
-
 		buffer.clear();
 
 	} else {
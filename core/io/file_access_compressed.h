@@ -69,6 +69,10 @@ public:
 
 	Error open_after_magic(FileAccess *p_base);
 
+	// Builds the contents of complete compressed files (as written when closing) for p_count buffers at once.
+	// Blocks of all buffers are compressed in parallel. p_magic must be 4 characters long.
+	static Error compress_buffers(const String &p_magic, Compression::Mode p_mode, uint32_t p_block_size, const uint8_t *const *p_src, const uint32_t *p_src_size, Vector<uint8_t> *r_dst, int p_count);
+
 	virtual Error _open(const String &p_path, int p_mode_flags); ///< open a file
 	virtual void close(); ///< close a file
 	virtual bool is_open() const; ///< true when file is open
@@ -30,12 +30,11 @@
 
 #include "file_access_pack.h"
 
+#include "core/io/file_access_compressed.h"
 #include "core/version.h"
 
 #include <stdio.h>
 
-#define PACK_VERSION 1
-
 Error PackedData::add_pack(const String &p_path) {
 
 	for (int i = 0; i < sources.size(); i++) {
@@ -49,7 +48,7 @@ Error PackedData::add_pack(const String &p_path) {
 	return ERR_FILE_UNRECOGNIZED;
 };
 
-void PackedData::add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src) {
+void PackedData::add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, uint32_t p_flags) {
 
 	PathMD5 pmd5(path.md5_buffer());
 	//printf("adding path %ls, %lli, %lli\n", path.c_str(), pmd5.a, pmd5.b);
@@ -62,6 +61,7 @@ void PackedData::add_path(const String &pkg_path, const String &path, uint64_t o
 	pf.size = size;
 	for (int i = 0; i < 16; i++)
 		pf.md5[i] = p_md5[i];
+	pf.flags = p_flags;
 	pf.src = p_src;
 
 	files[pmd5] = pf;
@@ -143,12 +143,12 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 
 	uint32_t magic = f->get_32();
 
-	if (magic != 0x43504447) {
+	if (magic != PACK_HEADER_MAGIC) {
 		//maybe at the end.... self contained exe
 		f->seek_end();
 		f->seek(f->get_position() - 4);
 		magic = f->get_32();
-		if (magic != 0x43504447) {
+		if (magic != PACK_HEADER_MAGIC) {
 
 			memdelete(f);
 			return false;
@@ -159,7 +159,7 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 		f->seek(f->get_position() - ds - 8);
 
 		magic = f->get_32();
-		if (magic != 0x43504447) {
+		if (magic != PACK_HEADER_MAGIC) {
 
 			memdelete(f);
 			return false;
@@ -172,7 +172,7 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 	f->get_32(); // ver_rev
 
 	ERR_EXPLAIN("Pack version unsupported: " + itos(version));
-	ERR_FAIL_COND_V(version != PACK_VERSION, false);
+	ERR_FAIL_COND_V(version < 1 || version > PACK_FORMAT_VERSION, false);
 	ERR_EXPLAIN("Pack created with a newer version of the engine: " + itos(ver_major) + "." + itos(ver_minor));
 	ERR_FAIL_COND_V(ver_major > VERSION_MAJOR || (ver_major == VERSION_MAJOR && ver_minor > VERSION_MINOR), false);
 
@@ -198,7 +198,11 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 		uint64_t size = f->get_64();
 		uint8_t md5[16];
 		f->get_buffer(md5, 16);
-		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this);
+		uint32_t flags = 0;
+		if (version >= 2) {
+			flags = f->get_32();
+		}
+		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this, flags);
 	};
 
 	return true;
@@ -206,7 +210,25 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 
 FileAccess *PackedSourcePCK::get_file(const String &p_path, PackedData::PackedFile *p_file) {
 
-	return memnew(FileAccessPack(p_path, *p_file));
+	FileAccess *f = memnew(FileAccessPack(p_path, *p_file));
+	if (!(p_file->flags & PACK_FILE_COMPRESSED))
+		return f;
+
+	// Blocks are decompressed as they are read, so seeking stays cheap
+	uint8_t magic[4];
+	if (f->get_buffer(magic, 4) != 4 || memcmp(magic, PACK_COMPRESSED_MAGIC, 4) != 0) {
+		memdelete(f);
+		ERR_EXPLAIN("Corrupted compressed file in pack: " + p_path);
+		ERR_FAIL_V(NULL);
+	}
+
+	FileAccessCompressed *fac = memnew(FileAccessCompressed);
+	if (fac->open_after_magic(f) != OK) {
+		memdelete(fac); // also closes f
+		ERR_EXPLAIN("Corrupted compressed file in pack: " + p_path);
+		ERR_FAIL_V(NULL);
+	}
+	return fac;
 };
 
 //////////////////////////////////////////////////////////////////
@@ -37,6 +37,17 @@
 #include "core/os/file_access.h"
 #include "core/print_string.h"
 
+// Godot's packed file magic header ("GDPC" in ASCII).
+#define PACK_HEADER_MAGIC 0x43504447
+// The current packed file format version number.
+#define PACK_FORMAT_VERSION 2
+
+enum PackFileFlags {
+	PACK_FILE_COMPRESSED = 1 << 0, // stored in FileAccessCompressed format (see PACK_COMPRESSED_MAGIC), size is the stored size
+};
+
+#define PACK_COMPRESSED_MAGIC "GCPF"
+
 class PackSource;
 
 class PackedData {
@@ -51,6 +62,7 @@ public:
 		uint64_t offset; //if offset is ZERO, the file was ERASED
 		uint64_t size;
 		uint8_t md5[16];
+		uint32_t flags;
 		PackSource *src;
 	};
 
@@ -102,7 +114,7 @@ private:
 
 public:
 	void add_pack_source(PackSource *p_source);
-	void add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src); // for PackSource
+	void add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, uint32_t p_flags = 0); // for PackSource
 
 	void set_disabled(bool p_disabled) { disabled = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled() const { return disabled; }
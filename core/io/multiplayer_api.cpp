@@ -31,6 +31,7 @@
 #include "multiplayer_api.h"
 
 #include "core/io/marshalls.h"
+#include "core/os/os.h"
 #include "scene/main/node.h"
 
 _FORCE_INLINE_ bool _should_call_local(MultiplayerAPI::RPCMode mode, bool is_master, bool &r_skip_rpc) {
@@ -117,6 +118,15 @@ void MultiplayerAPI::poll() {
 			break; // It's also possible that a packet or RPC caused a disconnection, so also check here.
 		}
 	}
+
+	if (replicated_nodes.size() && network_peer.is_valid() && network_peer->get_connection_status() == NetworkedMultiplayerPeer::CONNECTION_CONNECTED) {
+
+		uint64_t msec = OS::get_singleton()->get_ticks_msec();
+		if (msec - last_replication_msec >= (uint64_t)replication_interval) {
+			last_replication_msec = msec;
+			replication_tick();
+		}
+	}
 }
 
 void MultiplayerAPI::clear() {
@@ -125,6 +135,9 @@ void MultiplayerAPI::clear() {
 	path_send_cache.clear();
 	packet_cache.clear();
 	last_send_cache_id = 1;
+	replication_peers.clear();
+	replication_tick_count = 0;
+	last_replication_msec = 0;
 }
 
 void MultiplayerAPI::set_root_node(Node *p_node) {
@@ -222,6 +235,16 @@ void MultiplayerAPI::_process_packet(int p_from, const uint8_t *p_packet, int p_
 
 			_process_raw(p_from, p_packet, p_packet_len);
 		} break;
+
+		case NETWORK_COMMAND_REPLICATE: {
+
+			_process_replicate(p_from, p_packet, p_packet_len);
+		} break;
+
+		case NETWORK_COMMAND_REPLICATE_ACK: {
+
+			_process_replicate_ack(p_from, p_packet, p_packet_len);
+		} break;
 	}
 }
 
@@ -458,6 +481,19 @@ bool MultiplayerAPI::_send_confirm_path(NodePath p_path, PathSentCache *psc, int
 	return has_all_peers;
 }
 
+MultiplayerAPI::PathSentCache *MultiplayerAPI::_get_path_sent_cache(const NodePath &p_path) {
+
+	// See if the path is cached.
+	PathSentCache *psc = path_send_cache.getptr(p_path);
+	if (!psc) {
+		// Path is not cached, create.
+		path_send_cache[p_path] = PathSentCache();
+		psc = path_send_cache.getptr(p_path);
+		psc->id = last_send_cache_id++;
+	}
+	return psc;
+}
+
 void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, const StringName &p_name, const Variant **p_arg, int p_argcount) {
 
 	if (network_peer.is_null()) {
@@ -494,14 +530,7 @@ void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p
 	ERR_EXPLAIN("Unable to send RPC. Relative path is empty. THIS IS LIKELY A BUG IN THE ENGINE!");
 	ERR_FAIL_COND(from_path.is_empty());
 
-	// See if the path is cached.
-	PathSentCache *psc = path_send_cache.getptr(from_path);
-	if (!psc) {
-		// Path is not cached, create.
-		path_send_cache[from_path] = PathSentCache();
-		psc = path_send_cache.getptr(from_path);
-		psc->id = last_send_cache_id++;
-	}
+	PathSentCache *psc = _get_path_sent_cache(from_path);
 
 	// Create base packet, lots of hardcode because it must be tight.
 
@@ -606,6 +635,7 @@ void MultiplayerAPI::_add_peer(int p_id) {
 void MultiplayerAPI::_del_peer(int p_id) {
 	connected_peers.erase(p_id);
 	path_get_cache.erase(p_id); // I no longer need your cache, sorry.
+	replication_peers.erase(p_id);
 	emit_signal("network_peer_disconnected", p_id);
 }
 
@@ -796,6 +826,628 @@ void MultiplayerAPI::_process_raw(int p_from, const uint8_t *p_packet, int p_pac
 	emit_signal("network_peer_packet", p_from, out);
 }
 
+#define REPLICATION_HISTORY 64
+
+enum {
+	REPLICATION_ENTRY_FULL = 1, // Entry is not a delta, all properties are sent.
+};
+
+enum {
+	REPLICATION_ENCODING_VARIANT,
+	REPLICATION_ENCODING_INT,
+	REPLICATION_ENCODING_REAL,
+	REPLICATION_ENCODING_VECTOR2,
+	REPLICATION_ENCODING_VECTOR3,
+};
+
+static _FORCE_INLINE_ int64_t _quantize(double p_value, real_t p_step) {
+
+	return (int64_t)Math::round(p_value / p_step);
+}
+
+static _FORCE_INLINE_ uint64_t _zigzag(int64_t p_value) {
+
+	return ((uint64_t)p_value << 1) ^ (uint64_t)(p_value >> 63);
+}
+
+static _FORCE_INLINE_ int64_t _unzigzag(uint64_t p_value) {
+
+	return (int64_t)(p_value >> 1) ^ -(int64_t)(p_value & 1);
+}
+
+static bool _decode_varint(const uint8_t *p_packet, int p_packet_len, int &r_ofs, uint64_t &r_value) {
+
+	r_value = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (r_ofs >= p_packet_len)
+			return false;
+		uint8_t b = p_packet[r_ofs++];
+		r_value |= (uint64_t)(b & 0x7F) << shift;
+		if (!(b & 0x80))
+			return true;
+	}
+	return false;
+}
+
+// Values are stored quantized, so both ends compare against exactly what was sent.
+static Variant _quantize_value(const Variant &p_value, real_t p_step) {
+
+	if (p_step <= 0)
+		return p_value;
+
+	switch (p_value.get_type()) {
+		case Variant::REAL: {
+			return _quantize(p_value, p_step) * (double)p_step;
+		}
+		case Variant::VECTOR2: {
+			Vector2 v = p_value;
+			return Vector2(_quantize(v.x, p_step) * p_step, _quantize(v.y, p_step) * p_step);
+		}
+		case Variant::VECTOR3: {
+			Vector3 v = p_value;
+			return Vector3(_quantize(v.x, p_step) * p_step, _quantize(v.y, p_step) * p_step, _quantize(v.z, p_step) * p_step);
+		}
+		default: {
+			return p_value;
+		}
+	}
+}
+
+bool MultiplayerAPI::_encode_replicated_value(const Variant &p_value, const Variant &p_base, real_t p_quantization, bool p_force, int &r_ofs) {
+
+	// Numeric values are sent as the difference to the base (or zero when the base has another type), as zigzag varints.
+	bool numeric_base = p_base.get_type() == p_value.get_type() || p_base.get_type() == Variant::NIL;
+	uint8_t encoding = REPLICATION_ENCODING_VARIANT;
+	int64_t delta[3] = { 0, 0, 0 };
+	int components = 0;
+
+	if (numeric_base) {
+		switch (p_value.get_type()) {
+			case Variant::INT: {
+				int64_t base = p_base.get_type() == Variant::INT ? (int64_t)p_base : 0;
+				delta[0] = (int64_t)((uint64_t)(int64_t)p_value - (uint64_t)base);
+				encoding = REPLICATION_ENCODING_INT;
+				components = 1;
+			} break;
+			case Variant::REAL: {
+				if (p_quantization > 0) {
+					double base = p_base.get_type() == Variant::REAL ? (double)p_base : 0.0;
+					delta[0] = _quantize(p_value, p_quantization) - _quantize(base, p_quantization);
+					encoding = REPLICATION_ENCODING_REAL;
+					components = 1;
+				}
+			} break;
+			case Variant::VECTOR2: {
+				if (p_quantization > 0) {
+					Vector2 v = p_value;
+					Vector2 base = p_base.get_type() == Variant::VECTOR2 ? (Vector2)p_base : Vector2();
+					delta[0] = _quantize(v.x, p_quantization) - _quantize(base.x, p_quantization);
+					delta[1] = _quantize(v.y, p_quantization) - _quantize(base.y, p_quantization);
+					encoding = REPLICATION_ENCODING_VECTOR2;
+					components = 2;
+				}
+			} break;
+			case Variant::VECTOR3: {
+				if (p_quantization > 0) {
+					Vector3 v = p_value;
+					Vector3 base = p_base.get_type() == Variant::VECTOR3 ? (Vector3)p_base : Vector3();
+					delta[0] = _quantize(v.x, p_quantization) - _quantize(base.x, p_quantization);
+					delta[1] = _quantize(v.y, p_quantization) - _quantize(base.y, p_quantization);
+					delta[2] = _quantize(v.z, p_quantization) - _quantize(base.z, p_quantization);
+					encoding = REPLICATION_ENCODING_VECTOR3;
+					components = 3;
+				}
+			} break;
+			default: {
+			}
+		}
+	}
+
+	if (encoding == REPLICATION_ENCODING_VARIANT) {
+
+		if (!p_force && p_value.get_type() == p_base.get_type() && p_value == p_base)
+			return false;
+
+		int len;
+		Error err = encode_variant(p_value, NULL, len, allow_object_decoding || network_peer->is_object_decoding_allowed());
+		ERR_EXPLAIN("Unable to encode replicated value. THIS IS LIKELY A BUG IN THE ENGINE!");
+		ERR_FAIL_COND_V(err != OK, false);
+		MAKE_ROOM(r_ofs + 1 + len);
+		packet_cache.write[r_ofs++] = encoding;
+		encode_variant(p_value, &(packet_cache.write[r_ofs]), len, allow_object_decoding || network_peer->is_object_decoding_allowed());
+		r_ofs += len;
+		return true;
+	}
+
+	if (!p_force && delta[0] == 0 && delta[1] == 0 && delta[2] == 0)
+		return false;
+
+	MAKE_ROOM(r_ofs + 1 + components * 10);
+	packet_cache.write[r_ofs++] = encoding;
+	for (int i = 0; i < components; i++) {
+		uint64_t v = _zigzag(delta[i]);
+		while (v >= 0x80) {
+			packet_cache.write[r_ofs++] = (v & 0x7F) | 0x80;
+			v >>= 7;
+		}
+		packet_cache.write[r_ofs++] = v;
+	}
+	return true;
+}
+
+bool MultiplayerAPI::_decode_replicated_value(const uint8_t *p_packet, int p_packet_len, int &r_ofs, const Variant &p_base, real_t p_quantization, Variant &r_value, bool &r_valid) {
+
+	r_valid = true;
+	ERR_FAIL_COND_V(r_ofs >= p_packet_len, false);
+	uint8_t encoding = p_packet[r_ofs++];
+
+	int components = 0;
+	switch (encoding) {
+		case REPLICATION_ENCODING_VARIANT: {
+			int len;
+			Error err = decode_variant(r_value, &p_packet[r_ofs], p_packet_len - r_ofs, &len, allow_object_decoding || network_peer->is_object_decoding_allowed());
+			ERR_FAIL_COND_V(err != OK, false);
+			r_ofs += len;
+			return true;
+		}
+		case REPLICATION_ENCODING_INT:
+		case REPLICATION_ENCODING_REAL: {
+			components = 1;
+		} break;
+		case REPLICATION_ENCODING_VECTOR2: {
+			components = 2;
+		} break;
+		case REPLICATION_ENCODING_VECTOR3: {
+			components = 3;
+		} break;
+		default: {
+			ERR_FAIL_V(false);
+		}
+	}
+
+	int64_t delta[3] = { 0, 0, 0 };
+	for (int i = 0; i < components; i++) {
+		uint64_t v;
+		ERR_FAIL_COND_V(!_decode_varint(p_packet, p_packet_len, r_ofs, v), false);
+		delta[i] = _unzigzag(v);
+	}
+
+	if (encoding != REPLICATION_ENCODING_INT && p_quantization <= 0) {
+		// Quantized values can only be rebuilt knowing the step, the data is skipped.
+		r_valid = false;
+		return true;
+	}
+
+	switch (encoding) {
+		case REPLICATION_ENCODING_INT: {
+			int64_t base = p_base.get_type() == Variant::INT ? (int64_t)p_base : 0;
+			r_value = (int64_t)((uint64_t)base + (uint64_t)delta[0]);
+		} break;
+		case REPLICATION_ENCODING_REAL: {
+			double base = p_base.get_type() == Variant::REAL ? (double)p_base : 0.0;
+			r_value = (_quantize(base, p_quantization) + delta[0]) * (double)p_quantization;
+		} break;
+		case REPLICATION_ENCODING_VECTOR2: {
+			Vector2 base = p_base.get_type() == Variant::VECTOR2 ? (Vector2)p_base : Vector2();
+			r_value = Vector2((_quantize(base.x, p_quantization) + delta[0]) * p_quantization, (_quantize(base.y, p_quantization) + delta[1]) * p_quantization);
+		} break;
+		case REPLICATION_ENCODING_VECTOR3: {
+			Vector3 base = p_base.get_type() == Variant::VECTOR3 ? (Vector3)p_base : Vector3();
+			r_value = Vector3((_quantize(base.x, p_quantization) + delta[0]) * p_quantization, (_quantize(base.y, p_quantization) + delta[1]) * p_quantization, (_quantize(base.z, p_quantization) + delta[2]) * p_quantization);
+		} break;
+	}
+	return true;
+}
+
+void MultiplayerAPI::replication_track(Node *p_node, const StringName &p_property, real_t p_quantization) {
+
+	ERR_FAIL_NULL(p_node);
+	ERR_FAIL_COND(p_quantization < 0);
+
+	ReplicatedNode &rn = replicated_nodes[p_node->get_instance_id()];
+	if (rn.properties.empty()) {
+		rn.bytes_sent = 0;
+		rn.bytes_received = 0;
+	}
+
+	for (int i = 0; i < rn.properties.size(); i++) {
+		if (rn.properties[i].name == p_property) {
+			rn.properties.write[i].quantization = p_quantization;
+			return;
+		}
+	}
+
+	ERR_EXPLAIN("Too many replicated properties on node: " + String(p_node->get_name()));
+	ERR_FAIL_COND(rn.properties.size() >= 255);
+
+	ReplicatedProperty rp;
+	rp.name = p_property;
+	rp.quantization = p_quantization;
+	rn.properties.push_back(rp);
+}
+
+void MultiplayerAPI::replication_untrack(Node *p_node, const StringName &p_property) {
+
+	ERR_FAIL_NULL(p_node);
+
+	Map<ObjectID, ReplicatedNode>::Element *E = replicated_nodes.find(p_node->get_instance_id());
+	ERR_FAIL_COND(!E);
+
+	for (int i = 0; i < E->get().properties.size(); i++) {
+		if (E->get().properties[i].name == p_property) {
+			E->get().properties.remove(i);
+			break;
+		}
+	}
+
+	if (E->get().properties.empty()) {
+		replicated_nodes.erase(E);
+	}
+}
+
+void MultiplayerAPI::replication_tick() {
+
+	ERR_EXPLAIN("Trying to replicate while no network peer is active.");
+	ERR_FAIL_COND(!network_peer.is_valid());
+	ERR_EXPLAIN("Trying to replicate via a network peer which is not connected.");
+	ERR_FAIL_COND(network_peer->get_connection_status() != NetworkedMultiplayerPeer::CONNECTION_CONNECTED);
+	ERR_EXPLAIN("Multiplayer root node was not initialized. If you are using custom multiplayer, remember to set the root node via MultiplayerAPI.set_root_node before using it");
+	ERR_FAIL_COND(root_node == NULL);
+
+	int unique_id = network_peer->get_unique_id();
+
+	struct Snapshot {
+		ReplicatedNode *rn;
+		PathSentCache *psc;
+		Vector<Variant> values;
+	};
+
+	// Take a snapshot of every node this peer is master of.
+	List<Snapshot> snapshots;
+	List<ObjectID> freed;
+
+	for (Map<ObjectID, ReplicatedNode>::Element *E = replicated_nodes.front(); E; E = E->next()) {
+
+		Node *node = Object::cast_to<Node>(ObjectDB::get_instance(E->key()));
+		if (!node) {
+			freed.push_back(E->key());
+			continue;
+		}
+
+		if (!node->is_inside_tree() || node->get_network_master() != unique_id)
+			continue;
+
+		NodePath path = root_node->get_path().rel_path_to(node->get_path());
+		ERR_CONTINUE(path.is_empty());
+
+		Snapshot s;
+		s.rn = &E->get();
+		s.psc = _get_path_sent_cache(path);
+		s.values.resize(s.rn->properties.size());
+		for (int i = 0; i < s.rn->properties.size(); i++) {
+			s.values.write[i] = _quantize_value(node->get(s.rn->properties[i].name), s.rn->properties[i].quantization);
+		}
+
+		// Peers that don't know the path yet get the node once they confirm it.
+		_send_confirm_path(path, s.psc, 0);
+
+		snapshots.push_back(s);
+	}
+
+	for (List<ObjectID>::Element *E = freed.front(); E; E = E->next()) {
+		replicated_nodes.erase(E->get());
+	}
+
+	if (snapshots.empty())
+		return;
+
+	uint32_t tick = ++replication_tick_count;
+
+	network_peer->set_transfer_mode(NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE);
+
+	// One packet per peer, with the nodes that changed since the state it last acknowledged.
+	for (Set<int>::Element *E = connected_peers.front(); E; E = E->next()) {
+
+		int peer = E->get();
+		ReplicationPeer &rp = replication_peers[peer];
+
+		const Map<int, Vector<Variant> > *base = NULL;
+		if (rp.acked_tick) {
+			Map<uint32_t, Map<int, Vector<Variant> > >::Element *F = rp.sent.find(rp.acked_tick);
+			if (F) {
+				base = &F->get();
+			}
+		}
+
+		MAKE_ROOM(9);
+		packet_cache.write[0] = NETWORK_COMMAND_REPLICATE;
+		encode_uint32(tick, &(packet_cache.write[1]));
+		encode_uint32(base ? rp.acked_tick : 0, &(packet_cache.write[5]));
+		int ofs = 9;
+
+		Map<int, Vector<Variant> > &sent = rp.sent[tick];
+		bool changed = false;
+
+		for (List<Snapshot>::Element *F = snapshots.front(); F; F = F->next()) {
+
+			Snapshot &s = F->get();
+
+			Map<int, bool>::Element *C = s.psc->confirmed_peers.find(peer);
+			if (!C || !C->get())
+				continue;
+
+			sent[s.psc->id] = s.values;
+
+			const Vector<Variant> *base_values = NULL;
+			if (base) {
+				const Map<int, Vector<Variant> >::Element *B = base->find(s.psc->id);
+				if (B && B->get().size() == s.values.size()) {
+					base_values = &B->get();
+				}
+			}
+
+			// Entry: path cache id, flags, property count, bitmask of the properties that follow.
+			int count = s.values.size();
+			int mask_len = (count + 7) / 8;
+			int entry_ofs = ofs;
+			MAKE_ROOM(ofs + 6 + mask_len);
+			encode_uint32(s.psc->id, &(packet_cache.write[ofs]));
+			packet_cache.write[ofs + 4] = base_values ? 0 : REPLICATION_ENTRY_FULL;
+			packet_cache.write[ofs + 5] = count;
+			int mask_ofs = ofs + 6;
+			memset(&(packet_cache.write[mask_ofs]), 0, mask_len);
+			ofs += 6 + mask_len;
+
+			bool entry_changed = false;
+			for (int i = 0; i < count; i++) {
+				Variant base_value = base_values ? (*base_values)[i] : Variant();
+				if (_encode_replicated_value(s.values[i], base_value, s.rn->properties[i].quantization, !base_values, ofs)) {
+					packet_cache.write[mask_ofs + i / 8] |= 1 << (i % 8);
+					entry_changed = true;
+				}
+			}
+
+			if (!entry_changed) {
+				ofs = entry_ofs; // Same as acknowledged, nothing to send.
+				continue;
+			}
+
+			s.rn->bytes_sent += ofs - entry_ofs;
+			changed = true;
+		}
+
+		if (!changed) {
+			// Peer is up to date, the acknowledged snapshot stays as base.
+			rp.sent.erase(tick);
+			continue;
+		}
+
+		network_peer->set_target_peer(peer);
+		network_peer->put_packet(packet_cache.ptr(), ofs);
+
+		// Keep the acknowledged base, drop the oldest unacknowledged snapshots.
+		while (rp.sent.size() > REPLICATION_HISTORY) {
+			Map<uint32_t, Map<int, Vector<Variant> > >::Element *O = rp.sent.front();
+			if (O->key() == rp.acked_tick) {
+				O = O->next();
+			}
+			rp.sent.erase(O);
+		}
+	}
+}
+
+void MultiplayerAPI::_process_replicate(int p_from, const uint8_t *p_packet, int p_packet_len) {
+
+	ERR_EXPLAIN("Invalid packet received. Size too small.");
+	ERR_FAIL_COND(p_packet_len < 9);
+
+	uint32_t tick = decode_uint32(&p_packet[1]);
+	uint32_t base_tick = decode_uint32(&p_packet[5]);
+
+	ReplicationPeer &rp = replication_peers[p_from];
+	if (tick <= rp.received_tick)
+		return; // Late or duplicated, a newer state was already applied.
+
+	const Map<int, Vector<Variant> > *base = NULL;
+	if (base_tick) {
+		Map<uint32_t, Map<int, Vector<Variant> > >::Element *E = rp.received.find(base_tick);
+		if (!E) {
+			// Base is unknown (acknowledgements were lost for too long), ask for the full state.
+			_send_replicate_ack(p_from, 0, Vector<int>());
+			return;
+		}
+		base = &E->get();
+	}
+
+	// The new state is the base plus the entries in this packet.
+	Map<int, Vector<Variant> > state;
+	if (base) {
+		state = *base;
+	}
+
+	Map<int, PathGetCache>::Element *PC = path_get_cache.find(p_from);
+	Vector<int> missing;
+
+	int ofs = 9;
+	while (ofs < p_packet_len) {
+
+		ERR_EXPLAIN("Invalid packet received. Size too small.");
+		ERR_FAIL_COND(ofs + 6 > p_packet_len);
+
+		int entry_ofs = ofs;
+		int id = decode_uint32(&p_packet[ofs]);
+		bool full = p_packet[ofs + 4] & REPLICATION_ENTRY_FULL;
+		int count = p_packet[ofs + 5];
+		int mask_len = (count + 7) / 8;
+		ofs += 6;
+
+		ERR_EXPLAIN("Invalid packet received. Size too small.");
+		ERR_FAIL_COND(ofs + mask_len > p_packet_len);
+		const uint8_t *mask = &p_packet[ofs];
+		ofs += mask_len;
+
+		// Nodes are decoded with their tracked quantization, entries that can't be rebuilt are reported back.
+		Node *node = NULL;
+		ReplicatedNode *rn = NULL;
+		if (PC) {
+			Map<int, PathGetCache::NodeInfo>::Element *F = PC->get().nodes.find(id);
+			if (F) {
+				node = root_node->get_node_or_null(F->get().path);
+			}
+		}
+		if (node) {
+			Map<ObjectID, ReplicatedNode>::Element *F = replicated_nodes.find(node->get_instance_id());
+			if (F && F->get().properties.size() == count) {
+				rn = &F->get();
+			}
+		}
+
+		bool known = rn != NULL;
+		Vector<Variant> values;
+		if (full) {
+			values.resize(count);
+		} else {
+			Map<int, Vector<Variant> >::Element *E = state.find(id);
+			if (E && E->get().size() == count) {
+				values = E->get();
+			} else {
+				known = false;
+			}
+		}
+
+		Vector<bool> changed;
+		changed.resize(count);
+		for (int i = 0; i < count; i++) {
+
+			changed.write[i] = mask[i / 8] & (1 << (i % 8));
+			if (!changed[i])
+				continue;
+
+			Variant value;
+			bool valid;
+			ERR_EXPLAIN("Invalid packet received. Unable to decode replicated value.");
+			ERR_FAIL_COND(!_decode_replicated_value(p_packet, p_packet_len, ofs, known ? values[i] : Variant(), rn ? rn->properties[i].quantization : 0, value, valid));
+			if (known) {
+				values.write[i] = value;
+				known = valid;
+			}
+		}
+
+		if (!known) {
+			state.erase(id);
+			missing.push_back(id);
+			continue;
+		}
+
+		state[id] = values;
+
+		if (node->get_network_master() == p_from) {
+			for (int i = 0; i < count; i++) {
+				if (changed[i]) {
+					node->set(rn->properties[i].name, values[i]);
+				}
+			}
+			rn->bytes_received += ofs - entry_ofs;
+		}
+	}
+
+	rp.received[tick] = state;
+	rp.received_tick = tick;
+
+	// The sender only builds on acknowledged states newer than this base. The base itself is kept,
+	// as the sender keeps using it until one of the newer states is acknowledged.
+	while (rp.received.front()->key() < base_tick) {
+		rp.received.erase(rp.received.front());
+	}
+	while (rp.received.size() > REPLICATION_HISTORY) {
+		Map<uint32_t, Map<int, Vector<Variant> > >::Element *O = rp.received.front();
+		if (O->key() == base_tick) {
+			O = O->next();
+		}
+		rp.received.erase(O);
+	}
+
+	_send_replicate_ack(p_from, tick, missing);
+}
+
+void MultiplayerAPI::_send_replicate_ack(int p_to, uint32_t p_tick, const Vector<int> &p_missing) {
+
+	// Tick 0 requests the full state, otherwise it acknowledges the tick, listing the nodes that must be sent in full again.
+	Vector<uint8_t> ack;
+	ack.resize(5 + p_missing.size() * 4);
+	ack.write[0] = NETWORK_COMMAND_REPLICATE_ACK;
+	encode_uint32(p_tick, &ack.write[1]);
+	for (int i = 0; i < p_missing.size(); i++) {
+		encode_uint32(p_missing[i], &ack.write[5 + i * 4]);
+	}
+
+	network_peer->set_transfer_mode(NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE);
+	network_peer->set_target_peer(p_to);
+	network_peer->put_packet(ack.ptr(), ack.size());
+}
+
+void MultiplayerAPI::_process_replicate_ack(int p_from, const uint8_t *p_packet, int p_packet_len) {
+
+	ERR_EXPLAIN("Invalid packet received. Size too small.");
+	ERR_FAIL_COND(p_packet_len < 5);
+
+	uint32_t tick = decode_uint32(&p_packet[1]);
+
+	Map<int, ReplicationPeer>::Element *E = replication_peers.find(p_from);
+	if (!E)
+		return;
+
+	if (tick == 0) {
+		// Peer lost the base, start over from the full state.
+		E->get().acked_tick = 0;
+		E->get().sent.clear();
+		return;
+	}
+
+	if (tick <= E->get().acked_tick || !E->get().sent.has(tick))
+		return;
+
+	ReplicationPeer &rp = E->get();
+	rp.acked_tick = tick;
+	while (rp.sent.front()->key() < tick) {
+		rp.sent.erase(rp.sent.front());
+	}
+
+	// Nodes the peer could not rebuild are left out of the base, so they are sent in full.
+	Map<int, Vector<Variant> > &base = rp.sent.front()->get();
+	for (int ofs = 5; ofs + 4 <= p_packet_len; ofs += 4) {
+		base.erase(decode_uint32(&p_packet[ofs]));
+	}
+}
+
+void MultiplayerAPI::set_replication_interval(int p_msec) {
+
+	ERR_FAIL_COND(p_msec < 0);
+	replication_interval = p_msec;
+}
+
+int MultiplayerAPI::get_replication_interval() const {
+
+	return replication_interval;
+}
+
+Dictionary MultiplayerAPI::get_replication_stats() const {
+
+	Dictionary stats;
+	for (const Map<ObjectID, ReplicatedNode>::Element *E = replicated_nodes.front(); E; E = E->next()) {
+
+		Node *node = Object::cast_to<Node>(ObjectDB::get_instance(E->key()));
+		if (!node || !node->is_inside_tree())
+			continue;
+
+		Dictionary d;
+		d["bytes_sent"] = E->get().bytes_sent;
+		d["bytes_received"] = E->get().bytes_received;
+		stats[node->get_path()] = d;
+	}
+	return stats;
+}
+
 int MultiplayerAPI::get_network_unique_id() const {
 
 	ERR_EXPLAIN("No network peer is assigned. Unable to get unique network ID.");
@@ -870,10 +1522,17 @@ void MultiplayerAPI::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("is_refusing_new_network_connections"), &MultiplayerAPI::is_refusing_new_network_connections);
 	ClassDB::bind_method(D_METHOD("set_allow_object_decoding", "enable"), &MultiplayerAPI::set_allow_object_decoding);
 	ClassDB::bind_method(D_METHOD("is_object_decoding_allowed"), &MultiplayerAPI::is_object_decoding_allowed);
+	ClassDB::bind_method(D_METHOD("replication_track", "node", "property", "quantization"), &MultiplayerAPI::replication_track, DEFVAL(0.0));
+	ClassDB::bind_method(D_METHOD("replication_untrack", "node", "property"), &MultiplayerAPI::replication_untrack);
+	ClassDB::bind_method(D_METHOD("replication_tick"), &MultiplayerAPI::replication_tick);
+	ClassDB::bind_method(D_METHOD("set_replication_interval", "msec"), &MultiplayerAPI::set_replication_interval);
+	ClassDB::bind_method(D_METHOD("get_replication_interval"), &MultiplayerAPI::get_replication_interval);
+	ClassDB::bind_method(D_METHOD("get_replication_stats"), &MultiplayerAPI::get_replication_stats);
 
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "allow_object_decoding"), "set_allow_object_decoding", "is_object_decoding_allowed");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "refuse_new_network_connections"), "set_refuse_new_network_connections", "is_refusing_new_network_connections");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "network_peer", PROPERTY_HINT_RESOURCE_TYPE, "NetworkedMultiplayerPeer", 0), "set_network_peer", "get_network_peer");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "replication_interval", PROPERTY_HINT_RANGE, "0,1000,1"), "set_replication_interval", "get_replication_interval");
 	ADD_PROPERTY_DEFAULT("refuse_new_network_connections", false);
 
 	ADD_SIGNAL(MethodInfo("network_peer_connected", PropertyInfo(Variant::INT, "id")));
@@ -898,6 +1557,7 @@ MultiplayerAPI::MultiplayerAPI() :
 		allow_object_decoding(false) {
 	rpc_sender_id = 0;
 	root_node = NULL;
+	replication_interval = 50;
 	clear();
 }
 
@@ -55,6 +55,31 @@ private:
 		Map<int, NodeInfo> nodes;
 	};
 
+	// Replicated properties of a node, must be tracked in the same order on every peer
+	struct ReplicatedProperty {
+		StringName name;
+		real_t quantization;
+	};
+
+	struct ReplicatedNode {
+		Vector<ReplicatedProperty> properties;
+		uint64_t bytes_sent;
+		uint64_t bytes_received;
+	};
+
+	// Replication snapshots exchanged with a peer, deltas are sent against the last acknowledged one
+	struct ReplicationPeer {
+		uint32_t acked_tick;
+		Map<uint32_t, Map<int, Vector<Variant> > > sent; // by tick, then path cache id
+		uint32_t received_tick;
+		Map<uint32_t, Map<int, Vector<Variant> > > received;
+
+		ReplicationPeer() {
+			acked_tick = 0;
+			received_tick = 0;
+		}
+	};
+
 	Ref<NetworkedMultiplayerPeer> network_peer;
 	int rpc_sender_id;
 	Set<int> connected_peers;
@@ -65,6 +90,12 @@ private:
 	Node *root_node;
 	bool allow_object_decoding;
 
+	Map<ObjectID, ReplicatedNode> replicated_nodes;
+	Map<int, ReplicationPeer> replication_peers;
+	uint32_t replication_tick_count;
+	int replication_interval;
+	uint64_t last_replication_msec;
+
 protected:
 	static void _bind_methods();
 
@@ -75,9 +106,16 @@ protected:
 	void _process_rpc(Node *p_node, const StringName &p_name, int p_from, const uint8_t *p_packet, int p_packet_len, int p_offset);
 	void _process_rset(Node *p_node, const StringName &p_name, int p_from, const uint8_t *p_packet, int p_packet_len, int p_offset);
 	void _process_raw(int p_from, const uint8_t *p_packet, int p_packet_len);
+	void _process_replicate(int p_from, const uint8_t *p_packet, int p_packet_len);
+	void _process_replicate_ack(int p_from, const uint8_t *p_packet, int p_packet_len);
+	void _send_replicate_ack(int p_to, uint32_t p_tick, const Vector<int> &p_missing);
 
 	void _send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, const StringName &p_name, const Variant **p_arg, int p_argcount);
 	bool _send_confirm_path(NodePath p_path, PathSentCache *psc, int p_target);
+	PathSentCache *_get_path_sent_cache(const NodePath &p_path);
+
+	bool _encode_replicated_value(const Variant &p_value, const Variant &p_base, real_t p_quantization, bool p_force, int &r_ofs);
+	bool _decode_replicated_value(const uint8_t *p_packet, int p_packet_len, int &r_ofs, const Variant &p_base, real_t p_quantization, Variant &r_value, bool &r_valid);
 
 public:
 	enum NetworkCommands {
@@ -86,6 +124,8 @@ public:
 		NETWORK_COMMAND_SIMPLIFY_PATH,
 		NETWORK_COMMAND_CONFIRM_PATH,
 		NETWORK_COMMAND_RAW,
+		NETWORK_COMMAND_REPLICATE,
+		NETWORK_COMMAND_REPLICATE_ACK,
 	};
 
 	enum RPCMode {
@@ -130,6 +170,13 @@ public:
 	void set_allow_object_decoding(bool p_enable);
 	bool is_object_decoding_allowed() const;
 
+	void replication_track(Node *p_node, const StringName &p_property, real_t p_quantization = 0);
+	void replication_untrack(Node *p_node, const StringName &p_property);
+	void replication_tick();
+	void set_replication_interval(int p_msec);
+	int get_replication_interval() const;
+	Dictionary get_replication_stats() const;
+
 	MultiplayerAPI();
 	~MultiplayerAPI();
 };
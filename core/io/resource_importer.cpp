@@ -201,7 +201,7 @@ bool ResourceFormatImporter::can_be_imported(const String &p_path) const {
 	return ResourceFormatLoader::recognize_path(p_path);
 }
 
-int ResourceFormatImporter::get_import_order(const String &p_path) const {
+Ref<ResourceImporter> ResourceFormatImporter::get_importer_for_path(const String &p_path) const {
 
 	Ref<ResourceImporter> importer;
 
@@ -218,6 +218,13 @@ int ResourceFormatImporter::get_import_order(const String &p_path) const {
 		importer = get_importer_by_extension(p_path.get_extension().to_lower());
 	}
 
+	return importer;
+}
+
+int ResourceFormatImporter::get_import_order(const String &p_path) const {
+
+	Ref<ResourceImporter> importer = get_importer_for_path(p_path);
+
 	if (importer.is_valid())
 		return importer->get_import_order();
 
@@ -73,6 +73,7 @@ public:
 
 	virtual bool can_be_imported(const String &p_path) const;
 	virtual int get_import_order(const String &p_path) const;
+	Ref<ResourceImporter> get_importer_for_path(const String &p_path) const;
 
 	String get_internal_resource_path(const String &p_path) const;
 	void get_internal_resource_path_list(const String &p_path, List<String> *r_paths);
@@ -104,6 +105,7 @@ public:
 	virtual String get_resource_type() const = 0;
 	virtual float get_priority() const { return 1.0; }
 	virtual int get_import_order() const { return 0; }
+	virtual bool can_import_threaded() const { return false; } // import() may run on several files at once, from worker threads
 
 	struct ImportOption {
 		PropertyInfo option;
@@ -0,0 +1,197 @@
+/*************************************************************************/
+/*  stream_peer_compressed.cpp                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "stream_peer_compressed.h"
+
+#define PROCESS_CHUNK_SIZE 16384
+
+Error StreamPeerCompressed::_start(CompressionMode p_mode, int p_buffer_size, bool p_compress) {
+
+	ERR_FAIL_COND_V(p_buffer_size < 1024 || p_buffer_size > (1 << 28), ERR_INVALID_PARAMETER);
+
+	clear();
+
+	stream = Compression::create_stream(Compression::Mode(p_mode), p_compress);
+	ERR_FAIL_COND_V(!stream, ERR_UNAVAILABLE);
+
+	compressing = p_compress;
+	rb.resize(nearest_shift(p_buffer_size - 1));
+	buffer.resize(MIN(p_buffer_size, PROCESS_CHUNK_SIZE));
+
+	return OK;
+}
+
+Error StreamPeerCompressed::_process(const uint8_t *p_src, int p_src_size, int &r_consumed) {
+
+	r_consumed = 0;
+
+	while (!ended) {
+
+		int space = MIN(rb.space_left(), buffer.size());
+		if (space == 0)
+			break; // output is full, data must be read first
+
+		int src_size = p_src_size - r_consumed;
+		int dst_size = space;
+		Error err = stream->process(p_src + r_consumed, src_size, buffer.ptrw(), dst_size, finishing);
+
+		r_consumed += src_size;
+		rb.write(buffer.ptr(), dst_size);
+
+		if (err == ERR_FILE_EOF) {
+			ended = true;
+		} else if (err != OK) {
+			return err;
+		} else if (src_size == 0 && dst_size == 0) {
+			break; // no progress possible
+		} else if (r_consumed == p_src_size && dst_size < space && !finishing) {
+			break; // all input consumed and nothing left to output
+		}
+	}
+
+	return OK;
+}
+
+Error StreamPeerCompressed::start_compression(CompressionMode p_mode, int p_buffer_size) {
+
+	return _start(p_mode, p_buffer_size, true);
+}
+
+Error StreamPeerCompressed::start_decompression(CompressionMode p_mode, int p_buffer_size) {
+
+	return _start(p_mode, p_buffer_size, false);
+}
+
+Error StreamPeerCompressed::finish() {
+
+	ERR_FAIL_COND_V(!stream || !compressing, ERR_UNAVAILABLE);
+
+	finishing = true;
+
+	int consumed;
+	Error err = _process(NULL, 0, consumed);
+	if (err != OK)
+		return err;
+
+	// If the output filled up, the rest of the stream is produced as data is read
+	return ended ? OK : ERR_BUSY;
+}
+
+void StreamPeerCompressed::clear() {
+
+	if (stream) {
+		memdelete(stream);
+		stream = NULL;
+	}
+
+	compressing = false;
+	finishing = false;
+	ended = false;
+	rb.clear();
+}
+
+Error StreamPeerCompressed::put_data(const uint8_t *p_data, int p_bytes) {
+
+	int sent;
+	Error err = put_partial_data(p_data, p_bytes, sent);
+	if (err != OK)
+		return err;
+
+	ERR_EXPLAIN("Not enough space in the output buffer, read the available data before putting more.");
+	ERR_FAIL_COND_V(sent != p_bytes, ERR_OUT_OF_MEMORY);
+	return OK;
+}
+
+Error StreamPeerCompressed::put_partial_data(const uint8_t *p_data, int p_bytes, int &r_sent) {
+
+	r_sent = 0;
+	ERR_FAIL_COND_V(!stream, ERR_UNCONFIGURED);
+	ERR_FAIL_COND_V(finishing, ERR_ALREADY_IN_USE);
+
+	if (ended) {
+		return ERR_FILE_EOF; // decompressed stream ended, trailing data is not used
+	}
+
+	return _process(p_data, p_bytes, r_sent);
+}
+
+Error StreamPeerCompressed::get_data(uint8_t *p_buffer, int p_bytes) {
+
+	int received;
+	Error err = get_partial_data(p_buffer, p_bytes, received);
+	if (err != OK)
+		return err;
+
+	ERR_FAIL_COND_V(received != p_bytes, ERR_UNAVAILABLE);
+	return OK;
+}
+
+Error StreamPeerCompressed::get_partial_data(uint8_t *p_buffer, int p_bytes, int &r_received) {
+
+	r_received = rb.read(p_buffer, MIN(p_bytes, rb.data_left()));
+
+	// The stream may hold output that didn't fit before, move it now there is room
+	if (stream && !ended && r_received > 0) {
+		int consumed;
+		return _process(NULL, 0, consumed);
+	}
+
+	return OK;
+}
+
+int StreamPeerCompressed::get_available_bytes() const {
+
+	return rb.data_left();
+}
+
+void StreamPeerCompressed::_bind_methods() {
+
+	ClassDB::bind_method(D_METHOD("start_compression", "mode", "buffer_size"), &StreamPeerCompressed::start_compression, DEFVAL(COMPRESSION_ZSTD), DEFVAL(65536));
+	ClassDB::bind_method(D_METHOD("start_decompression", "mode", "buffer_size"), &StreamPeerCompressed::start_decompression, DEFVAL(COMPRESSION_ZSTD), DEFVAL(65536));
+	ClassDB::bind_method(D_METHOD("finish"), &StreamPeerCompressed::finish);
+	ClassDB::bind_method(D_METHOD("clear"), &StreamPeerCompressed::clear);
+
+	BIND_ENUM_CONSTANT(COMPRESSION_DEFLATE);
+	BIND_ENUM_CONSTANT(COMPRESSION_ZSTD);
+	BIND_ENUM_CONSTANT(COMPRESSION_GZIP);
+}
+
+StreamPeerCompressed::StreamPeerCompressed() {
+
+	stream = NULL;
+	compressing = false;
+	finishing = false;
+	ended = false;
+}
+
+StreamPeerCompressed::~StreamPeerCompressed() {
+
+	clear();
+}
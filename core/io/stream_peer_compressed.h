@@ -0,0 +1,84 @@
+/*************************************************************************/
+/*  stream_peer_compressed.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef STREAM_PEER_COMPRESSED_H
+#define STREAM_PEER_COMPRESSED_H
+
+#include "core/io/compression.h"
+#include "core/io/stream_peer.h"
+#include "core/ring_buffer.h"
+
+class StreamPeerCompressed : public StreamPeer {
+
+	GDCLASS(StreamPeerCompressed, StreamPeer);
+
+public:
+	enum CompressionMode {
+		COMPRESSION_DEFLATE = Compression::MODE_DEFLATE,
+		COMPRESSION_ZSTD = Compression::MODE_ZSTD,
+		COMPRESSION_GZIP = Compression::MODE_GZIP,
+	};
+
+private:
+	Compression::Stream *stream;
+	bool compressing;
+	bool finishing;
+	bool ended;
+
+	RingBuffer<uint8_t> rb; // processed data waiting to be read, its size bounds memory use
+	Vector<uint8_t> buffer;
+
+	Error _start(CompressionMode p_mode, int p_buffer_size, bool p_compress);
+	Error _process(const uint8_t *p_src, int p_src_size, int &r_consumed);
+
+protected:
+	static void _bind_methods();
+
+public:
+	Error start_compression(CompressionMode p_mode = COMPRESSION_ZSTD, int p_buffer_size = 65536);
+	Error start_decompression(CompressionMode p_mode = COMPRESSION_ZSTD, int p_buffer_size = 65536);
+	Error finish();
+	void clear();
+
+	virtual Error put_data(const uint8_t *p_data, int p_bytes);
+	virtual Error put_partial_data(const uint8_t *p_data, int p_bytes, int &r_sent);
+
+	virtual Error get_data(uint8_t *p_buffer, int p_bytes);
+	virtual Error get_partial_data(uint8_t *p_buffer, int p_bytes, int &r_received);
+
+	virtual int get_available_bytes() const;
+
+	StreamPeerCompressed();
+	~StreamPeerCompressed();
+};
+
+VARIANT_ENUM_CAST(StreamPeerCompressed::CompressionMode);
+
+#endif // STREAM_PEER_COMPRESSED_H
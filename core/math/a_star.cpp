@@ -36,11 +36,15 @@
 
 int AStar::get_available_point_id() const {
 
-	if (points.empty()) {
-		return 1;
+	if (points.has(last_free_id)) {
+		int cur_new_id = last_free_id + 1;
+		while (points.has(cur_new_id)) {
+			cur_new_id++;
+		}
+		const_cast<int &>(last_free_id) = cur_new_id;
 	}
 
-	return points.back()->key() + 1;
+	return last_free_id;
 }
 
 void AStar::add_point(int p_id, const Vector3 &p_pos, real_t p_weight_scale) {
@@ -48,93 +52,109 @@ void AStar::add_point(int p_id, const Vector3 &p_pos, real_t p_weight_scale) {
 	ERR_FAIL_COND(p_id < 0);
 	ERR_FAIL_COND(p_weight_scale < 1);
 
-	if (!points.has(p_id)) {
+	Point **found_pt = points.lookup_ptr(p_id);
+
+	if (!found_pt) {
 		Point *pt = memnew(Point);
 		pt->id = p_id;
+		pt->index = point_list.size();
 		pt->pos = p_pos;
 		pt->weight_scale = p_weight_scale;
-		pt->prev_point = NULL;
-		pt->open_pass = 0;
-		pt->closed_pass = 0;
 		pt->enabled = true;
-		points[p_id] = pt;
+		points.set(p_id, pt);
+		point_list.push_back(pt);
 	} else {
-		points[p_id]->pos = p_pos;
-		points[p_id]->weight_scale = p_weight_scale;
+		(*found_pt)->pos = p_pos;
+		(*found_pt)->weight_scale = p_weight_scale;
 	}
 }
 
 Vector3 AStar::get_point_position(int p_id) const {
 
-	ERR_FAIL_COND_V(!points.has(p_id), Vector3());
+	Point **p = points.lookup_ptr(p_id);
+	ERR_FAIL_COND_V(!p, Vector3());
 
-	return points[p_id]->pos;
+	return (*p)->pos;
 }
 
 void AStar::set_point_position(int p_id, const Vector3 &p_pos) {
 
-	ERR_FAIL_COND(!points.has(p_id));
+	Point **p = points.lookup_ptr(p_id);
+	ERR_FAIL_COND(!p);
 
-	points[p_id]->pos = p_pos;
+	(*p)->pos = p_pos;
 }
 
 real_t AStar::get_point_weight_scale(int p_id) const {
 
-	ERR_FAIL_COND_V(!points.has(p_id), 0);
+	Point **p = points.lookup_ptr(p_id);
+	ERR_FAIL_COND_V(!p, 0);
 
-	return points[p_id]->weight_scale;
+	return (*p)->weight_scale;
 }
 
 void AStar::set_point_weight_scale(int p_id, real_t p_weight_scale) {
 
-	ERR_FAIL_COND(!points.has(p_id));
+	Point **p = points.lookup_ptr(p_id);
+	ERR_FAIL_COND(!p);
 	ERR_FAIL_COND(p_weight_scale < 1);
 
-	points[p_id]->weight_scale = p_weight_scale;
+	(*p)->weight_scale = p_weight_scale;
 }
 
 void AStar::remove_point(int p_id) {
 
-	ERR_FAIL_COND(!points.has(p_id));
-
-	Point *p = points[p_id];
+	Point *p;
+	bool p_exists = points.lookup(p_id, p);
+	ERR_FAIL_COND(!p_exists);
 
-	for (Set<Point *>::Element *E = p->neighbours.front(); E; E = E->next()) {
+	for (OAHashMap<int, Point *>::Iterator it = p->neighbours.iter(); it.valid; it = p->neighbours.next_iter(it)) {
 
-		Segment s(p_id, E->get()->id);
-		segments.erase(s);
+		Segment s(p_id, (*it.key));
+		segments.remove(s.key);
 
-		E->get()->neighbours.erase(p);
-		E->get()->unlinked_neighbours.erase(p);
+		(*it.value)->neighbours.remove(p->id);
+		(*it.value)->unlinked_neighbours.remove(p->id);
 	}
 
-	for (Set<Point *>::Element *E = p->unlinked_neighbours.front(); E; E = E->next()) {
+	for (OAHashMap<int, Point *>::Iterator it = p->unlinked_neighbours.iter(); it.valid; it = p->unlinked_neighbours.next_iter(it)) {
 
-		Segment s(p_id, E->get()->id);
-		segments.erase(s);
+		Segment s(p_id, (*it.key));
+		segments.remove(s.key);
 
-		E->get()->neighbours.erase(p);
-		E->get()->unlinked_neighbours.erase(p);
+		(*it.value)->neighbours.remove(p->id);
+		(*it.value)->unlinked_neighbours.remove(p->id);
 	}
 
+	// Keep the list contiguous by moving the last point in the hole
+	Point *last = point_list[point_list.size() - 1];
+	last->index = p->index;
+	point_list.write[p->index] = last;
+	point_list.resize(point_list.size() - 1);
+
 	memdelete(p);
-	points.erase(p_id);
+	points.remove(p_id);
+	last_free_id = p_id;
 }
 
 void AStar::connect_points(int p_id, int p_with_id, bool bidirectional) {
 
-	ERR_FAIL_COND(!points.has(p_id));
-	ERR_FAIL_COND(!points.has(p_with_id));
 	ERR_FAIL_COND(p_id == p_with_id);
 
-	Point *a = points[p_id];
-	Point *b = points[p_with_id];
-	a->neighbours.insert(b);
+	Point *a;
+	bool from_exists = points.lookup(p_id, a);
+	ERR_FAIL_COND(!from_exists);
+
+	Point *b;
+	bool to_exists = points.lookup(p_with_id, b);
+	ERR_FAIL_COND(!to_exists);
+
+	a->neighbours.set(b->id, b);
 
 	if (bidirectional)
-		b->neighbours.insert(a);
+		b->neighbours.set(a->id, a);
 	else
-		b->unlinked_neighbours.insert(a);
+		b->unlinked_neighbours.set(a->id, a);
 
 	Segment s(p_id, p_with_id);
 	if (s.from == p_id) {
@@ -145,21 +165,28 @@ void AStar::connect_points(int p_id, int p_with_id, bool bidirectional) {
 		s.to_point = a;
 	}
 
-	segments.insert(s);
+	segments.set(s.key, s);
 }
+
 void AStar::disconnect_points(int p_id, int p_with_id) {
 
 	Segment s(p_id, p_with_id);
-	ERR_FAIL_COND(!segments.has(s));
+	ERR_FAIL_COND(!segments.has(s.key));
+
+	segments.remove(s.key);
+
+	Point *a;
+	bool a_exists = points.lookup(p_id, a);
+	CRASH_COND(!a_exists);
 
-	segments.erase(s);
+	Point *b;
+	bool b_exists = points.lookup(p_with_id, b);
+	CRASH_COND(!b_exists);
 
-	Point *a = points[p_id];
-	Point *b = points[p_with_id];
-	a->neighbours.erase(b);
-	a->unlinked_neighbours.erase(b);
-	b->neighbours.erase(a);
-	b->unlinked_neighbours.erase(a);
+	a->neighbours.remove(b->id);
+	a->unlinked_neighbours.remove(b->id);
+	b->neighbours.remove(a->id);
+	b->unlinked_neighbours.remove(a->id);
 }
 
 bool AStar::has_point(int p_id) const {
@@ -169,42 +196,43 @@ bool AStar::has_point(int p_id) const {
 
 Array AStar::get_points() {
 
-	Array point_list;
+	Array point_list_ids;
 
-	for (const Map<int, Point *>::Element *E = points.front(); E; E = E->next()) {
-		point_list.push_back(E->key());
+	for (int i = 0; i < point_list.size(); i++) {
+		point_list_ids.push_back(point_list[i]->id);
 	}
 
-	return point_list;
+	return point_list_ids;
 }
 
 PoolVector<int> AStar::get_point_connections(int p_id) {
 
-	ERR_FAIL_COND_V(!points.has(p_id), PoolVector<int>());
+	Point *p;
+	bool p_exists = points.lookup(p_id, p);
+	ERR_FAIL_COND_V(!p_exists, PoolVector<int>());
 
-	PoolVector<int> point_list;
+	PoolVector<int> point_list_ids;
 
-	Point *p = points[p_id];
-
-	for (Set<Point *>::Element *E = p->neighbours.front(); E; E = E->next()) {
-		point_list.push_back(E->get()->id);
+	for (OAHashMap<int, Point *>::Iterator it = p->neighbours.iter(); it.valid; it = p->neighbours.next_iter(it)) {
+		point_list_ids.push_back((*it.key));
 	}
 
-	return point_list;
+	return point_list_ids;
 }
 
 bool AStar::are_points_connected(int p_id, int p_with_id) const {
 
 	Segment s(p_id, p_with_id);
-	return segments.has(s);
+	return segments.has(s.key);
 }
 
 void AStar::clear() {
 
-	for (const Map<int, Point *>::Element *E = points.front(); E; E = E->next()) {
-
-		memdelete(E->get());
+	last_free_id = 0;
+	for (int i = 0; i < point_list.size(); i++) {
+		memdelete(point_list[i]);
 	}
+	point_list.clear();
 	segments.clear();
 	points.clear();
 }
@@ -214,14 +242,15 @@ int AStar::get_closest_point(const Vector3 &p_point) const {
 	int closest_id = -1;
 	real_t closest_dist = 1e20;
 
-	for (const Map<int, Point *>::Element *E = points.front(); E; E = E->next()) {
+	for (int i = 0; i < point_list.size(); i++) {
 
-		if (!E->get()->enabled)
+		const Point *p = point_list[i];
+		if (!p->enabled)
 			continue; //Disabled points should not be considered
-		real_t d = p_point.distance_squared_to(E->get()->pos);
-		if (closest_id < 0 || d < closest_dist) {
+		real_t d = p_point.distance_squared_to(p->pos);
+		if (closest_id < 0 || d < closest_dist || (d == closest_dist && p->id < closest_id)) { // Ties go to the lowest id, regardless of storage order
 			closest_dist = d;
-			closest_id = E->key();
+			closest_id = p->id;
 		}
 	}
 
@@ -234,15 +263,16 @@ Vector3 AStar::get_closest_position_in_segment(const Vector3 &p_point) const {
 	bool found = false;
 	Vector3 closest_point;
 
-	for (const Set<Segment>::Element *E = segments.front(); E; E = E->next()) {
+	for (OAHashMap<uint64_t, Segment>::Iterator it = segments.iter(); it.valid; it = segments.next_iter(it)) {
 
-		if (!(E->get().from_point->enabled && E->get().to_point->enabled)) {
+		const Segment &s = *it.value;
+		if (!(s.from_point->enabled && s.to_point->enabled)) {
 			continue;
 		}
 
 		Vector3 segment[2] = {
-			E->get().from_point->pos,
-			E->get().to_point->pos,
+			s.from_point->pos,
+			s.to_point->pos,
 		};
 
 		Vector3 p = Geometry::get_closest_point_to_segment(p_point, segment);
@@ -258,68 +288,170 @@ Vector3 AStar::get_closest_position_in_segment(const Vector3 &p_point) const {
 	return closest_point;
 }
 
-bool AStar::_solve(Point *begin_point, Point *end_point) {
+AStar::SearchState *AStar::_alloc_search_state() {
+
+	SearchState *state = NULL;
+
+	search_mutex->lock();
+	if (free_search_states.size()) {
+		state = free_search_states[free_search_states.size() - 1];
+		free_search_states.resize(free_search_states.size() - 1);
+	}
+	search_mutex->unlock();
+
+	if (!state) {
+		state = memnew(SearchState);
+		state->pass = 0;
+	}
+
+	if (state->nodes.size() < point_list.size()) {
+		int from = state->nodes.size();
+		state->nodes.resize(point_list.size());
+		SearchNode *nodes = state->nodes.ptrw();
+		for (int i = from; i < state->nodes.size(); i++) {
+			nodes[i].pass = 0;
+		}
+	}
+
+	state->pass++;
+	if (state->pass == 0) { // Wrapped around, old stamps could match again
+		SearchNode *nodes = state->nodes.ptrw();
+		for (int i = 0; i < state->nodes.size(); i++) {
+			nodes[i].pass = 0;
+		}
+		state->pass = 1;
+	}
+
+	state->open_heap.clear();
+
+	return state;
+}
+
+void AStar::_free_search_state(SearchState *p_state) {
 
-	pass++;
+	search_mutex->lock();
+	free_search_states.push_back(p_state);
+	search_mutex->unlock();
+}
+
+void AStar::_heap_sift_up(SearchState *p_state, int p_heap_index) {
+
+	int *heap = p_state->open_heap.ptrw();
+	SearchNode *nodes = p_state->nodes.ptrw();
+
+	int point = heap[p_heap_index];
+	while (p_heap_index > 0) {
+
+		int parent = (p_heap_index - 1) / 2;
+		if (!_is_better(nodes[point], nodes[heap[parent]]))
+			break;
+
+		heap[p_heap_index] = heap[parent];
+		nodes[heap[p_heap_index]].heap_index = p_heap_index;
+		p_heap_index = parent;
+	}
+
+	heap[p_heap_index] = point;
+	nodes[point].heap_index = p_heap_index;
+}
+
+void AStar::_heap_sift_down(SearchState *p_state, int p_heap_index) {
+
+	int *heap = p_state->open_heap.ptrw();
+	SearchNode *nodes = p_state->nodes.ptrw();
+	int size = p_state->open_heap.size();
+
+	int point = heap[p_heap_index];
+	while (true) {
+
+		int child = p_heap_index * 2 + 1;
+		if (child >= size)
+			break;
+
+		if (child + 1 < size && _is_better(nodes[heap[child + 1]], nodes[heap[child]]))
+			child++;
+
+		if (!_is_better(nodes[heap[child]], nodes[point]))
+			break;
+
+		heap[p_heap_index] = heap[child];
+		nodes[heap[p_heap_index]].heap_index = p_heap_index;
+		p_heap_index = child;
+	}
+
+	heap[p_heap_index] = point;
+	nodes[point].heap_index = p_heap_index;
+}
+
+bool AStar::_solve(SearchState *p_state, Point *begin_point, Point *end_point) {
 
 	if (!end_point->enabled)
 		return false;
 
 	bool found_route = false;
 
-	Vector<Point *> open_list;
-	SortArray<Point *, SortPoints> sorter;
+	SearchNode *nodes = p_state->nodes.ptrw();
+	uint32_t pass = p_state->pass;
 
-	begin_point->g_score = 0;
-	begin_point->f_score = _estimate_cost(begin_point->id, end_point->id);
+	SearchNode &begin = nodes[begin_point->index];
+	begin.pass = pass;
+	begin.prev_point = -1;
+	begin.g_score = 0;
+	begin.f_score = _estimate_cost(begin_point->id, end_point->id);
 
-	open_list.push_back(begin_point);
+	p_state->open_heap.push_back(begin_point->index);
+	begin.heap_index = 0;
 
 	while (true) {
 
-		if (open_list.size() == 0) // No path found
+		if (p_state->open_heap.size() == 0) // No path found
 			break;
 
-		Point *p = open_list[0]; // The currently processed point
+		int p_index = p_state->open_heap[0];
+		Point *p = point_list[p_index]; // The currently processed point
 
 		if (p == end_point) {
 			found_route = true;
 			break;
 		}
 
-		sorter.pop_heap(0, open_list.size(), open_list.ptrw()); // Remove the current point from the open list
-		open_list.remove(open_list.size() - 1);
-		p->closed_pass = pass; // Mark the point as closed
+		// Remove the current point from the open list, and mark it as closed
+		int last = p_state->open_heap[p_state->open_heap.size() - 1];
+		p_state->open_heap.resize(p_state->open_heap.size() - 1);
+		if (p_state->open_heap.size()) {
+			p_state->open_heap.write[0] = last;
+			_heap_sift_down(p_state, 0);
+		}
 
-		for (Set<Point *>::Element *E = p->neighbours.front(); E; E = E->next()) {
+		SearchNode &pn = nodes[p_index];
+		pn.heap_index = HEAP_CLOSED;
 
-			Point *e = E->get(); // The neighbour point
+		for (OAHashMap<int, Point *>::Iterator it = p->neighbours.iter(); it.valid; it = p->neighbours.next_iter(it)) {
 
-			if (!e->enabled || e->closed_pass == pass)
+			Point *e = *(it.value); // The neighbour point
+			SearchNode &en = nodes[e->index];
+			bool visited = en.pass == pass;
+
+			if (!e->enabled || (visited && en.heap_index == HEAP_CLOSED))
 				continue;
 
-			real_t tentative_g_score = p->g_score + _compute_cost(p->id, e->id) * e->weight_scale;
+			real_t tentative_g_score = pn.g_score + _compute_cost(p->id, e->id) * e->weight_scale;
 
-			bool new_point = false;
+			if (visited && tentative_g_score >= en.g_score) // The new path is worse than the previous
+				continue;
 
-			if (e->open_pass != pass) { // The point wasn't inside the open list
+			en.prev_point = p_index;
+			en.g_score = tentative_g_score;
+			en.f_score = en.g_score + _estimate_cost(e->id, end_point->id);
 
-				e->open_pass = pass;
-				open_list.push_back(e);
-				new_point = true;
-			} else if (tentative_g_score >= e->g_score) { // The new path is worse than the previous
+			if (!visited) { // The point wasn't inside the open list
 
-				continue;
+				en.pass = pass;
+				en.heap_index = p_state->open_heap.size();
+				p_state->open_heap.push_back(e->index);
 			}
 
-			e->prev_point = p;
-			e->g_score = tentative_g_score;
-			e->f_score = e->g_score + _estimate_cost(e->id, end_point->id);
-
-			if (new_point) // The position of the new points is already known
-				sorter.push_heap(0, open_list.size() - 1, 0, e, open_list.ptrw());
-			else
-				sorter.push_heap(0, open_list.find(e), 0, e, open_list.ptrw());
+			_heap_sift_up(p_state, en.heap_index); // The score only went down
 		}
 	}
 
@@ -331,7 +463,15 @@ float AStar::_estimate_cost(int p_from_id, int p_to_id) {
 	if (get_script_instance() && get_script_instance()->has_method(SceneStringNames::get_singleton()->_estimate_cost))
 		return get_script_instance()->call(SceneStringNames::get_singleton()->_estimate_cost, p_from_id, p_to_id);
 
-	return points[p_from_id]->pos.distance_to(points[p_to_id]->pos);
+	Point *from_point;
+	bool from_exists = points.lookup(p_from_id, from_point);
+	ERR_FAIL_COND_V(!from_exists, 0);
+
+	Point *to_point;
+	bool to_exists = points.lookup(p_to_id, to_point);
+	ERR_FAIL_COND_V(!to_exists, 0);
+
+	return from_point->pos.distance_to(to_point->pos);
 }
 
 float AStar::_compute_cost(int p_from_id, int p_to_id) {
@@ -339,16 +479,26 @@ float AStar::_compute_cost(int p_from_id, int p_to_id) {
 	if (get_script_instance() && get_script_instance()->has_method(SceneStringNames::get_singleton()->_compute_cost))
 		return get_script_instance()->call(SceneStringNames::get_singleton()->_compute_cost, p_from_id, p_to_id);
 
-	return points[p_from_id]->pos.distance_to(points[p_to_id]->pos);
+	Point *from_point;
+	bool from_exists = points.lookup(p_from_id, from_point);
+	ERR_FAIL_COND_V(!from_exists, 0);
+
+	Point *to_point;
+	bool to_exists = points.lookup(p_to_id, to_point);
+	ERR_FAIL_COND_V(!to_exists, 0);
+
+	return from_point->pos.distance_to(to_point->pos);
 }
 
 PoolVector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
 
-	ERR_FAIL_COND_V(!points.has(p_from_id), PoolVector<Vector3>());
-	ERR_FAIL_COND_V(!points.has(p_to_id), PoolVector<Vector3>());
+	Point *a;
+	bool from_exists = points.lookup(p_from_id, a);
+	ERR_FAIL_COND_V(!from_exists, PoolVector<Vector3>());
 
-	Point *a = points[p_from_id];
-	Point *b = points[p_to_id];
+	Point *b;
+	bool to_exists = points.lookup(p_to_id, b);
+	ERR_FAIL_COND_V(!to_exists, PoolVector<Vector3>());
 
 	if (a == b) {
 		PoolVector<Vector3> ret;
@@ -359,17 +509,22 @@ PoolVector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
 	Point *begin_point = a;
 	Point *end_point = b;
 
-	bool found_route = _solve(begin_point, end_point);
+	SearchState *state = _alloc_search_state();
+	bool found_route = _solve(state, begin_point, end_point);
 
-	if (!found_route)
+	if (!found_route) {
+		_free_search_state(state);
 		return PoolVector<Vector3>();
+	}
+
+	const SearchNode *nodes = state->nodes.ptr();
 
 	// Midpoints
-	Point *p = end_point;
+	int p = end_point->index;
 	int pc = 1; // Begin point
-	while (p != begin_point) {
+	while (p != begin_point->index) {
 		pc++;
-		p = p->prev_point;
+		p = nodes[p].prev_point;
 	}
 
 	PoolVector<Vector3> path;
@@ -378,26 +533,30 @@ PoolVector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
 	{
 		PoolVector<Vector3>::Write w = path.write();
 
-		Point *p2 = end_point;
+		int p2 = end_point->index;
 		int idx = pc - 1;
-		while (p2 != begin_point) {
-			w[idx--] = p2->pos;
-			p2 = p2->prev_point;
+		while (p2 != begin_point->index) {
+			w[idx--] = point_list[p2]->pos;
+			p2 = nodes[p2].prev_point;
 		}
 
-		w[0] = p2->pos; // Assign first
+		w[0] = begin_point->pos; // Assign first
 	}
 
+	_free_search_state(state);
+
 	return path;
 }
 
 PoolVector<int> AStar::get_id_path(int p_from_id, int p_to_id) {
 
-	ERR_FAIL_COND_V(!points.has(p_from_id), PoolVector<int>());
-	ERR_FAIL_COND_V(!points.has(p_to_id), PoolVector<int>());
+	Point *a;
+	bool from_exists = points.lookup(p_from_id, a);
+	ERR_FAIL_COND_V(!from_exists, PoolVector<int>());
 
-	Point *a = points[p_from_id];
-	Point *b = points[p_to_id];
+	Point *b;
+	bool to_exists = points.lookup(p_to_id, b);
+	ERR_FAIL_COND_V(!to_exists, PoolVector<int>());
 
 	if (a == b) {
 		PoolVector<int> ret;
@@ -408,17 +567,22 @@ PoolVector<int> AStar::get_id_path(int p_from_id, int p_to_id) {
 	Point *begin_point = a;
 	Point *end_point = b;
 
-	bool found_route = _solve(begin_point, end_point);
+	SearchState *state = _alloc_search_state();
+	bool found_route = _solve(state, begin_point, end_point);
 
-	if (!found_route)
+	if (!found_route) {
+		_free_search_state(state);
 		return PoolVector<int>();
+	}
+
+	const SearchNode *nodes = state->nodes.ptr();
 
 	// Midpoints
-	Point *p = end_point;
+	int p = end_point->index;
 	int pc = 1; // Begin point
-	while (p != begin_point) {
+	while (p != begin_point->index) {
 		pc++;
-		p = p->prev_point;
+		p = nodes[p].prev_point;
 	}
 
 	PoolVector<int> path;
@@ -427,31 +591,35 @@ PoolVector<int> AStar::get_id_path(int p_from_id, int p_to_id) {
 	{
 		PoolVector<int>::Write w = path.write();
 
-		p = end_point;
+		p = end_point->index;
 		int idx = pc - 1;
-		while (p != begin_point) {
-			w[idx--] = p->id;
-			p = p->prev_point;
+		while (p != begin_point->index) {
+			w[idx--] = point_list[p]->id;
+			p = nodes[p].prev_point;
 		}
 
-		w[0] = p->id; // Assign first
+		w[0] = begin_point->id; // Assign first
 	}
 
+	_free_search_state(state);
+
 	return path;
 }
 
 void AStar::set_point_disabled(int p_id, bool p_disabled) {
 
-	ERR_FAIL_COND(!points.has(p_id));
+	Point **p = points.lookup_ptr(p_id);
+	ERR_FAIL_COND(!p);
 
-	points[p_id]->enabled = !p_disabled;
+	(*p)->enabled = !p_disabled;
 }
 
 bool AStar::is_point_disabled(int p_id) const {
 
-	ERR_FAIL_COND_V(!points.has(p_id), false);
+	Point **p = points.lookup_ptr(p_id);
+	ERR_FAIL_COND_V(!p, false);
 
-	return !points[p_id]->enabled;
+	return !(*p)->enabled;
 }
 
 void AStar::_bind_methods() {
@@ -488,13 +656,18 @@ void AStar::_bind_methods() {
 
 AStar::AStar() {
 
-	pass = 1;
+	last_free_id = 0;
+	search_mutex = Mutex::create();
 }
 
 AStar::~AStar() {
 
-	pass = 1;
 	clear();
+
+	for (int i = 0; i < free_search_states.size(); i++) {
+		memdelete(free_search_states[i]);
+	}
+	memdelete(search_mutex);
 }
 
 /////////////////////////////////////////////////////////////
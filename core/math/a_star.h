@@ -31,8 +31,9 @@
 #ifndef ASTAR_H
 #define ASTAR_H
 
+#include "core/oa_hash_map.h"
+#include "core/os/mutex.h"
 #include "core/reference.h"
-#include "core/self_list.h"
 
 /**
 	A* pathfinding algorithm
@@ -44,38 +45,25 @@ class AStar : public Reference {
 
 	GDCLASS(AStar, Reference);
 
-	uint64_t pass;
-
 	struct Point {
 
+		Point() :
+				neighbours(4u),
+				unlinked_neighbours(4u) {}
+
 		int id;
+		int index; // Position in point_list, also indexes the search state
 		Vector3 pos;
 		real_t weight_scale;
 		bool enabled;
 
-		Set<Point *> neighbours;
-		Set<Point *> unlinked_neighbours;
-
-		// Used for pathfinding
-		Point *prev_point;
-		real_t g_score;
-		real_t f_score;
-		uint64_t open_pass;
-		uint64_t closed_pass;
+		OAHashMap<int, Point *> neighbours;
+		OAHashMap<int, Point *> unlinked_neighbours;
 	};
 
-	Map<int, Point *> points;
-
-	struct SortPoints {
-		_FORCE_INLINE_ bool operator()(const Point *A, const Point *B) const { // Returns true when the Point A is worse than Point B
-			if (A->f_score > B->f_score)
-				return true;
-			else if (A->f_score < B->f_score)
-				return false;
-			else
-				return A->g_score < B->g_score; // If the f_costs are the same then prioritize the points that are further away from the start
-		}
-	};
+	OAHashMap<int, Point *> points;
+	Vector<Point *> point_list; // Contiguous, for iteration
+	int last_free_id;
 
 	struct Segment {
 		union {
@@ -101,9 +89,45 @@ class AStar : public Reference {
 		}
 	};
 
-	Set<Segment> segments;
+	OAHashMap<uint64_t, Segment> segments;
+
+	// Scratch data of a search, indexed by Point::index. States are pooled and reused, so each
+	// concurrent query gets its own and nothing has to be cleared between queries.
+
+	enum {
+		HEAP_CLOSED = -1
+	};
+
+	struct SearchNode {
+		real_t g_score;
+		real_t f_score;
+		int prev_point;
+		int heap_index; // Position in the open heap, or HEAP_CLOSED
+		uint32_t pass; // The rest is only valid when this matches the state pass
+	};
+
+	struct SearchState {
+		Vector<SearchNode> nodes;
+		Vector<int> open_heap;
+		uint32_t pass;
+	};
+
+	Mutex *search_mutex;
+	Vector<SearchState *> free_search_states;
+
+	SearchState *_alloc_search_state();
+	void _free_search_state(SearchState *p_state);
+
+	_FORCE_INLINE_ bool _is_better(const SearchNode &A, const SearchNode &B) const {
+		if (A.f_score != B.f_score)
+			return A.f_score < B.f_score;
+		return A.g_score > B.g_score; // If the f_costs are the same then prioritize the points that are further away from the start
+	}
+
+	void _heap_sift_up(SearchState *p_state, int p_heap_index);
+	void _heap_sift_down(SearchState *p_state, int p_heap_index);
 
-	bool _solve(Point *begin_point, Point *end_point);
+	bool _solve(SearchState *p_state, Point *begin_point, Point *end_point);
 
 protected:
 	static void _bind_methods();
@@ -136,6 +160,7 @@ public:
 	int get_closest_point(const Vector3 &p_point) const;
 	Vector3 get_closest_position_in_segment(const Vector3 &p_point) const;
 
+	// Path queries may run on several threads at once, as long as the points are not modified meanwhile
 	PoolVector<Vector3> get_point_path(int p_from_id, int p_to_id);
 	PoolVector<int> get_id_path(int p_from_id, int p_to_id);
 
@@ -0,0 +1,60 @@
+/*************************************************************************/
+/*  file_system_watcher.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FILE_SYSTEM_WATCHER_H
+#define FILE_SYSTEM_WATCHER_H
+
+#include "core/error_list.h"
+#include "core/list.h"
+#include "core/ustring.h"
+
+/**
+ * Notifies about changes to the entries of a set of directories, so callers
+ * don't need to stat every file to find what changed. Directories are not
+ * watched recursively, each one must be added.
+ * Platforms without such a facility don't provide an implementation, in which
+ * case create() returns NULL.
+ */
+
+class FileSystemWatcher {
+protected:
+	static FileSystemWatcher *(*create_func)();
+
+public:
+	virtual Error watch_dir(const String &p_path) = 0; ///< Start reporting changes to the files and directories inside p_path
+	virtual void unwatch_dir(const String &p_path) = 0;
+	virtual bool poll_changes(List<String> *r_dirs) = 0; ///< Add the watched directories that changed since the last poll, returns false if changes were lost and everything must be rescanned
+
+	static FileSystemWatcher *create(); ///< Create a watcher, or NULL if not supported
+
+	virtual ~FileSystemWatcher();
+};
+
+#endif
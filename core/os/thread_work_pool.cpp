@@ -0,0 +1,186 @@
+/*************************************************************************/
+/*  thread_work_pool.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "thread_work_pool.h"
+
+#include "core/os/memory.h"
+#include "core/os/os.h"
+
+ThreadWorkPool *ThreadWorkPool::singleton = NULL;
+
+void ThreadWorkPool::_thread_function(void *p_user) {
+
+	ThreadData *thread = (ThreadData *)p_user;
+
+	while (true) {
+		thread->start->wait();
+		if (thread->exit)
+			break;
+		thread->work->work();
+		thread->completed->post();
+	}
+}
+
+void ThreadWorkPool::_dispatch(BaseWork *p_work) {
+
+	if (p_work->max_elements == 0)
+		return;
+
+	if (p_work->max_elements == 1 || !mutex || mutex->try_lock() != OK) {
+		p_work->work();
+		return;
+	}
+
+	if (working) {
+		// Dispatched from inside a job running on this same thread.
+		mutex->unlock();
+		p_work->work();
+		return;
+	}
+
+	if (!initialized) {
+		init();
+	}
+
+	working = true;
+
+	int used_threads = MIN((int)p_work->max_elements - 1, thread_count);
+
+	for (int i = 0; i < used_threads; i++) {
+		threads[i].work = p_work;
+		threads[i].start->post();
+	}
+
+	p_work->work();
+
+	for (int i = 0; i < used_threads; i++) {
+		threads[i].completed->wait();
+		threads[i].work = NULL;
+	}
+
+	working = false;
+	mutex->unlock();
+}
+
+int ThreadWorkPool::get_thread_count() const {
+
+	return thread_count;
+}
+
+void ThreadWorkPool::init(int p_thread_count) {
+
+	ERR_FAIL_COND(threads != NULL);
+
+	initialized = true;
+
+#ifdef NO_THREADS
+	thread_count = 0;
+#else
+	if (p_thread_count < 0) {
+		p_thread_count = OS::get_singleton()->get_processor_count() - 1;
+	}
+	thread_count = MAX(p_thread_count, 0);
+#endif
+
+	if (thread_count == 0)
+		return;
+
+	threads = memnew_arr(ThreadData, thread_count);
+
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].exit = false;
+		threads[i].work = NULL;
+		threads[i].start = Semaphore::create();
+		threads[i].completed = Semaphore::create();
+		threads[i].thread = Thread::create(&ThreadWorkPool::_thread_function, &threads[i]);
+	}
+}
+
+void ThreadWorkPool::finish() {
+
+	if (threads == NULL) {
+		initialized = false;
+		return;
+	}
+
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].exit = true;
+		threads[i].start->post();
+	}
+
+	for (int i = 0; i < thread_count; i++) {
+		Thread::wait_to_finish(threads[i].thread);
+		memdelete(threads[i].thread);
+		memdelete(threads[i].start);
+		memdelete(threads[i].completed);
+	}
+
+	memdelete_arr(threads);
+	threads = NULL;
+	thread_count = 0;
+	initialized = false;
+}
+
+void ThreadWorkPool::setup() {
+
+	ERR_FAIL_COND(singleton != NULL);
+	// Worker threads are only spawned on the first dispatch.
+	singleton = memnew(ThreadWorkPool);
+}
+
+void ThreadWorkPool::cleanup() {
+
+	if (singleton) {
+		memdelete(singleton);
+		singleton = NULL;
+	}
+}
+
+ThreadWorkPool *ThreadWorkPool::get_singleton() {
+
+	return singleton;
+}
+
+ThreadWorkPool::ThreadWorkPool() {
+
+	threads = NULL;
+	thread_count = 0;
+	initialized = false;
+	working = false;
+	mutex = Mutex::create();
+}
+
+ThreadWorkPool::~ThreadWorkPool() {
+
+	finish();
+	if (mutex) {
+		memdelete(mutex);
+	}
+}
@@ -0,0 +1,125 @@
+/*************************************************************************/
+/*  thread_work_pool.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef THREAD_WORK_POOL_H
+#define THREAD_WORK_POOL_H
+
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+
+/**
+	Persistent pool of worker threads, to run the same kind of jobs as
+	thread_process_array() without creating and destroying threads on
+	every call. The calling thread always takes part in the work, so a
+	pool without workers (single core, NO_THREADS) simply runs serially.
+
+	Dispatches are not nested: if the pool is already busy (called from
+	inside a job or from another thread), the work runs on the caller.
+*/
+
+class ThreadWorkPool {
+
+	struct BaseWork {
+
+		volatile uint32_t index;
+		uint32_t max_elements;
+
+		virtual void work() = 0;
+		virtual ~BaseWork() {}
+	};
+
+	template <class C, class M, class U>
+	struct Work : public BaseWork {
+
+		C *instance;
+		M method;
+		U userdata;
+
+		virtual void work() {
+
+			while (true) {
+				uint32_t work_index = atomic_increment(&this->index) - 1;
+				if (work_index >= this->max_elements)
+					break;
+				(instance->*method)(work_index, userdata);
+			}
+		}
+	};
+
+	struct ThreadData {
+
+		Thread *thread;
+		Semaphore *start;
+		Semaphore *completed;
+		bool exit;
+		BaseWork *work;
+	};
+
+	ThreadData *threads;
+	int thread_count;
+	bool initialized;
+	bool working;
+	Mutex *mutex;
+
+	static ThreadWorkPool *singleton;
+
+	static void _thread_function(void *p_user);
+	void _dispatch(BaseWork *p_work);
+
+public:
+	template <class C, class M, class U>
+	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+
+		Work<C, M, U> w;
+		w.index = 0;
+		w.max_elements = p_elements;
+		w.instance = p_instance;
+		w.method = p_method;
+		w.userdata = p_userdata;
+
+		_dispatch(&w);
+	}
+
+	int get_thread_count() const; // worker threads, not counting the caller
+
+	void init(int p_thread_count = -1); // -1 uses one worker per extra core
+	void finish();
+
+	static void setup();
+	static void cleanup();
+	static ThreadWorkPool *get_singleton();
+
+	ThreadWorkPool();
+	~ThreadWorkPool();
+};
+
+#endif // THREAD_WORK_POOL_H
@@ -48,6 +48,7 @@
 #include "core/io/pck_packer.h"
 #include "core/io/resource_format_binary.h"
 #include "core/io/resource_importer.h"
+#include "core/io/stream_peer_compressed.h"
 #include "core/io/stream_peer_ssl.h"
 #include "core/io/tcp_server.h"
 #include "core/io/translation_loader_po.h"
@@ -59,6 +60,7 @@
 #include "core/math/triangle_mesh.h"
 #include "core/os/input.h"
 #include "core/os/main_loop.h"
+#include "core/os/thread_work_pool.h"
 #include "core/packed_data_container.h"
 #include "core/path_remap.h"
 #include "core/project_settings.h"
@@ -98,6 +100,8 @@ void register_core_types() {
 
 	_global_mutex = Mutex::create();
 
+	ThreadWorkPool::setup();
+
 	StringName::setup();
 	ResourceLoader::initialize();
 
@@ -148,6 +152,7 @@ void register_core_types() {
 	ClassDB::register_class<FuncRef>();
 	ClassDB::register_virtual_class<StreamPeer>();
 	ClassDB::register_class<StreamPeerBuffer>();
+	ClassDB::register_class<StreamPeerCompressed>();
 	ClassDB::register_class<StreamPeerTCP>();
 	ClassDB::register_class<TCP_Server>();
 	ClassDB::register_class<PacketPeerUDP>();
@@ -288,6 +293,8 @@ void unregister_core_types() {
 	CoreStringNames::free();
 	StringName::cleanup();
 
+	ThreadWorkPool::cleanup();
+
 	if (_global_mutex) {
 		memdelete(_global_mutex);
 		_global_mutex = NULL; //still needed at a few places
@@ -129,6 +129,8 @@ public:
 
 	_FORCE_INLINE_ bool empty() const { return _data.empty(); }
 
+	_FORCE_INLINE_ void clear() { _data.clear(); }
+
 	_FORCE_INLINE_ int size() const { return _data.size(); }
 
 	inline T &operator[](int p_index) {
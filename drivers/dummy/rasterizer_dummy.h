@@ -37,8 +37,12 @@
 #include "servers/visual/rasterizer.h"
 #include "servers/visual_server.h"
 
+class RasterizerStorageDummy;
+
 class RasterizerSceneDummy : public RasterizerScene {
 public:
+	RasterizerStorageDummy *storage;
+
 	/* SHADOW ATLAS API */
 
 	RID shadow_atlas_create() { return RID(); }
@@ -106,7 +110,7 @@ public:
 	void gi_probe_instance_set_transform_to_data(RID p_probe, const Transform &p_xform) {}
 	void gi_probe_instance_set_bounds(RID p_probe, const Vector3 &p_bounds) {}
 
-	void render_scene(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_ortogonal, InstanceBase **p_cull_result, int p_cull_count, RID *p_light_cull_result, int p_light_cull_count, RID *p_reflection_probe_cull_result, int p_reflection_probe_cull_count, RID p_environment, RID p_shadow_atlas, RID p_reflection_atlas, RID p_reflection_probe, int p_reflection_probe_pass) {}
+	void render_scene(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_ortogonal, InstanceBase **p_cull_result, int p_cull_count, RID *p_light_cull_result, int p_light_cull_count, RID *p_reflection_probe_cull_result, int p_reflection_probe_cull_count, RID p_environment, RID p_shadow_atlas, RID p_reflection_atlas, RID p_reflection_probe, int p_reflection_probe_pass);
 	void render_shadow(RID p_light, RID p_shadow_atlas, int p_pass, InstanceBase **p_cull_result, int p_cull_count) {}
 
 	void set_scene_pass(uint64_t p_pass) {}
@@ -114,7 +118,7 @@ public:
 
 	bool free(RID p_rid) { return true; }
 
-	RasterizerSceneDummy() {}
+	RasterizerSceneDummy() { storage = NULL; }
 	~RasterizerSceneDummy() {}
 };
 
@@ -737,11 +741,64 @@ public:
 
 	void set_debug_generate_wireframes(bool p_generate) {}
 
-	void render_info_begin_capture() {}
-	void render_info_end_capture() {}
-	int get_captured_render_info(VS::RenderInfo p_info) { return 0; }
+	struct Info {
+
+		struct Render {
+
+			uint32_t object_count;
+			uint32_t draw_call_count;
+			uint32_t vertices_count;
+
+			void reset() {
+				object_count = 0;
+				draw_call_count = 0;
+				vertices_count = 0;
+			}
+
+			Render() { reset(); }
+		} render, render_final, snap;
+
+	} info;
+
+	void render_info_begin_capture() {
+
+		info.snap = info.render;
+	}
+
+	void render_info_end_capture() {
+
+		info.snap.object_count = info.render.object_count - info.snap.object_count;
+		info.snap.draw_call_count = info.render.draw_call_count - info.snap.draw_call_count;
+		info.snap.vertices_count = info.render.vertices_count - info.snap.vertices_count;
+	}
+
+	int get_captured_render_info(VS::RenderInfo p_info) {
+
+		switch (p_info) {
+			case VS::INFO_OBJECTS_IN_FRAME:
+				return info.snap.object_count;
+			case VS::INFO_VERTICES_IN_FRAME:
+				return info.snap.vertices_count;
+			case VS::INFO_DRAW_CALLS_IN_FRAME:
+				return info.snap.draw_call_count;
+			default:
+				return 0;
+		}
+	}
 
-	int get_render_info(VS::RenderInfo p_info) { return 0; }
+	int get_render_info(VS::RenderInfo p_info) {
+
+		switch (p_info) {
+			case VS::INFO_OBJECTS_IN_FRAME:
+				return info.render_final.object_count;
+			case VS::INFO_VERTICES_IN_FRAME:
+				return info.render_final.vertices_count;
+			case VS::INFO_DRAW_CALLS_IN_FRAME:
+				return info.render_final.draw_call_count;
+			default:
+				return 0;
+		}
+	}
 
 	static RasterizerStorage *base_singleton;
 
@@ -749,6 +806,31 @@ public:
 	~RasterizerStorageDummy() {}
 };
 
+inline void RasterizerSceneDummy::render_scene(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_ortogonal, InstanceBase **p_cull_result, int p_cull_count, RID *p_light_cull_result, int p_light_cull_count, RID *p_reflection_probe_cull_result, int p_reflection_probe_cull_count, RID p_environment, RID p_shadow_atlas, RID p_reflection_atlas, RID p_reflection_probe, int p_reflection_probe_pass) {
+
+	// Nothing is drawn, but counting what would be lets culling and LOD selection be measured headless.
+
+	for (int i = 0; i < p_cull_count; i++) {
+
+		InstanceBase *instance = p_cull_result[i];
+		storage->info.render.object_count++;
+
+		if (instance->base_type != VS::INSTANCE_MESH)
+			continue;
+
+		RasterizerStorageDummy::DummyMesh *mesh = storage->mesh_owner.getornull(instance->base);
+		if (!mesh)
+			continue;
+
+		for (int j = 0; j < mesh->surfaces.size(); j++) {
+
+			const RasterizerStorageDummy::DummySurface &surface = mesh->surfaces[j];
+			storage->info.render.vertices_count += surface.index_count ? surface.index_count : surface.vertex_count;
+			storage->info.render.draw_call_count++;
+		}
+	}
+}
+
 class RasterizerCanvasDummy : public RasterizerCanvas {
 public:
 	RID light_internal_create() { return RID(); }
@@ -785,7 +867,10 @@ public:
 	void set_boot_image(const Ref<Image> &p_image, const Color &p_color, bool p_scale, bool p_use_filter = true) {}
 
 	void initialize() {}
-	void begin_frame(double frame_step) {}
+	void begin_frame(double frame_step) {
+		storage.info.render_final = storage.info.render;
+		storage.info.render.reset();
+	}
 	void set_current_render_target(RID p_render_target) {}
 	void restore_render_target(bool p_3d_was_drawn) {}
 	void clear_render_target(const Color &p_color) {}
@@ -808,7 +893,7 @@ public:
 
 	virtual bool is_low_end() const { return true; }
 
-	RasterizerDummy() {}
+	RasterizerDummy() { scene.storage = &storage; }
 	~RasterizerDummy() {}
 };
 
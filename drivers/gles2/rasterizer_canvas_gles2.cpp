@@ -351,6 +351,8 @@ void RasterizerCanvasGLES2::_draw_polygon(const int *p_indices, int p_index_coun
 		glDrawElements(GL_TRIANGLES, p_index_count, GL_UNSIGNED_SHORT, 0);
 	}
 
+	storage->info.render.draw_call_count++;
+
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
@@ -389,6 +391,7 @@ void RasterizerCanvasGLES2::_draw_generic(GLuint p_primitive, int p_vertex_count
 	}
 
 	glDrawArrays(p_primitive, 0, p_vertex_count);
+	storage->info.render.draw_call_count++;
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -450,6 +453,7 @@ void RasterizerCanvasGLES2::_draw_gui_primitive(int p_points, const Vector2 *p_v
 	}
 
 	glDrawArrays(prim[p_points], 0, p_points);
+	storage->info.render.draw_call_count++;
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -464,6 +468,72 @@ static const GLenum gl_primitive[] = {
 	GL_TRIANGLE_FAN
 };
 
+int RasterizerCanvasGLES2::_batch_rects(Item::Command *const *p_commands, int p_command_count, int p_from, RasterizerStorageGLES2::Material *p_material) {
+
+	batcher.clear();
+
+	int count = 0;
+
+	while (p_from + count < p_command_count && CanvasBatcher::can_batch(p_commands[p_from + count])) {
+
+		Item::CommandRect *r = static_cast<Item::CommandRect *>(p_commands[p_from + count]);
+
+		Size2 texpixel_size;
+		if (r->texture.is_valid()) {
+			RasterizerStorageGLES2::Texture *texture = storage->texture_owner.getornull(r->texture);
+			if (texture) {
+				texture = texture->get_ptr();
+				texpixel_size = Size2(1.0 / texture->width, 1.0 / texture->height);
+			}
+		}
+
+		if (!batcher.add_rect(r, texpixel_size))
+			break;
+
+		count++;
+	}
+
+	if (count < 2)
+		return 0; // a lone rect is cheaper through the regular path
+
+	state.canvas_shader.set_conditional(CanvasShaderGLES2::USE_TEXTURE_RECT, false);
+	if (state.canvas_shader.bind()) {
+		_set_uniforms();
+		state.canvas_shader.use_material((void *)p_material);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, data.batch_vertex_buffer);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(CanvasBatcher::Vertex) * 4 * batcher.get_quad_count(), batcher.get_vertices());
+
+	glEnableVertexAttribArray(VS::ARRAY_VERTEX);
+	glVertexAttribPointer(VS::ARRAY_VERTEX, 2, GL_FLOAT, GL_FALSE, sizeof(CanvasBatcher::Vertex), NULL);
+	glEnableVertexAttribArray(VS::ARRAY_TEX_UV);
+	glVertexAttribPointer(VS::ARRAY_TEX_UV, 2, GL_FLOAT, GL_FALSE, sizeof(CanvasBatcher::Vertex), CAST_INT_TO_UCHAR_PTR(sizeof(Vector2)));
+	glEnableVertexAttribArray(VS::ARRAY_COLOR);
+	glVertexAttribPointer(VS::ARRAY_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(CanvasBatcher::Vertex), CAST_INT_TO_UCHAR_PTR(sizeof(Vector2) * 2));
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.batch_index_buffer);
+
+	for (int i = 0; i < batcher.get_batch_count(); i++) {
+
+		const CanvasBatcher::Batch &b = batcher.get_batch(i);
+
+		_bind_canvas_texture(b.texture, RID());
+		state.canvas_shader.set_uniform(CanvasShaderGLES2::COLOR_TEXPIXEL_SIZE, b.texpixel_size);
+
+		glDrawElements(GL_TRIANGLES, b.quad_count * 6, GL_UNSIGNED_SHORT, CAST_INT_TO_UCHAR_PTR(b.first_quad * 6 * sizeof(uint16_t)));
+		storage->info.render.draw_call_count++;
+	}
+
+	glDisableVertexAttribArray(VS::ARRAY_TEX_UV);
+	glDisableVertexAttribArray(VS::ARRAY_COLOR);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	return count;
+}
+
 void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *current_clip, bool &reclip, RasterizerStorageGLES2::Material *p_material) {
 
 	int command_count = p_item->commands.size();
@@ -471,6 +541,15 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 
 	for (int i = 0; i < command_count; i++) {
 
+		if (use_batching && !state.using_skeleton) {
+			// merge runs of rects sharing a texture, the item already shares material and blend state
+			int batched = _batch_rects(commands, command_count, i, p_material);
+			if (batched) {
+				i += batched - 1;
+				continue;
+			}
+		}
+
 		Item::Command *command = commands[i];
 
 		switch (command->type) {
@@ -672,6 +751,7 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 						state.canvas_shader.set_uniform(CanvasShaderGLES2::SRC_RECT, Color(0, 0, 1, 1));
 
 						glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+						storage->info.render.draw_call_count++;
 					} else {
 
 						bool untile = false;
@@ -714,6 +794,7 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 						state.canvas_shader.set_uniform(CanvasShaderGLES2::SRC_RECT, Color(src_rect.position.x, src_rect.position.y, src_rect.size.x, src_rect.size.y));
 
 						glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+						storage->info.render.draw_call_count++;
 
 						if (untile) {
 							glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -886,6 +967,7 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 				glVertexAttribPointer(VS::ARRAY_TEX_UV, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), CAST_INT_TO_UCHAR_PTR((sizeof(float) * 2)));
 
 				glDrawElements(GL_TRIANGLES, 18 * 3 - (np->draw_center ? 0 : 6), GL_UNSIGNED_BYTE, NULL);
+				storage->info.render.draw_call_count++;
 
 				glBindBuffer(GL_ARRAY_BUFFER, 0);
 				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -1004,6 +1086,7 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 						} else {
 							glDrawArrays(gl_primitive[s->primitive], 0, s->array_len);
 						}
+						storage->info.render.draw_call_count++;
 					}
 
 					for (int j = 1; j < VS::ARRAY_MAX - 1; j++) {
@@ -1128,6 +1211,7 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 						} else {
 							glDrawArrays(gl_primitive[s->primitive], 0, s->array_len);
 						}
+						storage->info.render.draw_call_count++;
 					}
 				}
 
@@ -2093,6 +2177,32 @@ void RasterizerCanvasGLES2::initialize() {
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
 
+	// rect batch buffers
+	{
+		glGenBuffers(1, &data.batch_vertex_buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, data.batch_vertex_buffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(CanvasBatcher::Vertex) * 4 * CanvasBatcher::MAX_QUADS, NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		// the quads never change layout, so the indices are only written once
+		Vector<uint16_t> indices;
+		indices.resize(CanvasBatcher::MAX_QUADS * 6);
+		uint16_t *w = indices.ptrw();
+		for (int i = 0; i < CanvasBatcher::MAX_QUADS; i++) {
+			w[i * 6 + 0] = i * 4 + 0;
+			w[i * 6 + 1] = i * 4 + 1;
+			w[i * 6 + 2] = i * 4 + 2;
+			w[i * 6 + 3] = i * 4 + 0;
+			w[i * 6 + 4] = i * 4 + 2;
+			w[i * 6 + 5] = i * 4 + 3;
+		}
+
+		glGenBuffers(1, &data.batch_index_buffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.batch_index_buffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * indices.size(), indices.ptr(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
 	state.canvas_shadow_shader.init();
 
 	state.canvas_shader.init();
@@ -2121,4 +2231,6 @@ RasterizerCanvasGLES2::RasterizerCanvasGLES2() {
 	// Not needed (a priori) on GLES devices
 	use_nvidia_rect_workaround = false;
 #endif
+
+	use_batching = GLOBAL_GET("rendering/quality/2d/gles2_use_batching");
 }
@@ -32,6 +32,7 @@
 #define RASTERIZERCANVASGLES2_H
 
 #include "rasterizer_storage_gles2.h"
+#include "servers/visual/canvas_batcher.h"
 #include "servers/visual/rasterizer.h"
 
 #include "shaders/canvas.glsl.gen.h"
@@ -69,6 +70,9 @@ public:
 		GLuint ninepatch_vertices;
 		GLuint ninepatch_elements;
 
+		GLuint batch_vertex_buffer;
+		GLuint batch_index_buffer;
+
 	} data;
 
 	struct State {
@@ -105,6 +109,9 @@ public:
 
 	bool use_nvidia_rect_workaround;
 
+	bool use_batching;
+	CanvasBatcher batcher;
+
 	virtual RID light_internal_create();
 	virtual void light_internal_update(RID p_rid, Light *p_light);
 	virtual void light_internal_free(RID p_rid);
@@ -118,6 +125,7 @@ public:
 	_FORCE_INLINE_ void _draw_polygon(const int *p_indices, int p_index_count, int p_vertex_count, const Vector2 *p_vertices, const Vector2 *p_uvs, const Color *p_colors, bool p_singlecolor, const float *p_weights = NULL, const int *p_bones = NULL);
 	_FORCE_INLINE_ void _draw_generic(GLuint p_primitive, int p_vertex_count, const Vector2 *p_vertices, const Vector2 *p_uvs, const Color *p_colors, bool p_singlecolor);
 
+	int _batch_rects(Item::Command *const *p_commands, int p_command_count, int p_from, RasterizerStorageGLES2::Material *p_material);
 	_FORCE_INLINE_ void _canvas_item_render_commands(Item *p_item, Item *current_clip, bool &reclip, RasterizerStorageGLES2::Material *p_material);
 	void _copy_screen(const Rect2 &p_rect);
 	_FORCE_INLINE_ void _copy_texscreen(const Rect2 &p_rect);
@@ -0,0 +1,183 @@
+/*************************************************************************/
+/*  file_system_watcher_inotify.cpp                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "file_system_watcher_inotify.h"
+
+#if defined(UNIX_ENABLED) && defined(__linux__)
+
+#include "core/project_settings.h"
+#include "core/set.h"
+
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#define WATCH_MASK (IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF | IN_ONLYDIR)
+
+void FileSystemWatcherInotify::_forget_watch(int p_wd) {
+
+	const String *path = watched_paths.getptr(p_wd);
+	if (!path)
+		return;
+
+	// The same path may have been watched again since, with a new descriptor
+	const int *wd = watched_descriptors.getptr(*path);
+	if (wd && *wd == p_wd) {
+		watched_descriptors.erase(*path);
+	}
+	watched_paths.erase(p_wd);
+}
+
+Error FileSystemWatcherInotify::watch_dir(const String &p_path) {
+
+	ERR_FAIL_COND_V(fd < 0, ERR_UNCONFIGURED);
+
+	String path = ProjectSettings::get_singleton()->globalize_path(p_path);
+	int wd = inotify_add_watch(fd, path.utf8().get_data(), WATCH_MASK);
+	if (wd < 0) {
+		// ENOSPC means the user limit of watches (fs.inotify.max_user_watches) was reached
+		return errno == ENOSPC ? ERR_OUT_OF_MEMORY : ERR_CANT_OPEN;
+	}
+
+	MutexLock lock(mutex);
+
+	// Adding a directory that is already watched returns its descriptor again
+	_forget_watch(wd);
+	watched_paths[wd] = p_path;
+	watched_descriptors[p_path] = wd;
+
+	return OK;
+}
+
+void FileSystemWatcherInotify::unwatch_dir(const String &p_path) {
+
+	ERR_FAIL_COND(fd < 0);
+
+	MutexLock lock(mutex);
+
+	const int *wd = watched_descriptors.getptr(p_path);
+	if (!wd)
+		return;
+
+	int watch = *wd;
+	_forget_watch(watch);
+	inotify_rm_watch(fd, watch);
+}
+
+bool FileSystemWatcherInotify::poll_changes(List<String> *r_dirs) {
+
+	ERR_FAIL_COND_V(fd < 0, false);
+
+	MutexLock lock(mutex);
+
+	Set<int> changed;
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+	while (true) {
+
+		ssize_t len = read(fd, buffer, sizeof(buffer));
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len <= 0)
+			break; // EAGAIN, no events left
+
+		const char *ptr = buffer;
+		while (ptr < buffer + len) {
+
+			const struct inotify_event *event = (const struct inotify_event *)ptr;
+			ptr += sizeof(struct inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW) {
+				overflowed = true;
+			} else if (event->mask & IN_IGNORED) {
+				// The directory was removed, its parent reports it
+				_forget_watch(event->wd);
+				changed.erase(event->wd);
+			} else if (event->mask & IN_MOVE_SELF) {
+				// The directory is known by another path now, it gets watched again when its new parent is scanned
+				_forget_watch(event->wd);
+				changed.erase(event->wd);
+				inotify_rm_watch(fd, event->wd);
+			} else {
+				changed.insert(event->wd);
+			}
+		}
+	}
+
+	for (Set<int>::Element *E = changed.front(); E; E = E->next()) {
+
+		const String *path = watched_paths.getptr(E->get());
+		if (path) {
+			r_dirs->push_back(*path);
+		}
+	}
+
+	bool complete = !overflowed;
+	overflowed = false;
+	return complete;
+}
+
+FileSystemWatcher *FileSystemWatcherInotify::create_watcher_inotify() {
+
+	FileSystemWatcherInotify *watcher = memnew(FileSystemWatcherInotify);
+	if (watcher->fd < 0) {
+		memdelete(watcher);
+		return NULL;
+	}
+	return watcher;
+}
+
+void FileSystemWatcherInotify::make_default() {
+
+	create_func = create_watcher_inotify;
+}
+
+FileSystemWatcherInotify::FileSystemWatcherInotify() {
+
+	overflowed = false;
+	mutex = Mutex::create();
+
+	fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0) {
+		ERR_PRINTS("Failed to initialize inotify: " + itos(errno));
+	}
+}
+
+FileSystemWatcherInotify::~FileSystemWatcherInotify() {
+
+	if (fd >= 0) {
+		close(fd); // Removes all watches
+	}
+	if (mutex) {
+		memdelete(mutex);
+	}
+}
+
+#endif
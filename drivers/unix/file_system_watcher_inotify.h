@@ -0,0 +1,66 @@
+/*************************************************************************/
+/*  file_system_watcher_inotify.h                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FILE_SYSTEM_WATCHER_INOTIFY_H
+#define FILE_SYSTEM_WATCHER_INOTIFY_H
+
+#include "core/os/file_system_watcher.h"
+
+#if defined(UNIX_ENABLED) && defined(__linux__)
+
+#include "core/hash_map.h"
+#include "core/os/mutex.h"
+
+class FileSystemWatcherInotify : public FileSystemWatcher {
+
+	int fd;
+	bool overflowed;
+	Mutex *mutex;
+
+	HashMap<int, String> watched_paths; // watch descriptor -> directory, as passed to watch_dir()
+	HashMap<String, int> watched_descriptors;
+
+	void _forget_watch(int p_wd);
+
+	static FileSystemWatcher *create_watcher_inotify();
+
+public:
+	virtual Error watch_dir(const String &p_path);
+	virtual void unwatch_dir(const String &p_path);
+	virtual bool poll_changes(List<String> *r_dirs);
+
+	static void make_default();
+
+	FileSystemWatcherInotify();
+	~FileSystemWatcherInotify();
+};
+
+#endif
+#endif
@@ -31,6 +31,8 @@
 #include "editor_export.h"
 
 #include "core/io/config_file.h"
+#include "core/io/file_access_compressed.h"
+#include "core/io/file_access_pack.h"
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
 #include "core/io/zip_io.h"
@@ -57,6 +59,8 @@ static int _get_pad(int p_alignment, int p_n) {
 }
 
 #define PCK_PADDING 16
+#define PCK_COMPRESSION_BLOCK_SIZE (64 * 1024)
+#define PCK_COMPRESSION_BATCH_SIZE (64 * 1024 * 1024)
 
 bool EditorExportPreset::_set(const StringName &p_name, const Variant &p_value) {
 
@@ -244,11 +248,23 @@ String EditorExportPreset::get_script_encryption_key() const {
 	return script_key;
 }
 
+void EditorExportPreset::set_compress_pack(bool p_enable) {
+
+	compress_pack = p_enable;
+	EditorExport::singleton->save_presets();
+}
+
+bool EditorExportPreset::get_compress_pack() const {
+
+	return compress_pack;
+}
+
 EditorExportPreset::EditorExportPreset() :
 		export_filter(EXPORT_ALL_RESOURCES),
 		export_path(""),
 		runnable(false),
-		script_mode(MODE_SCRIPT_COMPILED) {
+		script_mode(MODE_SCRIPT_COMPILED),
+		compress_pack(false) {
 }
 
 ///////////////////////////////////
@@ -313,14 +329,7 @@ Error EditorExportPlatform::_save_pack_file(void *p_userdata, const String &p_pa
 
 	SavedData sd;
 	sd.path_utf8 = p_path.utf8();
-	sd.ofs = pd->f->get_position();
-	sd.size = p_data.size();
-
-	pd->f->store_buffer(p_data.ptr(), p_data.size());
-	int pad = _get_pad(PCK_PADDING, sd.size);
-	for (int i = 0; i < pad; i++) {
-		pd->f->store_8(0);
-	}
+	sd.flags = 0;
 
 	{
 		unsigned char hash[16];
@@ -331,7 +340,19 @@ Error EditorExportPlatform::_save_pack_file(void *p_userdata, const String &p_pa
 		}
 	}
 
-	pd->file_ofs.push_back(sd);
+	if (pd->compress) {
+		PendingFile pf;
+		pf.sd = sd;
+		pf.data = p_data;
+		pd->pending.push_back(pf);
+		pd->pending_size += p_data.size();
+
+		if (pd->pending_size >= PCK_COMPRESSION_BATCH_SIZE) {
+			_store_pending_pack_files(pd);
+		}
+	} else {
+		_store_pack_file(pd, sd, p_data.ptr(), p_data.size());
+	}
 
 	if (pd->ep->step(TTR("Storing File:") + " " + p_path, 2 + p_file * 100 / p_total, false)) {
 		return ERR_SKIP;
@@ -340,6 +361,60 @@ Error EditorExportPlatform::_save_pack_file(void *p_userdata, const String &p_pa
 	return OK;
 }
 
+void EditorExportPlatform::_store_pack_file(PackData *p_pd, SavedData &p_sd, const uint8_t *p_data, uint64_t p_size) {
+
+	p_sd.ofs = p_pd->f->get_position();
+	p_sd.size = p_size;
+
+	p_pd->f->store_buffer(p_data, p_size);
+	int pad = _get_pad(PCK_PADDING, p_sd.size);
+	for (int i = 0; i < pad; i++) {
+		p_pd->f->store_8(0);
+	}
+
+	p_pd->file_ofs.push_back(p_sd);
+}
+
+void EditorExportPlatform::_store_pending_pack_files(PackData *p_pd) {
+
+	int count = p_pd->pending.size();
+	if (count == 0)
+		return;
+
+	Vector<const uint8_t *> src;
+	Vector<uint32_t> src_size;
+	Vector<Vector<uint8_t> > compressed;
+	src.resize(count);
+	src_size.resize(count);
+	compressed.resize(count);
+
+	for (int i = 0; i < count; i++) {
+		src.write[i] = p_pd->pending[i].data.ptr();
+		src_size.write[i] = p_pd->pending[i].data.size();
+	}
+
+	Error err = FileAccessCompressed::compress_buffers(PACK_COMPRESSED_MAGIC, Compression::MODE_ZSTD, PCK_COMPRESSION_BLOCK_SIZE, src.ptr(), src_size.ptr(), compressed.ptrw(), count);
+	if (err != OK) {
+		WARN_PRINT("Some files could not be compressed and are stored uncompressed in the pack.");
+	}
+
+	for (int i = 0; i < count; i++) {
+
+		PendingFile &pf = p_pd->pending.write[i];
+		// Output is left empty for files that failed to compress
+		if (compressed[i].size() > 0 && compressed[i].size() < pf.data.size()) {
+			pf.sd.flags |= PACK_FILE_COMPRESSED;
+			_store_pack_file(p_pd, pf.sd, compressed[i].ptr(), compressed[i].size());
+		} else {
+			// Already compressed data (textures, audio, compressed resources) is stored as is
+			_store_pack_file(p_pd, pf.sd, pf.data.ptr(), pf.data.size());
+		}
+	}
+
+	p_pd->pending.clear();
+	p_pd->pending_size = 0;
+}
+
 Error EditorExportPlatform::_save_zip_file(void *p_userdata, const String &p_path, const Vector<uint8_t> &p_data, int p_file, int p_total) {
 
 	String path = p_path.replace_first("res://", "");
@@ -911,8 +986,13 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 	pd.ep = &ep;
 	pd.f = ftmp;
 	pd.so_files = p_so_files;
+	pd.compress = p_preset->get_compress_pack();
+	pd.pending_size = 0;
 
 	Error err = export_project_files(p_preset, _save_pack_file, &pd, _add_shared_object);
+	if (err == OK) {
+		_store_pending_pack_files(&pd);
+	}
 
 	memdelete(ftmp); //close tmp file
 
@@ -948,8 +1028,8 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 
 	int64_t pck_start_pos = f->get_position();
 
-	f->store_32(0x43504447); //GDPC
-	f->store_32(1); //pack version
+	f->store_32(PACK_HEADER_MAGIC); //GDPC
+	f->store_32(PACK_FORMAT_VERSION); //pack version
 	f->store_32(VERSION_MAJOR);
 	f->store_32(VERSION_MINOR);
 	f->store_32(0); //hmph
@@ -971,6 +1051,7 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 		header_size += 8; // offset to file _with_ header size included
 		header_size += 8; // size of file
 		header_size += 16; // md5
+		header_size += 4; // flags
 	}
 
 	int header_padding = _get_pad(PCK_PADDING, header_size);
@@ -989,6 +1070,7 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 		f->store_64(pd.file_ofs[i].ofs + header_padding + header_size);
 		f->store_64(pd.file_ofs[i].size); // pay attention here, this is where file is
 		f->store_buffer(pd.file_ofs[i].md5.ptr(), 16); //also save md5 for file
+		f->store_32(pd.file_ofs[i].flags);
 	}
 
 	for (int i = 0; i < header_padding; i++) {
@@ -1027,7 +1109,7 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 
 		int64_t pck_size = f->get_position() - pck_start_pos;
 		f->store_64(pck_size);
-		f->store_32(0x43504447); //GDPC
+		f->store_32(PACK_HEADER_MAGIC); //GDPC
 
 		if (r_embedded_size) {
 			*r_embedded_size = f->get_position() - embed_pos;
@@ -1171,6 +1253,7 @@ void EditorExport::_save() {
 		config->set_value(section, "patch_list", preset->get_patches());
 		config->set_value(section, "script_export_mode", preset->get_script_export_mode());
 		config->set_value(section, "script_encryption_key", preset->get_script_encryption_key());
+		config->set_value(section, "compress_pack", preset->get_compress_pack());
 
 		String option_section = "preset." + itos(i) + ".options";
 
@@ -1363,6 +1446,9 @@ void EditorExport::load_config() {
 		if (config->has_section_key(section, "script_encryption_key")) {
 			preset->set_script_encryption_key(config->get_value(section, "script_encryption_key"));
 		}
+		if (config->has_section_key(section, "compress_pack")) {
+			preset->set_compress_pack(config->get_value(section, "compress_pack"));
+		}
 
 		String option_section = "preset." + itos(index) + ".options";
 
@@ -85,6 +85,8 @@ private:
 	int script_mode;
 	String script_key;
 
+	bool compress_pack;
+
 protected:
 	bool _set(const StringName &p_name, const Variant &p_value);
 	bool _get(const StringName &p_name, Variant &r_ret) const;
@@ -134,6 +136,9 @@ public:
 	void set_script_encryption_key(const String &p_key);
 	String get_script_encryption_key() const;
 
+	void set_compress_pack(bool p_enable);
+	bool get_compress_pack() const;
+
 	const List<PropertyInfo> &get_properties() const { return properties; }
 
 	EditorExportPreset();
@@ -164,6 +169,7 @@ private:
 
 		uint64_t ofs;
 		uint64_t size;
+		uint32_t flags;
 		Vector<uint8_t> md5;
 		CharString path_utf8;
 
@@ -172,12 +178,22 @@ private:
 		}
 	};
 
+	struct PendingFile {
+
+		SavedData sd;
+		Vector<uint8_t> data;
+	};
+
 	struct PackData {
 
 		FileAccess *f;
 		Vector<SavedData> file_ofs;
 		EditorProgress *ep;
 		Vector<SharedObject> *so_files;
+
+		bool compress;
+		Vector<PendingFile> pending; // files are compressed in batches, to compress blocks of many files in parallel
+		uint64_t pending_size;
 	};
 
 	struct ZipData {
@@ -196,6 +212,8 @@ private:
 
 	void gen_debug_flags(Vector<String> &r_flags, int p_flags);
 	static Error _save_pack_file(void *p_userdata, const String &p_path, const Vector<uint8_t> &p_data, int p_file, int p_total);
+	static void _store_pack_file(PackData *p_pd, SavedData &p_sd, const uint8_t *p_data, uint64_t p_size);
+	static void _store_pending_pack_files(PackData *p_pd);
 	static Error _save_zip_file(void *p_userdata, const String &p_path, const Vector<uint8_t> &p_data, int p_file, int p_total);
 
 	void _edit_files_with_filter(DirAccess *da, const Vector<String> &p_filters, Set<String> &r_list, bool exclude);
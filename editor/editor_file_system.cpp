@@ -34,7 +34,9 @@
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
 #include "core/os/file_access.h"
+#include "core/os/file_system_watcher.h"
 #include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
 #include "core/project_settings.h"
 #include "core/variant_parser.h"
 #include "editor_node.h"
@@ -43,7 +45,7 @@
 
 EditorFileSystem *EditorFileSystem::singleton = NULL;
 //the name is the version, to keep compatibility with different versions of Godot
-#define CACHE_FILE_NAME "filesystem_cache6"
+#define CACHE_FILE_NAME "filesystem_cache7"
 
 void EditorFileSystemDirectory::sort_files() {
 
@@ -118,7 +120,21 @@ String EditorFileSystemDirectory::get_file_path(int p_idx) const {
 Vector<String> EditorFileSystemDirectory::get_file_deps(int p_idx) const {
 
 	ERR_FAIL_INDEX_V(p_idx, files.size(), Vector<String>());
-	return files[p_idx]->deps;
+
+	FileInfo *fi = files[p_idx];
+	if (!fi->deps_valid) {
+		// Reading dependencies means parsing the file, so it's only done when somebody asks for them
+		List<String> deps;
+		ResourceLoader::get_dependencies(get_file_path(p_idx), &deps);
+
+		fi->deps.clear();
+		for (List<String>::Element *E = deps.front(); E; E = E->next()) {
+			fi->deps.push_back(E->get());
+		}
+		fi->deps_valid = true;
+	}
+
+	return fi->deps;
 }
 
 bool EditorFileSystemDirectory::get_file_import_is_valid(int p_idx) const {
@@ -241,7 +257,7 @@ void EditorFileSystem::_scan_filesystem() {
 
 			} else {
 				Vector<String> split = l.split("::");
-				ERR_CONTINUE(split.size() != 8);
+				ERR_CONTINUE(split.size() != 9);
 				String name = split[0];
 				String file;
 
@@ -258,7 +274,8 @@ void EditorFileSystem::_scan_filesystem() {
 				fc.script_class_extends = split[6].get_slice("<>", 1);
 				fc.script_class_icon_path = split[6].get_slice("<>", 2);
 
-				String deps = split[7].strip_edges();
+				fc.deps_valid = split[7].to_int64() != 0;
+				String deps = split[8].strip_edges();
 				if (deps.length()) {
 					Vector<String> dp = deps.split("<>");
 					for (int i = 0; i < dp.size(); i++) {
@@ -419,30 +436,35 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 
 	// Read the md5's from a separate file (so the import parameters aren't dependent on the file version
 	String base_path = ResourceFormatImporter::get_singleton()->get_import_base_path(p_path);
-	FileAccess *md5s = FileAccess::open(base_path + ".md5", FileAccess::READ, &err);
-	if (!md5s) { // No md5's stored for this resource
-		return true;
-	}
+	if (p_only_imported_files) {
+		// The md5's are only compared for sources, this runs for every imported file on startup so avoid parsing them
+		if (!FileAccess::exists(base_path + ".md5")) {
+			return true;
+		}
+	} else {
+		FileAccess *md5s = FileAccess::open(base_path + ".md5", FileAccess::READ, &err);
+		if (!md5s) { // No md5's stored for this resource
+			return true;
+		}
 
-	VariantParser::StreamFile md5_stream;
-	md5_stream.f = md5s;
+		VariantParser::StreamFile md5_stream;
+		md5_stream.f = md5s;
 
-	while (true) {
-		assign = Variant();
-		next_tag.fields.clear();
-		next_tag.name = String();
+		while (true) {
+			assign = Variant();
+			next_tag.fields.clear();
+			next_tag.name = String();
 
-		err = VariantParser::parse_tag_assign_eof(&md5_stream, lines, error_text, next_tag, assign, value, NULL, true);
+			err = VariantParser::parse_tag_assign_eof(&md5_stream, lines, error_text, next_tag, assign, value, NULL, true);
 
-		if (err == ERR_FILE_EOF) {
-			break;
-		} else if (err != OK) {
-			ERR_PRINTS("ResourceFormatImporter::load - " + p_path + ".import.md5:" + itos(lines) + " error: " + error_text);
-			memdelete(md5s);
-			return false; // parse error
-		}
-		if (assign != String()) {
-			if (!p_only_imported_files) {
+			if (err == ERR_FILE_EOF) {
+				break;
+			} else if (err != OK) {
+				ERR_PRINTS("ResourceFormatImporter::load - " + p_path + ".import.md5:" + itos(lines) + " error: " + error_text);
+				memdelete(md5s);
+				return false; // parse error
+			}
+			if (assign != String()) {
 				if (assign == "source_md5") {
 					source_md5 = value;
 				} else if (assign == "dest_md5") {
@@ -450,8 +472,8 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 				}
 			}
 		}
+		memdelete(md5s);
 	}
-	memdelete(md5s);
 
 	//imported files are gone, reimport
 	for (List<String>::Element *E = to_check.front(); E; E = E->next()) {
@@ -661,11 +683,26 @@ EditorFileSystem::ScanProgress EditorFileSystem::ScanProgress::get_sub(int p_cur
 	return sp;
 }
 
+void EditorFileSystem::_watch_dir(const String &p_path) {
+
+	if (!watcher || watcher_failed)
+		return;
+
+	if (watcher->watch_dir(p_path) != OK) {
+		// Most likely out of watches, go back to checking every directory for changes
+		print_verbose("EditorFileSystem: Can't watch " + p_path + " for changes, falling back to full scans.");
+		watcher_failed = true;
+	}
+}
+
 void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess *da, const ScanProgress &p_progress) {
 
 	List<String> dirs;
 	List<String> files;
 
+	// Watch before listing, so changes made while scanning are not lost
+	_watch_dir(p_dir->get_path());
+
 	String cd = da->get_current_dir();
 
 	p_dir->modified_time = FileAccess::get_modified_time(cd);
@@ -769,6 +806,7 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 
 				fi->type = fc->type;
 				fi->deps = fc->deps;
+				fi->deps_valid = fc->deps_valid;
 				fi->modified_time = fc->modification_time;
 				fi->import_modified_time = fc->import_modification_time;
 
@@ -815,6 +853,7 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 				fi->type = fc->type;
 				fi->modified_time = fc->modification_time;
 				fi->deps = fc->deps;
+				fi->deps_valid = fc->deps_valid;
 				fi->import_modified_time = 0;
 				fi->import_valid = true;
 				fi->script_class_name = fc->script_class_name;
@@ -824,7 +863,6 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 				//new or modified time
 				fi->type = ResourceLoader::get_resource_type(path);
 				fi->script_class_name = _get_global_script_class(fi->type, path, &fi->script_class_extends, &fi->script_class_icon_path);
-				fi->deps = _get_dependencies(path);
 				fi->modified_time = mt;
 				fi->import_modified_time = 0;
 				fi->import_valid = true;
@@ -838,6 +876,14 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 
 void EditorFileSystem::_scan_fs_changes(EditorFileSystemDirectory *p_dir, const ScanProgress &p_progress) {
 
+	if (use_changed_dirs && !changed_dirs.has(p_dir->get_path())) {
+		// Not reported by the watcher, nothing inside this directory changed
+		for (int i = 0; i < p_dir->subdirs.size(); i++) {
+			_scan_fs_changes(p_dir->get_subdir(i), p_progress);
+		}
+		return;
+	}
+
 	uint64_t current_mtime = FileAccess::get_modified_time(p_dir->get_path());
 
 	bool updated_dir = false;
@@ -1069,6 +1115,18 @@ void EditorFileSystem::scan_changes() {
 	scanning_changes = true;
 	scanning_changes_done = false;
 
+	use_changed_dirs = false;
+	changed_dirs.clear();
+	if (watcher && !watcher_failed && !using_fat32_or_exfat) {
+		List<String> dirs;
+		if (watcher->poll_changes(&dirs)) {
+			use_changed_dirs = true;
+			for (List<String>::Element *E = dirs.front(); E; E = E->next()) {
+				changed_dirs.insert(E->get());
+			}
+		}
+	}
+
 	abort_scan = false;
 
 	if (!use_threads) {
@@ -1197,7 +1255,7 @@ void EditorFileSystem::_save_filesystem_cache(EditorFileSystemDirectory *p_dir,
 			group_file_cache.insert(p_dir->files[i]->import_group_file);
 		}
 		String s = p_dir->files[i]->file + "::" + p_dir->files[i]->type + "::" + itos(p_dir->files[i]->modified_time) + "::" + itos(p_dir->files[i]->import_modified_time) + "::" + itos(p_dir->files[i]->import_valid) + "::" + p_dir->files[i]->import_group_file + "::" + p_dir->files[i]->script_class_name + "<>" + p_dir->files[i]->script_class_extends + "<>" + p_dir->files[i]->script_class_icon_path;
-		s += "::";
+		s += "::" + itos(p_dir->files[i]->deps_valid) + "::";
 		for (int j = 0; j < p_dir->files[i]->deps.size(); j++) {
 
 			if (j > 0)
@@ -1378,19 +1436,6 @@ void EditorFileSystem::_save_late_updated_files() {
 	}
 }
 
-Vector<String> EditorFileSystem::_get_dependencies(const String &p_path) {
-
-	List<String> deps;
-	ResourceLoader::get_dependencies(p_path, &deps);
-
-	Vector<String> ret;
-	for (List<String>::Element *E = deps.front(); E; E = E->next()) {
-		ret.push_back(E->get());
-	}
-
-	return ret;
-}
-
 String EditorFileSystem::_get_global_script_class(const String &p_type, const String &p_path, String *r_extends, String *r_icon_path) const {
 
 	for (int i = 0; i < ScriptServer::get_language_count(); i++) {
@@ -1495,7 +1540,9 @@ void EditorFileSystem::update_file(const String &p_file) {
 
 		//the file did not exist, it was added
 
+		late_added_mutex->lock();
 		late_added_files.insert(p_file); //remember that it was added. This mean it will be scanned and imported on editor restart
+		late_added_mutex->unlock();
 		int idx = 0;
 
 		for (int i = 0; i < fs->files.size(); i++) {
@@ -1528,7 +1575,8 @@ void EditorFileSystem::update_file(const String &p_file) {
 	fs->files[cpos]->script_class_name = _get_global_script_class(type, p_file, &fs->files[cpos]->script_class_extends, &fs->files[cpos]->script_class_icon_path);
 	fs->files[cpos]->import_group_file = ResourceLoader::get_import_group_file(p_file);
 	fs->files[cpos]->modified_time = FileAccess::get_modified_time(p_file);
-	fs->files[cpos]->deps = _get_dependencies(p_file);
+	fs->files[cpos]->deps.clear();
+	fs->files[cpos]->deps_valid = false;
 	fs->files[cpos]->import_valid = ResourceLoader::is_import_valid(p_file);
 
 	// Update preview
@@ -1676,7 +1724,8 @@ Error EditorFileSystem::_reimport_group(const String &p_group_file, const Vector
 		//update modified times, to avoid reimport
 		fs->files[cpos]->modified_time = FileAccess::get_modified_time(file);
 		fs->files[cpos]->import_modified_time = FileAccess::get_modified_time(file + ".import");
-		fs->files[cpos]->deps = _get_dependencies(file);
+		fs->files[cpos]->deps.clear();
+		fs->files[cpos]->deps_valid = false;
 		fs->files[cpos]->type = importer->get_resource_type();
 		fs->files[cpos]->import_valid = err == OK;
 
@@ -1731,7 +1780,9 @@ void EditorFileSystem::_reimport_file(const String &p_file) {
 		}
 
 	} else {
+		late_added_mutex->lock();
 		late_added_files.insert(p_file); //imported files do not call update_file(), but just in case..
+		late_added_mutex->unlock();
 	}
 
 	Ref<ResourceImporter> importer;
@@ -1883,7 +1934,8 @@ void EditorFileSystem::_reimport_file(const String &p_file) {
 	//update modified times, to avoid reimport
 	fs->files[cpos]->modified_time = FileAccess::get_modified_time(p_file);
 	fs->files[cpos]->import_modified_time = FileAccess::get_modified_time(p_file + ".import");
-	fs->files[cpos]->deps = _get_dependencies(p_file);
+	fs->files[cpos]->deps.clear();
+	fs->files[cpos]->deps_valid = false;
 	fs->files[cpos]->type = importer->get_resource_type();
 	fs->files[cpos]->import_valid = ResourceLoader::is_import_valid(p_file);
 
@@ -1922,6 +1974,11 @@ void EditorFileSystem::_find_group_files(EditorFileSystemDirectory *efd, Map<Str
 	}
 }
 
+void EditorFileSystem::_reimport_thread(uint32_t p_index, ImportThreadData *p_data) {
+
+	_reimport_file(p_data->files[p_data->from + p_index].path);
+}
+
 void EditorFileSystem::reimport_files(const Vector<String> &p_files) {
 
 	{ //check that .import folder exists
@@ -1959,7 +2016,16 @@ void EditorFileSystem::reimport_files(const Vector<String> &p_files) {
 			//it's a regular file
 			ImportFile ifile;
 			ifile.path = p_files[i];
-			ifile.order = ResourceFormatImporter::get_singleton()->get_import_order(p_files[i]);
+			ifile.order = 0;
+			ifile.threaded = false;
+
+			Ref<ResourceImporter> importer = ResourceFormatImporter::get_singleton()->get_importer_for_path(p_files[i]);
+			if (importer.is_valid()) {
+				ifile.importer = importer->get_importer_name();
+				ifile.order = importer->get_import_order();
+				ifile.threaded = use_threads && importer->can_import_threaded();
+			}
+
 			files.push_back(ifile);
 		}
 
@@ -1974,9 +2040,39 @@ void EditorFileSystem::reimport_files(const Vector<String> &p_files) {
 
 	files.sort();
 
-	for (int i = 0; i < files.size(); i++) {
-		pr.step(files[i].path.get_file(), i);
-		_reimport_file(files[i].path);
+	int from = 0;
+	while (from < files.size()) {
+
+		// Files of a thread-safe importer are imported together, files with a higher
+		// import order only start once everything before them is done.
+		int to = from + 1;
+		if (files[from].threaded && ThreadWorkPool::get_singleton()) {
+			while (to < files.size() && files[to].importer == files[from].importer) {
+				to++;
+			}
+		}
+
+		if (to - from > 1) {
+
+			// Stepping the progress dialog runs a frame, which may rescan and change the
+			// file list the workers write to, so it is only stepped between batches.
+			int batch = (ThreadWorkPool::get_singleton()->get_thread_count() + 1) * 2;
+			for (int i = from; i < to; i += batch) {
+
+				ImportThreadData data;
+				data.files = files.ptr();
+				data.from = i;
+
+				pr.step(files[i].path.get_file(), i);
+				ThreadWorkPool::get_singleton()->do_work(MIN(batch, to - i), this, &EditorFileSystem::_reimport_thread, &data);
+			}
+		} else {
+
+			pr.step(files[from].path.get_file(), from);
+			_reimport_file(files[from].path);
+		}
+
+		from = to;
 	}
 
 	//reimport groups
@@ -1993,6 +2089,11 @@ void EditorFileSystem::reimport_files(const Vector<String> &p_files) {
 		}
 	}
 
+	if (OS::get_singleton()->is_stdout_verbose()) {
+		print_line("Texture compression since startup:");
+		Image::print_compress_stats();
+	}
+
 	_save_filesystem_cache();
 	importing = false;
 	if (!is_scanning()) {
@@ -2140,7 +2241,19 @@ EditorFileSystem::EditorFileSystem() {
 	update_script_classes_queued = false;
 	first_scan = true;
 	revalidate_import_files = false;
+	late_added_mutex = Mutex::create();
+
+	watcher = NULL;
+	watcher_failed = false;
+	use_changed_dirs = false;
+	if (EDITOR_GET("filesystem/directories/watch_for_changes")) {
+		watcher = FileSystemWatcher::create();
+	}
 }
 
 EditorFileSystem::~EditorFileSystem() {
+
+	if (watcher)
+		memdelete(watcher);
+	memdelete(late_added_mutex);
 }
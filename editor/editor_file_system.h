@@ -32,11 +32,13 @@
 #define EDITOR_FILE_SYSTEM_H
 
 #include "core/os/dir_access.h"
+#include "core/os/mutex.h"
 #include "core/os/thread.h"
 #include "core/os/thread_safe.h"
 #include "core/set.h"
 #include "scene/main/node.h"
 class FileAccess;
+class FileSystemWatcher;
 
 struct EditorProgressBG;
 class EditorFileSystemDirectory : public Object {
@@ -58,10 +60,15 @@ class EditorFileSystemDirectory : public Object {
 		bool import_valid;
 		String import_group_file;
 		Vector<String> deps;
+		bool deps_valid; //dependencies are read on first use, see get_file_deps()
 		bool verified; //used for checking changes
 		String script_class_name;
 		String script_class_extends;
 		String script_class_icon_path;
+
+		FileInfo() {
+			deps_valid = false;
+		}
 	};
 
 	struct FileInfoSort {
@@ -167,6 +174,7 @@ class EditorFileSystem : public Node {
 		uint64_t modification_time;
 		uint64_t import_modification_time;
 		Vector<String> deps;
+		bool deps_valid;
 		bool import_valid;
 		String import_group_file;
 		String script_class_name;
@@ -199,6 +207,13 @@ class EditorFileSystem : public Node {
 
 	void _scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess *da, const ScanProgress &p_progress);
 
+	FileSystemWatcher *watcher;
+	volatile bool watcher_failed;
+	bool use_changed_dirs;
+	Set<String> changed_dirs; // directories reported by the watcher, only these are checked by _scan_fs_changes()
+
+	void _watch_dir(const String &p_path);
+
 	Thread *thread_sources;
 	bool scanning_changes;
 	bool scanning_changes_done;
@@ -219,16 +234,25 @@ class EditorFileSystem : public Node {
 
 	bool reimport_on_missing_imported_files;
 
-	Vector<String> _get_dependencies(const String &p_path);
-
 	struct ImportFile {
 		String path;
+		String importer;
 		int order;
+		bool threaded;
 		bool operator<(const ImportFile &p_if) const {
-			return order < p_if.order;
+			// Keep files of the same importer together, so they can be imported in parallel
+			return order == p_if.order ? importer < p_if.importer : order < p_if.order;
 		}
 	};
 
+	struct ImportThreadData {
+		const ImportFile *files;
+		int from;
+	};
+
+	void _reimport_thread(uint32_t p_index, ImportThreadData *p_data);
+	Mutex *late_added_mutex;
+
 	void _scan_script_classes(EditorFileSystemDirectory *p_dir);
 	volatile bool update_script_classes_queued;
 	void _queue_update_script_classes();
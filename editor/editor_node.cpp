@@ -41,6 +41,7 @@
 #include "core/os/input.h"
 #include "core/os/keyboard.h"
 #include "core/os/os.h"
+#include "core/os/thread.h"
 #include "core/path_remap.h"
 #include "core/print_string.h"
 #include "core/project_settings.h"
@@ -3445,9 +3446,19 @@ void EditorNode::add_io_error(const String &p_error) {
 void EditorNode::_load_error_notify(void *p_ud, const String &p_text) {
 
 	EditorNode *en = (EditorNode *)p_ud;
-	en->load_errors->add_image(en->gui_base->get_icon("Error", "EditorIcons"));
-	en->load_errors->add_text(p_text + "\n");
-	en->load_error_dialog->popup_centered_ratio(0.5);
+	if (Thread::get_caller_id() != Thread::get_main_id()) {
+		// Resources can be loaded or imported from worker threads, the dialog must be updated on the main one
+		en->call_deferred("_add_load_error", p_text);
+		return;
+	}
+	en->_add_load_error(p_text);
+}
+
+void EditorNode::_add_load_error(const String &p_text) {
+
+	load_errors->add_image(gui_base->get_icon("Error", "EditorIcons"));
+	load_errors->add_text(p_text + "\n");
+	load_error_dialog->popup_centered_ratio(0.5);
 }
 
 bool EditorNode::_find_scene_in_use(Node *p_node, const String &p_path) const {
@@ -5226,6 +5237,7 @@ void EditorNode::_bind_methods() {
 	ClassDB::bind_method("_tool_menu_option", &EditorNode::_tool_menu_option);
 	ClassDB::bind_method("_menu_confirm_current", &EditorNode::_menu_confirm_current);
 	ClassDB::bind_method("_dialog_action", &EditorNode::_dialog_action);
+	ClassDB::bind_method("_add_load_error", &EditorNode::_add_load_error);
 	ClassDB::bind_method("_editor_select", &EditorNode::_editor_select);
 	ClassDB::bind_method("_node_renamed", &EditorNode::_node_renamed);
 	ClassDB::bind_method("edit_node", &EditorNode::edit_node);
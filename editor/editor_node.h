@@ -519,6 +519,7 @@ private:
 	void _unhandled_input(const Ref<InputEvent> &p_event);
 
 	static void _load_error_notify(void *p_ud, const String &p_text);
+	void _add_load_error(const String &p_text);
 
 	bool has_main_screen() const { return true; }
 
@@ -83,6 +83,7 @@ public:
 
 	virtual bool are_import_settings_valid(const String &p_path) const;
 	virtual String get_import_settings_string() const;
+	virtual bool can_import_threaded() const { return true; }
 
 	void set_3d(bool p_3d) { is_3d = p_3d; }
 	ResourceImporterLayeredTexture();
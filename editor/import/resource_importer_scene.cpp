@@ -48,6 +48,7 @@
 #include "scene/resources/ray_shape.h"
 #include "scene/resources/resource_format_text.h"
 #include "scene/resources/sphere_shape.h"
+#include "scene/resources/surface_tool.h"
 
 uint32_t EditorSceneImporter::get_import_flags() const {
 
@@ -215,6 +216,10 @@ bool ResourceImporterScene::get_option_visibility(const String &p_option, const
 		return false;
 	}
 
+	if (p_option == "meshes/lod/distance" && int(p_options["meshes/lod/levels"]) == 0) {
+		return false;
+	}
+
 	return true;
 }
 
@@ -916,6 +921,24 @@ void ResourceImporterScene::_optimize_animations(Node *scene, float p_max_lin_er
 	}
 }
 
+void ResourceImporterScene::_compress_animations(Node *scene) {
+
+	if (!scene->has_node(String("AnimationPlayer")))
+		return;
+	Node *n = scene->get_node(String("AnimationPlayer"));
+	ERR_FAIL_COND(!n);
+	AnimationPlayer *anim = Object::cast_to<AnimationPlayer>(n);
+	ERR_FAIL_COND(!anim);
+
+	List<StringName> anim_names;
+	anim->get_animation_list(&anim_names);
+	for (List<StringName>::Element *E = anim_names.front(); E; E = E->next()) {
+
+		Ref<Animation> a = anim->get_animation(E->get());
+		a->compress();
+	}
+}
+
 static String _make_extname(const String &p_str) {
 
 	String ext_name = p_str.replace(".", "_");
@@ -960,6 +983,90 @@ void ResourceImporterScene::_find_meshes(Node *p_node, Map<Ref<ArrayMesh>, Trans
 	}
 }
 
+void ResourceImporterScene::_generate_lods(Node *p_node, Node *p_root, int p_levels, float p_distance) {
+
+	List<MeshInstance *> mesh_instances;
+
+	{
+		List<Node *> stack;
+		stack.push_back(p_node);
+		while (stack.size()) {
+			Node *n = stack.front()->get();
+			stack.pop_front();
+			MeshInstance *mi = Object::cast_to<MeshInstance>(n);
+			if (mi && mi != p_root && mi->get_mesh().is_valid()) {
+				mesh_instances.push_back(mi);
+			}
+			for (int i = 0; i < n->get_child_count(); i++) {
+				stack.push_back(n->get_child(i));
+			}
+		}
+	}
+
+	// Level N is drawn from p_distance * 2^(N-1) to p_distance * 2^N, the last level has no far limit.
+	// Each level halves the amount of grid cells used to simplify the mesh.
+
+	const float hysteresis = p_distance * 0.05;
+
+	for (List<MeshInstance *>::Element *E = mesh_instances.front(); E; E = E->next()) {
+
+		MeshInstance *mi = E->get();
+		Ref<Mesh> mesh = mi->get_mesh();
+		float size = mesh->get_aabb().get_longest_axis_size();
+		if (size <= 0)
+			continue;
+
+		mi->set_lod_max_distance(p_distance);
+		mi->set_lod_max_hysteresis(hysteresis);
+
+		for (int level = 1; level <= p_levels; level++) {
+
+			float cell_size = size / (64 >> level);
+
+			Ref<ArrayMesh> lod_mesh;
+			lod_mesh.instance();
+			lod_mesh->set_name(mesh->get_name() + "_lod" + itos(level));
+
+			for (int i = 0; i < mesh->get_surface_count(); i++) {
+
+				Ref<SurfaceTool> st;
+				st.instance();
+				st->create_from(mesh, i);
+				if (mesh->surface_get_primitive_type(i) == Mesh::PRIMITIVE_TRIANGLES) {
+					st->simplify(cell_size);
+				}
+				Array arrays = st->commit_to_arrays();
+				if (PoolVector<Vector3>(arrays[Mesh::ARRAY_VERTEX]).size() == 0) {
+					arrays = mesh->surface_get_arrays(i); // fully collapsed, keep the surface so material indices still match
+				}
+				lod_mesh->add_surface_from_arrays(mesh->surface_get_primitive_type(i), arrays);
+				lod_mesh->surface_set_material(i, mesh->surface_get_material(i));
+			}
+
+			MeshInstance *lod = memnew(MeshInstance);
+			lod->set_name(String(mi->get_name()) + "_lod" + itos(level));
+			lod->set_transform(mi->get_transform());
+			lod->set_mesh(lod_mesh);
+			lod->set_skeleton_path(mi->get_skeleton_path());
+			lod->set_material_override(mi->get_material_override());
+			lod->set_cast_shadows_setting(mi->get_cast_shadows_setting());
+			for (int i = 0; i < mi->get_surface_material_count(); i++) {
+				lod->set_surface_material(i, mi->get_surface_material(i));
+			}
+
+			lod->set_lod_min_distance(p_distance * (1 << (level - 1)));
+			lod->set_lod_min_hysteresis(hysteresis);
+			if (level < p_levels) {
+				lod->set_lod_max_distance(p_distance * (1 << level));
+				lod->set_lod_max_hysteresis(hysteresis);
+			}
+
+			mi->get_parent()->add_child(lod);
+			lod->set_owner(p_root);
+		}
+	}
+}
+
 void ResourceImporterScene::_make_external_resources(Node *p_node, const String &p_base_path, bool p_make_animations, bool p_keep_animations, bool p_make_materials, bool p_keep_materials, bool p_make_meshes, Map<Ref<Animation>, Ref<Animation> > &p_animations, Map<Ref<Material>, Ref<Material> > &p_materials, Map<Ref<ArrayMesh>, Ref<ArrayMesh> > &p_meshes) {
 
 	List<PropertyInfo> pi;
@@ -1141,6 +1248,8 @@ void ResourceImporterScene::get_import_options(List<ImportOption> *r_options, in
 	r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "meshes/storage", PROPERTY_HINT_ENUM, "Built-In,Files"), meshes_out ? 1 : 0));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "meshes/light_baking", PROPERTY_HINT_ENUM, "Disabled,Enable,Gen Lightmaps", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), 0));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "meshes/lightmap_texel_size", PROPERTY_HINT_RANGE, "0.001,100,0.001"), 0.1));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "meshes/lod/levels", PROPERTY_HINT_RANGE, "0,4,1", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), 0));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "meshes/lod/distance", PROPERTY_HINT_RANGE, "0.1,1000,0.1"), 20.0));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "external_files/store_in_subdir"), false));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "animation/import", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), true));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "animation/fps", PROPERTY_HINT_RANGE, "1,120,1"), 15));
@@ -1152,6 +1261,7 @@ void ResourceImporterScene::get_import_options(List<ImportOption> *r_options, in
 	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "animation/optimizer/max_angular_error"), 0.01));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "animation/optimizer/max_angle"), 22));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "animation/optimizer/remove_unused_tracks"), true));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "animation/compression/enabled"), false));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "animation/clips/amount", PROPERTY_HINT_RANGE, "0,256,1", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), 0));
 	for (int i = 0; i < 256; i++) {
 		r_options->push_back(ImportOption(PropertyInfo(Variant::STRING, "animation/clip_" + itos(i + 1) + "/name"), ""));
@@ -1367,6 +1477,10 @@ Error ResourceImporterScene::import(const String &p_source_file, const String &p
 		_filter_tracks(scene, animation_filter);
 	}
 
+	if (bool(p_options["animation/compression/enabled"])) {
+		_compress_animations(scene);
+	}
+
 	bool external_animations = int(p_options["animation/storage"]) == 1;
 	bool keep_custom_tracks = p_options["animation/keep_custom_tracks"];
 	bool external_materials = p_options["materials/storage"];
@@ -1387,13 +1501,15 @@ Error ResourceImporterScene::import(const String &p_source_file, const String &p
 		}
 	}
 
-	if (light_bake_mode == 2 /* || generate LOD */) {
+	int lod_levels = p_options["meshes/lod/levels"];
 
-		Map<Ref<ArrayMesh>, Transform> meshes;
-		_find_meshes(scene, meshes);
+	if (light_bake_mode == 2 || lod_levels > 0) {
 
 		if (light_bake_mode == 2) {
 
+			Map<Ref<ArrayMesh>, Transform> meshes;
+			_find_meshes(scene, meshes);
+
 			float texel_size = p_options["meshes/lightmap_texel_size"];
 			texel_size = MAX(0.001, texel_size);
 
@@ -1416,6 +1532,11 @@ Error ResourceImporterScene::import(const String &p_source_file, const String &p
 				step++;
 			}
 		}
+
+		if (lod_levels > 0) {
+			// after lightmap unwrapping, so the simplified meshes keep UV2
+			_generate_lods(scene, scene, lod_levels, p_options["meshes/lod/distance"]);
+		}
 	}
 
 	if (external_animations || external_materials || external_meshes) {
@@ -232,6 +232,7 @@ void ProjectExportDialog::_edit_preset(int p_index) {
 	export_filter->select(current->get_export_filter());
 	include_filters->set_text(current->get_include_filter());
 	exclude_filters->set_text(current->get_exclude_filter());
+	compress_pack->set_pressed(current->get_compress_pack());
 
 	patches->clear();
 	TreeItem *patch_root = patches->create_item();
@@ -593,6 +594,7 @@ void ProjectExportDialog::_duplicate_preset() {
 	preset->set_export_filter(current->get_export_filter());
 	preset->set_include_filter(current->get_include_filter());
 	preset->set_exclude_filter(current->get_exclude_filter());
+	preset->set_compress_pack(current->get_compress_pack());
 	Vector<String> list = current->get_patches();
 	for (int i = 0; i < list.size(); i++) {
 		preset->add_patch(list[i]);
@@ -786,6 +788,18 @@ void ProjectExportDialog::_filter_changed(const String &p_filter) {
 	current->set_exclude_filter(exclude_filters->get_text());
 }
 
+void ProjectExportDialog::_compress_pack_toggled(bool p_pressed) {
+
+	if (updating)
+		return;
+
+	Ref<EditorExportPreset> current = get_current_preset();
+	if (current.is_null())
+		return;
+
+	current->set_compress_pack(p_pressed);
+}
+
 void ProjectExportDialog::_fill_resource_tree() {
 
 	include_files->clear();
@@ -1040,6 +1054,7 @@ void ProjectExportDialog::_bind_methods() {
 	ClassDB::bind_method("drop_data_fw", &ProjectExportDialog::drop_data_fw);
 	ClassDB::bind_method("_export_type_changed", &ProjectExportDialog::_export_type_changed);
 	ClassDB::bind_method("_filter_changed", &ProjectExportDialog::_filter_changed);
+	ClassDB::bind_method("_compress_pack_toggled", &ProjectExportDialog::_compress_pack_toggled);
 	ClassDB::bind_method("_tree_changed", &ProjectExportDialog::_tree_changed);
 	ClassDB::bind_method("_patch_button_pressed", &ProjectExportDialog::_patch_button_pressed);
 	ClassDB::bind_method("_patch_selected", &ProjectExportDialog::_patch_selected);
@@ -1164,6 +1179,11 @@ ProjectExportDialog::ProjectExportDialog() {
 	resources_vb->add_margin_child(TTR("Filters to exclude files from project (comma separated, e.g: *.json, *.txt)"), exclude_filters);
 	exclude_filters->connect("text_changed", this, "_filter_changed");
 
+	compress_pack = memnew(CheckBox);
+	compress_pack->set_text(TTR("Compress Files in PCK (Zstandard)"));
+	resources_vb->add_child(compress_pack);
+	compress_pack->connect("toggled", this, "_compress_pack_toggled");
+
 	VBoxContainer *patch_vb = memnew(VBoxContainer);
 	sections->add_child(patch_vb);
 	patch_vb->set_name(TTR("Patches"));
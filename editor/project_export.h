@@ -80,6 +80,7 @@ private:
 	OptionButton *export_filter;
 	LineEdit *include_filters;
 	LineEdit *exclude_filters;
+	CheckBox *compress_pack;
 	Tree *include_files;
 
 	Label *include_label;
@@ -128,6 +129,7 @@ private:
 
 	void _export_type_changed(int p_which);
 	void _filter_changed(const String &p_filter);
+	void _compress_pack_toggled(bool p_pressed);
 	void _fill_resource_tree();
 	bool _fill_tree(EditorFileSystemDirectory *p_dir, TreeItem *p_item, Ref<EditorExportPreset> &current, bool p_only_scenes);
 	void _tree_changed();
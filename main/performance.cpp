@@ -74,6 +74,11 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(ANIMATION_TRACKS_EVALUATED_IN_FRAME);
+	BIND_ENUM_CONSTANT(ANIMATION_TRACKS_SKIPPED_IN_FRAME);
+	BIND_ENUM_CONSTANT(AUDIO_REAL_VOICES);
+	BIND_ENUM_CONSTANT(AUDIO_VIRTUAL_VOICES);
+	BIND_ENUM_CONSTANT(AUDIO_MIX_DECODE_TIME);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -86,6 +91,14 @@ float Performance::_get_node_count() const {
 	return sml->get_node_count();
 }
 
+float Performance::_get_animation_tracks(bool p_skipped) const {
+	MainLoop *ml = OS::get_singleton()->get_main_loop();
+	SceneTree *sml = Object::cast_to<SceneTree>(ml);
+	if (!sml)
+		return 0;
+	return p_skipped ? sml->get_animation_tracks_skipped() : sml->get_animation_tracks_evaluated();
+}
+
 String Performance::get_monitor_name(Monitor p_monitor) const {
 
 	ERR_FAIL_INDEX_V(p_monitor, MONITOR_MAX, String());
@@ -120,6 +133,11 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"animation/tracks_evaluated",
+		"animation/tracks_skipped",
+		"audio/real_voices",
+		"audio/virtual_voices",
+		"audio/mix_decode_time",
 
 	};
 
@@ -158,6 +176,11 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case PHYSICS_3D_COLLISION_PAIRS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
 		case PHYSICS_3D_ISLAND_COUNT: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY: return AudioServer::get_singleton()->get_output_latency();
+		case ANIMATION_TRACKS_EVALUATED_IN_FRAME: return _get_animation_tracks(false);
+		case ANIMATION_TRACKS_SKIPPED_IN_FRAME: return _get_animation_tracks(true);
+		case AUDIO_REAL_VOICES: return AudioServer::get_singleton()->get_real_voice_count();
+		case AUDIO_VIRTUAL_VOICES: return AudioServer::get_singleton()->get_virtual_voice_count();
+		case AUDIO_MIX_DECODE_TIME: return AudioServer::get_singleton()->get_mix_decode_time();
 
 		default: {
 		}
@@ -200,6 +223,11 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_TIME,
 
 	};
 
@@ -44,6 +44,7 @@ class Performance : public Object {
 	static void _bind_methods();
 
 	float _get_node_count() const;
+	float _get_animation_tracks(bool p_skipped) const;
 
 	float _process_time;
 	float _physics_process_time;
@@ -81,6 +82,11 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		ANIMATION_TRACKS_EVALUATED_IN_FRAME,
+		ANIMATION_TRACKS_SKIPPED_IN_FRAME,
+		AUDIO_REAL_VOICES,
+		AUDIO_VIRTUAL_VOICES,
+		AUDIO_MIX_DECODE_TIME,
 		MONITOR_MAX
 	};
 
@@ -0,0 +1,237 @@
+/*************************************************************************/
+/*  test_animation.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_animation.h"
+
+#include "core/os/memory.h"
+#include "core/os/os.h"
+#include "scene/resources/animation.h"
+
+namespace TestAnimation {
+
+enum {
+	KEY_COUNT = 600,
+	BENCH_TRACKS = 64,
+	BENCH_FRAMES = 2000
+};
+
+static const float FPS = 30;
+
+// Bones usually rotate only, so the location of every other track is kept still.
+static Ref<Animation> make_animation(int p_tracks) {
+
+	Ref<Animation> anim;
+	anim.instance();
+	anim->set_length((KEY_COUNT - 1) / FPS);
+	anim->set_loop(true);
+
+	for (int t = 0; t < p_tracks; t++) {
+
+		anim->add_track(Animation::TYPE_TRANSFORM);
+		anim->track_set_path(t, NodePath("Skeleton:bone" + itos(t)));
+
+		for (int k = 0; k < KEY_COUNT; k++) {
+
+			float time = k / FPS;
+			Vector3 loc = (t & 1) ? Vector3(Math::sin(time + t), Math::cos(time * 0.5) * 2.0, t * 0.1) : Vector3(0, 0.25, 0);
+			Quat rot(Vector3(Math::sin(t + 1.0), 1, Math::cos(t + 1.0)).normalized(), Math::sin(time * 2.0 + t) * Math_PI);
+			anim->transform_track_insert_key(t, time, loc, rot, Vector3(1, 1, 1));
+		}
+	}
+
+	return anim;
+}
+
+// Largest location and rotation difference between two animations, optionally sampling the second one with a cursor.
+static void compare(const Ref<Animation> &p_a, const Ref<Animation> &p_b, float &r_loc_err, float &r_rot_err, bool p_cursor = false) {
+
+	r_loc_err = 0;
+	r_rot_err = 0;
+
+	for (int t = 0; t < p_a->get_track_count(); t++) {
+
+		int cursor = -1;
+		for (float time = 0; time < p_a->get_length(); time += 1.0 / 97.0) {
+
+			Vector3 loc_a, loc_b, scale;
+			Quat rot_a, rot_b;
+			p_a->transform_track_interpolate(t, time, &loc_a, &rot_a, &scale);
+			p_b->transform_track_interpolate(t, time, &loc_b, &rot_b, &scale, p_cursor ? &cursor : NULL);
+
+			r_loc_err = MAX(r_loc_err, loc_a.distance_to(loc_b));
+			// q and -q are the same rotation, the distance is about half the angle between them
+			real_t rot_dist = MIN((rot_a - rot_b).length_squared(), (rot_a + rot_b).length_squared());
+			r_rot_err = MAX(r_rot_err, Math::sqrt(rot_dist) * 2.0);
+		}
+	}
+}
+
+bool test_accuracy() {
+
+	Ref<Animation> raw = make_animation(4);
+	Ref<Animation> compressed = make_animation(4);
+	compressed->compress();
+
+	float loc_err, rot_err;
+	compare(raw, compressed, loc_err, rot_err);
+
+	OS::get_singleton()->print("\n\nTesting compressed sampling accuracy\n");
+	OS::get_singleton()->print("\tmax location error %f, max rotation error %f rad\n", loc_err, rot_err);
+
+	return compressed->track_is_compressed(0) && compressed->track_get_key_count(0) == KEY_COUNT && loc_err < 0.001 && rot_err < 0.001;
+}
+
+bool test_cursor() {
+
+	Ref<Animation> raw = make_animation(2);
+	Ref<Animation> compressed = make_animation(2);
+	compressed->compress();
+
+	float raw_loc_err, raw_rot_err, loc_err, rot_err;
+	compare(raw, raw, raw_loc_err, raw_rot_err, true);
+	compare(compressed, compressed, loc_err, rot_err, true);
+
+	OS::get_singleton()->print("\n\nTesting that the key cursor gives the same result as a full search\n");
+
+	return raw_loc_err == 0 && raw_rot_err == 0 && loc_err == 0 && rot_err == 0;
+}
+
+bool test_serialize() {
+
+	Ref<Animation> compressed = make_animation(2);
+	compressed->compress();
+
+	Ref<Animation> loaded;
+	loaded.instance();
+	loaded->set_length(compressed->get_length());
+	loaded->set_loop(true);
+	for (int t = 0; t < 2; t++) {
+		loaded->add_track(Animation::TYPE_TRANSFORM);
+		loaded->set("tracks/" + itos(t) + "/keys", compressed->get("tracks/" + itos(t) + "/keys"));
+	}
+
+	float loc_err, rot_err;
+	compare(compressed, loaded, loc_err, rot_err);
+
+	OS::get_singleton()->print("\n\nTesting that compressed keys survive saving and loading\n");
+
+	return loaded->track_is_compressed(1) && loc_err == 0 && rot_err == 0;
+}
+
+bool test_edit() {
+
+	Ref<Animation> anim = make_animation(1);
+	anim->compress();
+	float time = anim->track_get_key_time(0, 10);
+	anim->track_remove_key(0, 10);
+
+	OS::get_singleton()->print("\n\nTesting that editing keys decompresses the track\n");
+
+	return !anim->track_is_compressed(0) && anim->track_get_key_count(0) == KEY_COUNT - 1 && anim->track_find_key(0, time, true) == -1;
+}
+
+static uint64_t sample(const Ref<Animation> &p_anim, bool p_cursor) {
+
+	Vector<int> cursors;
+	cursors.resize(p_anim->get_track_count());
+	for (int i = 0; i < cursors.size(); i++)
+		cursors.write[i] = -1;
+
+	Vector3 loc, scale;
+	Quat rot;
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int f = 0; f < BENCH_FRAMES; f++) {
+		float time = Math::fmod(float(f / 60.0), p_anim->get_length());
+		for (int t = 0; t < p_anim->get_track_count(); t++)
+			p_anim->transform_track_interpolate(t, time, &loc, &rot, &scale, p_cursor ? &cursors.write[t] : NULL);
+	}
+	uint64_t usec = MAX(OS::get_singleton()->get_ticks_usec() - from, (uint64_t)1);
+
+	return uint64_t(BENCH_FRAMES) * p_anim->get_track_count() * 1000000 / usec;
+}
+
+bool test_benchmark() {
+
+	OS::get_singleton()->print("\n\nBenchmarking %i tracks of %i keys\n", BENCH_TRACKS, KEY_COUNT);
+
+	uint64_t mem_from = Memory::get_mem_usage();
+	Ref<Animation> anim = make_animation(BENCH_TRACKS);
+	uint64_t raw_mem = Memory::get_mem_usage() - mem_from;
+
+	OS::get_singleton()->print("\tuncompressed: %i bytes, %i samples/s, %i samples/s with cursor\n", (int)raw_mem, (int)sample(anim, false), (int)sample(anim, true));
+
+	anim->compress();
+	uint64_t compressed_mem = Memory::get_mem_usage() - mem_from;
+
+	OS::get_singleton()->print("\tcompressed: %i bytes, %i samples/s, %i samples/s with cursor\n", (int)compressed_mem, (int)sample(anim, false), (int)sample(anim, true));
+
+	return true;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_accuracy,
+	test_cursor,
+	test_serialize,
+	test_edit,
+	test_benchmark,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestAnimation
@@ -32,6 +32,7 @@
 
 #include "core/math/a_star.h"
 #include "core/os/os.h"
+#include "core/os/thread.h"
 
 #include <stdio.h>
 
@@ -87,11 +88,95 @@ bool test_abcx() {
 	return ok;
 }
 
+class Grid : public AStar {
+public:
+	enum { SIZE = 256 };
+
+	Grid() {
+		for (int y = 0; y < SIZE; y++) {
+			for (int x = 0; x < SIZE; x++) {
+				add_point(id(x, y), Vector3(x, y, 0));
+				if (x > 0)
+					connect_points(id(x, y), id(x - 1, y));
+				if (y > 0)
+					connect_points(id(x, y), id(x, y - 1));
+			}
+		}
+	}
+
+	static int id(int p_x, int p_y) {
+		return p_y * SIZE + p_x;
+	}
+};
+
+bool test_grid() {
+	Grid grid;
+	bool ok = true;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < 16; i++) {
+		int x = (i * 37) % Grid::SIZE;
+		int y = (i * 91) % Grid::SIZE;
+		PoolVector<int> path = grid.get_id_path(Grid::id(0, 0), Grid::id(x, y));
+		ok = ok && path.size() == x + y + 1;
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	OS::get_singleton()->print("\t16 queries on a %ix%i grid: %i usec\n", Grid::SIZE, Grid::SIZE, int(elapsed));
+
+	// Removing points moves others around in storage, paths must not change
+	grid.remove_point(Grid::id(1, 0));
+	grid.remove_point(Grid::id(0, 1));
+	PoolVector<int> path = grid.get_id_path(Grid::id(0, 0), Grid::id(5, 5));
+	ok = ok && path.size() == 0;
+	path = grid.get_id_path(Grid::id(1, 1), Grid::id(5, 5));
+	ok = ok && path.size() == 9;
+
+	return ok;
+}
+
+struct GridQuery {
+	Grid *grid;
+	int to_x;
+	PoolVector<int> result;
+};
+
+static void _grid_query_thread(void *p_userdata) {
+	GridQuery *q = (GridQuery *)p_userdata;
+	q->result = q->grid->get_id_path(Grid::id(0, 0), Grid::id(q->to_x, Grid::SIZE - 1));
+}
+
+bool test_threads() {
+	Grid grid;
+	GridQuery queries[4];
+	Thread *threads[4];
+
+	for (int i = 0; i < 4; i++) {
+		queries[i].grid = &grid;
+		queries[i].to_x = i * 50;
+		threads[i] = Thread::create(_grid_query_thread, &queries[i]);
+	}
+
+	bool ok = true;
+	for (int i = 0; i < 4; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+
+		PoolVector<int> serial = grid.get_id_path(Grid::id(0, 0), Grid::id(queries[i].to_x, Grid::SIZE - 1));
+		ok = ok && serial.size() == queries[i].result.size();
+		for (int j = 0; ok && j < serial.size(); j++) {
+			ok = serial[j] == queries[i].result[j];
+		}
+	}
+	return ok;
+}
+
 typedef bool (*TestFunc)(void);
 
 TestFunc test_funcs[] = {
 	test_abc,
 	test_abcx,
+	test_grid,
+	test_threads,
 	NULL
 };
 
@@ -0,0 +1,472 @@
+/*************************************************************************/
+/*  test_audio.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_audio.h"
+
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "servers/audio/audio_stream.h"
+#include "servers/audio/effects/audio_effect_chorus.h"
+#include "servers/audio/effects/audio_effect_compressor.h"
+#include "servers/audio/effects/audio_effect_delay.h"
+#include "servers/audio/effects/audio_effect_eq.h"
+#include "servers/audio/effects/audio_effect_filter.h"
+#include "servers/audio/effects/audio_effect_limiter.h"
+#include "servers/audio/effects/audio_effect_phaser.h"
+#include "servers/audio/effects/audio_effect_reverb.h"
+#include "servers/audio/effects/reverb.h"
+#include "servers/audio_server.h"
+
+// Run with "--audio-driver Dummy" to benchmark without an audio device.
+
+namespace TestAudio {
+
+enum {
+	BUFFER_FRAMES = 1024,
+	BENCH_BUFFERS = 500,
+	STREAM_RATE = 32000
+};
+
+static AudioFrame signal(int p_frame) {
+
+	if (p_frame < 0)
+		return AudioFrame(0, 0);
+
+	return AudioFrame(Math::sin(p_frame * 0.05) * 0.5, Math::cos(p_frame * 0.031) * 0.3);
+}
+
+static void fill_signal(AudioFrame *p_frames, int p_from, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		p_frames[i] = signal(p_from + i);
+	}
+}
+
+class SignalPlayback : public AudioStreamPlaybackResampled {
+
+	GDCLASS(SignalPlayback, AudioStreamPlaybackResampled);
+
+	int position;
+
+protected:
+	virtual void _mix_internal(AudioFrame *p_buffer, int p_frames) {
+
+		fill_signal(p_buffer, position, p_frames);
+		position += p_frames;
+	}
+
+	virtual float get_stream_sampling_rate() { return STREAM_RATE; }
+
+public:
+	virtual void start(float p_from_pos = 0.0) {
+
+		position = 0;
+		_begin_resample();
+	}
+	virtual void stop() {}
+	virtual bool is_playing() const { return true; }
+	virtual int get_loop_count() const { return 0; }
+	virtual float get_playback_position() const { return 0; }
+	virtual void seek(float p_time) {}
+
+	SignalPlayback() { position = 0; }
+};
+
+bool test_eq() {
+
+	OS::get_singleton()->print("\n\nTest 1: EQ against the scalar band filters\n");
+
+	Ref<AudioEffectEQ> eq = memnew(AudioEffectEQ10);
+	for (int i = 0; i < eq->get_band_count(); i++) {
+		eq->set_band_gain_db(i, (i % 3) * 4.0 - 4.0);
+	}
+
+	EQ reference;
+	reference.set_mix_rate(AudioServer::get_singleton()->get_mix_rate());
+	reference.set_preset_band_mode(EQ::PRESET_10_BANDS);
+
+	Vector<EQ::BandProcess> bands[2];
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < reference.get_band_count(); j++) {
+			bands[i].push_back(reference.get_band_processor(j));
+		}
+	}
+
+	Ref<AudioEffectInstance> instance = eq->instance();
+
+	AudioFrame src[BUFFER_FRAMES];
+	AudioFrame dst[BUFFER_FRAMES];
+	float max_error = 0;
+
+	for (int b = 0; b < 4; b++) {
+
+		fill_signal(src, b * BUFFER_FRAMES, BUFFER_FRAMES);
+		instance->process(src, dst, BUFFER_FRAMES);
+
+		for (int i = 0; i < BUFFER_FRAMES; i++) {
+
+			AudioFrame expected(0, 0);
+			for (int j = 0; j < bands[0].size(); j++) {
+				float l = src[i].l;
+				float r = src[i].r;
+				bands[0].write[j].process_one(l);
+				bands[1].write[j].process_one(r);
+				float gain = Math::db2linear(eq->get_band_gain_db(j));
+				expected.l += l * gain;
+				expected.r += r * gain;
+			}
+
+			max_error = MAX(max_error, MAX(ABS(dst[i].l - expected.l), ABS(dst[i].r - expected.r)));
+		}
+	}
+
+	OS::get_singleton()->print("\tmax error %g\n", max_error);
+
+	return max_error < 1e-4;
+}
+
+bool test_resampler() {
+
+	OS::get_singleton()->print("\n\nTest 2: cubic resampler against the scalar formula\n");
+
+	Ref<SignalPlayback> playback = memnew(SignalPlayback);
+	playback->start();
+
+	float rate_scale = 1.37;
+	float target_rate = AudioServer::get_singleton()->get_mix_rate();
+	float global_rate_scale = AudioServer::get_singleton()->get_global_rate_scale();
+	uint64_t increment = uint64_t(((STREAM_RATE * rate_scale) / double(target_rate * global_rate_scale)) * double(1 << 16));
+
+	AudioFrame dst[BUFFER_FRAMES];
+	uint64_t offset = 0;
+	float max_error = 0;
+
+	for (int b = 0; b < 8; b++) {
+
+		// odd sizes so both the paired and the single frame paths run
+		int frames = BUFFER_FRAMES - (b & 1);
+		playback->mix(dst, rate_scale, frames);
+
+		for (int i = 0; i < frames; i++) {
+
+			int k = int(offset >> 16);
+			float mu = (offset & 0xFFFF) / float(1 << 16);
+			AudioFrame y0 = signal(k - 3);
+			AudioFrame y1 = signal(k - 2);
+			AudioFrame y2 = signal(k - 1);
+			AudioFrame y3 = signal(k);
+
+			float mu2 = mu * mu;
+			AudioFrame a0 = y3 - y2 - y0 + y1;
+			AudioFrame a1 = y0 - y1 - a0;
+			AudioFrame a2 = y2 - y0;
+			AudioFrame expected = a0 * mu * mu2 + a1 * mu2 + a2 * mu + y1;
+
+			max_error = MAX(max_error, MAX(ABS(dst[i].l - expected.l), ABS(dst[i].r - expected.r)));
+			offset += increment;
+		}
+	}
+
+	OS::get_singleton()->print("\tmax error %g\n", max_error);
+
+	return max_error < 1e-5;
+}
+
+bool test_filter() {
+
+	OS::get_singleton()->print("\n\nTest 3: filter against the scalar filter processors\n");
+
+	Ref<AudioEffectLowPassFilter> lowpass = memnew(AudioEffectLowPassFilter);
+	lowpass->set_cutoff(1200);
+	lowpass->set_resonance(0.7);
+	lowpass->set_db(AudioEffectFilter::FILTER_24DB);
+
+	AudioFilterSW reference;
+	reference.set_mode(AudioFilterSW::LOWPASS);
+	reference.set_cutoff(lowpass->get_cutoff());
+	reference.set_resonance(lowpass->get_resonance());
+	reference.set_gain(lowpass->get_gain());
+	reference.set_stages(4);
+	reference.set_sampling_rate(AudioServer::get_singleton()->get_mix_rate());
+
+	AudioFilterSW::Processor stages[2][4];
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 4; j++) {
+			stages[i][j].set_filter(&reference);
+			stages[i][j].update_coeffs();
+		}
+	}
+
+	Ref<AudioEffectInstance> instance = lowpass->instance();
+
+	AudioFrame src[BUFFER_FRAMES];
+	AudioFrame dst[BUFFER_FRAMES];
+	float max_error = 0;
+
+	for (int b = 0; b < 4; b++) {
+
+		fill_signal(src, b * BUFFER_FRAMES, BUFFER_FRAMES);
+		instance->process(src, dst, BUFFER_FRAMES);
+
+		for (int i = 0; i < BUFFER_FRAMES; i++) {
+
+			AudioFrame expected = src[i];
+			for (int j = 0; j < 4; j++) {
+				stages[0][j].process_one(expected.l);
+				stages[1][j].process_one(expected.r);
+			}
+
+			max_error = MAX(max_error, MAX(ABS(dst[i].l - expected.l), ABS(dst[i].r - expected.r)));
+		}
+	}
+
+	OS::get_singleton()->print("\tmax error %g\n", max_error);
+
+	return max_error < 1e-5;
+}
+
+// Plain freeverb, one comb and one allpass after the other, as Reverb did before running them in vectors.
+class ReverbReference {
+
+	struct Delay {
+		Vector<float> buffer;
+		int pos;
+	};
+
+	Delay combs[8];
+	Delay allpasses[4];
+	float damp_h[8];
+	Vector<float> echo;
+	int echo_pos;
+	float feedback;
+	float damp;
+
+public:
+	float wet;
+
+	float process(float p_src, int p_predelay_frames, float p_predelay_feedback) {
+
+		int read_pos = echo_pos - p_predelay_frames;
+		if (read_pos < 0)
+			read_pos += echo.size();
+		float in = echo[read_pos] * p_predelay_feedback + p_src;
+		echo.write[echo_pos] = in;
+		echo_pos = (echo_pos + 1) % echo.size();
+
+		float out = 0;
+		for (int i = 0; i < 8; i++) {
+
+			Delay &c = combs[i];
+			float v = c.buffer[c.pos] * feedback;
+			v = v * (1.0 - damp) + damp_h[i] * damp;
+			damp_h[i] = v;
+			c.buffer.write[c.pos] = in + v;
+			c.pos = (c.pos + 1) % c.buffer.size();
+			out += v;
+		}
+
+		for (int i = 0; i < 4; i++) {
+
+			Delay &a = allpasses[i];
+			float aux = a.buffer[a.pos];
+			a.buffer.write[a.pos] = 0.7f * aux + out;
+			out = aux - 0.7f * a.buffer[a.pos];
+			a.pos = (a.pos + 1) % a.buffer.size();
+		}
+
+		return out * wet * 0.6f + p_src;
+	}
+
+	ReverbReference(float p_mix_rate, float p_spread_base, float p_room_size, float p_damp) {
+
+		static const float comb_tunings[8] = { 0.025306122448979593f, 0.026938775510204082f, 0.028956916099773241f, 0.03074829931972789f, 0.032244897959183672f, 0.03380952380952381f, 0.035306122448979592f, 0.036666666666666667f };
+		static const float allpass_tunings[4] = { 0.0051020408163265302f, 0.007732426303854875f, 0.01f, 0.012607709750566893f };
+
+		int spread = lrint(p_spread_base * p_mix_rate);
+		for (int i = 0; i < 8; i++) {
+			combs[i].buffer.resize(lrint(comb_tunings[i] * p_mix_rate) + spread);
+			combs[i].pos = 0;
+			damp_h[i] = 0;
+			for (int j = 0; j < combs[i].buffer.size(); j++) {
+				combs[i].buffer.write[j] = 0;
+			}
+		}
+		for (int i = 0; i < 4; i++) {
+			allpasses[i].buffer.resize(lrint(allpass_tunings[i] * p_mix_rate) + spread);
+			allpasses[i].pos = 0;
+			for (int j = 0; j < allpasses[i].buffer.size(); j++) {
+				allpasses[i].buffer.write[j] = 0;
+			}
+		}
+
+		echo.resize((int)(0.5 * p_mix_rate + 1.0));
+		for (int i = 0; i < echo.size(); i++) {
+			echo.write[i] = 0;
+		}
+		echo_pos = 0;
+
+		feedback = CLAMP(0.7f + p_room_size * 0.28f, 0.7f, 0.98f);
+		float auxdmp = p_damp / 2.0 + 0.5;
+		auxdmp *= auxdmp;
+		damp = expf(-2.0 * Math_PI * auxdmp * 10000 / p_mix_rate);
+		wet = 0;
+	}
+};
+
+bool test_reverb() {
+
+	OS::get_singleton()->print("\n\nTest 4: reverb against a scalar freeverb\n");
+
+	const float mix_rate = 44100;
+	const float spread_base = 0.000521;
+
+	Reverb reverb;
+	reverb.set_mix_rate(mix_rate);
+	reverb.set_extra_spread_base(spread_base);
+	reverb.set_room_size(0.8);
+	reverb.set_damp(0.5);
+	reverb.set_wet(0.5);
+
+	ReverbReference reference(mix_rate, spread_base, 0.8, 0.5);
+	reference.wet = 0.5;
+	int predelay_frames = lrint(0.150 * mix_rate); // default predelay, 150 msec
+
+	float src[BUFFER_FRAMES];
+	float dst[BUFFER_FRAMES];
+	float max_error = 0;
+
+	for (int b = 0; b < 16; b++) {
+
+		// odd sizes, so the allpass delays wrap at every possible offset
+		int frames = BUFFER_FRAMES - (b % 4);
+		for (int i = 0; i < frames; i++) {
+			src[i] = signal(b * BUFFER_FRAMES + i).l;
+		}
+
+		reverb.process(src, dst, frames);
+
+		for (int i = 0; i < frames; i++) {
+			float expected = reference.process(src[i], predelay_frames, 0.4);
+			max_error = MAX(max_error, ABS(dst[i] - expected));
+		}
+	}
+
+	OS::get_singleton()->print("\tmax error %g\n", max_error);
+
+	return max_error < 1e-4;
+}
+
+bool test_benchmark() {
+
+	OS::get_singleton()->print("\n\nBenchmarking %i buffers of %i frames\n", BENCH_BUFFERS, BUFFER_FRAMES);
+
+	Vector<Ref<AudioEffect> > effects;
+	effects.push_back(memnew(AudioEffectLowPassFilter));
+	effects.push_back(memnew(AudioEffectEQ6));
+	effects.push_back(memnew(AudioEffectEQ10));
+	effects.push_back(memnew(AudioEffectEQ21));
+	effects.push_back(memnew(AudioEffectReverb));
+	effects.push_back(memnew(AudioEffectChorus));
+	effects.push_back(memnew(AudioEffectCompressor));
+	effects.push_back(memnew(AudioEffectLimiter));
+	effects.push_back(memnew(AudioEffectDelay));
+	effects.push_back(memnew(AudioEffectPhaser));
+
+	AudioFrame src[BUFFER_FRAMES];
+	AudioFrame dst[BUFFER_FRAMES];
+	fill_signal(src, 0, BUFFER_FRAMES);
+
+	for (int i = 0; i < effects.size(); i++) {
+
+		Ref<AudioEffect> effect = effects[i];
+		Ref<AudioEffectInstance> instance = effect->instance();
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		for (int j = 0; j < BENCH_BUFFERS; j++) {
+			instance->process(src, dst, BUFFER_FRAMES);
+		}
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+
+		OS::get_singleton()->print("\t%s: %.2f ns/frame\n", String(effect->get_class()).utf8().get_data(), usec * 1000.0 / (BENCH_BUFFERS * BUFFER_FRAMES));
+	}
+
+	Ref<SignalPlayback> playback = memnew(SignalPlayback);
+	playback->start();
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int j = 0; j < BENCH_BUFFERS; j++) {
+		playback->mix(dst, 1.0, BUFFER_FRAMES);
+	}
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	OS::get_singleton()->print("\tAudioStreamPlaybackResampled: %.2f ns/frame\n", usec * 1000.0 / (BENCH_BUFFERS * BUFFER_FRAMES));
+
+	return true;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_eq,
+	test_resampler,
+	test_filter,
+	test_reverb,
+	test_benchmark,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestAudio
@@ -0,0 +1,190 @@
+/*************************************************************************/
+/*  test_canvas_batcher.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_canvas_batcher.h"
+
+#include "core/os/os.h"
+#include "core/rid.h"
+#include "servers/visual/canvas_batcher.h"
+
+namespace TestCanvasBatcher {
+
+typedef RasterizerCanvas::Item::CommandRect CommandRect;
+
+static RID_Owner<RID_Data> texture_owner;
+static RID_Data texture_data[2];
+static RID textures[2];
+
+static CommandRect make_rect(const Rect2 &p_rect, const RID &p_texture, uint8_t p_flags = 0) {
+
+	CommandRect r;
+	r.rect = p_rect;
+	r.texture = p_texture;
+	r.modulate = Color(1, 0.5, 0.25, 1);
+	r.flags = p_flags;
+	return r;
+}
+
+static bool near_equal(const Vector2 &p_a, const Vector2 &p_b) {
+
+	return p_a.distance_to(p_b) < CMP_EPSILON;
+}
+
+bool test_can_batch() {
+
+	CommandRect plain = make_rect(Rect2(0, 0, 8, 8), textures[0]);
+	CommandRect tiled = make_rect(Rect2(0, 0, 8, 8), textures[0], RasterizerCanvas::CANVAS_RECT_TILE);
+	CommandRect normal_mapped = make_rect(Rect2(0, 0, 8, 8), textures[0]);
+	normal_mapped.normal_map = textures[1];
+	RasterizerCanvas::Item::CommandLine line;
+
+	OS::get_singleton()->print("\n\nTesting which commands can be batched\n");
+
+	return CanvasBatcher::can_batch(&plain) && !CanvasBatcher::can_batch(&tiled) && !CanvasBatcher::can_batch(&normal_mapped) && !CanvasBatcher::can_batch(&line);
+}
+
+bool test_merge_by_texture() {
+
+	CanvasBatcher batcher;
+	RID order[6] = { textures[0], textures[0], textures[0], textures[1], textures[0], textures[0] };
+
+	for (int i = 0; i < 6; i++) {
+		CommandRect r = make_rect(Rect2(i * 8, 0, 8, 8), order[i]);
+		batcher.add_rect(&r, Size2(1.0 / 16, 1.0 / 16));
+	}
+
+	OS::get_singleton()->print("\n\nTesting that consecutive rects with the same texture share a batch\n");
+	OS::get_singleton()->print("\tquads %i, batches %i\n", batcher.get_quad_count(), batcher.get_batch_count());
+
+	if (batcher.get_quad_count() != 6 || batcher.get_batch_count() != 3)
+		return false;
+
+	const CanvasBatcher::Batch &b0 = batcher.get_batch(0);
+	const CanvasBatcher::Batch &b1 = batcher.get_batch(1);
+	const CanvasBatcher::Batch &b2 = batcher.get_batch(2);
+
+	return b0.texture == textures[0] && b0.first_quad == 0 && b0.quad_count == 3 &&
+		   b1.texture == textures[1] && b1.first_quad == 3 && b1.quad_count == 1 &&
+		   b2.texture == textures[0] && b2.first_quad == 4 && b2.quad_count == 2;
+}
+
+bool test_region_and_flip() {
+
+	CanvasBatcher batcher;
+	CommandRect r = make_rect(Rect2(10, 20, 30, 40), textures[0], RasterizerCanvas::CANVAS_RECT_REGION | RasterizerCanvas::CANVAS_RECT_FLIP_H);
+	r.source = Rect2(16, 0, 16, 32);
+	batcher.add_rect(&r, Size2(1.0 / 64, 1.0 / 64));
+
+	const CanvasBatcher::Vertex *v = batcher.get_vertices();
+
+	OS::get_singleton()->print("\n\nTesting region and horizontal flip\n");
+	OS::get_singleton()->print("\tfirst vertex %s uv %s\n", String(v[0].position).utf8().get_data(), String(v[0].uv).utf8().get_data());
+
+	// flipping mirrors the positions, uvs keep their order
+	return near_equal(v[0].position, Vector2(40, 20)) && near_equal(v[2].position, Vector2(10, 60)) &&
+		   near_equal(v[0].uv, Vector2(0.25, 0)) && near_equal(v[2].uv, Vector2(0.5, 0.5)) &&
+		   v[3].color == r.modulate;
+}
+
+bool test_negative_size() {
+
+	CanvasBatcher batcher;
+	CommandRect r = make_rect(Rect2(10, 10, -5, -5), RID());
+	batcher.add_rect(&r, Size2());
+
+	const CanvasBatcher::Vertex *v = batcher.get_vertices();
+
+	OS::get_singleton()->print("\n\nTesting untextured rect with negative size\n");
+
+	return near_equal(v[0].position, Vector2(5, 5)) && near_equal(v[2].position, Vector2(10, 10)) && near_equal(v[2].uv, Vector2(1, 1));
+}
+
+bool test_full() {
+
+	CanvasBatcher batcher;
+	CommandRect r = make_rect(Rect2(0, 0, 1, 1), textures[0]);
+
+	for (int i = 0; i < CanvasBatcher::MAX_QUADS; i++) {
+		if (!batcher.add_rect(&r, Size2(1, 1)))
+			return false;
+	}
+
+	OS::get_singleton()->print("\n\nTesting that the batcher refuses rects once full\n");
+
+	return !batcher.add_rect(&r, Size2(1, 1)) && batcher.get_quad_count() == CanvasBatcher::MAX_QUADS && batcher.get_batch_count() == 1;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_can_batch,
+	test_merge_by_texture,
+	test_region_and_flip,
+	test_negative_size,
+	test_full,
+	0
+
+};
+
+MainLoop *test() {
+
+	for (int i = 0; i < 2; i++) {
+		textures[i] = texture_owner.make_rid(&texture_data[i]);
+	}
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	for (int i = 0; i < 2; i++) {
+		texture_owner.free(textures[i]);
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestCanvasBatcher
@@ -0,0 +1,336 @@
+/*************************************************************************/
+/*  test_compression.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_compression.h"
+
+#include "core/io/compression.h"
+#include "core/io/stream_peer_compressed.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+
+namespace TestCompression {
+
+enum {
+	DATA_SIZE = 256 * 1024,
+	SMALL_BUFFER = 1024 // smallest output buffer StreamPeerCompressed accepts
+};
+
+struct ModeInfo {
+	StreamPeerCompressed::CompressionMode mode;
+	const char *name;
+};
+
+static const ModeInfo modes[] = {
+	{ StreamPeerCompressed::COMPRESSION_DEFLATE, "deflate" },
+	{ StreamPeerCompressed::COMPRESSION_GZIP, "gzip" },
+	{ StreamPeerCompressed::COMPRESSION_ZSTD, "zstd" },
+};
+
+static const int mode_count = sizeof(modes) / sizeof(modes[0]);
+
+// Text-like data, so it compresses but not to nothing.
+static Vector<uint8_t> make_text(int p_size) {
+
+	static const char *words[] = { "stream ", "peer ", "compressed ", "chunk ", "buffer ", "godot ", "data ", "\n" };
+	RandomPCG rng(1234);
+
+	Vector<uint8_t> data;
+	data.resize(p_size);
+	for (int i = 0; i < p_size;) {
+		const char *w = words[rng.rand() % 8];
+		for (int j = 0; w[j] && i < p_size; j++) {
+			data.write[i++] = w[j];
+		}
+	}
+	return data;
+}
+
+static Vector<uint8_t> make_noise(int p_size) {
+
+	RandomPCG rng(5678);
+
+	Vector<uint8_t> data;
+	data.resize(p_size);
+	for (int i = 0; i < p_size; i++) {
+		data.write[i] = rng.rand() & 0xFF;
+	}
+	return data;
+}
+
+static bool same(const Vector<uint8_t> &p_a, const Vector<uint8_t> &p_b) {
+
+	return p_a.size() == p_b.size() && memcmp(p_a.ptr(), p_b.ptr(), p_a.size()) == 0;
+}
+
+static void drain(Ref<StreamPeerCompressed> p_peer, Vector<uint8_t> &r_out) {
+
+	uint8_t chunk[333];
+	while (true) {
+		int received = 0;
+		p_peer->get_partial_data(chunk, sizeof(chunk), received);
+		if (received == 0)
+			break;
+		for (int i = 0; i < received; i++) {
+			r_out.push_back(chunk[i]);
+		}
+	}
+}
+
+// Puts the data in small chunks, reading the output as it goes, then finishes the stream.
+static Error run_stream(Ref<StreamPeerCompressed> p_peer, const Vector<uint8_t> &p_data, int p_chunk, Vector<uint8_t> &r_out) {
+
+	int pos = 0;
+	while (pos < p_data.size()) {
+
+		int sent = 0;
+		Error err = p_peer->put_partial_data(p_data.ptr() + pos, MIN(p_chunk, p_data.size() - pos), sent);
+		if (err == ERR_FILE_EOF)
+			break; // decompressed stream ended
+		if (err != OK)
+			return err;
+
+		pos += sent;
+		drain(p_peer, r_out);
+	}
+
+	return OK;
+}
+
+static Error finish_stream(Ref<StreamPeerCompressed> p_peer, Vector<uint8_t> &r_out, int *r_busy_count = NULL) {
+
+	Error err;
+	while ((err = p_peer->finish()) == ERR_BUSY) {
+		if (r_busy_count) {
+			(*r_busy_count)++;
+		}
+		drain(p_peer, r_out);
+	}
+	drain(p_peer, r_out);
+	return err;
+}
+
+static bool check(bool p_ok, const String &p_what) {
+
+	OS::get_singleton()->print("\t%s: %s\n", p_what.utf8().get_data(), p_ok ? "OK" : "FAIL");
+	return p_ok;
+}
+
+bool test_round_trip() {
+
+	OS::get_singleton()->print("\n\nTest 1: round trip in small chunks, checked against Compression::decompress\n");
+
+	Vector<uint8_t> data = make_text(DATA_SIZE);
+	bool ok = true;
+
+	for (int m = 0; m < mode_count; m++) {
+
+		String name = modes[m].name;
+
+		Ref<StreamPeerCompressed> compressor;
+		compressor.instance();
+		compressor->start_compression(modes[m].mode, 4096);
+
+		Vector<uint8_t> compressed;
+		Error err = run_stream(compressor, data, 777, compressed);
+		if (err == OK) {
+			err = finish_stream(compressor, compressed);
+		}
+		ok &= check(err == OK, name + " compress, " + itos(compressed.size()) + " bytes");
+		if (err != OK)
+			continue;
+
+		// The one-shot decoder must read the streamed output.
+		Vector<uint8_t> one_shot;
+		one_shot.resize(data.size());
+		int size = Compression::decompress(one_shot.ptrw(), one_shot.size(), compressed.ptr(), compressed.size(), Compression::Mode(modes[m].mode));
+		ok &= check(size == data.size() && same(one_shot, data), name + " decodes with Compression::decompress");
+
+		Ref<StreamPeerCompressed> decompressor;
+		decompressor.instance();
+		decompressor->start_decompression(modes[m].mode, 4096);
+
+		Vector<uint8_t> decompressed;
+		err = run_stream(decompressor, compressed, 129, decompressed);
+		drain(decompressor, decompressed);
+		ok &= check(err == OK && same(decompressed, data), name + " decompress in chunks");
+
+		// Data past the end of the stream is refused.
+		int sent = 0;
+		uint8_t trailing = 0;
+		ok &= check(decompressor->put_partial_data(&trailing, 1, sent) == ERR_FILE_EOF && sent == 0, name + " refuses data after the end");
+	}
+
+	return ok;
+}
+
+bool test_out_of_memory() {
+
+	OS::get_singleton()->print("\n\nTest 2: put_data() without reading the output\n");
+
+	// Zeros compress to almost nothing, so decompressing them overflows a small output buffer.
+	Vector<uint8_t> zeros;
+	zeros.resize(DATA_SIZE);
+	for (int i = 0; i < zeros.size(); i++) {
+		zeros.write[i] = 0;
+	}
+
+	bool ok = true;
+
+	for (int m = 0; m < mode_count; m++) {
+
+		String name = modes[m].name;
+
+		Vector<uint8_t> compressed;
+		compressed.resize(Compression::get_max_compressed_buffer_size(zeros.size(), Compression::Mode(modes[m].mode)));
+		int size = Compression::compress(compressed.ptrw(), zeros.ptr(), zeros.size(), Compression::Mode(modes[m].mode));
+		compressed.resize(MAX(size, 0));
+
+		Ref<StreamPeerCompressed> decompressor;
+		decompressor.instance();
+		decompressor->start_decompression(modes[m].mode, SMALL_BUFFER);
+
+		int sent = 0;
+		decompressor->put_partial_data(compressed.ptr(), compressed.size(), sent);
+		// the ring buffer keeps one byte free
+		ok &= check(decompressor->get_available_bytes() >= SMALL_BUFFER - 1, name + " output buffer is full");
+
+		// The decoder may have taken all the input already, it must still refuse more.
+		uint8_t extra = 0;
+		bool all_sent = sent == compressed.size();
+		Error err = decompressor->put_data(all_sent ? &extra : compressed.ptr() + sent, all_sent ? 1 : compressed.size() - sent);
+		ok &= check(err == ERR_OUT_OF_MEMORY, name + " put_data fails with ERR_OUT_OF_MEMORY");
+
+		// Reading the output makes room again, and nothing was lost.
+		Vector<uint8_t> rest;
+		for (int i = sent; i < compressed.size(); i++) {
+			rest.push_back(compressed[i]);
+		}
+
+		Vector<uint8_t> decompressed;
+		drain(decompressor, decompressed);
+		err = run_stream(decompressor, rest, 64, decompressed);
+		drain(decompressor, decompressed);
+		ok &= check(err == OK && same(decompressed, zeros), name + " decompresses fully once read");
+	}
+
+	return ok;
+}
+
+bool test_finish() {
+
+	OS::get_singleton()->print("\n\nTest 3: finish() with a full output buffer\n");
+
+	// Noise doesn't compress, so the output can't fit the small buffer.
+	Vector<uint8_t> noise = make_noise(64 * 1024);
+	bool ok = true;
+
+	for (int m = 0; m < mode_count; m++) {
+
+		String name = modes[m].name;
+
+		Ref<StreamPeerCompressed> compressor;
+		compressor.instance();
+		compressor->start_compression(modes[m].mode, SMALL_BUFFER);
+
+		// Put as much as it takes without reading anything.
+		int accepted = 0;
+		while (accepted < noise.size()) {
+			int sent = 0;
+			if (compressor->put_partial_data(noise.ptr() + accepted, noise.size() - accepted, sent) != OK || sent == 0)
+				break;
+			accepted += sent;
+		}
+
+		Vector<uint8_t> compressed;
+		int busy_count = 0;
+		Error err = finish_stream(compressor, compressed, &busy_count);
+		ok &= check(err == OK && busy_count > 0, name + " finish() returned ERR_BUSY " + itos(busy_count) + " times, then OK");
+
+		Vector<uint8_t> expected = noise;
+		expected.resize(accepted);
+
+		Vector<uint8_t> decompressed;
+		decompressed.resize(accepted);
+		int size = Compression::decompress(decompressed.ptrw(), decompressed.size(), compressed.ptr(), compressed.size(), Compression::Mode(modes[m].mode));
+		ok &= check(size == accepted && same(decompressed, expected), name + " output of " + itos(accepted) + " bytes decodes");
+
+		int sent = 0;
+		ok &= check(compressor->put_partial_data(noise.ptr(), 1, sent) == ERR_ALREADY_IN_USE, name + " refuses data after finish()");
+	}
+
+	Ref<StreamPeerCompressed> decompressor;
+	decompressor.instance();
+	decompressor->start_decompression(StreamPeerCompressed::COMPRESSION_ZSTD, SMALL_BUFFER);
+	ok &= check(decompressor->finish() == ERR_UNAVAILABLE, "finish() is refused when decompressing");
+
+	return ok;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_round_trip,
+	test_out_of_memory,
+	test_finish,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	if (passed != count) {
+		OS::get_singleton()->set_exit_code(1);
+	}
+
+	return NULL;
+}
+} // namespace TestCompression
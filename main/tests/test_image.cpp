@@ -0,0 +1,227 @@
+/*************************************************************************/
+/*  test_image.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_image.h"
+
+#include "core/image.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
+
+#include <string.h>
+
+namespace TestImage {
+
+// Texture processing benchmark: each operation runs on a 4K and an 8K image,
+// once on the calling thread only and once split over the worker threads.
+// Both runs must produce the same pixels.
+
+enum Operation {
+	OP_RESIZE_BILINEAR,
+	OP_RESIZE_CUBIC,
+	OP_RESIZE_LANCZOS,
+	OP_GENERATE_MIPMAPS,
+	OP_GENERATE_MIPMAPS_FLOAT,
+	OP_CONVERT,
+	OP_CONVERT_FLOAT,
+	OP_SRGB_TO_LINEAR,
+	OP_PREMULTIPLY_ALPHA,
+	OP_MAX
+};
+
+static const char *op_names[OP_MAX] = {
+	"resize (bilinear)",
+	"resize (cubic)",
+	"resize (lanczos)",
+	"generate_mipmaps (RGBA8)",
+	"generate_mipmaps (RGBAF)",
+	"convert (RGBA8 to RGB8)",
+	"convert (RGBA8 to RGBAF)",
+	"srgb_to_linear",
+	"premultiply_alpha",
+};
+
+static Ref<Image> _make_image(int p_size) {
+
+	PoolVector<uint8_t> data;
+	data.resize(p_size * p_size * 4);
+
+	{
+		PoolVector<uint8_t>::Write w = data.write();
+		uint32_t seed = 12345;
+		for (int i = 0; i < data.size(); i++) {
+			seed = seed * 1103515245 + 12345;
+			w[i] = seed >> 24;
+		}
+	}
+
+	Ref<Image> img;
+	img.instance();
+	img->create(p_size, p_size, false, Image::FORMAT_RGBA8, data);
+	return img;
+}
+
+static void _run(Operation p_op, Ref<Image> p_img) {
+
+	switch (p_op) {
+		case OP_RESIZE_BILINEAR: p_img->resize(p_img->get_width() * 3 / 4, p_img->get_height() * 3 / 4, Image::INTERPOLATE_BILINEAR); break;
+		case OP_RESIZE_CUBIC: p_img->resize(p_img->get_width() * 3 / 4, p_img->get_height() * 3 / 4, Image::INTERPOLATE_CUBIC); break;
+		case OP_RESIZE_LANCZOS: p_img->resize(p_img->get_width() / 2, p_img->get_height() / 2, Image::INTERPOLATE_LANCZOS); break;
+		case OP_GENERATE_MIPMAPS: p_img->generate_mipmaps(); break;
+		case OP_GENERATE_MIPMAPS_FLOAT:
+			p_img->convert(Image::FORMAT_RGBAF);
+			p_img->generate_mipmaps();
+			break;
+		case OP_CONVERT: p_img->convert(Image::FORMAT_RGB8); break;
+		case OP_CONVERT_FLOAT: p_img->convert(Image::FORMAT_RGBAF); break;
+		case OP_SRGB_TO_LINEAR: p_img->srgb_to_linear(); break;
+		case OP_PREMULTIPLY_ALPHA: p_img->premultiply_alpha(); break;
+		default: {
+		}
+	}
+}
+
+static bool _same_data(const Ref<Image> &p_a, const Ref<Image> &p_b) {
+
+	PoolVector<uint8_t> a = p_a->get_data();
+	PoolVector<uint8_t> b = p_b->get_data();
+	if (a.size() != b.size())
+		return false;
+
+	PoolVector<uint8_t>::Read ra = a.read();
+	PoolVector<uint8_t>::Read rb = b.read();
+	return memcmp(ra.ptr(), rb.ptr(), a.size()) == 0;
+}
+
+static bool _test_operation(Operation p_op, const Ref<Image> &p_source) {
+
+	Ref<Image> results[2];
+	uint64_t times[2];
+
+	for (int i = 0; i < 2; i++) {
+
+		ThreadWorkPool::get_singleton()->finish();
+		ThreadWorkPool::get_singleton()->init(i == 0 ? 0 : -1);
+
+		results[i] = p_source->duplicate();
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		_run(p_op, results[i]);
+		times[i] = OS::get_singleton()->get_ticks_usec() - from;
+	}
+
+	bool pass = _same_data(results[0], results[1]);
+
+	OS::get_singleton()->print("\t%s, %ix%i: %i msec serial, %i msec threaded\n", op_names[p_op], p_source->get_width(), p_source->get_height(), int(times[0] / 1000), int(times[1] / 1000));
+
+	return pass;
+}
+
+// Block rows and small mipmaps are compressed as separate tasks, so the threaded
+// output is checked against a serial compression of the same mipmapped image.
+static bool _test_compression(Image::CompressMode p_mode, const Ref<Image> &p_source) {
+
+	Ref<Image> source = p_source->duplicate();
+	source->generate_mipmaps();
+
+	Ref<Image> results[2];
+	uint64_t times[2];
+
+	for (int i = 0; i < 2; i++) {
+
+		ThreadWorkPool::get_singleton()->finish();
+		ThreadWorkPool::get_singleton()->init(i == 0 ? 0 : -1);
+
+		results[i] = source->duplicate();
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		results[i]->compress(p_mode, Image::COMPRESS_SOURCE_GENERIC, 0.7);
+		times[i] = OS::get_singleton()->get_ticks_usec() - from;
+	}
+
+	OS::get_singleton()->print("\tcompress to %s, %ix%i: %i msec serial, %i msec threaded\n", Image::get_format_name(results[1]->get_format()).utf8().get_data(), source->get_width(), source->get_height(), int(times[0] / 1000), int(times[1] / 1000));
+
+	return results[0]->get_format() == results[1]->get_format() && _same_data(results[0], results[1]);
+}
+
+MainLoop *test() {
+
+	int sizes[2] = { 4096, 8192 };
+	int count = 0;
+	int passed = 0;
+
+	for (int i = 0; i < 2; i++) {
+
+		Ref<Image> source = _make_image(sizes[i]);
+
+		for (int j = 0; j < OP_MAX; j++) {
+
+			bool pass = _test_operation(Operation(j), source);
+			if (pass)
+				passed++;
+			OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+			count++;
+		}
+	}
+
+	struct Mode {
+		Image::CompressMode mode;
+		bool available;
+	};
+
+	Mode modes[3] = {
+		{ Image::COMPRESS_S3TC, Image::_image_compress_bc_func != NULL },
+		{ Image::COMPRESS_ETC2, Image::_image_compress_etc2_func != NULL },
+		{ Image::COMPRESS_BPTC, Image::_image_compress_bptc_func != NULL },
+	};
+
+	Ref<Image> source = _make_image(sizes[0]);
+	for (int i = 0; i < 3; i++) {
+
+		if (!modes[i].available)
+			continue;
+
+		bool pass = _test_compression(modes[i].mode, source);
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	ThreadWorkPool::get_singleton()->finish();
+
+	OS::get_singleton()->print("\n");
+	Image::print_compress_stats();
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	return NULL;
+}
+
+} // namespace TestImage
@@ -33,16 +33,27 @@
 
 #ifdef DEBUG_ENABLED
 
+#include "test_animation.h"
 #include "test_astar.h"
+#include "test_audio.h"
+#include "test_canvas_batcher.h"
+#include "test_compression.h"
 #include "test_gdscript.h"
 #include "test_gui.h"
+#include "test_image.h"
 #include "test_math.h"
+#include "test_multiplayer.h"
+#ifndef _3D_DISABLED
+#include "test_navigation.h"
+#endif
 #include "test_oa_hash_map.h"
 #include "test_ordered_hash_map.h"
+#include "test_particles.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
 #include "test_render.h"
 #include "test_shader_lang.h"
+#include "test_skeleton.h"
 #include "test_string.h"
 
 const char **tests_get_names() {
@@ -53,6 +64,7 @@ const char **tests_get_names() {
 		"physics",
 		"physics_2d",
 		"render",
+		"render_lod",
 		"oa_hash_map",
 		"gui",
 		"shaderlang",
@@ -62,6 +74,17 @@ const char **tests_get_names() {
 		"gd_bytecode",
 		"ordered_hash_map",
 		"astar",
+		"skeleton",
+		"particles",
+		"canvas_batcher",
+		"animation",
+		"audio",
+		"image",
+		"multiplayer",
+#ifndef _3D_DISABLED
+		"navigation",
+#endif
+		"compression",
 		NULL
 	};
 
@@ -95,6 +118,11 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestRender::test();
 	}
 
+	if (p_test == "render_lod") {
+
+		return TestRender::test_lod();
+	}
+
 	if (p_test == "oa_hash_map") {
 
 		return TestOAHashMap::test();
@@ -142,6 +170,55 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestAStar::test();
 	}
 
+#ifndef _3D_DISABLED
+	if (p_test == "skeleton") {
+
+		return TestSkeleton::test();
+	}
+#endif
+
+	if (p_test == "particles") {
+
+		return TestParticles::test();
+	}
+
+	if (p_test == "canvas_batcher") {
+
+		return TestCanvasBatcher::test();
+	}
+
+	if (p_test == "animation") {
+
+		return TestAnimation::test();
+	}
+
+	if (p_test == "audio") {
+
+		return TestAudio::test();
+	}
+
+	if (p_test == "image") {
+
+		return TestImage::test();
+	}
+
+	if (p_test == "multiplayer") {
+
+		return TestMultiplayer::test();
+	}
+
+#ifndef _3D_DISABLED
+	if (p_test == "navigation") {
+
+		return TestNavigation::test();
+	}
+#endif
+
+	if (p_test == "compression") {
+
+		return TestCompression::test();
+	}
+
 	print_line("Unknown test: " + p_test);
 	return NULL;
 }
@@ -0,0 +1,349 @@
+/*************************************************************************/
+/*  test_multiplayer.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_multiplayer.h"
+
+#include "core/io/marshalls.h"
+#include "core/io/multiplayer_api.h"
+#include "core/os/os.h"
+#include "scene/2d/node_2d.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+
+namespace TestMultiplayer {
+
+// Server and client in the same tree, connected over ENet on the loopback, each
+// with its own MultiplayerAPI. The server moves some players every tick and the
+// client must end up with the same (quantized) state, first on a lossless link,
+// then after a period where acknowledgements and replication packets are dropped.
+
+// Forwards to an ENet peer, optionally dropping replication traffic.
+class LossyPeer : public NetworkedMultiplayerPeer {
+
+public:
+	Ref<NetworkedMultiplayerPeer> peer;
+	bool drop_acks;
+	int drop_every; // Drop one of this many replication packets, 0 to keep them all.
+	int sent;
+
+	virtual void set_transfer_mode(TransferMode p_mode) { peer->set_transfer_mode(p_mode); }
+	virtual TransferMode get_transfer_mode() const { return peer->get_transfer_mode(); }
+	virtual void set_target_peer(int p_peer_id) { peer->set_target_peer(p_peer_id); }
+	virtual int get_packet_peer() const { return peer->get_packet_peer(); }
+	virtual bool is_server() const { return peer->is_server(); }
+	virtual void poll() { peer->poll(); }
+	virtual int get_unique_id() const { return peer->get_unique_id(); }
+	virtual void set_refuse_new_connections(bool p_enable) { peer->set_refuse_new_connections(p_enable); }
+	virtual bool is_refusing_new_connections() const { return peer->is_refusing_new_connections(); }
+	virtual ConnectionStatus get_connection_status() const { return peer->get_connection_status(); }
+	virtual int get_available_packet_count() const { return peer->get_available_packet_count(); }
+	virtual Error get_packet(const uint8_t **r_buffer, int &r_buffer_size) { return peer->get_packet(r_buffer, r_buffer_size); }
+	virtual int get_max_packet_size() const { return peer->get_max_packet_size(); }
+
+	virtual Error put_packet(const uint8_t *p_buffer, int p_buffer_size) {
+
+		if (p_buffer[0] == MultiplayerAPI::NETWORK_COMMAND_REPLICATE_ACK && drop_acks)
+			return OK;
+		if (p_buffer[0] == MultiplayerAPI::NETWORK_COMMAND_REPLICATE && drop_every && (sent++ % drop_every) == 0)
+			return OK;
+		return peer->put_packet(p_buffer, p_buffer_size);
+	}
+
+	LossyPeer() {
+		drop_acks = false;
+		drop_every = 0;
+		sent = 0;
+	}
+};
+
+class TestMainLoop : public SceneTree {
+
+	enum {
+		PORT = 27960,
+		PLAYER_COUNT = 64,
+		TICKS = 120,
+		LOSSY_TICKS = 200, // Longer than the replication history.
+		TIMEOUT_MSEC = 10000
+	};
+
+	enum Phase {
+		PHASE_LOSSLESS,
+		PHASE_LOSSY,
+		PHASE_DONE
+	};
+
+	Ref<MultiplayerAPI> server;
+	Ref<MultiplayerAPI> client;
+	Ref<LossyPeer> server_peer;
+	Ref<LossyPeer> client_peer;
+	Vector<Node2D *> server_players;
+	Vector<Node2D *> client_players;
+
+	Phase phase;
+	int ticks;
+	int settle_ticks;
+	uint64_t phase_msec;
+	uint64_t rset_bytes;
+	bool failed;
+
+	Node *_make_side(const String &p_name, Ref<MultiplayerAPI> p_api, Vector<Node2D *> &r_players) {
+
+		Node *side = memnew(Node);
+		side->set_name(p_name);
+		get_root()->add_child(side);
+
+		for (int i = 0; i < PLAYER_COUNT; i++) {
+			Node2D *player = memnew(Node2D);
+			player->set_name("Player" + itos(i));
+			side->add_child(player);
+			p_api->replication_track(player, "position", 0.01);
+			p_api->replication_track(player, "rotation", 0.001);
+			p_api->replication_track(player, "z_index");
+			r_players.push_back(player);
+		}
+
+		p_api->set_root_node(side);
+		return side;
+	}
+
+	Ref<LossyPeer> _make_peer(Ref<MultiplayerAPI> p_api) {
+
+		Object *obj = ClassDB::instance("NetworkedMultiplayerENet");
+		NetworkedMultiplayerPeer *peer = Object::cast_to<NetworkedMultiplayerPeer>(obj);
+		if (!peer) {
+			if (obj) {
+				memdelete(obj);
+			}
+			return Ref<LossyPeer>();
+		}
+
+		Ref<LossyPeer> lossy;
+		lossy.instance();
+		lossy->peer = Ref<NetworkedMultiplayerPeer>(peer);
+
+		// The API listens to the wrapper, which doesn't emit, so route the ENet signals to it.
+		peer->connect("peer_connected", p_api.ptr(), "_add_peer");
+		peer->connect("peer_disconnected", p_api.ptr(), "_del_peer");
+		peer->connect("connection_succeeded", p_api.ptr(), "_connected_to_server");
+		peer->connect("connection_failed", p_api.ptr(), "_connection_failed");
+		peer->connect("server_disconnected", p_api.ptr(), "_server_disconnected");
+		return lossy;
+	}
+
+	// Size the same changes would take as one rset per property.
+	int _rset_size(const StringName &p_property, const Variant &p_value) {
+
+		int len;
+		encode_variant(p_value, NULL, len);
+		return 1 + 4 + String(p_property).utf8().length() + 1 + len;
+	}
+
+	void _move_players(int p_tick) {
+
+		// A quarter of the players move each tick.
+		for (int i = p_tick % 4; i < PLAYER_COUNT; i += 4) {
+
+			Node2D *player = server_players[i];
+			player->set_position(player->get_position() + Vector2(Math::cos(p_tick * 0.1 + i), Math::sin(p_tick * 0.1 + i)) * 3.0);
+			player->set_rotation(Math::sin(p_tick * 0.05 + i));
+			if (p_tick % 50 == 0) {
+				player->set_z_index(p_tick % 8);
+			}
+			rset_bytes += _rset_size("position", player->get_position());
+			rset_bytes += _rset_size("rotation", player->get_rotation());
+		}
+	}
+
+	bool _check_state() {
+
+		for (int i = 0; i < PLAYER_COUNT; i++) {
+
+			Vector2 ds = server_players[i]->get_position() - client_players[i]->get_position();
+			real_t dr = server_players[i]->get_rotation() - client_players[i]->get_rotation();
+			if (ABS(ds.x) > 0.01 || ABS(ds.y) > 0.01 || ABS(dr) > 0.001 || server_players[i]->get_z_index() != client_players[i]->get_z_index())
+				return false;
+		}
+		return true;
+	}
+
+	void _fail(const String &p_message) {
+
+		OS::get_singleton()->print("ERROR: %s\n", p_message.utf8().get_data());
+		OS::get_singleton()->set_exit_code(1);
+		failed = true;
+	}
+
+	void _next_phase() {
+
+		ticks = 0;
+		settle_ticks = 0;
+		phase_msec = OS::get_singleton()->get_ticks_msec();
+		phase = Phase(phase + 1);
+	}
+
+	// Moves players for p_ticks ticks, then replicates until the client is up to date.
+	// Returns true once the phase is over.
+	bool _run_phase(int p_ticks, const char *p_name) {
+
+		if (OS::get_singleton()->get_ticks_msec() - phase_msec > TIMEOUT_MSEC) {
+			_fail(String(p_name) + ": timed out after " + itos(ticks) + " ticks, client state does not match server.");
+			return true;
+		}
+
+		if (ticks < p_ticks) {
+			_move_players(ticks);
+			server->replication_tick();
+			ticks++;
+			return false;
+		}
+
+		if (phase == PHASE_LOSSY && ticks == p_ticks) {
+			// Link is back, the rest must recover on its own.
+			server_peer->drop_every = 0;
+			client_peer->drop_acks = false;
+		}
+
+		// Let the last changes arrive, replicating again until the client is up to date.
+		if (!_check_state()) {
+			server->replication_tick();
+			settle_ticks++;
+			return false;
+		}
+
+		OS::get_singleton()->print("%s: client state matches server after %i extra ticks: PASS\n", p_name, settle_ticks);
+		return true;
+	}
+
+public:
+	virtual void init() {
+
+		SceneTree::init();
+
+		failed = false;
+		rset_bytes = 0;
+		phase = PHASE_LOSSLESS;
+		ticks = 0;
+		settle_ticks = 0;
+		phase_msec = OS::get_singleton()->get_ticks_msec();
+
+		server.instance();
+		client.instance();
+		_make_side("Server", server, server_players);
+		_make_side("Client", client, client_players);
+
+		// Ticks are driven by the test.
+		server->set_replication_interval(1000000);
+		client->set_replication_interval(1000000);
+
+		for (int i = 0; i < PLAYER_COUNT; i++) {
+			server_players[i]->set_z_index(i % 8);
+		}
+
+		server_peer = _make_peer(server);
+		client_peer = _make_peer(client);
+		if (server_peer.is_null() || client_peer.is_null()) {
+			OS::get_singleton()->print("ENet is not available, skipping.\n");
+			quit();
+			return;
+		}
+
+		if ((int)server_peer->peer->call("create_server", PORT) != OK || (int)client_peer->peer->call("create_client", "127.0.0.1", PORT) != OK) {
+			_fail("Unable to create ENet peers on port " + itos(PORT) + ".");
+			quit();
+			return;
+		}
+
+		server->set_network_peer(server_peer);
+		client->set_network_peer(client_peer);
+	}
+
+	virtual bool idle(float p_time) {
+
+		bool quit = SceneTree::idle(p_time);
+
+		if (failed || server.is_null() || !server->has_network_peer())
+			return true;
+
+		server->poll();
+		client->poll();
+
+		if (server->get_network_connected_peers().empty() || client_peer->get_connection_status() != NetworkedMultiplayerPeer::CONNECTION_CONNECTED) {
+			if (OS::get_singleton()->get_ticks_msec() - phase_msec > TIMEOUT_MSEC) {
+				_fail("Timed out connecting over the loopback.");
+				return true;
+			}
+			return quit;
+		}
+
+		switch (phase) {
+			case PHASE_LOSSLESS: {
+
+				if (!_run_phase(TICKS, "Lossless"))
+					return quit;
+				if (failed)
+					break;
+
+				Dictionary stats = server->get_replication_stats();
+				uint64_t sent = 0;
+				for (int i = 0; i < PLAYER_COUNT; i++) {
+					Dictionary d = stats[server_players[i]->get_path()];
+					sent += (uint64_t)d["bytes_sent"];
+				}
+				OS::get_singleton()->print("Replicated %i players over %i ticks: %i bytes, same changes as rset: %i bytes\n", PLAYER_COUNT, ticks, (int)sent, (int)rset_bytes);
+
+				// Drop all acknowledgements, and a third of the state, for longer than the history kept.
+				server_peer->drop_every = 3;
+				client_peer->drop_acks = true;
+				_next_phase();
+			} break;
+			case PHASE_LOSSY: {
+
+				if (!_run_phase(LOSSY_TICKS, "Loss recovery"))
+					return quit;
+				_next_phase();
+			} break;
+			case PHASE_DONE: {
+			} break;
+		}
+
+		if (failed || phase == PHASE_DONE) {
+			server->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+			client->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+			return true;
+		}
+		return quit;
+	}
+};
+
+MainLoop *test() {
+
+	return memnew(TestMainLoop);
+}
+} // namespace TestMultiplayer
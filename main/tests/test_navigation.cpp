@@ -0,0 +1,185 @@
+/*************************************************************************/
+/*  test_navigation.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef _3D_DISABLED
+
+#include "test_navigation.h"
+
+#include "core/os/os.h"
+#include "scene/3d/mesh_instance.h"
+#include "scene/3d/navigation.h"
+#include "scene/3d/navigation_mesh.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+#include "scene/resources/primitive_meshes.h"
+
+namespace TestNavigation {
+
+// Bakes a floor with a few walls as small tiles, then asks for paths that have to
+// cross many tile borders. Tiles are baked separately, so this only works if the
+// borders of neighbouring tiles are joined.
+
+class TestMainLoop : public SceneTree {
+
+	enum {
+		TIMEOUT_MSEC = 60000
+	};
+
+	Navigation *navigation;
+	Node *tiled;
+	uint64_t start_msec;
+	bool failed;
+	bool done;
+
+	void _add_box(Node *p_parent, const Vector3 &p_pos, const Vector3 &p_size) {
+
+		Ref<CubeMesh> cube;
+		cube.instance();
+		cube->set_size(p_size);
+
+		MeshInstance *mi = memnew(MeshInstance);
+		mi->set_mesh(cube);
+		mi->set_translation(p_pos);
+		p_parent->add_child(mi);
+	}
+
+	void _check_path(const Vector3 &p_from, const Vector3 &p_to) {
+
+		Vector<Vector3> path = navigation->get_simple_path(p_from, p_to);
+		String name = String(p_from) + " -> " + String(p_to);
+
+		if (path.empty()) {
+			OS::get_singleton()->print("Path %s: no path found: FAILED\n", name.utf8().get_data());
+			failed = true;
+			return;
+		}
+
+		Vector3 end = path[path.size() - 1];
+		Vector2 miss = Vector2(end.x - p_to.x, end.z - p_to.z);
+		if (miss.length() > 0.5) {
+			OS::get_singleton()->print("Path %s: ends at %s: FAILED\n", name.utf8().get_data(), String(end).utf8().get_data());
+			failed = true;
+			return;
+		}
+
+		OS::get_singleton()->print("Path %s: %i points: PASS\n", name.utf8().get_data(), path.size());
+	}
+
+public:
+	virtual void init() {
+
+		SceneTree::init();
+
+		failed = false;
+		done = false;
+		start_msec = OS::get_singleton()->get_ticks_msec();
+
+		navigation = memnew(Navigation);
+		get_root()->add_child(navigation);
+
+		Object *obj = ClassDB::instance("TiledNavigationMeshInstance");
+		tiled = Object::cast_to<Node>(obj);
+		if (!tiled) {
+			if (obj) {
+				memdelete(obj);
+			}
+			OS::get_singleton()->print("TiledNavigationMeshInstance is not available, skipping.\n");
+			done = true;
+			return;
+		}
+		navigation->add_child(tiled);
+
+		Ref<NavigationMesh> navmesh;
+		navmesh.instance();
+		navmesh->set_cell_size(0.25);
+		navmesh->set_cell_height(0.2);
+		tiled->set("navmesh", navmesh);
+		tiled->set("tile_size", 4.0);
+
+		Ref<PlaneMesh> plane;
+		plane.instance();
+		plane->set_size(Size2(40, 40));
+		MeshInstance *floor = memnew(MeshInstance);
+		floor->set_mesh(plane);
+		tiled->add_child(floor);
+
+		// Walls with gaps, so paths wind through tiles instead of going straight.
+		_add_box(tiled, Vector3(-4, 1, -6), Vector3(28, 2, 1));
+		_add_box(tiled, Vector3(4, 1, 6), Vector3(28, 2, 1));
+		_add_box(tiled, Vector3(0.3, 1, 13), Vector3(1, 2, 6));
+
+		tiled->call("bake");
+	}
+
+	virtual bool idle(float p_time) {
+
+		bool quit = SceneTree::idle(p_time);
+
+		if (done)
+			return true;
+
+		if ((bool)tiled->call("is_baking")) {
+			if (OS::get_singleton()->get_ticks_msec() - start_msec > TIMEOUT_MSEC) {
+				OS::get_singleton()->print("Bake timed out: FAILED\n");
+				OS::get_singleton()->set_exit_code(1);
+				return true;
+			}
+			return quit;
+		}
+
+		int tile_count = tiled->call("get_tile_count");
+		OS::get_singleton()->print("Baked %i tiles in %i msec\n", tile_count, (int)(OS::get_singleton()->get_ticks_msec() - start_msec));
+		if (tile_count < 16) {
+			OS::get_singleton()->print("Expected at least 16 tiles: FAILED\n");
+			failed = true;
+		}
+
+		_check_path(Vector3(-18, 0, -18), Vector3(18, 0, 18));
+		_check_path(Vector3(18, 0, -18), Vector3(-18, 0, 18));
+		_check_path(Vector3(-18, 0, 0), Vector3(18, 0, 0));
+		_check_path(Vector3(-1.5, 0, 18), Vector3(2.1, 0, 18));
+
+		OS::get_singleton()->print(failed ? "Navigation test: FAILED\n" : "Navigation test: OK\n");
+		if (failed) {
+			OS::get_singleton()->set_exit_code(1);
+		}
+
+		done = true;
+		return true;
+	}
+};
+
+MainLoop *test() {
+
+	return memnew(TestMainLoop);
+}
+} // namespace TestNavigation
+
+#endif
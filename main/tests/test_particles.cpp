@@ -0,0 +1,145 @@
+/*************************************************************************/
+/*  test_particles.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_particles.h"
+
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
+#include "scene/2d/cpu_particles_2d.h"
+#ifndef _3D_DISABLED
+#include "scene/3d/cpu_particles.h"
+#endif
+
+namespace TestParticles {
+
+// CPU particles are stepped in chunks on the work pool, each chunk with its own random
+// stream. For a fixed seed, the result must not depend on how chunks reach the threads.
+
+class TestMainLoop : public MainLoop {
+
+	enum {
+		AMOUNT = 1000, // several chunks
+		STEPS = 60
+	};
+
+	template <class T>
+	void _setup(T *p_particles) {
+
+		p_particles->set_amount(AMOUNT);
+		p_particles->set_lifetime(0.5);
+		p_particles->set_lifetime_randomness(0.5);
+		p_particles->set_randomness_ratio(1.0);
+		p_particles->set_use_local_coordinates(true);
+		p_particles->set_spread(180);
+		p_particles->set_param(T::PARAM_INITIAL_LINEAR_VELOCITY, 10);
+		p_particles->set_param_randomness(T::PARAM_INITIAL_LINEAR_VELOCITY, 1.0);
+		p_particles->set_param(T::PARAM_ANGULAR_VELOCITY, 90);
+		p_particles->set_param_randomness(T::PARAM_ANGULAR_VELOCITY, 1.0);
+		p_particles->set_param(T::PARAM_DAMPING, 2);
+		p_particles->set_emitting(true);
+	}
+
+	template <class T>
+	void _run(T *p_particles, bool p_threaded) {
+
+		ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+		pool->finish();
+		pool->init(p_threaded ? -1 : 0); // a pool without workers runs every chunk on the caller
+
+		Math::seed(1234);
+		for (int i = 0; i < STEPS; i++) {
+			p_particles->_particles_process(1.0 / 30.0);
+		}
+	}
+
+	template <class T>
+	bool _check(const char *p_name) {
+
+		T *serial = memnew(T);
+		T *threaded = memnew(T);
+		_setup(serial);
+		_setup(threaded);
+		_run(serial, false);
+		_run(threaded, true);
+
+		bool ok = true;
+		{
+			typename PoolVector<typename T::Particle>::Read s = serial->particles.read();
+			typename PoolVector<typename T::Particle>::Read t = threaded->particles.read();
+			for (int i = 0; i < AMOUNT; i++) {
+				if (s[i].active != t[i].active || !(s[i].transform == t[i].transform)) {
+					OS::get_singleton()->print("%s: particle %i differs\n", p_name, i);
+					ok = false;
+					break;
+				}
+			}
+		}
+
+		memdelete(serial);
+		memdelete(threaded);
+
+		OS::get_singleton()->print("%s, threaded and serial steps match: %s\n", p_name, ok ? "OK" : "FAIL");
+		return ok;
+	}
+
+public:
+	virtual void init() {
+
+		OS::get_singleton()->print("Particles: %i, steps: %i\n", AMOUNT, STEPS);
+
+		bool ok = _check<CPUParticles2D>("CPUParticles2D");
+#ifndef _3D_DISABLED
+		ok = _check<CPUParticles>("CPUParticles") && ok;
+#endif
+
+		// the threaded run left the pool with its default workers
+		OS::get_singleton()->print("Worker threads: %i\n", ThreadWorkPool::get_singleton()->get_thread_count());
+
+		if (!ok)
+			OS::get_singleton()->set_exit_code(1);
+	}
+
+	virtual bool iteration(float p_time) {
+
+		return true;
+	}
+
+	virtual bool idle(float p_time) {
+
+		return true;
+	}
+};
+
+MainLoop *test() {
+
+	return memnew(TestMainLoop);
+}
+} // namespace TestParticles
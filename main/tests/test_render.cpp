@@ -238,8 +238,135 @@ public:
 	}
 };
 
+// Checks that draw ranges pick the expected LOD, through the objects and vertices
+// drawn per frame. Runs headless with the dummy rasterizer.
+
+class TestLODMainLoop : public MainLoop {
+
+	enum {
+		LOD0_TRIANGLES = 12,
+		LOD1_TRIANGLES = 1,
+		LOD_SWITCH_DISTANCE = 20,
+		FRAMES_PER_STEP = 4 // render info lags the frame it describes
+	};
+
+	RID scenario;
+	RID camera;
+	RID viewport;
+	RID meshes[2];
+	RID instances[2];
+
+	int frame;
+	int objects[2];
+	int vertices[2];
+
+	RID _make_mesh(int p_triangles) {
+
+		PoolVector<Vector3> points;
+		for (int i = 0; i < p_triangles; i++) {
+			float angle = i * Math_PI * 2 / p_triangles;
+			points.push_back(Vector3());
+			points.push_back(Vector3(Math::cos(angle), Math::sin(angle), 0));
+			points.push_back(Vector3(Math::cos(angle + 0.5), Math::sin(angle + 0.5), 0));
+		}
+
+		Array arrays;
+		arrays.resize(VS::ARRAY_MAX);
+		arrays[VS::ARRAY_VERTEX] = points;
+
+		RID mesh = VS::get_singleton()->mesh_create();
+		VS::get_singleton()->mesh_add_surface_from_arrays(mesh, VS::PRIMITIVE_TRIANGLES, arrays);
+		return mesh;
+	}
+
+	void _set_camera_distance(float p_distance) {
+
+		VS::get_singleton()->camera_set_transform(camera, Transform(Basis(), Vector3(0, 0, p_distance)));
+	}
+
+public:
+	virtual void init() {
+
+		VisualServer *vs = VisualServer::get_singleton();
+		scenario = vs->scenario_create();
+
+		for (int i = 0; i < 2; i++) {
+			meshes[i] = _make_mesh(i == 0 ? LOD0_TRIANGLES : LOD1_TRIANGLES);
+			instances[i] = vs->instance_create2(meshes[i], scenario);
+		}
+		vs->instance_geometry_set_draw_range(instances[0], 0, LOD_SWITCH_DISTANCE, 0, 1);
+		vs->instance_geometry_set_draw_range(instances[1], LOD_SWITCH_DISTANCE, 0, 1, 0);
+
+		camera = vs->camera_create();
+		vs->camera_set_perspective(camera, 60, 0.1, 1000);
+
+		viewport = vs->viewport_create();
+		Size2i screen_size = OS::get_singleton()->get_window_size();
+		vs->viewport_set_size(viewport, screen_size.x, screen_size.y);
+		vs->viewport_attach_to_screen(viewport, Rect2(Vector2(), screen_size));
+		vs->viewport_set_active(viewport, true);
+		vs->viewport_attach_camera(viewport, camera);
+		vs->viewport_set_scenario(viewport, scenario);
+
+		_set_camera_distance(LOD_SWITCH_DISTANCE / 2);
+		frame = 0;
+	}
+
+	virtual bool iteration(float p_time) {
+
+		return false;
+	}
+
+	virtual bool idle(float p_time) {
+
+		VisualServer *vs = VisualServer::get_singleton();
+
+		frame++;
+		if (frame % FRAMES_PER_STEP != 0)
+			return false;
+
+		int step = frame / FRAMES_PER_STEP - 1;
+		objects[step] = vs->get_render_info(VS::INFO_OBJECTS_IN_FRAME);
+		vertices[step] = vs->get_render_info(VS::INFO_VERTICES_IN_FRAME);
+
+		if (step == 0) {
+			_set_camera_distance(LOD_SWITCH_DISTANCE * 2);
+			return false;
+		}
+
+		OS::get_singleton()->print("Near: %i objects, %i vertices. Far: %i objects, %i vertices\n", objects[0], vertices[0], objects[1], vertices[1]);
+
+		bool near_ok = objects[0] == 1 && vertices[0] == LOD0_TRIANGLES * 3;
+		bool far_ok = objects[1] == 1 && vertices[1] == LOD1_TRIANGLES * 3;
+		OS::get_singleton()->print("LOD 0 drawn when near: %s\n", near_ok ? "OK" : "FAIL");
+		OS::get_singleton()->print("LOD 1 drawn when far: %s\n", far_ok ? "OK" : "FAIL");
+		if (!near_ok || !far_ok) {
+			OS::get_singleton()->set_exit_code(1);
+		}
+
+		return true;
+	}
+
+	virtual void finish() {
+
+		VisualServer *vs = VisualServer::get_singleton();
+		for (int i = 0; i < 2; i++) {
+			vs->free(instances[i]);
+			vs->free(meshes[i]);
+		}
+		vs->free(viewport);
+		vs->free(camera);
+		vs->free(scenario);
+	}
+};
+
 MainLoop *test() {
 
 	return memnew(TestMainLoop);
 }
+
+MainLoop *test_lod() {
+
+	return memnew(TestLODMainLoop);
+}
 } // namespace TestRender
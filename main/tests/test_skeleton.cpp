@@ -0,0 +1,343 @@
+/*************************************************************************/
+/*  test_skeleton.cpp                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef _3D_DISABLED
+
+#include "test_skeleton.h"
+
+#include "core/message_queue.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
+#include "scene/3d/skeleton.h"
+#include "scene/animation/animation_blend_tree.h"
+#include "scene/animation/animation_player.h"
+#include "scene/animation/animation_tree.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+
+namespace TestSkeleton {
+
+// Crowd benchmark: many animated skeletons updated in the same frame.
+
+class TestMainLoop : public SceneTree {
+
+	enum {
+		SKELETON_COUNT = 400,
+		BONES_PER_LIMB = 12,
+		LIMB_COUNT = 5,
+		FRAMES = 60
+	};
+
+	Vector<Skeleton *> skeletons;
+	Vector<AnimationPlayer *> players;
+
+	void _animate(int p_frame, bool p_single_bone) {
+
+		for (int i = 0; i < skeletons.size(); i++) {
+
+			Skeleton *sk = skeletons[i];
+			int count = p_single_bone ? 1 : sk->get_bone_count();
+			for (int j = 0; j < count; j++) {
+				// in single bone mode, move the tip of one limb (bones are added root first, limb by limb)
+				int bone = p_single_bone ? (p_frame % LIMB_COUNT + 1) * BONES_PER_LIMB : j;
+				real_t angle = Math::sin((p_frame + i + j) * 0.1) * 0.5;
+				sk->set_bone_pose(bone, Transform(Basis(Vector3(0, 0, 1), angle)));
+			}
+		}
+	}
+
+	uint64_t _run(bool p_single_bone) {
+
+		uint64_t total = 0;
+		for (int f = 0; f < FRAMES; f++) {
+			_animate(f, p_single_bone);
+			uint64_t from = OS::get_singleton()->get_ticks_usec();
+			MessageQueue::get_singleton()->flush();
+			total += OS::get_singleton()->get_ticks_usec() - from;
+		}
+		return total / FRAMES;
+	}
+
+	// Every bone driven by an AnimationPlayer, either processed one player at a
+	// time or through the process notification, which samples all players together.
+	uint64_t _run_players(bool p_deferred) {
+
+		uint64_t total = 0;
+		for (int f = 0; f < FRAMES; f++) {
+			uint64_t from = OS::get_singleton()->get_ticks_usec();
+			for (int i = 0; i < players.size(); i++) {
+				players[i]->seek(f / 60.0, false);
+				if (p_deferred)
+					players[i]->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+				else
+					players[i]->advance(0);
+			}
+			MessageQueue::get_singleton()->flush();
+			total += OS::get_singleton()->get_ticks_usec() - from;
+		}
+		return total / FRAMES;
+	}
+
+	void _get_poses(Vector<Transform> &r_poses) {
+
+		r_poses.clear();
+		for (int i = 0; i < skeletons.size(); i++) {
+			for (int j = 0; j < skeletons[i]->get_bone_count(); j++) {
+				r_poses.push_back(skeletons[i]->get_bone_pose(j));
+			}
+		}
+	}
+
+	static bool _same_pose(const Transform &p_a, const Transform &p_b) {
+
+		return p_a.basis[0] == p_b.basis[0] && p_a.basis[1] == p_b.basis[1] && p_a.basis[2] == p_b.basis[2] && p_a.origin == p_b.origin;
+	}
+
+	// Global poses must match a full recompute, whatever subtrees the update skipped.
+	bool _check_global_poses() {
+
+		for (int i = 0; i < skeletons.size(); i++) {
+
+			Skeleton *sk = skeletons[i];
+			Vector<Transform> expected;
+			expected.resize(sk->get_bone_count());
+			// bones were added parent first
+			for (int j = 0; j < sk->get_bone_count(); j++) {
+				int parent = sk->get_bone_parent(j);
+				Transform local = sk->get_bone_rest(j) * sk->get_bone_pose(j);
+				expected.write[j] = parent >= 0 ? expected[parent] * local : local;
+			}
+
+			for (int j = 0; j < sk->get_bone_count(); j++) {
+				if (!_same_pose(sk->get_bone_global_pose(j), expected[j])) {
+					OS::get_singleton()->print("Skeleton %i bone %i global pose is stale\n", i, j);
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// A node bound to a bone gets the bone's global pose without the bone being posed again.
+	bool _check_bound_node() {
+
+		Skeleton *sk = skeletons[0];
+		int bone = sk->get_bone_count() - 1;
+
+		Spatial *attachment = memnew(Spatial);
+		sk->add_child(attachment);
+		MessageQueue::get_singleton()->flush();
+
+		sk->bind_child_node_to_bone(bone, attachment);
+		MessageQueue::get_singleton()->flush();
+
+		bool ok = _same_pose(attachment->get_transform(), sk->get_bone_global_pose(bone));
+
+		sk->unbind_child_node_from_bone(bone, attachment);
+		attachment->queue_delete();
+		return ok;
+	}
+
+	// Both ways of processing the players must pose every bone the same.
+	bool _check_players() {
+
+		static const int frames[] = { 0, 7, 31, 59 };
+
+		for (int f = 0; f < 4; f++) {
+
+			Vector<Transform> serial;
+			for (int i = 0; i < players.size(); i++) {
+				players[i]->seek(frames[f] / 60.0, false);
+				players[i]->advance(0);
+			}
+			MessageQueue::get_singleton()->flush();
+			_get_poses(serial);
+
+			// reset, so poses left over from the serial pass can't hide a missed update
+			for (int i = 0; i < skeletons.size(); i++) {
+				for (int j = 0; j < skeletons[i]->get_bone_count(); j++) {
+					skeletons[i]->set_bone_pose(j, Transform());
+				}
+			}
+
+			Vector<Transform> deferred;
+			for (int i = 0; i < players.size(); i++) {
+				players[i]->seek(frames[f] / 60.0, false);
+				players[i]->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+			}
+			MessageQueue::get_singleton()->flush();
+			_get_poses(deferred);
+
+			if (serial.size() != deferred.size())
+				return false;
+			for (int i = 0; i < serial.size(); i++) {
+				if (!_same_pose(serial[i], deferred[i])) {
+					OS::get_singleton()->print("Bone pose %i differs at frame %i\n", i, frames[f]);
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// Freeing an animated node while its deferred sample is still queued must drop the sample,
+	// otherwise it is applied to the freed node. Best run with a memory checker.
+	void _check_removed_node(bool p_tree) {
+
+		Spatial *rig = memnew(Spatial);
+		Skeleton *sk = memnew(Skeleton);
+		sk->set_name("Skeleton");
+		sk->add_bone("root");
+		rig->add_child(sk);
+
+		AnimationPlayer *player = memnew(AnimationPlayer);
+		player->set_name("AnimationPlayer");
+		player->add_animation("walk", _make_animation(sk));
+		rig->add_child(player);
+
+		AnimationTree *tree = NULL;
+		if (p_tree) {
+			Ref<AnimationNodeAnimation> node;
+			node.instance();
+			node->set_animation("walk");
+			tree = memnew(AnimationTree);
+			tree->set_tree_root(node);
+			tree->set_animation_player(NodePath("../AnimationPlayer"));
+			tree->set_active(true);
+			rig->add_child(tree);
+		} else {
+			player->play("walk");
+		}
+
+		get_root()->add_child(rig);
+		MessageQueue::get_singleton()->flush();
+
+		// queue a deferred sample, then free the node it writes to before it runs
+		if (p_tree)
+			tree->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+		else
+			player->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+		memdelete(sk);
+		MessageQueue::get_singleton()->flush();
+
+		memdelete(rig);
+	}
+
+	Ref<Animation> _make_animation(Skeleton *p_skeleton) {
+
+		Ref<Animation> anim;
+		anim.instance();
+		anim->set_length(2.0);
+		anim->set_loop(true);
+
+		for (int i = 0; i < p_skeleton->get_bone_count(); i++) {
+			anim->add_track(Animation::TYPE_TRANSFORM);
+			anim->track_set_path(i, NodePath("Skeleton:" + p_skeleton->get_bone_name(i)));
+			for (int k = 0; k <= 60; k++) {
+				real_t angle = Math::sin(k * 0.2 + i) * 0.5;
+				anim->transform_track_insert_key(i, k / 30.0, Vector3(), Quat(Vector3(0, 0, 1), angle), Vector3(1, 1, 1));
+			}
+		}
+
+		return anim;
+	}
+
+public:
+	virtual void init() {
+
+		SceneTree::init();
+
+		for (int i = 0; i < SKELETON_COUNT; i++) {
+
+			Skeleton *sk = memnew(Skeleton);
+			sk->add_bone("root");
+			for (int l = 0; l < LIMB_COUNT; l++) {
+				int parent = 0;
+				for (int b = 0; b < BONES_PER_LIMB; b++) {
+					int idx = sk->get_bone_count();
+					sk->add_bone("limb" + itos(l) + "_" + itos(b));
+					sk->set_bone_parent(idx, parent);
+					sk->set_bone_rest(idx, Transform(Basis(), Vector3(0, 0.1, 0)));
+					parent = idx;
+				}
+			}
+			Spatial *character = memnew(Spatial);
+			sk->set_name("Skeleton");
+			character->add_child(sk);
+			get_root()->add_child(character);
+			skeletons.push_back(sk);
+		}
+
+		Ref<Animation> anim = _make_animation(skeletons[0]);
+		for (int i = 0; i < SKELETON_COUNT; i++) {
+
+			AnimationPlayer *player = memnew(AnimationPlayer);
+			player->add_animation("walk", anim);
+			skeletons[i]->get_parent()->add_child(player);
+			player->play("walk");
+			players.push_back(player);
+		}
+
+		MessageQueue::get_singleton()->flush();
+
+		OS::get_singleton()->print("Skeletons: %i, bones each: %i, worker threads: %i\n", SKELETON_COUNT, skeletons[0]->get_bone_count(), ThreadWorkPool::get_singleton()->get_thread_count());
+		OS::get_singleton()->print("All bones animated: %i usec per frame\n", (int)_run(false));
+		OS::get_singleton()->print("One leaf bone animated: %i usec per frame\n", (int)_run(true));
+
+		bool poses_ok = _check_global_poses();
+		OS::get_singleton()->print("Global poses after partial updates match: %s\n", poses_ok ? "OK" : "FAIL");
+		bool bound_ok = _check_bound_node();
+		OS::get_singleton()->print("Node bound to a bone follows it: %s\n", bound_ok ? "OK" : "FAIL");
+
+		OS::get_singleton()->print("AnimationPlayers, one at a time: %i usec per frame\n", (int)_run_players(false));
+		OS::get_singleton()->print("AnimationPlayers, sampled together: %i usec per frame\n", (int)_run_players(true));
+
+		_check_removed_node(false);
+		_check_removed_node(true);
+		OS::get_singleton()->print("Animated node freed while a sample is pending: OK\n");
+
+		bool players_ok = _check_players();
+		OS::get_singleton()->print("AnimationPlayers, serial and deferred poses match: %s\n", players_ok ? "OK" : "FAIL");
+		if (!poses_ok || !bound_ok || !players_ok)
+			OS::get_singleton()->set_exit_code(1);
+
+		quit();
+	}
+};
+
+MainLoop *test() {
+
+	return memnew(TestMainLoop);
+}
+} // namespace TestSkeleton
+
+#endif
@@ -1325,6 +1325,68 @@ void CSGBrushOperation::MeshMerge::add_face(const Vector3 &p_a, const Vector3 &p
 	faces.push_back(face);
 }
 
+void CSGBrushOperation::_find_face_pairs(const CSGBrush &p_A, const CSGBrush &p_B, Vector<FacePair> &r_pairs) {
+
+	//sort and sweep along X, so only faces overlapping on that axis get the full AABB test
+	Vector<FaceSort> sort_a;
+	sort_a.resize(p_A.faces.size());
+	for (int i = 0; i < p_A.faces.size(); i++) {
+		const AABB &aabb = p_A.faces[i].aabb;
+		sort_a.write[i].face = i;
+		sort_a.write[i].from = aabb.position.x;
+		sort_a.write[i].to = aabb.position.x + aabb.size.x;
+	}
+	sort_a.sort();
+
+	Vector<FaceSort> sort_b;
+	sort_b.resize(p_B.faces.size());
+	for (int i = 0; i < p_B.faces.size(); i++) {
+		const AABB &aabb = p_B.faces[i].aabb;
+		sort_b.write[i].face = i;
+		sort_b.write[i].from = aabb.position.x;
+		sort_b.write[i].to = aabb.position.x + aabb.size.x;
+	}
+	sort_b.sort();
+
+	const FaceSort *sa = sort_a.ptr();
+	const FaceSort *sb = sort_b.ptr();
+	int count_a = sort_a.size();
+	int count_b = sort_b.size();
+	int ia = 0;
+	int ib = 0;
+
+	//each pair is found once, from whichever face starts first
+	while (ia < count_a && ib < count_b) {
+
+		if (sa[ia].from <= sb[ib].from) {
+			const AABB &aabb = p_A.faces[sa[ia].face].aabb;
+			for (int j = ib; j < count_b && sb[j].from <= sa[ia].to; j++) {
+				if (aabb.intersects(p_B.faces[sb[j].face].aabb)) {
+					FacePair pair;
+					pair.a = sa[ia].face;
+					pair.b = sb[j].face;
+					r_pairs.push_back(pair);
+				}
+			}
+			ia++;
+		} else {
+			const AABB &aabb = p_B.faces[sb[ib].face].aabb;
+			for (int j = ia; j < count_a && sa[j].from <= sb[ib].to; j++) {
+				if (aabb.intersects(p_A.faces[sa[j].face].aabb)) {
+					FacePair pair;
+					pair.a = sa[j].face;
+					pair.b = sb[ib].face;
+					r_pairs.push_back(pair);
+				}
+			}
+			ib++;
+		}
+	}
+
+	//clip in the same order as testing every pair would, so results don't change
+	r_pairs.sort();
+}
+
 void CSGBrushOperation::merge_brushes(Operation p_operation, const CSGBrush &p_A, const CSGBrush &p_B, CSGBrush &result, float p_snap) {
 
 	CallbackData cd;
@@ -1337,14 +1399,12 @@ void CSGBrushOperation::merge_brushes(Operation p_operation, const CSGBrush &p_A
 
 	//check intersections between faces. Use AABB to speed up precheck
 	//this generates list of buildpolys and clips them.
-	//this was originally BVH optimized, but its not really worth it.
-	for (int i = 0; i < p_A.faces.size(); i++) {
-		cd.face_a = i;
-		for (int j = 0; j < p_B.faces.size(); j++) {
-			if (p_A.faces[i].aabb.intersects(p_B.faces[j].aabb)) {
-				_collision_callback(&p_A, i, cd.build_polys_A, &p_B, j, cd.build_polys_B, mesh_merge);
-			}
-		}
+	Vector<FacePair> pairs;
+	_find_face_pairs(p_A, p_B, pairs);
+
+	for (int i = 0; i < pairs.size(); i++) {
+		cd.face_a = pairs[i].a;
+		_collision_callback(&p_A, pairs[i].a, cd.build_polys_A, &p_B, pairs[i].b, cd.build_polys_B, mesh_merge);
 	}
 
 	//merge the already cliped polys back to 3D
@@ -214,6 +214,21 @@ struct CSGBrushOperation {
 		bool operator<(const EdgeSort &p_edge) const { return angle < p_edge.angle; }
 	};
 
+	struct FaceSort {
+		int face;
+		real_t from;
+		real_t to;
+		bool operator<(const FaceSort &p_face) const { return from < p_face.from; }
+	};
+
+	struct FacePair {
+		int a;
+		int b;
+		bool operator<(const FacePair &p_pair) const { return a == p_pair.a ? b < p_pair.b : a < p_pair.a; }
+	};
+
+	static void _find_face_pairs(const CSGBrush &p_A, const CSGBrush &p_B, Vector<FacePair> &r_pairs);
+
 	struct CallbackData {
 		const CSGBrush *A;
 		const CSGBrush *B;
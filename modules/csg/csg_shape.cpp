@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "csg_shape.h"
+#include "core/os/thread_work_pool.h"
 #include "scene/3d/path.h"
 
 void CSGShape::set_use_collision(bool p_enable) {
@@ -131,7 +132,10 @@ float CSGShape::get_snap() const {
 	return snap;
 }
 
-void CSGShape::_make_dirty() {
+void CSGShape::_make_dirty(bool p_only_children) {
+
+	if (!p_only_children)
+		base_dirty = true;
 
 	if (!is_inside_tree())
 		return;
@@ -143,7 +147,7 @@ void CSGShape::_make_dirty() {
 	dirty = true;
 
 	if (parent) {
-		parent->_make_dirty();
+		parent->_make_dirty(true);
 	} else {
 		//only parent will do
 		call_deferred("_update_shape");
@@ -153,69 +157,141 @@ void CSGShape::_make_dirty() {
 CSGBrush *CSGShape::_get_brush() {
 
 	if (dirty) {
-		if (brush) {
-			memdelete(brush);
+		// Primitives may read resources or the scene, so they are built here,
+		// while the merges below only touch brushes and can run on any thread.
+		_update_base_brushes();
+		_update_brush();
+	}
+
+	return brush;
+}
+
+void CSGShape::_update_base_brushes() {
+
+	if (!dirty)
+		return;
+
+	if (base_dirty) {
+		if (base_brush) {
+			memdelete(base_brush);
 		}
-		brush = NULL;
+		base_dirty = false;
+		base_brush = _build_brush();
+	}
+
+	for (int i = 0; i < get_child_count(); i++) {
+
+		CSGShape *child = Object::cast_to<CSGShape>(get_child(i));
+		if (!child)
+			continue;
+		if (!child->is_visible_in_tree())
+			continue;
 
-		CSGBrush *n = _build_brush();
+		child->_update_base_brushes();
+	}
+}
 
-		for (int i = 0; i < get_child_count(); i++) {
+void CSGShape::_update_child_brush_thread(uint32_t p_index, CSGShape **p_children) {
 
-			CSGShape *child = Object::cast_to<CSGShape>(get_child(i));
-			if (!child)
-				continue;
-			if (!child->is_visible_in_tree())
-				continue;
+	p_children[p_index]->_update_brush();
+}
 
-			CSGBrush *n2 = child->_get_brush();
-			if (!n2)
-				continue;
-			if (!n) {
-				n = memnew(CSGBrush);
+void CSGShape::_update_brush() {
 
-				n->copy_from(*n2, child->get_transform());
+	if (!dirty)
+		return;
 
-			} else {
+	if (brush) {
+		memdelete(brush);
+	}
+	brush = NULL;
 
-				CSGBrush *nn = memnew(CSGBrush);
-				CSGBrush *nn2 = memnew(CSGBrush);
-				nn2->copy_from(*n2, child->get_transform());
+	Vector<CSGShape *> children;
+	Vector<CSGShape *> dirty_children;
 
-				CSGBrushOperation bop;
+	for (int i = 0; i < get_child_count(); i++) {
 
-				switch (child->get_operation()) {
-					case CSGShape::OPERATION_UNION: bop.merge_brushes(CSGBrushOperation::OPERATION_UNION, *n, *nn2, *nn, snap); break;
-					case CSGShape::OPERATION_INTERSECTION: bop.merge_brushes(CSGBrushOperation::OPERATION_INTERSECTION, *n, *nn2, *nn, snap); break;
-					case CSGShape::OPERATION_SUBTRACTION: bop.merge_brushes(CSGBrushOperation::OPERATION_SUBSTRACTION, *n, *nn2, *nn, snap); break;
-				}
-				memdelete(n);
-				memdelete(nn2);
-				n = nn;
-			}
+		CSGShape *child = Object::cast_to<CSGShape>(get_child(i));
+		if (!child)
+			continue;
+		if (!child->is_visible_in_tree())
+			continue;
+
+		children.push_back(child);
+		if (child->dirty) {
+			dirty_children.push_back(child);
 		}
+	}
+
+	// Sibling branches don't depend on each other, so they can be merged in parallel.
+	// Clean branches keep their cached brush.
+	if (dirty_children.size() > 1) {
+		ThreadWorkPool::get_singleton()->do_work(dirty_children.size(), this, &CSGShape::_update_child_brush_thread, dirty_children.ptrw());
+	} else if (dirty_children.size() == 1) {
+		dirty_children[0]->_update_brush();
+	}
+
+	const CSGBrush *base = base_brush;
+	CSGBrush *n = NULL;
+
+	for (int i = 0; i < children.size(); i++) {
+
+		CSGShape *child = children[i];
+
+		CSGBrush *n2 = child->brush;
+		if (!n2)
+			continue;
+		if (!base && !n) {
+			n = memnew(CSGBrush);
+
+			n->copy_from(*n2, child->get_transform());
 
-		if (n) {
-			AABB aabb;
-			for (int i = 0; i < n->faces.size(); i++) {
-				for (int j = 0; j < 3; j++) {
-					if (i == 0 && j == 0)
-						aabb.position = n->faces[i].vertices[j];
-					else
-						aabb.expand_to(n->faces[i].vertices[j]);
-				}
-			}
-			node_aabb = aabb;
 		} else {
-			node_aabb = AABB();
+
+			CSGBrush *nn = memnew(CSGBrush);
+			CSGBrush *nn2 = memnew(CSGBrush);
+			nn2->copy_from(*n2, child->get_transform());
+
+			const CSGBrush *a = n ? n : base;
+
+			CSGBrushOperation bop;
+
+			switch (child->get_operation()) {
+				case CSGShape::OPERATION_UNION: bop.merge_brushes(CSGBrushOperation::OPERATION_UNION, *a, *nn2, *nn, snap); break;
+				case CSGShape::OPERATION_INTERSECTION: bop.merge_brushes(CSGBrushOperation::OPERATION_INTERSECTION, *a, *nn2, *nn, snap); break;
+				case CSGShape::OPERATION_SUBTRACTION: bop.merge_brushes(CSGBrushOperation::OPERATION_SUBSTRACTION, *a, *nn2, *nn, snap); break;
+			}
+			if (n) {
+				memdelete(n);
+			}
+			memdelete(nn2);
+			n = nn;
 		}
+	}
 
-		brush = n;
+	if (!n && base) {
+		n = memnew(CSGBrush);
+		n->copy_from(*base, Transform());
+	}
 
-		dirty = false;
+	if (n) {
+		AABB aabb;
+		for (int i = 0; i < n->faces.size(); i++) {
+			for (int j = 0; j < 3; j++) {
+				if (i == 0 && j == 0)
+					aabb.position = n->faces[i].vertices[j];
+				else
+					aabb.expand_to(n->faces[i].vertices[j]);
+			}
+		}
+		node_aabb = aabb;
+	} else {
+		node_aabb = AABB();
 	}
 
-	return brush;
+	brush = n;
+
+	dirty = false;
 }
 
 int CSGShape::mikktGetNumFaces(const SMikkTSpaceContext *pContext) {
@@ -527,21 +603,21 @@ void CSGShape::_notification(int p_what) {
 	if (p_what == NOTIFICATION_LOCAL_TRANSFORM_CHANGED) {
 
 		if (parent) {
-			parent->_make_dirty();
+			parent->_make_dirty(true);
 		}
 	}
 
 	if (p_what == NOTIFICATION_VISIBILITY_CHANGED) {
 
 		if (parent) {
-			parent->_make_dirty();
+			parent->_make_dirty(true);
 		}
 	}
 
 	if (p_what == NOTIFICATION_EXIT_TREE) {
 
 		if (parent)
-			parent->_make_dirty();
+			parent->_make_dirty(true);
 		parent = NULL;
 
 		if (use_collision && is_root_shape() && root_collision_instance.is_valid()) {
@@ -644,7 +720,9 @@ CSGShape::CSGShape() {
 	operation = OPERATION_UNION;
 	parent = NULL;
 	brush = NULL;
+	base_brush = NULL;
 	dirty = false;
+	base_dirty = true;
 	snap = 0.001;
 	use_collision = false;
 	collision_layer = 1;
@@ -658,6 +736,10 @@ CSGShape::~CSGShape() {
 		memdelete(brush);
 		brush = NULL;
 	}
+	if (base_brush) {
+		memdelete(base_brush);
+		base_brush = NULL;
+	}
 }
 //////////////////////////////////
 
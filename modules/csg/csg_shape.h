@@ -54,10 +54,12 @@ private:
 	CSGShape *parent;
 
 	CSGBrush *brush;
+	CSGBrush *base_brush; // result of _build_brush(), kept while only children change
 
 	AABB node_aabb;
 
 	bool dirty;
+	bool base_dirty;
 	float snap;
 
 	bool use_collision;
@@ -107,7 +109,10 @@ private:
 protected:
 	void _notification(int p_what);
 	virtual CSGBrush *_build_brush() = 0;
-	void _make_dirty();
+	void _make_dirty(bool p_only_children = false);
+	void _update_base_brushes();
+	void _update_brush();
+	void _update_child_brush_thread(uint32_t p_index, CSGShape **p_children);
 
 	static void _bind_methods();
 
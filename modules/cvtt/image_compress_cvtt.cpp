@@ -30,8 +30,6 @@
 
 #include "image_compress_cvtt.h"
 
-#include "core/os/os.h"
-#include "core/os/thread.h"
 #include "core/print_string.h"
 
 #include <ConvectionKernels.h>
@@ -52,13 +50,6 @@ struct CVTTCompressionRowTask {
 	int height;
 };
 
-struct CVTTCompressionJobQueue {
-	CVTTCompressionJobParams job_params;
-	const CVTTCompressionRowTask *job_tasks;
-	uint32_t num_tasks;
-	uint32_t current_task;
-};
-
 static void _digest_row_task(const CVTTCompressionJobParams &p_job_params, const CVTTCompressionRowTask &p_row_task) {
 	const uint8_t *in_bytes = p_row_task.in_mm_bytes;
 	uint8_t *out_bytes = p_row_task.out_mm_bytes;
@@ -128,11 +119,18 @@ static void _digest_row_task(const CVTTCompressionJobParams &p_job_params, const
 	}
 }
 
-static void _digest_job_queue(void *p_job_queue) {
-	CVTTCompressionJobQueue *job_queue = static_cast<CVTTCompressionJobQueue *>(p_job_queue);
+static void _digest_block_rows(const Image::CompressBlockLevel &p_level, int p_from_row, int p_to_row, void *p_job_params) {
+	const CVTTCompressionJobParams *job_params = static_cast<const CVTTCompressionJobParams *>(p_job_params);
 
-	for (uint32_t next_task = atomic_increment(&job_queue->current_task); next_task <= job_queue->num_tasks; next_task = atomic_increment(&job_queue->current_task)) {
-		_digest_row_task(job_queue->job_params, job_queue->job_tasks[next_task - 1]);
+	for (int row = p_from_row; row < p_to_row; row++) {
+		CVTTCompressionRowTask row_task;
+		row_task.width = p_level.width;
+		row_task.height = p_level.height;
+		row_task.y_start = row * 4;
+		row_task.in_mm_bytes = p_level.src;
+		row_task.out_mm_bytes = p_level.dst + row * p_level.dst_row_pitch;
+
+		_digest_row_task(*job_params, row_task);
 	}
 }
 
@@ -207,74 +205,33 @@ void image_compress_cvtt(Image *p_image, float p_lossy_quality, Image::CompressS
 
 	int dst_ofs = 0;
 
-	CVTTCompressionJobQueue job_queue;
-	job_queue.job_params.is_hdr = is_hdr;
-	job_queue.job_params.is_signed = is_signed;
-	job_queue.job_params.options = options;
-	job_queue.job_params.bytes_per_pixel = is_hdr ? 6 : 4;
-
-#ifdef NO_THREADS
-	int num_job_threads = 0;
-#else
-	int num_job_threads = OS::get_singleton()->can_use_threads() ? (OS::get_singleton()->get_processor_count() - 1) : 0;
-#endif
+	CVTTCompressionJobParams job_params;
+	job_params.is_hdr = is_hdr;
+	job_params.is_signed = is_signed;
+	job_params.options = options;
+	job_params.bytes_per_pixel = is_hdr ? 6 : 4;
 
-	PoolVector<CVTTCompressionRowTask> tasks;
+	Vector<Image::CompressBlockLevel> levels;
 
 	for (int i = 0; i <= mm_count; i++) {
 
 		int bw = w % 4 != 0 ? w + (4 - w % 4) : w;
 		int bh = h % 4 != 0 ? h + (4 - h % 4) : h;
 
-		int src_ofs = p_image->get_mipmap_offset(i);
-
-		const uint8_t *in_bytes = &rb[src_ofs];
-		uint8_t *out_bytes = &wb[dst_ofs];
-
-		for (int y_start = 0; y_start < h; y_start += 4) {
-			CVTTCompressionRowTask row_task;
-			row_task.width = w;
-			row_task.height = h;
-			row_task.y_start = y_start;
-			row_task.in_mm_bytes = in_bytes;
-			row_task.out_mm_bytes = out_bytes;
-
-			if (num_job_threads > 0) {
-				tasks.push_back(row_task);
-			} else {
-				_digest_row_task(job_queue.job_params, row_task);
-			}
-
-			out_bytes += 16 * (bw / 4);
-		}
+		Image::CompressBlockLevel level;
+		level.src = &rb[p_image->get_mipmap_offset(i)];
+		level.dst = &wb[dst_ofs];
+		level.width = w;
+		level.height = h;
+		level.dst_row_pitch = 16 * (bw / 4);
+		levels.push_back(level);
 
 		dst_ofs += (MAX(4, bw) * MAX(4, bh)) >> shift;
 		w = MAX(w / 2, 1);
 		h = MAX(h / 2, 1);
 	}
 
-	if (num_job_threads > 0) {
-		PoolVector<Thread *> threads;
-		threads.resize(num_job_threads);
-
-		PoolVector<Thread *>::Write threads_wb = threads.write();
-
-		PoolVector<CVTTCompressionRowTask>::Read tasks_rb = tasks.read();
-
-		job_queue.job_tasks = &tasks_rb[0];
-		job_queue.current_task = 0;
-		job_queue.num_tasks = static_cast<uint32_t>(tasks.size());
-
-		for (int i = 0; i < num_job_threads; i++) {
-			threads_wb[i] = Thread::create(_digest_job_queue, &job_queue);
-		}
-		_digest_job_queue(&job_queue);
-
-		for (int i = 0; i < num_job_threads; i++) {
-			Thread::wait_to_finish(threads_wb[i]);
-			memdelete(threads_wb[i]);
-		}
-	}
+	Image::compress_block_rows(levels, _digest_block_rows, &job_params);
 
 	p_image->create(p_image->get_width(), p_image->get_height(), p_image->has_mipmaps(), target_format, data);
 }
@@ -88,6 +88,46 @@ static Etc::Image::Format _image_format_to_etc2comp_format(Image::Format format)
 	}
 }
 
+struct EtcCompressParams {
+	Etc::Image::Format format;
+	Etc::ErrorMetric error_metric;
+	float effort;
+};
+
+static void _compress_etc_rows(const Image::CompressBlockLevel &p_level, int p_from_row, int p_to_row, void *p_userdata) {
+	const EtcCompressParams *params = static_cast<const EtcCompressParams *>(p_userdata);
+
+	int y = p_from_row * 4;
+	int w = p_level.width;
+	int h = MIN(p_to_row * 4, p_level.height) - y;
+
+	// convert source image to internal etc2comp format (which is equivalent to Image::FORMAT_RGBAF)
+	// NOTE: We can alternatively add a case to Image::convert to handle Image::FORMAT_RGBAF conversion.
+	const uint8_t *src = &p_level.src[y * w * 4];
+
+	Etc::ColorFloatRGBA *src_rgba_f = new Etc::ColorFloatRGBA[w * h];
+	for (int j = 0; j < w * h; j++) {
+		int si = j * 4; // RGBA8
+		src_rgba_f[j] = Etc::ColorFloatRGBA::ConvertFromRGBA8(src[si], src[si + 1], src[si + 2], src[si + 3]);
+	}
+
+	// Rows are already spread over the worker threads, so etc2comp runs a single job
+	unsigned char *etc_data = NULL;
+	unsigned int etc_data_len = 0;
+	unsigned int extended_width = 0, extended_height = 0;
+	int encoding_time = 0;
+	Etc::Encode((float *)src_rgba_f, w, h, params->format, params->error_metric, params->effort, 1, 1, &etc_data, &etc_data_len, &extended_width, &extended_height, &encoding_time);
+
+	if (etc_data_len == (unsigned int)((p_to_row - p_from_row) * p_level.dst_row_pitch)) {
+		memcpy(&p_level.dst[p_from_row * p_level.dst_row_pitch], etc_data, etc_data_len);
+	} else {
+		ERR_PRINTS("ETC: Unexpected encoded size for block rows " + itos(p_from_row) + " to " + itos(p_to_row) + ".");
+	}
+
+	delete[] etc_data;
+	delete[] src_rgba_f;
+}
+
 static void _compress_etc(Image *p_img, float p_lossy_quality, bool force_etc1_format, Image::CompressSource p_source) {
 	Image::Format img_format = p_img->get_format();
 	Image::DetectChannels detected_channels = p_img->get_detected_channels();
@@ -178,8 +218,6 @@ static void _compress_etc(Image *p_img, float p_lossy_quality, bool force_etc1_f
 	PoolVector<uint8_t>::Write w = dst_data.write();
 
 	// prepare parameters to be passed to etc2comp
-	int num_cpus = OS::get_singleton()->get_processor_count();
-	int encoding_time = 0;
 	float effort = 0.0; //default, reasonable time
 
 	if (p_lossy_quality > 0.75)
@@ -192,36 +230,40 @@ static void _compress_etc(Image *p_img, float p_lossy_quality, bool force_etc1_f
 	Etc::ErrorMetric error_metric = Etc::ErrorMetric::RGBX; // NOTE: we can experiment with other error metrics
 	Etc::Image::Format etc2comp_etc_format = _image_format_to_etc2comp_format(etc_format);
 
-	int wofs = 0;
+	EtcCompressParams params;
+	params.format = etc2comp_etc_format;
+	params.error_metric = error_metric;
+	params.effort = effort;
+
+	// ETC blocks are 4x4 pixels, stored in 8 or 16 bytes
+	int block_bytes = 16 >> Image::get_format_pixel_rshift(etc_format);
+
+	Vector<Image::CompressBlockLevel> levels;
+	unsigned int wofs = 0;
 
 	print_verbose("ETC: Begin encoding, format: " + Image::get_format_name(etc_format));
 	uint64_t t = OS::get_singleton()->get_ticks_msec();
 	for (int i = 0; i < mmc; i++) {
-		// convert source image to internal etc2comp format (which is equivalent to Image::FORMAT_RGBAF)
-		// NOTE: We can alternatively add a case to Image::convert to handle Image::FORMAT_RGBAF conversion.
 		int mipmap_ofs = 0, mipmap_size = 0, mipmap_w = 0, mipmap_h = 0;
 		img->get_mipmap_offset_size_and_dimensions(i, mipmap_ofs, mipmap_size, mipmap_w, mipmap_h);
-		const uint8_t *src = &r[mipmap_ofs];
 
-		Etc::ColorFloatRGBA *src_rgba_f = new Etc::ColorFloatRGBA[mipmap_w * mipmap_h];
-		for (int j = 0; j < mipmap_w * mipmap_h; j++) {
-			int si = j * 4; // RGBA8
-			src_rgba_f[j] = Etc::ColorFloatRGBA::ConvertFromRGBA8(src[si], src[si + 1], src[si + 2], src[si + 3]);
-		}
-
-		unsigned char *etc_data = NULL;
-		unsigned int etc_data_len = 0;
-		unsigned int extended_width = 0, extended_height = 0;
-		Etc::Encode((float *)src_rgba_f, mipmap_w, mipmap_h, etc2comp_etc_format, error_metric, effort, num_cpus, num_cpus, &etc_data, &etc_data_len, &extended_width, &extended_height, &encoding_time);
+		int block_columns = MAX((mipmap_w + 3) / 4, 1);
+		int block_rows = MAX((mipmap_h + 3) / 4, 1);
 
-		CRASH_COND(wofs + etc_data_len > target_size);
-		memcpy(&w[wofs], etc_data, etc_data_len);
-		wofs += etc_data_len;
+		Image::CompressBlockLevel level;
+		level.src = &r[mipmap_ofs];
+		level.dst = &w[wofs];
+		level.width = mipmap_w;
+		level.height = mipmap_h;
+		level.dst_row_pitch = block_columns * block_bytes;
+		levels.push_back(level);
 
-		delete[] etc_data;
-		delete[] src_rgba_f;
+		wofs += block_rows * level.dst_row_pitch;
+		CRASH_COND(wofs > target_size);
 	}
 
+	Image::compress_block_rows(levels, _compress_etc_rows, &params);
+
 	print_verbose("ETC: Time encoding: " + rtos(OS::get_singleton()->get_ticks_msec() - t));
 
 	p_img->create(imgw, imgh, p_img->has_mipmaps(), etc_format, dst_data);
@@ -32,6 +32,7 @@
 
 #include "core/io/marshalls.h"
 #include "core/message_queue.h"
+#include "core/os/thread_work_pool.h"
 #include "scene/3d/light.h"
 #include "scene/resources/mesh_library.h"
 #include "scene/resources/surface_tool.h"
@@ -418,47 +419,91 @@ void GridMap::_octant_transform(const OctantKey &p_key) {
 	for (int i = 0; i < g.multimesh_instances.size(); i++) {
 		VS::get_singleton()->instance_set_transform(g.multimesh_instances[i].instance, get_global_transform());
 	}
+
+	if (g.merged_instance.is_valid()) {
+		VS::get_singleton()->instance_set_transform(g.merged_instance, get_global_transform());
+	}
 }
 
-bool GridMap::_octant_update(const OctantKey &p_key) {
-	ERR_FAIL_COND_V(!octant_map.has(p_key), false);
-	Octant &g = *octant_map[p_key];
-	if (!g.dirty)
-		return false;
+void GridMap::_fetch_item_surfaces(const Set<IndexKey> &p_cells, Map<int, ItemSurfaces> &r_surfaces) const {
 
-	//erase body shapes
-	PhysicsServer::get_singleton()->body_clear_shapes(g.static_body);
+	for (const Set<IndexKey>::Element *E = p_cells.front(); E; E = E->next()) {
 
-	//erase body shapes debug
-	if (g.collision_debug.is_valid()) {
+		const Map<IndexKey, Cell>::Element *C = cell_map.find(E->get());
+		ERR_CONTINUE(!C);
 
-		VS::get_singleton()->mesh_clear(g.collision_debug);
-	}
+		int item = C->get().item;
+		if (r_surfaces.has(item) || !mesh_library->has_item(item))
+			continue;
 
-	//erase navigation
-	if (navigation) {
-		for (Map<IndexKey, Octant::NavMesh>::Element *E = g.navmesh_ids.front(); E; E = E->next()) {
-			navigation->navmesh_remove(E->get().id);
+		ItemSurfaces &is = r_surfaces[item];
+		Ref<Mesh> mesh = mesh_library->get_item_mesh(item);
+		if (!mesh.is_valid())
+			continue;
+
+		for (int i = 0; i < mesh->get_surface_count(); i++) {
+
+			if (mesh->surface_get_primitive_type(i) != Mesh::PRIMITIVE_TRIANGLES)
+				continue;
+
+			is.arrays.push_back(mesh->surface_get_arrays(i));
+			is.materials.push_back(mesh->surface_get_material(i));
 		}
-		g.navmesh_ids.clear();
 	}
+}
 
-	//erase multimeshes
+void GridMap::_merge_cell_meshes(const Set<IndexKey> &p_cells, const Map<int, ItemSurfaces> &p_surfaces, Vector<Array> &r_arrays, Vector<Ref<Material> > &r_materials) const {
 
-	for (int i = 0; i < g.multimesh_instances.size(); i++) {
+	Map<Ref<Material>, Ref<SurfaceTool> > mat_map;
+	Vector3 ofs = _get_offset();
 
-		VS::get_singleton()->free(g.multimesh_instances[i].instance);
-		VS::get_singleton()->free(g.multimesh_instances[i].multimesh);
+	for (const Set<IndexKey>::Element *E = p_cells.front(); E; E = E->next()) {
+
+		const Map<IndexKey, Cell>::Element *C = cell_map.find(E->get());
+		ERR_CONTINUE(!C);
+
+		const Map<int, ItemSurfaces>::Element *S = p_surfaces.find(C->get().item);
+		if (!S)
+			continue;
+
+		Vector3 cellpos = Vector3(E->get().x, E->get().y, E->get().z);
+
+		Transform xform;
+
+		xform.basis.set_orthogonal_index(C->get().rot);
+		xform.set_origin(cellpos * cell_size + ofs);
+		xform.basis.scale(Vector3(cell_scale, cell_scale, cell_scale));
+
+		const ItemSurfaces &is = S->get();
+		for (int i = 0; i < is.arrays.size(); i++) {
+
+			const Ref<Material> &surf_mat = is.materials[i];
+			if (!mat_map.has(surf_mat)) {
+				Ref<SurfaceTool> st;
+				st.instance();
+				st->begin(Mesh::PRIMITIVE_TRIANGLES);
+				st->set_material(surf_mat);
+				mat_map[surf_mat] = st;
+			}
+
+			mat_map[surf_mat]->append_from_arrays(is.arrays[i], xform);
+		}
 	}
-	g.multimesh_instances.clear();
 
-	if (g.cells.size() == 0) {
-		//octant no longer needed
-		_octant_clean_up(p_key);
-		return true;
+	for (Map<Ref<Material>, Ref<SurfaceTool> >::Element *E = mat_map.front(); E; E = E->next()) {
+
+		r_arrays.push_back(E->get()->commit_to_arrays());
+		r_materials.push_back(E->key());
 	}
+}
+
+void GridMap::_octant_build_thread(uint32_t p_index, OctantBuildData *p_data) {
 
-	PoolVector<Vector3> col_debug;
+	OctantBuild &b = p_data->builds[p_index];
+	const Octant &g = *b.octant;
+
+	if (!mesh_library.is_valid())
+		return;
 
 	/*
 	 * foreach item in this octant,
@@ -467,29 +512,26 @@ bool GridMap::_octant_update(const OctantKey &p_key) {
 	 */
 
 	Map<int, List<Pair<Transform, IndexKey> > > multimesh_items;
+	Vector3 ofs = _get_offset();
 
-	for (Set<IndexKey>::Element *E = g.cells.front(); E; E = E->next()) {
+	for (const Set<IndexKey>::Element *E = g.cells.front(); E; E = E->next()) {
 
-		ERR_CONTINUE(!cell_map.has(E->get()));
-		const Cell &c = cell_map[E->get()];
+		const Map<IndexKey, Cell>::Element *C = cell_map.find(E->get());
+		ERR_CONTINUE(!C);
+		const Cell &c = C->get();
 
-		if (!mesh_library.is_valid() || !mesh_library->has_item(c.item))
+		if (!mesh_library->has_item(c.item))
 			continue;
 
 		Vector3 cellpos = Vector3(E->get().x, E->get().y, E->get().z);
-		Vector3 ofs = _get_offset();
 
 		Transform xform;
 
 		xform.basis.set_orthogonal_index(c.rot);
 		xform.set_origin(cellpos * cell_size + ofs);
 		xform.basis.scale(Vector3(cell_scale, cell_scale, cell_scale));
-		if (baked_meshes.size() == 0) {
+		if (p_data->build_multimeshes) {
 			if (mesh_library->get_item_mesh(c.item).is_valid()) {
-				if (!multimesh_items.has(c.item)) {
-					multimesh_items[c.item] = List<Pair<Transform, IndexKey> >();
-				}
-
 				Pair<Transform, IndexKey> p;
 				p.first = xform;
 				p.second = E->get();
@@ -503,72 +545,181 @@ bool GridMap::_octant_update(const OctantKey &p_key) {
 			// add the item's shape
 			if (!shapes[i].shape.is_valid())
 				continue;
-			PhysicsServer::get_singleton()->body_add_shape(g.static_body, shapes[i].shape->get_rid(), xform * shapes[i].local_transform);
+			OctantBuild::ShapeData sd;
+			sd.shape = shapes[i].shape;
+			sd.xform = xform * shapes[i].local_transform;
+			b.shapes.push_back(sd);
 			if (g.collision_debug.is_valid()) {
-				shapes.write[i].shape->add_vertices_to_array(col_debug, xform * shapes[i].local_transform);
+				shapes.write[i].shape->add_vertices_to_array(b.col_debug, sd.xform);
 			}
 		}
 
 		// add the item's navmesh at given xform to GridMap's Navigation ancestor
 		Ref<NavigationMesh> navmesh = mesh_library->get_item_navmesh(c.item);
 		if (navmesh.is_valid()) {
-			Octant::NavMesh nm;
-			nm.xform = xform * mesh_library->get_item_navmesh_transform(c.item);
+			OctantBuild::NavMeshData nd;
+			nd.key = E->get();
+			nd.navmesh = navmesh;
+			nd.cell_xform = xform;
+			nd.xform = xform * mesh_library->get_item_navmesh_transform(c.item);
+			b.navmeshes.push_back(nd);
+		}
+	}
 
-			if (navigation) {
-				nm.id = navigation->navmesh_add(navmesh, xform, this);
-			} else {
-				nm.id = -1;
-			}
-			g.navmesh_ids[E->get()] = nm;
+	for (Map<int, List<Pair<Transform, IndexKey> > >::Element *E = multimesh_items.front(); E; E = E->next()) {
+
+		OctantBuild::MultimeshData md;
+		md.item = E->key();
+		md.transforms.resize(E->get().size() * 12);
+
+		PoolVector<float>::Write w = md.transforms.write();
+		int idx = 0;
+		for (List<Pair<Transform, IndexKey> >::Element *F = E->get().front(); F; F = F->next()) {
+
+			const Transform &t = F->get().first;
+			float *ptr = &w[idx * 12];
+			ptr[0] = t.basis.elements[0][0];
+			ptr[1] = t.basis.elements[0][1];
+			ptr[2] = t.basis.elements[0][2];
+			ptr[3] = t.origin.x;
+			ptr[4] = t.basis.elements[1][0];
+			ptr[5] = t.basis.elements[1][1];
+			ptr[6] = t.basis.elements[1][2];
+			ptr[7] = t.origin.y;
+			ptr[8] = t.basis.elements[2][0];
+			ptr[9] = t.basis.elements[2][1];
+			ptr[10] = t.basis.elements[2][2];
+			ptr[11] = t.origin.z;
+#ifdef TOOLS_ENABLED
+
+			Octant::MultimeshInstance::Item it;
+			it.index = idx;
+			it.transform = t;
+			it.key = F->get().second;
+			md.items.push_back(it);
+#endif
+
+			idx++;
 		}
+		w.release();
+
+		b.multimeshes.push_back(md);
 	}
 
-	//update multimeshes, only if not baked
-	if (baked_meshes.size() == 0) {
+	if (p_data->build_merged) {
+		_merge_cell_meshes(g.cells, *p_data->surfaces, b.merged_arrays, b.merged_materials);
+	}
+}
 
-		for (Map<int, List<Pair<Transform, IndexKey> > >::Element *E = multimesh_items.front(); E; E = E->next()) {
-			Octant::MultimeshInstance mmi;
+void GridMap::_free_octant_render_data(Octant &g) {
 
-			RID mm = VS::get_singleton()->multimesh_create();
-			VS::get_singleton()->multimesh_allocate(mm, E->get().size(), VS::MULTIMESH_TRANSFORM_3D, VS::MULTIMESH_COLOR_NONE);
-			VS::get_singleton()->multimesh_set_mesh(mm, mesh_library->get_item_mesh(E->key())->get_rid());
+	for (int i = 0; i < g.multimesh_instances.size(); i++) {
 
-			int idx = 0;
-			for (List<Pair<Transform, IndexKey> >::Element *F = E->get().front(); F; F = F->next()) {
-				VS::get_singleton()->multimesh_instance_set_transform(mm, idx, F->get().first);
-#ifdef TOOLS_ENABLED
+		VS::get_singleton()->free(g.multimesh_instances[i].instance);
+		VS::get_singleton()->free(g.multimesh_instances[i].multimesh);
+	}
+	g.multimesh_instances.clear();
 
-				Octant::MultimeshInstance::Item it;
-				it.index = idx;
-				it.transform = F->get().first;
-				it.key = F->get().second;
-				mmi.items.push_back(it);
-#endif
+	if (g.merged_instance.is_valid()) {
+		VS::get_singleton()->free(g.merged_instance);
+		VS::get_singleton()->free(g.merged_mesh);
+		g.merged_instance = RID();
+		g.merged_mesh = RID();
+	}
+}
 
-				idx++;
-			}
+void GridMap::_octant_publish(OctantBuild &p_build) {
 
-			RID instance = VS::get_singleton()->instance_create();
-			VS::get_singleton()->instance_set_base(instance, mm);
+	Octant &g = *p_build.octant;
 
-			if (is_inside_tree()) {
-				VS::get_singleton()->instance_set_scenario(instance, get_world()->get_scenario());
-				VS::get_singleton()->instance_set_transform(instance, get_global_transform());
+	//erase body shapes
+	PhysicsServer::get_singleton()->body_clear_shapes(g.static_body);
+
+	//erase body shapes debug
+	if (g.collision_debug.is_valid()) {
+
+		VS::get_singleton()->mesh_clear(g.collision_debug);
+	}
+
+	//erase navigation
+	if (navigation) {
+		for (Map<IndexKey, Octant::NavMesh>::Element *E = g.navmesh_ids.front(); E; E = E->next()) {
+			navigation->navmesh_remove(E->get().id);
+		}
+	}
+	g.navmesh_ids.clear();
+
+	//erase multimeshes
+	_free_octant_render_data(g);
+
+	for (int i = 0; i < p_build.shapes.size(); i++) {
+		PhysicsServer::get_singleton()->body_add_shape(g.static_body, p_build.shapes[i].shape->get_rid(), p_build.shapes[i].xform);
+	}
+
+	for (int i = 0; i < p_build.navmeshes.size(); i++) {
+
+		const OctantBuild::NavMeshData &nd = p_build.navmeshes[i];
+		Octant::NavMesh nm;
+		nm.xform = nd.xform;
+
+		if (navigation) {
+			nm.id = navigation->navmesh_add(nd.navmesh, nd.cell_xform, this);
+		} else {
+			nm.id = -1;
+		}
+		g.navmesh_ids[nd.key] = nm;
+	}
+
+	for (int i = 0; i < p_build.multimeshes.size(); i++) {
+
+		const OctantBuild::MultimeshData &md = p_build.multimeshes[i];
+		Octant::MultimeshInstance mmi;
+
+		RID mm = VS::get_singleton()->multimesh_create();
+		VS::get_singleton()->multimesh_allocate(mm, md.transforms.size() / 12, VS::MULTIMESH_TRANSFORM_3D, VS::MULTIMESH_COLOR_NONE);
+		VS::get_singleton()->multimesh_set_mesh(mm, mesh_library->get_item_mesh(md.item)->get_rid());
+		VS::get_singleton()->multimesh_set_as_bulk_array(mm, md.transforms);
+		mmi.items = md.items;
+
+		RID instance = VS::get_singleton()->instance_create();
+		VS::get_singleton()->instance_set_base(instance, mm);
+
+		if (is_inside_tree()) {
+			VS::get_singleton()->instance_set_scenario(instance, get_world()->get_scenario());
+			VS::get_singleton()->instance_set_transform(instance, get_global_transform());
+		}
+
+		mmi.multimesh = mm;
+		mmi.instance = instance;
+
+		g.multimesh_instances.push_back(mmi);
+	}
+
+	if (p_build.merged_arrays.size()) {
+
+		g.merged_mesh = VS::get_singleton()->mesh_create();
+		for (int i = 0; i < p_build.merged_arrays.size(); i++) {
+			VS::get_singleton()->mesh_add_surface_from_arrays(g.merged_mesh, VS::PRIMITIVE_TRIANGLES, p_build.merged_arrays[i]);
+			if (p_build.merged_materials[i].is_valid()) {
+				VS::get_singleton()->mesh_surface_set_material(g.merged_mesh, i, p_build.merged_materials[i]->get_rid());
 			}
+		}
 
-			mmi.multimesh = mm;
-			mmi.instance = instance;
+		g.merged_instance = VS::get_singleton()->instance_create();
+		VS::get_singleton()->instance_set_base(g.merged_instance, g.merged_mesh);
+		VS::get_singleton()->instance_attach_object_instance_id(g.merged_instance, get_instance_id());
 
-			g.multimesh_instances.push_back(mmi);
+		if (is_inside_tree()) {
+			VS::get_singleton()->instance_set_scenario(g.merged_instance, get_world()->get_scenario());
+			VS::get_singleton()->instance_set_transform(g.merged_instance, get_global_transform());
 		}
 	}
 
-	if (col_debug.size()) {
+	if (p_build.col_debug.size()) {
 
 		Array arr;
 		arr.resize(VS::ARRAY_MAX);
-		arr[VS::ARRAY_VERTEX] = col_debug;
+		arr[VS::ARRAY_VERTEX] = p_build.col_debug;
 
 		VS::get_singleton()->mesh_add_surface_from_arrays(g.collision_debug, VS::PRIMITIVE_LINES, arr);
 		SceneTree *st = SceneTree::get_singleton();
@@ -578,8 +729,6 @@ bool GridMap::_octant_update(const OctantKey &p_key) {
 	}
 
 	g.dirty = false;
-
-	return false;
 }
 
 void GridMap::_reset_physic_bodies_collision_filters() {
@@ -606,6 +755,11 @@ void GridMap::_octant_enter_world(const OctantKey &p_key) {
 		VS::get_singleton()->instance_set_transform(g.multimesh_instances[i].instance, get_global_transform());
 	}
 
+	if (g.merged_instance.is_valid()) {
+		VS::get_singleton()->instance_set_scenario(g.merged_instance, get_world()->get_scenario());
+		VS::get_singleton()->instance_set_transform(g.merged_instance, get_global_transform());
+	}
+
 	if (navigation && mesh_library.is_valid()) {
 		for (Map<IndexKey, Octant::NavMesh>::Element *F = g.navmesh_ids.front(); F; F = F->next()) {
 
@@ -635,6 +789,10 @@ void GridMap::_octant_exit_world(const OctantKey &p_key) {
 		VS::get_singleton()->instance_set_scenario(g.multimesh_instances[i].instance, RID());
 	}
 
+	if (g.merged_instance.is_valid()) {
+		VS::get_singleton()->instance_set_scenario(g.merged_instance, RID());
+	}
+
 	if (navigation) {
 		for (Map<IndexKey, Octant::NavMesh>::Element *F = g.navmesh_ids.front(); F; F = F->next()) {
 
@@ -667,13 +825,7 @@ void GridMap::_octant_clean_up(const OctantKey &p_key) {
 	}
 
 	//erase multimeshes
-
-	for (int i = 0; i < g.multimesh_instances.size(); i++) {
-
-		VS::get_singleton()->free(g.multimesh_instances[i].instance);
-		VS::get_singleton()->free(g.multimesh_instances[i].multimesh);
-	}
-	g.multimesh_instances.clear();
+	_free_octant_render_data(g);
 }
 
 void GridMap::_notification(int p_what) {
@@ -755,6 +907,9 @@ void GridMap::_update_visibility() {
 			const Octant::MultimeshInstance &mi = octant->multimesh_instances[i];
 			VS::get_singleton()->instance_set_visible(mi.instance, is_visible());
 		}
+		if (octant->merged_instance.is_valid()) {
+			VS::get_singleton()->instance_set_visible(octant->merged_instance, is_visible());
+		}
 	}
 }
 
@@ -810,16 +965,57 @@ void GridMap::_update_octants_callback() {
 		return;
 
 	List<OctantKey> to_delete;
+	Vector<OctantBuild> builds;
+
 	for (Map<OctantKey, Octant *>::Element *E = octant_map.front(); E; E = E->next()) {
 
-		if (_octant_update(E->key())) {
+		Octant *g = E->get();
+		if (!g->dirty)
+			continue;
+
+		if (g->cells.size() == 0) {
+			//octant no longer needed
+			_octant_clean_up(E->key());
 			to_delete.push_back(E->key());
+			continue;
+		}
+
+		OctantBuild b;
+		b.octant = g;
+		builds.push_back(b);
+	}
+
+	if (builds.size()) {
+
+		bool build_meshes = mesh_library.is_valid() && baked_meshes.size() == 0;
+
+		// Mesh arrays can only be fetched from the main thread.
+		Map<int, ItemSurfaces> surfaces;
+		if (build_meshes && merge_meshes) {
+			for (int i = 0; i < builds.size(); i++) {
+				_fetch_item_surfaces(builds[i].octant->cells, surfaces);
+			}
+		}
+
+		OctantBuildData data;
+		data.builds = builds.ptrw();
+		data.surfaces = &surfaces;
+		data.build_multimeshes = build_meshes && !merge_meshes;
+		data.build_merged = build_meshes && merge_meshes;
+
+		// Octants are rebuilt in parallel, then all of them are handed to the servers
+		// at once, so a half built map is never visible.
+		ThreadWorkPool::get_singleton()->do_work(builds.size(), this, &GridMap::_octant_build_thread, &data);
+
+		for (int i = 0; i < builds.size(); i++) {
+			_octant_publish(builds.write[i]);
 		}
 	}
 
 	while (to_delete.front()) {
+		memdelete(octant_map[to_delete.front()->get()]);
 		octant_map.erase(to_delete.front()->get());
-		to_delete.pop_back();
+		to_delete.pop_front();
 	}
 
 	_update_visibility();
@@ -857,6 +1053,9 @@ void GridMap::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_octant_size", "size"), &GridMap::set_octant_size);
 	ClassDB::bind_method(D_METHOD("get_octant_size"), &GridMap::get_octant_size);
 
+	ClassDB::bind_method(D_METHOD("set_merge_meshes", "enable"), &GridMap::set_merge_meshes);
+	ClassDB::bind_method(D_METHOD("get_merge_meshes"), &GridMap::get_merge_meshes);
+
 	ClassDB::bind_method(D_METHOD("set_cell_item", "x", "y", "z", "item", "orientation"), &GridMap::set_cell_item, DEFVAL(0));
 	ClassDB::bind_method(D_METHOD("get_cell_item", "x", "y", "z"), &GridMap::get_cell_item);
 	ClassDB::bind_method(D_METHOD("get_cell_item_orientation", "x", "y", "z"), &GridMap::get_cell_item_orientation);
@@ -892,6 +1091,7 @@ void GridMap::_bind_methods() {
 #endif // DISABLE_DEPRECATED
 
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "mesh_library", PROPERTY_HINT_RESOURCE_TYPE, "MeshLibrary"), "set_mesh_library", "get_mesh_library");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "merge_meshes"), "set_merge_meshes", "get_merge_meshes");
 	ADD_GROUP("Cell", "cell_");
 	ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "cell_size"), "set_cell_size", "get_cell_size");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "cell_octant_size", PROPERTY_HINT_RANGE, "1,1024,1"), "set_octant_size", "get_octant_size");
@@ -939,6 +1139,20 @@ float GridMap::get_cell_scale() const {
 	return cell_scale;
 }
 
+void GridMap::set_merge_meshes(bool p_enable) {
+
+	if (merge_meshes == p_enable)
+		return;
+
+	merge_meshes = p_enable;
+	_recreate_octant_data();
+}
+
+bool GridMap::get_merge_meshes() const {
+
+	return merge_meshes;
+}
+
 Array GridMap::get_used_cells() const {
 
 	Array a;
@@ -1004,70 +1218,55 @@ void GridMap::clear_baked_meshes() {
 	_recreate_octant_data();
 }
 
+void GridMap::_octant_bake_thread(uint32_t p_index, OctantBuildData *p_data) {
+
+	OctantBuild &b = p_data->builds[p_index];
+	_merge_cell_meshes(b.octant->cells, *p_data->surfaces, b.merged_arrays, b.merged_materials);
+}
+
 void GridMap::make_baked_meshes(bool p_gen_lightmap_uv, float p_lightmap_uv_texel_size) {
 
 	if (!mesh_library.is_valid())
 		return;
 
 	//generate
-	Map<OctantKey, Map<Ref<Material>, Ref<SurfaceTool> > > surface_map;
-
-	for (Map<IndexKey, Cell>::Element *E = cell_map.front(); E; E = E->next()) {
+	Vector<OctantBuild> builds;
+	Map<int, ItemSurfaces> surfaces;
 
-		IndexKey key = E->key();
-
-		int item = E->get().item;
-		if (!mesh_library->has_item(item))
-			continue;
+	for (Map<OctantKey, Octant *>::Element *E = octant_map.front(); E; E = E->next()) {
 
-		Ref<Mesh> mesh = mesh_library->get_item_mesh(item);
-		if (!mesh.is_valid())
+		if (E->get()->cells.size() == 0)
 			continue;
 
-		Vector3 cellpos = Vector3(key.x, key.y, key.z);
-		Vector3 ofs = _get_offset();
-
-		Transform xform;
-
-		xform.basis.set_orthogonal_index(E->get().rot);
-		xform.set_origin(cellpos * cell_size + ofs);
-		xform.basis.scale(Vector3(cell_scale, cell_scale, cell_scale));
-
-		OctantKey ok;
-		ok.x = key.x / octant_size;
-		ok.y = key.y / octant_size;
-		ok.z = key.z / octant_size;
+		OctantBuild b;
+		b.octant = E->get();
+		builds.push_back(b);
 
-		if (!surface_map.has(ok)) {
-			surface_map[ok] = Map<Ref<Material>, Ref<SurfaceTool> >();
-		}
-
-		Map<Ref<Material>, Ref<SurfaceTool> > &mat_map = surface_map[ok];
-
-		for (int i = 0; i < mesh->get_surface_count(); i++) {
+		_fetch_item_surfaces(E->get()->cells, surfaces);
+	}
 
-			if (mesh->surface_get_primitive_type(i) != Mesh::PRIMITIVE_TRIANGLES)
-				continue;
+	OctantBuildData data;
+	data.builds = builds.ptrw();
+	data.surfaces = &surfaces;
+	data.build_multimeshes = false;
+	data.build_merged = true;
 
-			Ref<Material> surf_mat = mesh->surface_get_material(i);
-			if (!mat_map.has(surf_mat)) {
-				Ref<SurfaceTool> st;
-				st.instance();
-				st->begin(Mesh::PRIMITIVE_TRIANGLES);
-				st->set_material(surf_mat);
-				mat_map[surf_mat] = st;
-			}
+	// every octant is merged on its own, so they can all be done in parallel
+	ThreadWorkPool::get_singleton()->do_work(builds.size(), this, &GridMap::_octant_bake_thread, &data);
 
-			mat_map[surf_mat]->append_from(mesh, i, xform);
-		}
-	}
+	for (int i = 0; i < builds.size(); i++) {
 
-	for (Map<OctantKey, Map<Ref<Material>, Ref<SurfaceTool> > >::Element *E = surface_map.front(); E; E = E->next()) {
+		const OctantBuild &b = builds[i];
+		if (b.merged_arrays.size() == 0)
+			continue;
 
 		Ref<ArrayMesh> mesh;
 		mesh.instance();
-		for (Map<Ref<Material>, Ref<SurfaceTool> >::Element *F = E->get().front(); F; F = F->next()) {
-			F->get()->commit(mesh);
+		for (int j = 0; j < b.merged_arrays.size(); j++) {
+			mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, b.merged_arrays[j]);
+			if (b.merged_materials[j].is_valid()) {
+				mesh->surface_set_material(j, b.merged_materials[j]);
+			}
 		}
 
 		BakedMesh bm;
@@ -1132,6 +1331,7 @@ GridMap::GridMap() {
 	navigation = NULL;
 	set_notify_transform(true);
 	recreating_octants = false;
+	merge_meshes = false;
 }
 
 GridMap::~GridMap() {
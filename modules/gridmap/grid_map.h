@@ -108,6 +108,8 @@ class GridMap : public Spatial {
 		};
 
 		Vector<MultimeshInstance> multimesh_instances;
+		RID merged_mesh; // used instead of multimeshes when merge_meshes is enabled
+		RID merged_instance;
 		Set<IndexKey> cells;
 		RID collision_debug;
 		RID collision_debug_instance;
@@ -154,6 +156,7 @@ class GridMap : public Spatial {
 	int clip_floor;
 
 	bool recreating_octants;
+	bool merge_meshes;
 
 	Vector3::Axis clip_axis;
 
@@ -164,6 +167,55 @@ class GridMap : public Spatial {
 
 	void _recreate_octant_data();
 
+	/**
+	 * @brief Surfaces of a MeshLibrary item, fetched on the main thread so octants can be merged from worker threads.
+	 */
+	struct ItemSurfaces {
+
+		Vector<Array> arrays;
+		Vector<Ref<Material> > materials;
+	};
+
+	/**
+	 * @brief Everything needed to publish a rebuilt Octant, computed on worker threads.
+	 */
+	struct OctantBuild {
+
+		struct MultimeshData {
+			int item;
+			PoolVector<float> transforms; // bulk array layout, 12 floats per instance
+			Vector<Octant::MultimeshInstance::Item> items;
+		};
+
+		struct ShapeData {
+			Ref<Shape> shape;
+			Transform xform;
+		};
+
+		struct NavMeshData {
+			IndexKey key;
+			Ref<NavigationMesh> navmesh;
+			Transform cell_xform;
+			Transform xform;
+		};
+
+		Octant *octant;
+		Vector<MultimeshData> multimeshes;
+		Vector<ShapeData> shapes;
+		Vector<NavMeshData> navmeshes;
+		PoolVector<Vector3> col_debug;
+		Vector<Array> merged_arrays;
+		Vector<Ref<Material> > merged_materials;
+	};
+
+	struct OctantBuildData {
+
+		OctantBuild *builds;
+		const Map<int, ItemSurfaces> *surfaces;
+		bool build_multimeshes;
+		bool build_merged;
+	};
+
 	struct BakeLight {
 
 		VS::LightType type;
@@ -180,9 +232,14 @@ class GridMap : public Spatial {
 	void _reset_physic_bodies_collision_filters();
 	void _octant_enter_world(const OctantKey &p_key);
 	void _octant_exit_world(const OctantKey &p_key);
-	bool _octant_update(const OctantKey &p_key);
 	void _octant_clean_up(const OctantKey &p_key);
 	void _octant_transform(const OctantKey &p_key);
+	void _octant_build_thread(uint32_t p_index, OctantBuildData *p_data);
+	void _octant_bake_thread(uint32_t p_index, OctantBuildData *p_data);
+	void _octant_publish(OctantBuild &p_build);
+	void _fetch_item_surfaces(const Set<IndexKey> &p_cells, Map<int, ItemSurfaces> &r_surfaces) const;
+	void _merge_cell_meshes(const Set<IndexKey> &p_cells, const Map<int, ItemSurfaces> &p_surfaces, Vector<Array> &r_arrays, Vector<Ref<Material> > &r_materials) const;
+	void _free_octant_render_data(Octant &g);
 	bool awaiting_update;
 
 	void _queue_octants_dirty();
@@ -260,6 +317,9 @@ public:
 	void set_cell_scale(float p_scale);
 	float get_cell_scale() const;
 
+	void set_merge_meshes(bool p_enable);
+	bool get_merge_meshes() const;
+
 	Array get_used_cells() const;
 
 	Array get_meshes();
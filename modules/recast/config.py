@@ -1,5 +1,13 @@
 def can_build(env, platform):
-    return env['tools']
+    return True
 
 def configure(env):
     pass
+
+def get_doc_classes():
+    return [
+        "TiledNavigationMeshInstance",
+    ]
+
+def get_doc_path():
+    return "doc_classes"
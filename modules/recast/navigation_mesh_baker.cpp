@@ -0,0 +1,488 @@
+/*************************************************************************/
+/*  navigation_mesh_baker.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "navigation_mesh_baker.h"
+
+#include "core/math/quick_hull.h"
+#include "scene/3d/collision_shape.h"
+#include "scene/3d/mesh_instance.h"
+#include "scene/3d/physics_body.h"
+#include "scene/resources/box_shape.h"
+#include "scene/resources/capsule_shape.h"
+#include "scene/resources/concave_polygon_shape.h"
+#include "scene/resources/convex_polygon_shape.h"
+#include "scene/resources/cylinder_shape.h"
+#include "scene/resources/plane_shape.h"
+#include "scene/resources/primitive_meshes.h"
+#include "scene/resources/shape.h"
+#include "scene/resources/sphere_shape.h"
+
+#include <Recast.h>
+
+#ifdef MODULE_CSG_ENABLED
+#include "modules/csg/csg_shape.h"
+#endif
+
+void NavigationMeshBaker::_add_vertex(const Vector3 &p_vec3, Vector<float> &p_verticies) {
+	p_verticies.push_back(p_vec3.x);
+	p_verticies.push_back(p_vec3.y);
+	p_verticies.push_back(p_vec3.z);
+}
+
+void NavigationMeshBaker::_add_mesh(const Ref<Mesh> &p_mesh, const Transform &p_xform, Vector<float> &p_verticies, Vector<int> &p_indices) {
+	int current_vertex_count = 0;
+
+	for (int i = 0; i < p_mesh->get_surface_count(); i++) {
+		current_vertex_count = p_verticies.size() / 3;
+
+		if (p_mesh->surface_get_primitive_type(i) != Mesh::PRIMITIVE_TRIANGLES)
+			continue;
+
+		int index_count = 0;
+		if (p_mesh->surface_get_format(i) & Mesh::ARRAY_FORMAT_INDEX) {
+			index_count = p_mesh->surface_get_array_index_len(i);
+		} else {
+			index_count = p_mesh->surface_get_array_len(i);
+		}
+
+		ERR_CONTINUE((index_count == 0 || (index_count % 3) != 0));
+
+		int face_count = index_count / 3;
+
+		Array a = p_mesh->surface_get_arrays(i);
+
+		PoolVector<Vector3> mesh_vertices = a[Mesh::ARRAY_VERTEX];
+		PoolVector<Vector3>::Read vr = mesh_vertices.read();
+
+		if (p_mesh->surface_get_format(i) & Mesh::ARRAY_FORMAT_INDEX) {
+
+			PoolVector<int> mesh_indices = a[Mesh::ARRAY_INDEX];
+			PoolVector<int>::Read ir = mesh_indices.read();
+
+			for (int j = 0; j < mesh_vertices.size(); j++) {
+				_add_vertex(p_xform.xform(vr[j]), p_verticies);
+			}
+
+			for (int j = 0; j < face_count; j++) {
+				// CCW
+				p_indices.push_back(current_vertex_count + (ir[j * 3 + 0]));
+				p_indices.push_back(current_vertex_count + (ir[j * 3 + 2]));
+				p_indices.push_back(current_vertex_count + (ir[j * 3 + 1]));
+			}
+		} else {
+			face_count = mesh_vertices.size() / 3;
+			for (int j = 0; j < face_count; j++) {
+				_add_vertex(p_xform.xform(vr[j * 3 + 0]), p_verticies);
+				_add_vertex(p_xform.xform(vr[j * 3 + 2]), p_verticies);
+				_add_vertex(p_xform.xform(vr[j * 3 + 1]), p_verticies);
+
+				p_indices.push_back(current_vertex_count + (j * 3 + 0));
+				p_indices.push_back(current_vertex_count + (j * 3 + 1));
+				p_indices.push_back(current_vertex_count + (j * 3 + 2));
+			}
+		}
+	}
+}
+
+void NavigationMeshBaker::_add_faces(const PoolVector3Array &p_faces, const Transform &p_xform, Vector<float> &p_verticies, Vector<int> &p_indices) {
+	int face_count = p_faces.size() / 3;
+	int current_vertex_count = p_verticies.size() / 3;
+
+	for (int j = 0; j < face_count; j++) {
+		_add_vertex(p_xform.xform(p_faces[j * 3 + 0]), p_verticies);
+		_add_vertex(p_xform.xform(p_faces[j * 3 + 1]), p_verticies);
+		_add_vertex(p_xform.xform(p_faces[j * 3 + 2]), p_verticies);
+
+		p_indices.push_back(current_vertex_count + (j * 3 + 0));
+		p_indices.push_back(current_vertex_count + (j * 3 + 2));
+		p_indices.push_back(current_vertex_count + (j * 3 + 1));
+	}
+}
+
+void NavigationMeshBaker::parse_geometry(Transform p_accumulated_transform, Node *p_node, Vector<float> &p_verticies, Vector<int> &p_indices, int p_generate_from, uint32_t p_collision_mask) {
+
+	if (Object::cast_to<MeshInstance>(p_node) && p_generate_from != NavigationMesh::PARSED_GEOMETRY_STATIC_COLLIDERS) {
+
+		MeshInstance *mesh_instance = Object::cast_to<MeshInstance>(p_node);
+		Ref<Mesh> mesh = mesh_instance->get_mesh();
+		if (mesh.is_valid()) {
+			_add_mesh(mesh, p_accumulated_transform * mesh_instance->get_transform(), p_verticies, p_indices);
+		}
+	}
+
+#ifdef MODULE_CSG_ENABLED
+	if (Object::cast_to<CSGShape>(p_node) && p_generate_from != NavigationMesh::PARSED_GEOMETRY_STATIC_COLLIDERS) {
+
+		CSGShape *csg_shape = Object::cast_to<CSGShape>(p_node);
+		Array meshes = csg_shape->get_meshes();
+		if (!meshes.empty()) {
+			Ref<Mesh> mesh = meshes[1];
+			if (mesh.is_valid()) {
+				_add_mesh(mesh, p_accumulated_transform * csg_shape->get_transform(), p_verticies, p_indices);
+			}
+		}
+	}
+#endif
+
+	if (Object::cast_to<StaticBody>(p_node) && p_generate_from != NavigationMesh::PARSED_GEOMETRY_MESH_INSTANCES) {
+		StaticBody *static_body = Object::cast_to<StaticBody>(p_node);
+
+		if (static_body->get_collision_layer() & p_collision_mask) {
+
+			for (int i = 0; i < p_node->get_child_count(); ++i) {
+				Node *child = p_node->get_child(i);
+				if (Object::cast_to<CollisionShape>(child)) {
+					CollisionShape *col_shape = Object::cast_to<CollisionShape>(child);
+
+					Transform transform = p_accumulated_transform * static_body->get_transform() * col_shape->get_transform();
+
+					Ref<Mesh> mesh;
+					Ref<Shape> s = col_shape->get_shape();
+
+					BoxShape *box = Object::cast_to<BoxShape>(*s);
+					if (box) {
+						Ref<CubeMesh> cube_mesh;
+						cube_mesh.instance();
+						cube_mesh->set_size(box->get_extents() * 2.0);
+						mesh = cube_mesh;
+					}
+
+					CapsuleShape *capsule = Object::cast_to<CapsuleShape>(*s);
+					if (capsule) {
+						Ref<CapsuleMesh> capsule_mesh;
+						capsule_mesh.instance();
+						capsule_mesh->set_radius(capsule->get_radius());
+						capsule_mesh->set_mid_height(capsule->get_height() / 2.0);
+						mesh = capsule_mesh;
+					}
+
+					CylinderShape *cylinder = Object::cast_to<CylinderShape>(*s);
+					if (cylinder) {
+						Ref<CylinderMesh> cylinder_mesh;
+						cylinder_mesh.instance();
+						cylinder_mesh->set_height(cylinder->get_height());
+						cylinder_mesh->set_bottom_radius(cylinder->get_radius());
+						cylinder_mesh->set_top_radius(cylinder->get_radius());
+						mesh = cylinder_mesh;
+					}
+
+					SphereShape *sphere = Object::cast_to<SphereShape>(*s);
+					if (sphere) {
+						Ref<SphereMesh> sphere_mesh;
+						sphere_mesh.instance();
+						sphere_mesh->set_radius(sphere->get_radius());
+						sphere_mesh->set_height(sphere->get_radius() * 2.0);
+						mesh = sphere_mesh;
+					}
+
+					ConcavePolygonShape *concave_polygon = Object::cast_to<ConcavePolygonShape>(*s);
+					if (concave_polygon) {
+						_add_faces(concave_polygon->get_faces(), transform, p_verticies, p_indices);
+					}
+
+					ConvexPolygonShape *convex_polygon = Object::cast_to<ConvexPolygonShape>(*s);
+					if (convex_polygon) {
+						Vector<Vector3> varr = Variant(convex_polygon->get_points());
+						Geometry::MeshData md;
+
+						Error err = QuickHull::build(varr, md);
+
+						if (err == OK) {
+							PoolVector3Array faces;
+
+							for (int j = 0; j < md.faces.size(); ++j) {
+								Geometry::MeshData::Face face = md.faces[j];
+
+								for (int k = 2; k < face.indices.size(); ++k) {
+									faces.push_back(md.vertices[face.indices[0]]);
+									faces.push_back(md.vertices[face.indices[k - 1]]);
+									faces.push_back(md.vertices[face.indices[k]]);
+								}
+							}
+
+							_add_faces(faces, transform, p_verticies, p_indices);
+						}
+					}
+
+					if (mesh.is_valid()) {
+						_add_mesh(mesh, transform, p_verticies, p_indices);
+					}
+				}
+			}
+		}
+	}
+
+	if (Object::cast_to<Spatial>(p_node)) {
+
+		Spatial *spatial = Object::cast_to<Spatial>(p_node);
+		p_accumulated_transform = p_accumulated_transform * spatial->get_transform();
+	}
+
+	for (int i = 0; i < p_node->get_child_count(); i++) {
+		parse_geometry(p_accumulated_transform, p_node->get_child(i), p_verticies, p_indices, p_generate_from, p_collision_mask);
+	}
+}
+
+static void _convert_detail_mesh_to_native_navigation_mesh(const rcPolyMeshDetail *p_detail_mesh, Ref<NavigationMesh> p_nav_mesh) {
+
+	PoolVector<Vector3> nav_vertices;
+
+	for (int i = 0; i < p_detail_mesh->nverts; i++) {
+		const float *v = &p_detail_mesh->verts[i * 3];
+		nav_vertices.append(Vector3(v[0], v[1], v[2]));
+	}
+	p_nav_mesh->set_vertices(nav_vertices);
+
+	for (int i = 0; i < p_detail_mesh->nmeshes; i++) {
+		const unsigned int *m = &p_detail_mesh->meshes[i * 4];
+		const unsigned int bverts = m[0];
+		const unsigned int btris = m[2];
+		const unsigned int ntris = m[3];
+		const unsigned char *tris = &p_detail_mesh->tris[btris * 4];
+		for (unsigned int j = 0; j < ntris; j++) {
+			Vector<int> nav_indices;
+			nav_indices.resize(3);
+			// Polygon order in recast is opposite than godot's
+			nav_indices.write[0] = ((int)(bverts + tris[j * 4 + 0]));
+			nav_indices.write[1] = ((int)(bverts + tris[j * 4 + 2]));
+			nav_indices.write[2] = ((int)(bverts + tris[j * 4 + 1]));
+			p_nav_mesh->add_polygon(nav_indices);
+		}
+	}
+}
+
+
+static void _convert_poly_mesh_to_native_navigation_mesh(const rcPolyMesh *p_poly_mesh, int p_origin_x, int p_origin_y, int p_origin_z, Ref<NavigationMesh> p_nav_mesh) {
+
+	// Vertices are rebuilt from whole cells, so every tile computes the exact same position for a shared vertex.
+	PoolVector<Vector3> nav_vertices;
+	nav_vertices.resize(p_poly_mesh->nverts);
+	{
+		PoolVector<Vector3>::Write w = nav_vertices.write();
+		for (int i = 0; i < p_poly_mesh->nverts; i++) {
+			const unsigned short *v = &p_poly_mesh->verts[i * 3];
+			w[i] = Vector3((p_origin_x + v[0]) * p_poly_mesh->cs, (p_origin_y + v[1]) * p_poly_mesh->ch, (p_origin_z + v[2]) * p_poly_mesh->cs);
+		}
+	}
+	p_nav_mesh->set_vertices(nav_vertices);
+
+	const int nvp = p_poly_mesh->nvp;
+	for (int i = 0; i < p_poly_mesh->npolys; i++) {
+
+		const unsigned short *p = &p_poly_mesh->polys[i * nvp * 2];
+		int count = 0;
+		while (count < nvp && p[count] != RC_MESH_NULL_IDX) {
+			count++;
+		}
+
+		Vector<int> nav_indices;
+		nav_indices.resize(count);
+		// Polygon order in recast is opposite than godot's
+		for (int j = 0; j < count; j++) {
+			nav_indices.write[j] = p[count - 1 - j];
+		}
+		p_nav_mesh->add_polygon(nav_indices);
+	}
+}
+
+struct _RecastBuildData {
+
+	rcHeightfield *hf;
+	rcCompactHeightfield *chf;
+	rcContourSet *cset;
+	rcPolyMesh *poly_mesh;
+	rcPolyMeshDetail *detail_mesh;
+
+	_RecastBuildData() {
+		hf = NULL;
+		chf = NULL;
+		cset = NULL;
+		poly_mesh = NULL;
+		detail_mesh = NULL;
+	}
+
+	~_RecastBuildData() {
+		rcFreeHeightField(hf);
+		rcFreeCompactHeightfield(chf);
+		rcFreeContourSet(cset);
+		rcFreePolyMesh(poly_mesh);
+		rcFreePolyMeshDetail(detail_mesh);
+	}
+};
+
+#define BUILD_STEP(m_step)                   \
+	if (p_step_callback) {                   \
+		p_step_callback(p_userdata, m_step); \
+	}
+
+bool NavigationMeshBaker::build(const Ref<NavigationMesh> &p_settings, const Vector<float> &p_verticies, const Vector<int> &p_indices, Ref<NavigationMesh> p_nav_mesh, const AABB *p_tile_bounds, StepCallback p_step_callback, void *p_userdata) {
+
+	ERR_FAIL_COND_V(p_settings.is_null(), false);
+	ERR_FAIL_COND_V(p_nav_mesh.is_null(), false);
+
+	rcContext ctx;
+	_RecastBuildData data;
+	BUILD_STEP(STEP_CONFIGURATION);
+
+	const float *verts = p_verticies.ptr();
+	const int nverts = p_verticies.size() / 3;
+	const int *tris = p_indices.ptr();
+	const int ntris = p_indices.size() / 3;
+
+	ERR_FAIL_COND_V(ntris == 0, false);
+
+	rcConfig cfg;
+	memset(&cfg, 0, sizeof(cfg));
+
+	cfg.cs = p_settings->get_cell_size();
+	cfg.ch = p_settings->get_cell_height();
+	cfg.walkableSlopeAngle = p_settings->get_agent_max_slope();
+	cfg.walkableHeight = (int)Math::ceil(p_settings->get_agent_height() / cfg.ch);
+	cfg.walkableClimb = (int)Math::floor(p_settings->get_agent_max_climb() / cfg.ch);
+	cfg.walkableRadius = (int)Math::ceil(p_settings->get_agent_radius() / cfg.cs);
+	cfg.maxEdgeLen = (int)(p_settings->get_edge_max_length() / p_settings->get_cell_size());
+	cfg.maxSimplificationError = p_settings->get_edge_max_error();
+	cfg.minRegionArea = (int)(p_settings->get_region_min_size() * p_settings->get_region_min_size());
+	cfg.mergeRegionArea = (int)(p_settings->get_region_merge_size() * p_settings->get_region_merge_size());
+	cfg.maxVertsPerPoly = (int)p_settings->get_verts_per_poly();
+	cfg.detailSampleDist = p_settings->get_detail_sample_distance() < 0.9f ? 0 : p_settings->get_cell_size() * p_settings->get_detail_sample_distance();
+	cfg.detailSampleMaxError = p_settings->get_cell_height() * p_settings->get_detail_sample_max_error();
+
+	int tile_x = 0;
+	int tile_y = 0;
+	int tile_z = 0;
+
+	BUILD_STEP(STEP_GRID_SIZE);
+
+	if (p_tile_bounds) {
+
+		// The border lets the tile see the geometry around it, so erosion and regions match its neighbours.
+		tile_x = (int)Math::round(p_tile_bounds->position.x / cfg.cs);
+		tile_y = (int)Math::round(p_tile_bounds->position.y / cfg.ch);
+		tile_z = (int)Math::round(p_tile_bounds->position.z / cfg.cs);
+		cfg.tileSize = (int)Math::round(p_tile_bounds->size.x / cfg.cs);
+		cfg.borderSize = cfg.walkableRadius + 3;
+		cfg.width = cfg.tileSize + cfg.borderSize * 2;
+		cfg.height = (int)Math::round(p_tile_bounds->size.z / cfg.cs) + cfg.borderSize * 2;
+
+		cfg.bmin[0] = (tile_x - cfg.borderSize) * cfg.cs;
+		cfg.bmin[1] = tile_y * cfg.ch;
+		cfg.bmin[2] = (tile_z - cfg.borderSize) * cfg.cs;
+		cfg.bmax[0] = (tile_x + cfg.width - cfg.borderSize) * cfg.cs;
+		cfg.bmax[1] = p_tile_bounds->position.y + p_tile_bounds->size.y;
+		cfg.bmax[2] = (tile_z + cfg.height - cfg.borderSize) * cfg.cs;
+	} else {
+
+		rcCalcBounds(verts, nverts, cfg.bmin, cfg.bmax);
+		rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
+	}
+
+	BUILD_STEP(STEP_HEIGHTFIELD);
+	data.hf = rcAllocHeightfield();
+
+	ERR_FAIL_COND_V(!data.hf, false);
+	ERR_FAIL_COND_V(!rcCreateHeightfield(&ctx, *data.hf, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch), false);
+
+	BUILD_STEP(STEP_MARK_WALKABLE);
+	{
+		Vector<unsigned char> tri_areas;
+		tri_areas.resize(ntris);
+
+		ERR_FAIL_COND_V(tri_areas.size() == 0, false);
+
+		memset(tri_areas.ptrw(), 0, ntris * sizeof(unsigned char));
+		rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, verts, nverts, tris, ntris, tri_areas.ptrw());
+
+		ERR_FAIL_COND_V(!rcRasterizeTriangles(&ctx, verts, nverts, tris, tri_areas.ptr(), ntris, *data.hf, cfg.walkableClimb), false);
+	}
+
+	if (p_settings->get_filter_low_hanging_obstacles())
+		rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *data.hf);
+	if (p_settings->get_filter_ledge_spans())
+		rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *data.hf);
+	if (p_settings->get_filter_walkable_low_height_spans())
+		rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *data.hf);
+
+	BUILD_STEP(STEP_COMPACT_HEIGHTFIELD);
+
+	data.chf = rcAllocCompactHeightfield();
+
+	ERR_FAIL_COND_V(!data.chf, false);
+	ERR_FAIL_COND_V(!rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *data.hf, *data.chf), false);
+
+	rcFreeHeightField(data.hf);
+	data.hf = NULL;
+
+	BUILD_STEP(STEP_ERODE);
+	ERR_FAIL_COND_V(!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *data.chf), false);
+
+	BUILD_STEP(STEP_PARTITION);
+	if (p_settings->get_sample_partition_type() == NavigationMesh::SAMPLE_PARTITION_WATERSHED) {
+		ERR_FAIL_COND_V(!rcBuildDistanceField(&ctx, *data.chf), false);
+		ERR_FAIL_COND_V(!rcBuildRegions(&ctx, *data.chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea), false);
+	} else if (p_settings->get_sample_partition_type() == NavigationMesh::SAMPLE_PARTITION_MONOTONE) {
+		ERR_FAIL_COND_V(!rcBuildRegionsMonotone(&ctx, *data.chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea), false);
+	} else {
+		ERR_FAIL_COND_V(!rcBuildLayerRegions(&ctx, *data.chf, cfg.borderSize, cfg.minRegionArea), false);
+	}
+
+	BUILD_STEP(STEP_CONTOURS);
+
+	data.cset = rcAllocContourSet();
+
+	ERR_FAIL_COND_V(!data.cset, false);
+	ERR_FAIL_COND_V(!rcBuildContours(&ctx, *data.chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *data.cset), false);
+
+	BUILD_STEP(STEP_POLYMESH);
+
+	data.poly_mesh = rcAllocPolyMesh();
+	ERR_FAIL_COND_V(!data.poly_mesh, false);
+	ERR_FAIL_COND_V(!rcBuildPolyMesh(&ctx, *data.cset, cfg.maxVertsPerPoly, *data.poly_mesh), false);
+
+	if (p_tile_bounds) {
+
+		// Detail meshes sample heights inside each tile and would break the seams, tiles use the polygons as is.
+		BUILD_STEP(STEP_CONVERT);
+		_convert_poly_mesh_to_native_navigation_mesh(data.poly_mesh, tile_x, tile_y, tile_z, p_nav_mesh);
+		return true;
+	}
+
+	data.detail_mesh = rcAllocPolyMeshDetail();
+	ERR_FAIL_COND_V(!data.detail_mesh, false);
+	ERR_FAIL_COND_V(!rcBuildPolyMeshDetail(&ctx, *data.poly_mesh, *data.chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *data.detail_mesh), false);
+
+	BUILD_STEP(STEP_CONVERT);
+
+	_convert_detail_mesh_to_native_navigation_mesh(data.detail_mesh, p_nav_mesh);
+
+	return true;
+}
+
+#undef BUILD_STEP
@@ -0,0 +1,73 @@
+/*************************************************************************/
+/*  navigation_mesh_baker.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef NAVIGATION_MESH_BAKER_H
+#define NAVIGATION_MESH_BAKER_H
+
+#include "scene/3d/navigation_mesh.h"
+
+/**
+	Recast navigation mesh building, shared by the editor baker and by
+	TiledNavigationMeshInstance at runtime. Nothing here touches the scene
+	except parse_geometry(), so build() may run on any thread.
+*/
+
+class NavigationMeshBaker {
+
+	static void _add_vertex(const Vector3 &p_vec3, Vector<float> &p_verticies);
+	static void _add_mesh(const Ref<Mesh> &p_mesh, const Transform &p_xform, Vector<float> &p_verticies, Vector<int> &p_indices);
+	static void _add_faces(const PoolVector3Array &p_faces, const Transform &p_xform, Vector<float> &p_verticies, Vector<int> &p_indices);
+
+public:
+	enum BuildStep {
+		STEP_CONFIGURATION = 1,
+		STEP_GRID_SIZE,
+		STEP_HEIGHTFIELD,
+		STEP_MARK_WALKABLE,
+		STEP_COMPACT_HEIGHTFIELD,
+		STEP_ERODE,
+		STEP_PARTITION,
+		STEP_CONTOURS,
+		STEP_POLYMESH,
+		STEP_CONVERT,
+	};
+
+	typedef void (*StepCallback)(void *p_userdata, BuildStep p_step);
+
+	static void parse_geometry(Transform p_accumulated_transform, Node *p_node, Vector<float> &p_verticies, Vector<int> &p_indices, int p_generate_from, uint32_t p_collision_mask);
+
+	// Builds p_nav_mesh from the geometry, using the agent and sampling settings of p_settings.
+	// With p_tile_bounds, only that tile is built, with a border around it so it joins its
+	// neighbours. Tile bounds must be aligned to the cell size, tile vertices are snapped
+	// to the cell grid so the vertices along shared borders match exactly.
+	static bool build(const Ref<NavigationMesh> &p_settings, const Vector<float> &p_verticies, const Vector<int> &p_indices, Ref<NavigationMesh> p_nav_mesh, const AABB *p_tile_bounds = NULL, StepCallback p_step_callback = NULL, void *p_userdata = NULL);
+};
+
+#endif // NAVIGATION_MESH_BAKER_H
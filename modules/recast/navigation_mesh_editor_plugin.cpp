@@ -30,6 +30,8 @@
 
 #include "navigation_mesh_editor_plugin.h"
 
+#ifdef TOOLS_ENABLED
+
 #include "core/io/marshalls.h"
 #include "core/io/resource_saver.h"
 #include "scene/3d/mesh_instance.h"
@@ -160,3 +162,5 @@ NavigationMeshEditorPlugin::NavigationMeshEditorPlugin(EditorNode *p_node) {
 
 NavigationMeshEditorPlugin::~NavigationMeshEditorPlugin() {
 }
+
+#endif // TOOLS_ENABLED
@@ -31,11 +31,12 @@
 #ifndef NAVIGATION_MESH_GENERATOR_H
 #define NAVIGATION_MESH_GENERATOR_H
 
+#ifdef TOOLS_ENABLED
+
 #include "editor/editor_node.h"
+#include "navigation_mesh_baker.h"
 #include "scene/3d/navigation_mesh.h"
 
-#include <Recast.h>
-
 class EditorNavigationMeshGenerator : public Object {
 	GDCLASS(EditorNavigationMeshGenerator, Object);
 
@@ -44,15 +45,7 @@ class EditorNavigationMeshGenerator : public Object {
 protected:
 	static void _bind_methods();
 
-	static void _add_vertex(const Vector3 &p_vec3, Vector<float> &p_verticies);
-	static void _add_mesh(const Ref<Mesh> &p_mesh, const Transform &p_xform, Vector<float> &p_verticies, Vector<int> &p_indices);
-	static void _add_faces(const PoolVector3Array &p_faces, const Transform &p_xform, Vector<float> &p_verticies, Vector<int> &p_indices);
-	static void _parse_geometry(Transform p_accumulated_transform, Node *p_node, Vector<float> &p_verticies, Vector<int> &p_indices, int p_generate_from, uint32_t p_collision_mask);
-
-	static void _convert_detail_mesh_to_native_navigation_mesh(const rcPolyMeshDetail *p_detail_mesh, Ref<NavigationMesh> p_nav_mesh);
-	static void _build_recast_navigation_mesh(Ref<NavigationMesh> p_nav_mesh, EditorProgress *ep,
-			rcHeightfield *hf, rcCompactHeightfield *chf, rcContourSet *cset, rcPolyMesh *poly_mesh,
-			rcPolyMeshDetail *detail_mesh, Vector<float> &vertices, Vector<int> &indices);
+	static void _bake_step(void *p_userdata, NavigationMeshBaker::BuildStep p_step);
 
 public:
 	static EditorNavigationMeshGenerator *get_singleton();
@@ -64,4 +57,6 @@ public:
 	void clear(Ref<NavigationMesh> p_nav_mesh);
 };
 
+#endif // TOOLS_ENABLED
+
 #endif // NAVIGATION_MESH_GENERATOR_H
@@ -30,13 +30,19 @@
 
 #include "register_types.h"
 
+#include "core/class_db.h"
 #include "navigation_mesh_editor_plugin.h"
+#include "tiled_navigation_mesh_instance.h"
 
 #ifdef TOOLS_ENABLED
 EditorNavigationMeshGenerator *_nav_mesh_generator = NULL;
 #endif
 
 void register_recast_types() {
+#ifndef _3D_DISABLED
+	ClassDB::register_class<TiledNavigationMeshInstance>();
+#endif
+
 #ifdef TOOLS_ENABLED
 	EditorPlugins::add_by_type<NavigationMeshEditorPlugin>();
 	_nav_mesh_generator = memnew(EditorNavigationMeshGenerator);
@@ -0,0 +1,576 @@
+/*************************************************************************/
+/*  tiled_navigation_mesh_instance.cpp                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "tiled_navigation_mesh_instance.h"
+
+#include "core/hashfuncs.h"
+#include "core/os/thread_work_pool.h"
+#include "navigation_mesh_baker.h"
+
+float TiledNavigationMeshInstance::_get_snapped_tile_size() const {
+
+	// Tiles must start on a cell, so neighbours sample the same grid.
+	float cell_size = navmesh->get_cell_size();
+	return MAX(1, (int)Math::round(tile_size / cell_size)) * cell_size;
+}
+
+void TiledNavigationMeshInstance::_add_tile(Tile &p_tile) {
+
+	if (navigation && p_tile.navmesh.is_valid() && p_tile.nav_id == -1) {
+		p_tile.nav_id = navigation->navmesh_add(p_tile.navmesh, get_relative_transform(navigation), this);
+	}
+}
+
+void TiledNavigationMeshInstance::_remove_tile(Tile &p_tile) {
+
+	if (navigation && p_tile.nav_id != -1) {
+		navigation->navmesh_remove(p_tile.nav_id);
+	}
+	p_tile.nav_id = -1;
+}
+
+uint32_t TiledNavigationMeshInstance::_hash_settings() const {
+
+	// Anything that changes how a tile is built, so tiles built with other settings are not kept.
+	uint32_t h = hash_djb2_one_float(_get_snapped_tile_size());
+	h = hash_djb2_one_float(bake_settings->get_cell_size(), h);
+	h = hash_djb2_one_float(bake_settings->get_cell_height(), h);
+	h = hash_djb2_one_float(bake_settings->get_agent_height(), h);
+	h = hash_djb2_one_float(bake_settings->get_agent_radius(), h);
+	h = hash_djb2_one_float(bake_settings->get_agent_max_climb(), h);
+	h = hash_djb2_one_float(bake_settings->get_agent_max_slope(), h);
+	h = hash_djb2_one_float(bake_settings->get_region_min_size(), h);
+	h = hash_djb2_one_float(bake_settings->get_region_merge_size(), h);
+	h = hash_djb2_one_float(bake_settings->get_edge_max_length(), h);
+	h = hash_djb2_one_float(bake_settings->get_edge_max_error(), h);
+	h = hash_djb2_one_float(bake_settings->get_verts_per_poly(), h);
+	h = hash_djb2_one_float(bake_settings->get_detail_sample_distance(), h);
+	h = hash_djb2_one_float(bake_settings->get_detail_sample_max_error(), h);
+	h = hash_djb2_one_32(bake_settings->get_sample_partition_type(), h);
+	h = hash_djb2_one_32(bake_settings->get_filter_low_hanging_obstacles(), h);
+	h = hash_djb2_one_32(bake_settings->get_filter_ledge_spans(), h);
+	h = hash_djb2_one_32(bake_settings->get_filter_walkable_low_height_spans(), h);
+	return h;
+}
+
+// Vertices of p_navmesh on a tile border line, by cell along the line. Points already in r_points are kept.
+static void _get_border_points(const Ref<NavigationMesh> &p_navmesh, int p_axis, int p_line, float p_cell_size, Map<int, Vector3> &r_points) {
+
+	int along = p_axis == 0 ? 2 : 0;
+	PoolVector<Vector3> vertices = p_navmesh->get_vertices();
+	PoolVector<Vector3>::Read r = vertices.read();
+	for (int i = 0; i < vertices.size(); i++) {
+		if ((int)Math::round(r[i][p_axis] / p_cell_size) == p_line) {
+			int t = (int)Math::round(r[i][along] / p_cell_size);
+			if (!r_points.has(t)) {
+				r_points[t] = r[i];
+			}
+		}
+	}
+}
+
+// Splits the edges of p_navmesh lying on the border line at every point of p_points, and moves its
+// border vertices onto the matching points, so both sides of the border have the exact same edges.
+static bool _stitch_border(Ref<NavigationMesh> p_navmesh, int p_axis, int p_line, float p_cell_size, const Map<int, Vector3> &p_points) {
+
+	int along = p_axis == 0 ? 2 : 0;
+	PoolVector<Vector3> vertices = p_navmesh->get_vertices();
+	bool changed = false;
+
+	Map<int, int> border_vertices; // cell along the line -> vertex index
+	Vector<int> line_pos; // cell along the line for each vertex, or INT32_MIN if not on it
+	line_pos.resize(vertices.size());
+	{
+		PoolVector<Vector3>::Write w = vertices.write();
+		for (int i = 0; i < vertices.size(); i++) {
+
+			line_pos.write[i] = INT32_MIN;
+			if ((int)Math::round(w[i][p_axis] / p_cell_size) != p_line)
+				continue;
+
+			int t = (int)Math::round(w[i][along] / p_cell_size);
+			line_pos.write[i] = t;
+			border_vertices[t] = i;
+
+			const Map<int, Vector3>::Element *P = p_points.find(t);
+			if (P && P->get() != w[i]) {
+				w[i] = P->get();
+				changed = true;
+			}
+		}
+	}
+
+	Vector<Vector<int> > polygons;
+	for (int i = 0; i < p_navmesh->get_polygon_count(); i++) {
+
+		Vector<int> polygon = p_navmesh->get_polygon(i);
+		Vector<int> stitched;
+
+		for (int j = 0; j < polygon.size(); j++) {
+
+			int a = polygon[j];
+			int b = polygon[(j + 1) % polygon.size()];
+			stitched.push_back(a);
+
+			if (a < 0 || b < 0 || a >= line_pos.size() || b >= line_pos.size() || line_pos[a] == INT32_MIN || line_pos[b] == INT32_MIN)
+				continue; // not along the border
+
+			int from = MIN(line_pos[a], line_pos[b]);
+			int to = MAX(line_pos[a], line_pos[b]);
+
+			Vector<int> split;
+			const Map<int, Vector3>::Element *P = p_points.find_closest(from);
+			P = P ? P->next() : p_points.front();
+			for (; P && P->key() < to; P = P->next()) {
+
+				Map<int, int>::Element *V = border_vertices.find(P->key());
+				if (!V) {
+					V = border_vertices.insert(P->key(), vertices.size());
+					vertices.push_back(P->get());
+					line_pos.push_back(P->key());
+				}
+				split.push_back(V->get());
+			}
+
+			if (split.empty())
+				continue;
+
+			if (line_pos[a] > line_pos[b]) {
+				split.invert();
+			}
+			stitched.append_array(split);
+			changed = true;
+		}
+
+		polygons.push_back(stitched);
+	}
+
+	if (changed) {
+		p_navmesh->set_vertices(vertices);
+		p_navmesh->clear_polygons();
+		for (int i = 0; i < polygons.size(); i++) {
+			p_navmesh->add_polygon(polygons[i]);
+		}
+	}
+
+	return changed;
+}
+
+// Tiles are built on their own, so a border can be split differently on each side. Navigation only links
+// edges with identical end points, so the edges on the shared border are split at the vertices of both sides.
+bool TiledNavigationMeshInstance::_stitch_tiles(const TileKey &p_a, const TileKey &p_b) {
+
+	Map<TileKey, Tile>::Element *A = tiles.find(p_a);
+	Map<TileKey, Tile>::Element *B = tiles.find(p_b);
+	if (!A || !B || A->get().navmesh.is_null() || B->get().navmesh.is_null())
+		return false;
+
+	// The settings the tiles were built with, the navmesh could have been edited since.
+	float cell_size = bake_settings->get_cell_size();
+	int tile_cells = MAX(1, (int)Math::round(tile_size / cell_size));
+
+	// p_b is the tile after p_a, on x or on z
+	int axis = p_b.x != p_a.x ? 0 : 2;
+	int line = (axis == 0 ? p_b.x : p_b.z) * tile_cells;
+
+	Map<int, Vector3> points;
+	_get_border_points(A->get().navmesh, axis, line, cell_size, points);
+	_get_border_points(B->get().navmesh, axis, line, cell_size, points);
+
+	bool changed = _stitch_border(A->get().navmesh, axis, line, cell_size, points);
+	changed = _stitch_border(B->get().navmesh, axis, line, cell_size, points) || changed;
+	return changed;
+}
+
+void TiledNavigationMeshInstance::bake() {
+
+	ERR_FAIL_COND(navmesh.is_null());
+
+	if (baking) {
+		bake_pending = true;
+		return;
+	}
+
+	Vector<float> vertices;
+	Vector<int> indices;
+	NavigationMeshBaker::parse_geometry(get_transform().affine_inverse(), this, vertices, indices, navmesh->get_parsed_geometry_type(), navmesh->get_collision_mask());
+
+	bake_settings = navmesh->duplicate();
+
+	float size = _get_snapped_tile_size();
+	// Same border as the tile build, so a tile gets every triangle it rasterizes.
+	float border = ((int)Math::ceil(bake_settings->get_agent_radius() / bake_settings->get_cell_size()) + 3) * bake_settings->get_cell_size();
+
+	Map<TileKey, TileBuild> inputs;
+	float min_y = 1e20;
+	float max_y = -1e20;
+
+	const float *v = vertices.ptr();
+	const int *idx = indices.ptr();
+	for (int i = 0; i + 2 < indices.size(); i += 3) {
+
+		const float *a = &v[idx[i + 0] * 3];
+		const float *b = &v[idx[i + 1] * 3];
+		const float *c = &v[idx[i + 2] * 3];
+
+		min_y = MIN(min_y, MIN(a[1], MIN(b[1], c[1])));
+		max_y = MAX(max_y, MAX(a[1], MAX(b[1], c[1])));
+
+		int from_x = (int)Math::floor((MIN(a[0], MIN(b[0], c[0])) - border) / size);
+		int to_x = (int)Math::floor((MAX(a[0], MAX(b[0], c[0])) + border) / size);
+		int from_z = (int)Math::floor((MIN(a[2], MIN(b[2], c[2])) - border) / size);
+		int to_z = (int)Math::floor((MAX(a[2], MAX(b[2], c[2])) + border) / size);
+
+		for (int x = from_x; x <= to_x; x++) {
+			for (int z = from_z; z <= to_z; z++) {
+
+				TileKey key;
+				key.x = x;
+				key.z = z;
+				Vector<float> &tile_vertices = inputs[key].vertices;
+				for (int j = 0; j < 3; j++) {
+					tile_vertices.push_back(a[j]);
+				}
+				for (int j = 0; j < 3; j++) {
+					tile_vertices.push_back(b[j]);
+				}
+				for (int j = 0; j < 3; j++) {
+					tile_vertices.push_back(c[j]);
+				}
+			}
+		}
+	}
+
+	// All tiles share a vertical range aligned to the cell height, so tiles rebuilt later still line up.
+	float cell_height = bake_settings->get_cell_height();
+	float base_y = Math::floor(min_y / cell_height) * cell_height;
+	float height = max_y - base_y + cell_height;
+	uint32_t settings_hash = _hash_settings();
+
+	for (Map<TileKey, TileBuild>::Element *E = inputs.front(); E; E = E->next()) {
+
+		TileBuild &build = E->get();
+		build.key = E->key();
+		build.hash = hash_djb2_buffer((const uint8_t *)build.vertices.ptr(), build.vertices.size() * sizeof(float), settings_hash);
+
+		Map<TileKey, Tile>::Element *T = tiles.find(build.key);
+		if (T && T->get().hash == build.hash)
+			continue; //geometry did not change
+
+		build.bounds = AABB(Vector3(build.key.x * size, base_y, build.key.z * size), Vector3(size, height, size));
+		tile_builds.push_back(build);
+	}
+
+	for (Map<TileKey, Tile>::Element *E = tiles.front(); E; E = E->next()) {
+
+		if (!inputs.has(E->key())) {
+			tile_removes.push_back(E->key());
+		}
+	}
+
+	baking = true;
+	build_version = bake_version;
+
+#ifdef NO_THREADS
+	for (int i = 0; i < tile_builds.size(); i++) {
+		_build_tile(i, tile_builds.ptrw());
+	}
+	_bake_finished();
+#else
+	if (!bake_pool) {
+		bake_pool = memnew(ThreadWorkPool);
+		bake_pool->init();
+	}
+	bake_thread = Thread::create(&TiledNavigationMeshInstance::_bake_thread_function, this);
+#endif
+}
+
+void TiledNavigationMeshInstance::_bake_thread_function(void *p_user) {
+
+	TiledNavigationMeshInstance *instance = (TiledNavigationMeshInstance *)p_user;
+
+	instance->bake_pool->do_work(instance->tile_builds.size(), instance, &TiledNavigationMeshInstance::_build_tile, instance->tile_builds.ptrw());
+	instance->call_deferred("_bake_finished");
+}
+
+void TiledNavigationMeshInstance::_build_tile(uint32_t p_index, TileBuild *p_builds) {
+
+	TileBuild &build = p_builds[p_index];
+
+	Vector<int> indices;
+	indices.resize(build.vertices.size() / 3);
+	for (int i = 0; i < indices.size(); i++) {
+		indices.write[i] = i;
+	}
+
+	Ref<NavigationMesh> tile_navmesh;
+	tile_navmesh.instance();
+	if (NavigationMeshBaker::build(bake_settings, build.vertices, indices, tile_navmesh, &build.bounds)) {
+		build.navmesh = tile_navmesh;
+	}
+}
+
+void TiledNavigationMeshInstance::_bake_finished() {
+
+	if (bake_thread) {
+		Thread::wait_to_finish(bake_thread);
+		memdelete(bake_thread);
+		bake_thread = NULL;
+	}
+
+	baking = false;
+
+	if (build_version == bake_version) {
+
+		//swap the rebuilt tiles in, the rest of the navigation stays untouched
+
+		for (int i = 0; i < tile_removes.size(); i++) {
+
+			Map<TileKey, Tile>::Element *E = tiles.find(tile_removes[i]);
+			if (E) {
+				_remove_tile(E->get());
+				tiles.erase(E);
+			}
+		}
+
+		for (int i = 0; i < tile_builds.size(); i++) {
+
+			const TileBuild &build = tile_builds[i];
+			Tile &tile = tiles[build.key];
+			_remove_tile(tile);
+			tile.navmesh = build.navmesh;
+			tile.hash = build.navmesh.is_valid() ? build.hash : 0; // failed tiles are retried on the next bake
+		}
+
+		// Join the new tiles to their neighbours, untouched neighbours that had to be split are added again.
+		Set<TileKey> changed;
+		for (int i = 0; i < tile_builds.size(); i++) {
+
+			const TileKey &key = tile_builds[i].key;
+			TileKey neighbours[4] = { key, key, key, key };
+			neighbours[0].x--;
+			neighbours[1].x++;
+			neighbours[2].z--;
+			neighbours[3].z++;
+
+			for (int j = 0; j < 4; j++) {
+				bool before = j % 2 == 0;
+				if (_stitch_tiles(before ? neighbours[j] : key, before ? key : neighbours[j])) {
+					changed.insert(neighbours[j]);
+				}
+			}
+		}
+
+		for (int i = 0; i < tile_builds.size(); i++) {
+			changed.erase(tile_builds[i].key);
+			_add_tile(tiles[tile_builds[i].key]);
+		}
+
+		for (Set<TileKey>::Element *E = changed.front(); E; E = E->next()) {
+			Tile &tile = tiles[E->get()];
+			_remove_tile(tile);
+			_add_tile(tile);
+		}
+	}
+
+	tile_builds.clear();
+	tile_removes.clear();
+	bake_settings.unref();
+
+	emit_signal("bake_finished");
+
+	if (bake_pending) {
+		bake_pending = false;
+		bake();
+	}
+}
+
+void TiledNavigationMeshInstance::clear() {
+
+	for (Map<TileKey, Tile>::Element *E = tiles.front(); E; E = E->next()) {
+		_remove_tile(E->get());
+	}
+	tiles.clear();
+
+	bake_version++;
+	bake_pending = false;
+}
+
+bool TiledNavigationMeshInstance::is_baking() const {
+
+	return baking;
+}
+
+int TiledNavigationMeshInstance::get_tile_count() const {
+
+	return tiles.size();
+}
+
+void TiledNavigationMeshInstance::set_navigation_mesh(const Ref<NavigationMesh> &p_navmesh) {
+
+	if (p_navmesh == navmesh)
+		return;
+
+	clear();
+	navmesh = p_navmesh;
+	update_configuration_warning();
+}
+
+Ref<NavigationMesh> TiledNavigationMeshInstance::get_navigation_mesh() const {
+
+	return navmesh;
+}
+
+void TiledNavigationMeshInstance::set_tile_size(float p_size) {
+
+	ERR_FAIL_COND(p_size <= 0);
+	if (p_size == tile_size)
+		return;
+
+	clear();
+	tile_size = p_size;
+}
+
+float TiledNavigationMeshInstance::get_tile_size() const {
+
+	return tile_size;
+}
+
+void TiledNavigationMeshInstance::_notification(int p_what) {
+
+	switch (p_what) {
+		case NOTIFICATION_ENTER_TREE: {
+
+			Spatial *c = this;
+			while (c) {
+
+				navigation = Object::cast_to<Navigation>(c);
+				if (navigation) {
+
+					for (Map<TileKey, Tile>::Element *E = tiles.front(); E; E = E->next()) {
+						_add_tile(E->get());
+					}
+					break;
+				}
+
+				c = c->get_parent_spatial();
+			}
+
+		} break;
+		case NOTIFICATION_TRANSFORM_CHANGED: {
+
+			if (navigation) {
+
+				Transform xform = get_relative_transform(navigation);
+				for (Map<TileKey, Tile>::Element *E = tiles.front(); E; E = E->next()) {
+					if (E->get().nav_id != -1) {
+						navigation->navmesh_set_transform(E->get().nav_id, xform);
+					}
+				}
+			}
+
+		} break;
+		case NOTIFICATION_EXIT_TREE: {
+
+			if (navigation) {
+
+				for (Map<TileKey, Tile>::Element *E = tiles.front(); E; E = E->next()) {
+					_remove_tile(E->get());
+				}
+			}
+			navigation = NULL;
+		} break;
+	}
+}
+
+String TiledNavigationMeshInstance::get_configuration_warning() const {
+
+	if (!is_visible_in_tree() || !is_inside_tree())
+		return String();
+
+	if (!navmesh.is_valid()) {
+		return TTR("A NavigationMesh resource must be set or created for this node to work. Only its bake settings are used.");
+	}
+	const Spatial *c = this;
+	while (c) {
+
+		if (Object::cast_to<Navigation>(c))
+			return String();
+
+		c = Object::cast_to<Spatial>(c->get_parent());
+	}
+
+	return TTR("TiledNavigationMeshInstance must be a child or grandchild to a Navigation node. It only provides navigation data.");
+}
+
+void TiledNavigationMeshInstance::_bind_methods() {
+
+	ClassDB::bind_method(D_METHOD("set_navigation_mesh", "navmesh"), &TiledNavigationMeshInstance::set_navigation_mesh);
+	ClassDB::bind_method(D_METHOD("get_navigation_mesh"), &TiledNavigationMeshInstance::get_navigation_mesh);
+
+	ClassDB::bind_method(D_METHOD("set_tile_size", "size"), &TiledNavigationMeshInstance::set_tile_size);
+	ClassDB::bind_method(D_METHOD("get_tile_size"), &TiledNavigationMeshInstance::get_tile_size);
+
+	ClassDB::bind_method(D_METHOD("bake"), &TiledNavigationMeshInstance::bake);
+	ClassDB::bind_method(D_METHOD("clear"), &TiledNavigationMeshInstance::clear);
+	ClassDB::bind_method(D_METHOD("is_baking"), &TiledNavigationMeshInstance::is_baking);
+	ClassDB::bind_method(D_METHOD("get_tile_count"), &TiledNavigationMeshInstance::get_tile_count);
+
+	ClassDB::bind_method(D_METHOD("_bake_finished"), &TiledNavigationMeshInstance::_bake_finished);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "navmesh", PROPERTY_HINT_RESOURCE_TYPE, "NavigationMesh"), "set_navigation_mesh", "get_navigation_mesh");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "tile_size", PROPERTY_HINT_RANGE, "1,1024,0.1,or_greater"), "set_tile_size", "get_tile_size");
+
+	ADD_SIGNAL(MethodInfo("bake_finished"));
+}
+
+TiledNavigationMeshInstance::TiledNavigationMeshInstance() {
+
+	tile_size = 32;
+	navigation = NULL;
+	bake_thread = NULL;
+	bake_pool = NULL;
+	baking = false;
+	bake_pending = false;
+	bake_version = 0;
+	build_version = 0;
+	set_notify_transform(true);
+}
+
+TiledNavigationMeshInstance::~TiledNavigationMeshInstance() {
+
+	if (bake_thread) {
+		Thread::wait_to_finish(bake_thread);
+		memdelete(bake_thread);
+	}
+	if (bake_pool) {
+		memdelete(bake_pool);
+	}
+}
@@ -0,0 +1,121 @@
+/*************************************************************************/
+/*  tiled_navigation_mesh_instance.h                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TILED_NAVIGATION_MESH_INSTANCE_H
+#define TILED_NAVIGATION_MESH_INSTANCE_H
+
+#include "core/os/thread.h"
+#include "core/os/thread_work_pool.h"
+#include "scene/3d/navigation.h"
+
+class TiledNavigationMeshInstance : public Spatial {
+
+	GDCLASS(TiledNavigationMeshInstance, Spatial);
+
+	struct TileKey {
+
+		int x;
+		int z;
+
+		bool operator<(const TileKey &p_key) const {
+			return (x == p_key.x) ? (z < p_key.z) : (x < p_key.x);
+		}
+	};
+
+	struct Tile {
+
+		uint32_t hash; // of the geometry the tile was built from
+		Ref<NavigationMesh> navmesh;
+		int nav_id;
+
+		Tile() {
+			hash = 0;
+			nav_id = -1;
+		}
+	};
+
+	struct TileBuild {
+
+		TileKey key;
+		AABB bounds;
+		uint32_t hash;
+		Vector<float> vertices; // unindexed triangles, border included
+		Ref<NavigationMesh> navmesh; // result, null if the build failed
+	};
+
+	Ref<NavigationMesh> navmesh; // bake settings
+	float tile_size;
+
+	Map<TileKey, Tile> tiles;
+	Navigation *navigation;
+
+	Ref<NavigationMesh> bake_settings;
+	Vector<TileBuild> tile_builds;
+	Vector<TileKey> tile_removes;
+	Thread *bake_thread;
+	ThreadWorkPool *bake_pool; // own workers, so the shared pool stays free for the main thread
+	bool baking;
+	bool bake_pending;
+	uint32_t bake_version; // bumped by clear(), so a bake in flight is discarded
+	uint32_t build_version;
+
+	float _get_snapped_tile_size() const;
+	void _add_tile(Tile &p_tile);
+	void _remove_tile(Tile &p_tile);
+	uint32_t _hash_settings() const;
+	bool _stitch_tiles(const TileKey &p_a, const TileKey &p_b);
+
+	static void _bake_thread_function(void *p_user);
+	void _build_tile(uint32_t p_index, TileBuild *p_builds);
+	void _bake_finished();
+
+protected:
+	void _notification(int p_what);
+	static void _bind_methods();
+
+public:
+	void set_navigation_mesh(const Ref<NavigationMesh> &p_navmesh);
+	Ref<NavigationMesh> get_navigation_mesh() const;
+
+	void set_tile_size(float p_size);
+	float get_tile_size() const;
+
+	void bake();
+	void clear();
+	bool is_baking() const;
+	int get_tile_count() const;
+
+	String get_configuration_warning() const;
+
+	TiledNavigationMeshInstance();
+	~TiledNavigationMeshInstance();
+};
+
+#endif // TILED_NAVIGATION_MESH_INSTANCE_H
@@ -75,6 +75,15 @@ void image_decompress_squish(Image *p_image) {
 }
 
 #ifdef TOOLS_ENABLED
+static void _compress_squish_rows(const Image::CompressBlockLevel &p_level, int p_from_row, int p_to_row, void *p_userdata) {
+
+	int squish_comp = *(const int *)p_userdata;
+	int y = p_from_row * 4;
+	int h = MIN(p_to_row * 4, p_level.height) - y;
+
+	squish::CompressImage(&p_level.src[y * p_level.width * 4], p_level.width, h, &p_level.dst[p_from_row * p_level.dst_row_pitch], squish_comp);
+}
+
 void image_compress_squish(Image *p_image, float p_lossy_quality, Image::CompressSource p_source) {
 
 	if (p_image->get_format() >= Image::FORMAT_DXT1)
@@ -186,18 +195,28 @@ void image_compress_squish(Image *p_image, float p_lossy_quality, Image::Compres
 
 		int dst_ofs = 0;
 
+		Vector<Image::CompressBlockLevel> levels;
+
 		for (int i = 0; i <= mm_count; i++) {
 
 			int bw = w % 4 != 0 ? w + (4 - w % 4) : w;
 			int bh = h % 4 != 0 ? h + (4 - h % 4) : h;
 
-			int src_ofs = p_image->get_mipmap_offset(i);
-			squish::CompressImage(&rb[src_ofs], w, h, &wb[dst_ofs], squish_comp);
+			Image::CompressBlockLevel level;
+			level.src = &rb[p_image->get_mipmap_offset(i)];
+			level.dst = &wb[dst_ofs];
+			level.width = w;
+			level.height = h;
+			level.dst_row_pitch = (MAX(4, bw) * 4) >> shift;
+			levels.push_back(level);
+
 			dst_ofs += (MAX(4, bw) * MAX(4, bh)) >> shift;
 			w = MAX(w / 2, 1);
 			h = MAX(h / 2, 1);
 		}
 
+		Image::compress_block_rows(levels, _compress_squish_rows, &squish_comp);
+
 		rb.release();
 		wb.release();
 
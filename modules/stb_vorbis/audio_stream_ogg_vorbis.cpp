@@ -31,25 +31,19 @@
 #include "audio_stream_ogg_vorbis.h"
 
 #include "core/os/file_access.h"
+#include "core/os/os.h"
 
-void AudioStreamPlaybackOGGVorbis::_mix_internal(AudioFrame *p_buffer, int p_frames) {
-
-	ERR_FAIL_COND(!active);
+int AudioStreamPlaybackOGGVorbis::_decode(AudioFrame *p_buffer, int p_frames) {
 
 	int todo = p_frames;
 
-	int start_buffer = 0;
-
-	while (todo && active) {
-		float *buffer = (float *)p_buffer;
-		if (start_buffer > 0) {
-			buffer = (buffer + start_buffer * 2);
-		}
-		int mixed = stb_vorbis_get_samples_float_interleaved(ogg_stream, 2, buffer, todo * 2);
+	while (todo && !decode_end) {
+		AudioFrame *dst = p_buffer + (p_frames - todo);
+		int mixed = stb_vorbis_get_samples_float_interleaved(ogg_stream, 2, (float *)dst, todo * 2);
 		if (vorbis_stream->channels == 1 && mixed > 0) {
 			//mix mono to stereo
-			for (int i = start_buffer; i < mixed; i++) {
-				p_buffer[i].r = p_buffer[i].l;
+			for (int i = 0; i < mixed; i++) {
+				dst[i].r = dst[i].l;
 			}
 		}
 		todo -= mixed;
@@ -59,18 +53,177 @@ void AudioStreamPlaybackOGGVorbis::_mix_internal(AudioFrame *p_buffer, int p_fra
 			//end of file!
 			if (vorbis_stream->loop) {
 				//loop
-				seek(vorbis_stream->loop_offset);
+				_seek_decoder(vorbis_stream->loop_offset);
 				loops++;
-				// we still have buffer to fill, start from this element in the next iteration.
-				start_buffer = p_frames - todo;
+				if (decode_loop_at < 0) {
+					decode_loop_at = p_frames - todo;
+				}
 			} else {
-				for (int i = p_frames - todo; i < p_frames; i++) {
-					p_buffer[i] = AudioFrame(0, 0);
+				decode_end = true;
+			}
+		}
+	}
+
+	return p_frames - todo;
+}
+
+void AudioStreamPlaybackOGGVorbis::_seek_decoder(float p_time) {
+
+	if (p_time >= vorbis_stream->get_length()) {
+		p_time = 0;
+	}
+	frames_mixed = uint32_t(vorbis_stream->sample_rate * p_time);
+
+	stb_vorbis_seek(ogg_stream, frames_mixed);
+}
+
+void AudioStreamPlaybackOGGVorbis::_apply_pending_seek() {
+
+	//decode_mutex must be held
+	ring_mutex->lock();
+	bool pending = seek_pending;
+	float time = seek_time;
+	seek_pending = false;
+	ring_mutex->unlock();
+
+	if (pending) {
+		decode_end = false;
+		_seek_decoder(time);
+	}
+}
+
+void AudioStreamPlaybackOGGVorbis::_decode_ahead() {
+
+	AudioFrame chunk[DECODE_AHEAD_CHUNK];
+
+	while (active) {
+
+		//the decoder is only held one chunk at a time, so the mix thread can take it over
+		decode_mutex->lock();
+
+		_apply_pending_seek();
+
+		ring_mutex->lock();
+		int space = decoded.space_left();
+		uint32_t version = seek_version;
+		ring_mutex->unlock();
+
+		if (decode_end || space < DECODE_AHEAD_CHUNK) {
+			decode_mutex->unlock();
+			break;
+		}
+
+		decode_loop_at = -1;
+		int frames = _decode(chunk, DECODE_AHEAD_CHUNK);
+
+		ring_mutex->lock();
+		if (version == seek_version) {
+			if (decode_loop_at >= 0 && loop_mark < 0) {
+				loop_mark = frames_written + decode_loop_at;
+			}
+			decoded.write(chunk, frames);
+			frames_written += frames;
+		}
+		ring_mutex->unlock();
+
+		decode_mutex->unlock();
+	}
+}
+
+void AudioStreamPlaybackOGGVorbis::_update_played() {
+
+	//ring_mutex must be held
+	if (loop_mark < 0 || int64_t(frames_read) < loop_mark) {
+		frames_played = seek_frame + uint32_t(frames_read);
+		return;
+	}
+
+	//the decoder may have looped several times since, each loop has the same length
+	uint32_t loop_start = uint32_t(vorbis_stream->sample_rate * vorbis_stream->loop_offset);
+	uint64_t loop_frames = length_frames > loop_start ? length_frames - loop_start : 0;
+	uint64_t ofs = frames_read - uint64_t(loop_mark);
+	frames_played = loop_start + uint32_t(loop_frames ? ofs % loop_frames : 0);
+}
+
+int AudioStreamPlaybackOGGVorbis::_read_decoded(AudioFrame *p_buffer, int p_frames) {
+
+	ring_mutex->lock();
+
+	int read = decoded.read(p_buffer, p_frames);
+	frames_read += read;
+	_update_played();
+
+	ring_mutex->unlock();
+
+	return read;
+}
+
+void AudioStreamPlaybackOGGVorbis::_mix_internal(AudioFrame *p_buffer, int p_frames) {
+
+	ERR_FAIL_COND(!active);
+
+	int done = 0;
+	bool ended = true;
+
+	if (decode_ahead) {
+
+		done = _read_decoded(p_buffer, p_frames);
+
+		if (done < p_frames) {
+
+			//ran dry, decode the rest here unless the worker is in the middle of a chunk
+			if (decode_mutex->try_lock() == OK) {
+
+				uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+
+				_apply_pending_seek();
+				done += _read_decoded(p_buffer + done, p_frames - done);
+
+				if (done < p_frames && !decode_end) {
+					//ring is empty, so the decoder is right where the mix is
+					decode_loop_at = -1;
+					int frames = _decode(p_buffer + done, p_frames - done);
+
+					ring_mutex->lock();
+					if (decode_loop_at >= 0 && loop_mark < 0) {
+						loop_mark = frames_written + decode_loop_at;
+					}
+					frames_written += frames;
+					frames_read += frames;
+					_update_played();
+					ring_mutex->unlock();
+
+					done += frames;
 				}
-				active = false;
-				todo = 0;
+
+				ended = decode_end && !seek_pending;
+
+				decode_mutex->unlock();
+				AudioServer::get_singleton()->thread_add_decode_time(OS::get_singleton()->get_ticks_usec() - ticks);
+			} else {
+				//skip this block rather than wait for the worker
+				ended = false;
 			}
 		}
+
+		if ((!decode_end || seek_pending) && decoded.data_left() < decoded.size() / 2 && AudioDecodePool::get_singleton()) {
+			AudioDecodePool::get_singleton()->request(&decode_client);
+		}
+
+	} else {
+
+		uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+		done = _decode(p_buffer, p_frames);
+		AudioServer::get_singleton()->thread_add_decode_time(OS::get_singleton()->get_ticks_usec() - ticks);
+	}
+
+	if (done < p_frames) {
+		for (int i = done; i < p_frames; i++) {
+			p_buffer[i] = AudioFrame(0, 0);
+		}
+		if (ended) {
+			active = false;
+		}
 	}
 }
 
@@ -103,22 +256,101 @@ int AudioStreamPlaybackOGGVorbis::get_loop_count() const {
 
 float AudioStreamPlaybackOGGVorbis::get_playback_position() const {
 
-	return float(frames_mixed) / vorbis_stream->sample_rate;
+	return float(decode_ahead ? frames_played : frames_mixed) / vorbis_stream->sample_rate;
 }
 void AudioStreamPlaybackOGGVorbis::seek(float p_time) {
 
 	if (!active)
 		return;
 
-	if (p_time >= vorbis_stream->get_length()) {
-		p_time = 0;
+	if (decode_ahead) {
+
+		if (p_time >= vorbis_stream->get_length()) {
+			p_time = 0;
+		}
+
+		ring_mutex->lock();
+		decoded.clear();
+		frames_written = 0;
+		frames_read = 0;
+		loop_mark = -1;
+		seek_frame = uint32_t(vorbis_stream->sample_rate * p_time);
+		frames_played = seek_frame;
+		seek_time = p_time;
+		seek_pending = true;
+		seek_version++;
+		ring_mutex->unlock();
+
+		//if the worker has the decoder, it moves it before its next chunk
+		if (decode_mutex->try_lock() == OK) {
+			_apply_pending_seek();
+			decode_mutex->unlock();
+		}
+		return;
 	}
-	frames_mixed = uint32_t(vorbis_stream->sample_rate * p_time);
 
-	stb_vorbis_seek(ogg_stream, frames_mixed);
+	decode_end = false;
+	_seek_decoder(p_time);
+}
+
+void AudioStreamPlaybackOGGVorbis::advance(float p_time) {
+
+	if (!active)
+		return;
+
+	float pos = get_playback_position() + p_time;
+	float length = vorbis_stream->get_length();
+	if (pos >= length) {
+		if (!vorbis_stream->loop) {
+			active = false;
+			return;
+		}
+
+		float loop_len = length - vorbis_stream->loop_offset;
+		if (loop_len > 0) {
+			pos = vorbis_stream->loop_offset + Math::fmod(pos - vorbis_stream->loop_offset, loop_len);
+		} else {
+			pos = vorbis_stream->loop_offset;
+		}
+		loops++;
+	}
+
+	seek(pos);
+}
+
+AudioStreamPlaybackOGGVorbis::AudioStreamPlaybackOGGVorbis() {
+
+	ogg_stream = NULL;
+	ogg_alloc.alloc_buffer = NULL;
+	ogg_alloc.alloc_buffer_length_in_bytes = 0;
+	frames_mixed = 0;
+	active = false;
+	loops = 0;
+	decode_ahead = false;
+	decode_client.playback = this;
+	decode_mutex = NULL;
+	ring_mutex = NULL;
+	frames_written = 0;
+	frames_read = 0;
+	loop_mark = -1;
+	seek_frame = 0;
+	frames_played = 0;
+	length_frames = 0;
+	seek_version = 0;
+	seek_pending = false;
+	seek_time = 0;
+	decode_end = false;
+	decode_loop_at = -1;
 }
 
 AudioStreamPlaybackOGGVorbis::~AudioStreamPlaybackOGGVorbis() {
+	if (decode_ahead) {
+		if (AudioDecodePool::get_singleton()) {
+			AudioDecodePool::get_singleton()->remove_client(&decode_client);
+		}
+		memdelete(decode_mutex);
+		memdelete(ring_mutex);
+	}
 	if (ogg_alloc.alloc_buffer) {
 		stb_vorbis_close(ogg_stream);
 		AudioServer::get_singleton()->audio_data_free(ogg_alloc.alloc_buffer);
@@ -135,9 +367,6 @@ Ref<AudioStreamPlayback> AudioStreamOGGVorbis::instance_playback() {
 	ovs->vorbis_stream = Ref<AudioStreamOGGVorbis>(this);
 	ovs->ogg_alloc.alloc_buffer = (char *)AudioServer::get_singleton()->audio_data_alloc(decode_mem_size);
 	ovs->ogg_alloc.alloc_buffer_length_in_bytes = decode_mem_size;
-	ovs->frames_mixed = 0;
-	ovs->active = false;
-	ovs->loops = 0;
 	int error;
 	ovs->ogg_stream = stb_vorbis_open_memory((const unsigned char *)data, data_len, &error, &ovs->ogg_alloc);
 	if (!ovs->ogg_stream) {
@@ -147,6 +376,16 @@ Ref<AudioStreamPlayback> AudioStreamOGGVorbis::instance_playback() {
 		ERR_FAIL_COND_V(!ovs->ogg_stream, Ref<AudioStreamPlaybackOGGVorbis>());
 	}
 
+	if (decode_ahead_time > 0 && AudioDecodePool::get_singleton() && AudioDecodePool::get_singleton()->get_thread_count() > 0) {
+		int frames = MAX(int(decode_ahead_time * sample_rate), AudioStreamPlaybackOGGVorbis::DECODE_AHEAD_CHUNK * 2);
+		ovs->decoded.resize(nearest_shift(frames));
+		ovs->length_frames = stb_vorbis_stream_length_in_samples(ovs->ogg_stream);
+		ovs->decode_mutex = Mutex::create();
+		ovs->ring_mutex = Mutex::create();
+		ovs->decode_ahead = true;
+		AudioDecodePool::get_singleton()->add_client(&ovs->decode_client);
+	}
+
 	return ovs;
 }
 
@@ -249,6 +488,14 @@ float AudioStreamOGGVorbis::get_loop_offset() const {
 	return loop_offset;
 }
 
+void AudioStreamOGGVorbis::set_decode_ahead_time(float p_seconds) {
+	decode_ahead_time = p_seconds;
+}
+
+float AudioStreamOGGVorbis::get_decode_ahead_time() const {
+	return decode_ahead_time;
+}
+
 float AudioStreamOGGVorbis::get_length() const {
 
 	return length;
@@ -265,9 +512,13 @@ void AudioStreamOGGVorbis::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_loop_offset", "seconds"), &AudioStreamOGGVorbis::set_loop_offset);
 	ClassDB::bind_method(D_METHOD("get_loop_offset"), &AudioStreamOGGVorbis::get_loop_offset);
 
+	ClassDB::bind_method(D_METHOD("set_decode_ahead_time", "seconds"), &AudioStreamOGGVorbis::set_decode_ahead_time);
+	ClassDB::bind_method(D_METHOD("get_decode_ahead_time"), &AudioStreamOGGVorbis::get_decode_ahead_time);
+
 	ADD_PROPERTY(PropertyInfo(Variant::POOL_BYTE_ARRAY, "data", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR), "set_data", "get_data");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "loop", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR), "set_loop", "has_loop");
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "loop_offset", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR), "set_loop_offset", "get_loop_offset");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "decode_ahead_time", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR), "set_decode_ahead_time", "get_decode_ahead_time");
 }
 
 AudioStreamOGGVorbis::AudioStreamOGGVorbis() {
@@ -278,6 +529,7 @@ AudioStreamOGGVorbis::AudioStreamOGGVorbis() {
 	sample_rate = 1;
 	channels = 1;
 	loop_offset = 0;
+	decode_ahead_time = 0;
 	decode_mem_size = 0;
 	loop = false;
 }
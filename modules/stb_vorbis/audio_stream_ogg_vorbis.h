@@ -32,6 +32,9 @@
 #define AUDIO_STREAM_STB_VORBIS_H
 
 #include "core/io/resource_loader.h"
+#include "core/os/mutex.h"
+#include "core/ring_buffer.h"
+#include "servers/audio/audio_decode_pool.h"
 #include "servers/audio/audio_stream.h"
 
 #include "thirdparty/misc/stb_vorbis.h"
@@ -42,9 +45,13 @@ class AudioStreamPlaybackOGGVorbis : public AudioStreamPlaybackResampled {
 
 	GDCLASS(AudioStreamPlaybackOGGVorbis, AudioStreamPlaybackResampled);
 
+	enum {
+		DECODE_AHEAD_CHUNK = 1024
+	};
+
 	stb_vorbis *ogg_stream;
 	stb_vorbis_alloc ogg_alloc;
-	uint32_t frames_mixed;
+	uint32_t frames_mixed; //decoder position
 	bool active;
 	int loops;
 
@@ -52,6 +59,38 @@ class AudioStreamPlaybackOGGVorbis : public AudioStreamPlaybackResampled {
 
 	Ref<AudioStreamOGGVorbis> vorbis_stream;
 
+	struct DecodeAhead : public AudioDecodePool::Client {
+		AudioStreamPlaybackOGGVorbis *playback;
+		virtual void decode_ahead() { playback->_decode_ahead(); }
+	};
+
+	// When decoding ahead, a pool worker keeps the ring filled and the mix
+	// only copies from it, unless it runs dry. The worker holds the decoder one
+	// chunk at a time and the mix thread never waits for it.
+	bool decode_ahead;
+	DecodeAhead decode_client;
+	RingBuffer<AudioFrame> decoded;
+	Mutex *decode_mutex; //held while using the decoder
+	Mutex *ring_mutex; //held while touching the ring and the counters below
+	uint64_t frames_written;
+	uint64_t frames_read;
+	int64_t loop_mark; //value of frames_written where the decoder first looped since the seek, -1 if it didn't
+	uint32_t seek_frame; //decoder position at frames_written 0
+	uint32_t frames_played; //position of what was read from the ring
+	uint32_t length_frames;
+	uint32_t seek_version; //bumped on seek, so chunks decoded before it are dropped
+	volatile bool seek_pending; //decoder was busy on seek, it moves before decoding again
+	float seek_time;
+	volatile bool decode_end;
+	int decode_loop_at;
+
+	int _decode(AudioFrame *p_buffer, int p_frames);
+	void _seek_decoder(float p_time);
+	void _apply_pending_seek();
+	void _decode_ahead();
+	void _update_played();
+	int _read_decoded(AudioFrame *p_buffer, int p_frames);
+
 protected:
 	virtual void _mix_internal(AudioFrame *p_buffer, int p_frames);
 	virtual float get_stream_sampling_rate();
@@ -65,8 +104,9 @@ public:
 
 	virtual float get_playback_position() const;
 	virtual void seek(float p_time);
+	virtual void advance(float p_time);
 
-	AudioStreamPlaybackOGGVorbis() {}
+	AudioStreamPlaybackOGGVorbis();
 	~AudioStreamPlaybackOGGVorbis();
 };
 
@@ -87,6 +127,7 @@ class AudioStreamOGGVorbis : public AudioStream {
 	float length;
 	bool loop;
 	float loop_offset;
+	float decode_ahead_time;
 	void clear_data();
 
 protected:
@@ -99,6 +140,9 @@ public:
 	void set_loop_offset(float p_seconds);
 	float get_loop_offset() const;
 
+	void set_decode_ahead_time(float p_seconds);
+	float get_decode_ahead_time() const;
+
 	virtual Ref<AudioStreamPlayback> instance_playback();
 	virtual String get_stream_name() const;
 
@@ -45,8 +45,6 @@ SVGRasterizer::~SVGRasterizer() {
 	nsvgDeleteRasterizer(rasterizer);
 }
 
-SVGRasterizer ImageLoaderSVG::rasterizer;
-
 inline void change_nsvg_paint_color(NSVGpaint *p_paint, const uint32_t p_old, const uint32_t p_new) {
 
 	if (p_paint->type == NSVG_PAINT_COLOR) {
@@ -121,6 +119,8 @@ Error ImageLoaderSVG::_create_image(Ref<Image> p_image, const PoolVector<uint8_t
 
 	PoolVector<uint8_t>::Write dw = dst_image.write();
 
+	// A rasterizer per call, SVG textures can be imported from several threads at once
+	SVGRasterizer rasterizer;
 	rasterizer.rasterize(svg_image, 0, 0, p_scale * upscale, (unsigned char *)dw.ptr(), w, h, w * 4);
 
 	dw.release();
@@ -30,6 +30,8 @@
 
 #include "cpu_particles_2d.h"
 
+#include "core/math/random_pcg.h"
+#include "core/os/thread_work_pool.h"
 #include "scene/2d/canvas_item.h"
 #include "scene/2d/particles_2d.h"
 #include "scene/resources/particles_material.h"
@@ -542,8 +544,6 @@ void CPUParticles2D::_particles_process(float p_delta) {
 	int pcount = particles.size();
 	PoolVector<Particle>::Write w = particles.write();
 
-	Particle *parray = w.ptr();
-
 	float prev_time = time;
 	time += p_delta;
 	if (time > lifetime) {
@@ -565,14 +565,80 @@ void CPUParticles2D::_particles_process(float p_delta) {
 
 	float system_phase = time / lifetime;
 
-	for (int i = 0; i < pcount; i++) {
+	ProcessData data;
+	data.particles = w.ptr();
+	data.particle_count = pcount;
+	data.delta = p_delta;
+	data.prev_time = prev_time;
+	data.system_phase = system_phase;
+	data.emission_xform = emission_xform;
+	data.velocity_xform = velocity_xform;
+	data.seed = Math::rand();
+
+	if (color_ramp.is_valid()) {
+		color_ramp->get_color_at_offset(0.0); // sorts the ramp points here, jobs only read them
+	}
+
+	PoolVector<Vector2>::Read emission_points_r = emission_points.read();
+	PoolVector<Vector2>::Read emission_normals_r = emission_normals.read();
+	PoolVector<Color>::Read emission_colors_r = emission_colors.read();
+	data.emission_points = emission_points_r.ptr();
+	data.emission_points_size = emission_points.size();
+	data.emission_normals = emission_normals_r.ptr();
+	data.emission_normals_size = emission_normals.size();
+	data.emission_colors = emission_colors_r.ptr();
+	data.emission_colors_size = emission_colors.size();
+
+	// Render data only needs sorting for other draw orders, otherwise it is written while the chunk is still in cache.
+	bool write_data = draw_order == DRAW_ORDER_INDEX;
+
+#ifndef NO_THREADS
+	if (write_data)
+		update_mutex->lock();
+#endif
+
+	{
+		PoolVector<float>::Write dw;
+		data.particle_data = NULL;
+		if (write_data) {
+			dw = particle_data.write();
+			data.particle_data = dw.ptr();
+		}
+
+		int chunk_count = (pcount + PROCESS_CHUNK_SIZE - 1) / PROCESS_CHUNK_SIZE;
+		ThreadWorkPool::get_singleton()->do_work(chunk_count, this, &CPUParticles2D::_particles_process_chunk, &data);
+	}
+
+#ifndef NO_THREADS
+	if (write_data)
+		update_mutex->unlock();
+#endif
+}
+
+void CPUParticles2D::_particles_process_chunk(uint32_t p_chunk, ProcessData *p_data) {
+
+	int from = p_chunk * PROCESS_CHUNK_SIZE;
+	int to = MIN(from + PROCESS_CHUNK_SIZE, p_data->particle_count);
+
+	// Math::rand() is not thread safe, so each chunk draws from its own stream.
+	RandomPCG rng(p_data->seed, p_chunk);
+
+	Particle *parray = p_data->particles;
+	int pcount = p_data->particle_count;
+	float delta = p_data->delta;
+	float prev_time = p_data->prev_time;
+	float system_phase = p_data->system_phase;
+	const Transform2D &emission_xform = p_data->emission_xform;
+	const Transform2D &velocity_xform = p_data->velocity_xform;
+
+	for (int i = from; i < to; i++) {
 
 		Particle &p = parray[i];
 
 		if (!emitting && !p.active)
 			continue;
 
-		float local_delta = p_delta;
+		float local_delta = delta;
 
 		// The phase is a ratio between 0 (birth) and 1 (end of life) for each particle.
 		// While we use time in tests later on, for randomness we use the phase as done in the
@@ -646,16 +712,16 @@ void CPUParticles2D::_particles_process(float p_delta) {
 				tex_anim_offset = curve_parameters[PARAM_ANGLE]->interpolate(0);
 			}
 
-			p.seed = Math::rand();
+			p.seed = rng.rand();
 
-			p.angle_rand = Math::randf();
-			p.scale_rand = Math::randf();
-			p.hue_rot_rand = Math::randf();
-			p.anim_offset_rand = Math::randf();
+			p.angle_rand = rng.randf();
+			p.scale_rand = rng.randf();
+			p.hue_rot_rand = rng.randf();
+			p.anim_offset_rand = rng.randf();
 
-			float angle1_rad = Math::atan2(direction.y, direction.x) + (Math::randf() * 2.0 - 1.0) * Math_PI * spread / 180.0;
+			float angle1_rad = Math::atan2(direction.y, direction.x) + (rng.randf() * 2.0 - 1.0) * Math_PI * spread / 180.0;
 			Vector2 rot = Vector2(Math::cos(angle1_rad), Math::sin(angle1_rad));
-			p.velocity = rot * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, float(Math::randf()), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
+			p.velocity = rot * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, float(rng.randf()), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
 
 			float base_angle = (parameters[PARAM_ANGLE] + tex_angle) * Math::lerp(1.0f, p.angle_rand, randomness[PARAM_ANGLE]);
 			p.rotation = Math::deg2rad(base_angle);
@@ -666,7 +732,7 @@ void CPUParticles2D::_particles_process(float p_delta) {
 			p.custom[3] = 0.0;
 			p.transform = Transform2D();
 			p.time = 0;
-			p.lifetime = lifetime * (1.0 - Math::randf() * lifetime_randomness);
+			p.lifetime = lifetime * (1.0 - rng.randf() * lifetime_randomness);
 			p.base_color = Color(1, 1, 1, 1);
 
 			switch (emission_shape) {
@@ -674,30 +740,30 @@ void CPUParticles2D::_particles_process(float p_delta) {
 					//do none
 				} break;
 				case EMISSION_SHAPE_SPHERE: {
-					float s = Math::randf(), t = 2.0 * Math_PI * Math::randf();
+					float s = rng.randf(), t = 2.0 * Math_PI * rng.randf();
 					float radius = emission_sphere_radius * Math::sqrt(1.0 - s * s);
 					p.transform[2] = Vector2(Math::cos(t), Math::sin(t)) * radius;
 				} break;
 				case EMISSION_SHAPE_RECTANGLE: {
-					p.transform[2] = Vector2(Math::randf() * 2.0 - 1.0, Math::randf() * 2.0 - 1.0) * emission_rect_extents;
+					p.transform[2] = Vector2(rng.randf() * 2.0 - 1.0, rng.randf() * 2.0 - 1.0) * emission_rect_extents;
 				} break;
 				case EMISSION_SHAPE_POINTS:
 				case EMISSION_SHAPE_DIRECTED_POINTS: {
 
-					int pc = emission_points.size();
+					int pc = p_data->emission_points_size;
 					if (pc == 0)
 						break;
 
-					int random_idx = Math::rand() % pc;
+					int random_idx = rng.rand() % pc;
 
-					p.transform[2] = emission_points.get(random_idx);
+					p.transform[2] = p_data->emission_points[random_idx];
 
-					if (emission_shape == EMISSION_SHAPE_DIRECTED_POINTS && emission_normals.size() == pc) {
-						p.velocity = emission_normals.get(random_idx);
+					if (emission_shape == EMISSION_SHAPE_DIRECTED_POINTS && p_data->emission_normals_size == pc) {
+						p.velocity = p_data->emission_normals[random_idx];
 					}
 
-					if (emission_colors.size() == pc) {
-						p.base_color = emission_colors.get(random_idx);
+					if (p_data->emission_colors_size == pc) {
+						p.base_color = p_data->emission_colors[random_idx];
 					}
 				} break;
 			}
@@ -874,9 +940,58 @@ void CPUParticles2D::_particles_process(float p_delta) {
 
 		p.transform[2] += p.velocity * local_delta;
 	}
+
+	if (p_data->particle_data) {
+
+		float *ptr = p_data->particle_data + from * 13;
+		for (int i = from; i < to; i++) {
+			_fill_particle_data(parray[i], ptr);
+			ptr += 13;
+		}
+	}
+}
+
+void CPUParticles2D::_fill_particle_data(const Particle &p_particle, float *r_ptr) const {
+
+	Transform2D t = p_particle.transform;
+
+	if (!local_coords) {
+		t = inv_emission_transform * t;
+	}
+
+	if (p_particle.active) {
+
+		r_ptr[0] = t.elements[0][0];
+		r_ptr[1] = t.elements[1][0];
+		r_ptr[2] = 0;
+		r_ptr[3] = t.elements[2][0];
+		r_ptr[4] = t.elements[0][1];
+		r_ptr[5] = t.elements[1][1];
+		r_ptr[6] = 0;
+		r_ptr[7] = t.elements[2][1];
+
+	} else {
+		zeromem(r_ptr, sizeof(float) * 8);
+	}
+
+	Color c = p_particle.color;
+	uint8_t *data8 = (uint8_t *)&r_ptr[8];
+	data8[0] = CLAMP(c.r * 255.0, 0, 255);
+	data8[1] = CLAMP(c.g * 255.0, 0, 255);
+	data8[2] = CLAMP(c.b * 255.0, 0, 255);
+	data8[3] = CLAMP(c.a * 255.0, 0, 255);
+
+	r_ptr[9] = p_particle.custom[0];
+	r_ptr[10] = p_particle.custom[1];
+	r_ptr[11] = p_particle.custom[2];
+	r_ptr[12] = p_particle.custom[3];
 }
 
 void CPUParticles2D::_update_particle_data_buffer() {
+
+	if (draw_order == DRAW_ORDER_INDEX)
+		return; // already written by _particles_process()
+
 #ifndef NO_THREADS
 	update_mutex->lock();
 #endif
@@ -885,64 +1000,25 @@ void CPUParticles2D::_update_particle_data_buffer() {
 
 		int pc = particles.size();
 
-		PoolVector<int>::Write ow;
-		int *order = NULL;
+		PoolVector<int>::Write ow = particle_order.write();
+		int *order = ow.ptr();
 
 		PoolVector<float>::Write w = particle_data.write();
 		PoolVector<Particle>::Read r = particles.read();
 		float *ptr = w.ptr();
 
-		if (draw_order != DRAW_ORDER_INDEX) {
-			ow = particle_order.write();
-			order = ow.ptr();
-
-			for (int i = 0; i < pc; i++) {
-				order[i] = i;
-			}
-			if (draw_order == DRAW_ORDER_LIFETIME) {
-				SortArray<int, SortLifetime> sorter;
-				sorter.compare.particles = r.ptr();
-				sorter.sort(order, pc);
-			}
+		for (int i = 0; i < pc; i++) {
+			order[i] = i;
+		}
+		if (draw_order == DRAW_ORDER_LIFETIME) {
+			SortArray<int, SortLifetime> sorter;
+			sorter.compare.particles = r.ptr();
+			sorter.sort(order, pc);
 		}
 
 		for (int i = 0; i < pc; i++) {
 
-			int idx = order ? order[i] : i;
-
-			Transform2D t = r[idx].transform;
-
-			if (!local_coords) {
-				t = inv_emission_transform * t;
-			}
-
-			if (r[idx].active) {
-
-				ptr[0] = t.elements[0][0];
-				ptr[1] = t.elements[1][0];
-				ptr[2] = 0;
-				ptr[3] = t.elements[2][0];
-				ptr[4] = t.elements[0][1];
-				ptr[5] = t.elements[1][1];
-				ptr[6] = 0;
-				ptr[7] = t.elements[2][1];
-
-			} else {
-				zeromem(ptr, sizeof(float) * 8);
-			}
-
-			Color c = r[idx].color;
-			uint8_t *data8 = (uint8_t *)&ptr[8];
-			data8[0] = CLAMP(c.r * 255.0, 0, 255);
-			data8[1] = CLAMP(c.g * 255.0, 0, 255);
-			data8[2] = CLAMP(c.b * 255.0, 0, 255);
-			data8[3] = CLAMP(c.a * 255.0, 0, 255);
-
-			ptr[9] = r[idx].custom[0];
-			ptr[10] = r[idx].custom[1];
-			ptr[11] = r[idx].custom[2];
-			ptr[12] = r[idx].custom[3];
-
+			_fill_particle_data(r[order[i]], ptr);
 			ptr += 13;
 		}
 	}
@@ -35,6 +35,10 @@
 #include "scene/2d/node_2d.h"
 #include "scene/resources/texture.h"
 
+namespace TestParticles {
+class TestMainLoop;
+}
+
 /**
 	@author Juan Linietsky <reduzio@gmail.com>
 */
@@ -178,7 +182,33 @@ private:
 
 	Vector2 gravity;
 
+	enum {
+		PROCESS_CHUNK_SIZE = 256 // particles handled by each job of _particles_process()
+	};
+
+	struct ProcessData {
+		Particle *particles;
+		int particle_count;
+		float delta;
+		float prev_time;
+		float system_phase;
+		Transform2D emission_xform;
+		Transform2D velocity_xform;
+		const Vector2 *emission_points;
+		int emission_points_size;
+		const Vector2 *emission_normals;
+		int emission_normals_size;
+		const Color *emission_colors;
+		int emission_colors_size;
+		float *particle_data; // if not NULL, render data is written as soon as a chunk is processed
+		uint32_t seed;
+	};
+
+	friend class TestParticles::TestMainLoop; // compares threaded and serial steps
+
 	void _particles_process(float p_delta);
+	void _particles_process_chunk(uint32_t p_chunk, ProcessData *p_data);
+	void _fill_particle_data(const Particle &p_particle, float *r_ptr) const;
 	void _update_particle_data_buffer();
 
 	Mutex *update_mutex;
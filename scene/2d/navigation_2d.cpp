@@ -30,6 +30,9 @@
 
 #include "navigation_2d.h"
 
+#include "core/os/thread_work_pool.h"
+#include "core/sort_array.h"
+
 #define USE_ENTRY_POINT
 
 void Navigation2D::_navpoly_link(int p_id) {
@@ -73,6 +76,10 @@ void Navigation2D::_navpoly_link(int p_id) {
 			Polygon::Edge e;
 			Vector2 ep = nm.xform.xform(r[idx]);
 			center += ep;
+			if (j == 0)
+				p.aabb.position = ep;
+			else
+				p.aabb.expand_to(ep);
 			e.point = _get_point(ep);
 			p.edges.write[j] = e;
 
@@ -134,6 +141,7 @@ void Navigation2D::_navpoly_link(int p_id) {
 	}
 
 	nm.linked = true;
+	index_dirty = true;
 }
 
 void Navigation2D::_navpoly_unlink(int p_id) {
@@ -200,10 +208,192 @@ void Navigation2D::_navpoly_unlink(int p_id) {
 	nm.polygons.clear();
 
 	nm.linked = false;
+	index_dirty = true;
+}
+
+int Navigation2D::_build_bvh(int p_from, int p_count) {
+
+	Polygon **polys = polygons.ptrw() + p_from;
+
+	BVHNode node;
+	node.aabb = polys[0]->aabb;
+	for (int i = 1; i < p_count; i++) {
+		node.aabb = node.aabb.merge(polys[i]->aabb);
+	}
+	node.from = p_from;
+	node.count = p_count;
+	node.children[0] = -1;
+	node.children[1] = -1;
+
+	int index = bvh.size();
+	bvh.push_back(node);
+
+	if (p_count > BVH_LEAF_SIZE) {
+		//split at the median of the longest axis, so the tree stays balanced
+		SortArray<Polygon *, BVHSort> sorter;
+		sorter.compare.axis = node.aabb.size.x >= node.aabb.size.y ? 0 : 1;
+		int half = p_count / 2;
+		sorter.nth_element(0, p_count, half, polys);
+
+		int left = _build_bvh(p_from, half);
+		int right = _build_bvh(p_from + half, p_count - half);
+		bvh.write[index].children[0] = left;
+		bvh.write[index].children[1] = right;
+	}
+
+	return index;
+}
+
+void Navigation2D::_update_index() {
+
+	polygons.clear();
+	bvh.clear();
+
+	for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
+
+		if (!E->get().linked)
+			continue;
+		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+			polygons.push_back(&F->get());
+		}
+	}
+
+	if (polygons.size()) {
+		_build_bvh(0, polygons.size());
+	}
+
+	for (int i = 0; i < polygons.size(); i++) {
+		polygons[i]->id = i;
+	}
+
+	index_dirty = false;
+}
+
+void Navigation2D::_read_lock_index() {
+
+	lock->read_lock();
+
+	while (index_dirty) {
+		lock->read_unlock();
+		lock->write_lock();
+		if (index_dirty) {
+			_update_index();
+		}
+		lock->write_unlock();
+		lock->read_lock();
+	}
+}
+
+static _FORCE_INLINE_ float _rect_distance_squared(const Rect2 &p_rect, const Vector2 &p_point) {
+
+	Vector2 end = p_rect.position + p_rect.size;
+	Vector2 closest(CLAMP(p_point.x, p_rect.position.x, end.x), CLAMP(p_point.y, p_rect.position.y, end.y));
+	return closest.distance_squared_to(p_point);
+}
+
+Navigation2D::Polygon *Navigation2D::_get_closest_polygon(const Vector2 &p_point, Vector2 *r_point) const {
+
+	if (bvh.empty())
+		return NULL;
+
+	int stack[BVH_STACK_MAX];
+	int stack_size = 0;
+
+	//look for point inside triangle
+
+	stack[stack_size++] = 0;
+
+	while (stack_size) {
+
+		const BVHNode &node = bvh[stack[--stack_size]];
+		if (_rect_distance_squared(node.aabb, p_point) > 0)
+			continue;
+
+		if (node.children[0] == -1) {
+
+			for (int i = 0; i < node.count; i++) {
+
+				Polygon *p = polygons[node.from + i];
+				if (_rect_distance_squared(p->aabb, p_point) > 0)
+					continue;
+
+				for (int j = 2; j < p->edges.size(); j++) {
+
+					if (Geometry::is_point_in_triangle(p_point, _get_vertex(p->edges[0].point), _get_vertex(p->edges[j - 1].point), _get_vertex(p->edges[j].point))) {
+
+						*r_point = p_point;
+						return p;
+					}
+				}
+			}
+			continue;
+		}
+
+		ERR_CONTINUE(stack_size + 2 > BVH_STACK_MAX);
+		stack[stack_size++] = node.children[1];
+		stack[stack_size++] = node.children[0];
+	}
+
+	//not inside triangle.. look for closest segment :|
+
+	Polygon *closest = NULL;
+	float closest_d = 1e20;
+
+	stack[stack_size++] = 0;
+
+	while (stack_size) {
+
+		const BVHNode &node = bvh[stack[--stack_size]];
+		if (_rect_distance_squared(node.aabb, p_point) >= closest_d)
+			continue;
+
+		if (node.children[0] == -1) {
+
+			for (int i = 0; i < node.count; i++) {
+
+				Polygon *p = polygons[node.from + i];
+				if (_rect_distance_squared(p->aabb, p_point) >= closest_d)
+					continue;
+
+				int es = p->edges.size();
+				for (int j = 0; j < es; j++) {
+
+					Vector2 edge[2] = {
+						_get_vertex(p->edges[j].point),
+						_get_vertex(p->edges[(j + 1) % es].point)
+					};
+
+					Vector2 spoint = Geometry::get_closest_point_to_segment_2d(p_point, edge);
+					float d = spoint.distance_squared_to(p_point);
+					if (d < closest_d) {
+						closest_d = d;
+						closest = p;
+						*r_point = spoint;
+					}
+				}
+			}
+			continue;
+		}
+
+		ERR_CONTINUE(stack_size + 2 > BVH_STACK_MAX);
+
+		//visit the nearest child first, it is the most likely to shrink the search
+		int near_child = node.children[0];
+		int far_child = node.children[1];
+		if (_rect_distance_squared(bvh[far_child].aabb, p_point) < _rect_distance_squared(bvh[near_child].aabb, p_point)) {
+			SWAP(near_child, far_child);
+		}
+		stack[stack_size++] = far_child;
+		stack[stack_size++] = near_child;
+	}
+
+	return closest;
 }
 
 int Navigation2D::navpoly_add(const Ref<NavigationPolygon> &p_mesh, const Transform2D &p_xform, Object *p_owner) {
 
+	RWLockWrite write_lock(lock);
+
 	int id = last_id++;
 	NavMesh nm;
 	nm.linked = false;
@@ -219,6 +409,8 @@ int Navigation2D::navpoly_add(const Ref<NavigationPolygon> &p_mesh, const Transf
 
 void Navigation2D::navpoly_set_transform(int p_id, const Transform2D &p_xform) {
 
+	RWLockWrite write_lock(lock);
+
 	ERR_FAIL_COND(!navpoly_map.has(p_id));
 	NavMesh &nm = navpoly_map[p_id];
 	if (nm.xform == p_xform)
@@ -229,102 +421,49 @@ void Navigation2D::navpoly_set_transform(int p_id, const Transform2D &p_xform) {
 }
 void Navigation2D::navpoly_remove(int p_id) {
 
+	RWLockWrite write_lock(lock);
+
 	ERR_FAIL_COND(!navpoly_map.has(p_id));
 	_navpoly_unlink(p_id);
 	navpoly_map.erase(p_id);
 }
 
-Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vector2 &p_end, bool p_optimize) {
+float Navigation2D::_get_cost_estimate(const Polygon *p_poly, const Vector2 &p_entry, const Vector2 &p_end_point) const {
 
-	Polygon *begin_poly = NULL;
-	Polygon *end_poly = NULL;
-	Vector2 begin_point;
-	Vector2 end_point;
-	float begin_d = 1e20;
-	float end_d = 1e20;
+#ifdef USE_ENTRY_POINT
+	int es = p_poly->edges.size();
 
-	//look for point inside triangle
+	float shortest_distance = 1e30;
 
-	for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
+	for (int i = 0; i < es; i++) {
+		const Polygon::Edge &e = p_poly->edges[i];
 
-		if (!E->get().linked)
+		if (!e.C)
 			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
-
-			Polygon &p = F->get();
-			if (begin_d || end_d) {
-				for (int i = 2; i < p.edges.size(); i++) {
 
-					if (begin_d > 0) {
+		Vector2 edge[2] = {
+			_get_vertex(p_poly->edges[i].point),
+			_get_vertex(p_poly->edges[(i + 1) % es].point)
+		};
 
-						if (Geometry::is_point_in_triangle(p_start, _get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point))) {
-
-							begin_poly = &p;
-							begin_point = p_start;
-							begin_d = 0;
-							if (end_d == 0)
-								break;
-						}
-					}
-
-					if (end_d > 0) {
-
-						if (Geometry::is_point_in_triangle(p_end, _get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point))) {
-
-							end_poly = &p;
-							end_point = p_end;
-							end_d = 0;
-							if (begin_d == 0)
-								break;
-						}
-					}
-				}
-			}
-
-			p.prev_edge = -1;
-		}
+		Vector2 edge_point = Geometry::get_closest_point_to_segment_2d(p_entry, edge);
+		float dist = p_entry.distance_to(edge_point);
+		if (dist < shortest_distance)
+			shortest_distance = dist;
 	}
 
-	//start or end not inside triangle.. look for closest segment :|
-	if (begin_d || end_d) {
-		for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
-
-			if (!E->get().linked)
-				continue;
-			for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
-
-				Polygon &p = F->get();
-				int es = p.edges.size();
-				for (int i = 0; i < es; i++) {
-
-					Vector2 edge[2] = {
-						_get_vertex(p.edges[i].point),
-						_get_vertex(p.edges[(i + 1) % es].point)
-					};
+	return shortest_distance;
+#else
+	return p_poly->center.distance_to(p_end_point);
+#endif
+}
 
-					if (begin_d > 0) {
-						Vector2 spoint = Geometry::get_closest_point_to_segment_2d(p_start, edge);
-						float d = spoint.distance_to(p_start);
-						if (d < begin_d) {
-							begin_poly = &p;
-							begin_point = spoint;
-							begin_d = d;
-						}
-					}
+Vector<Vector2> Navigation2D::_get_path(const Vector2 &p_start, const Vector2 &p_end, bool p_optimize) {
 
-					if (end_d > 0) {
-						Vector2 spoint = Geometry::get_closest_point_to_segment_2d(p_end, edge);
-						float d = spoint.distance_to(p_end);
-						if (d < end_d) {
-							end_poly = &p;
-							end_point = spoint;
-							end_d = d;
-						}
-					}
-				}
-			}
-		}
-	}
+	Vector2 begin_point;
+	Vector2 end_point;
+	Polygon *begin_poly = _get_closest_polygon(p_start, &begin_point);
+	Polygon *end_poly = _get_closest_polygon(p_end, &end_point);
 
 	if (!begin_poly || !end_poly) {
 
@@ -340,146 +479,123 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 		return path;
 	}
 
-	bool found_route = false;
+	Vector<QueryNode> query_nodes;
+	query_nodes.resize(polygons.size());
+	QueryNode *nodes = query_nodes.ptrw();
+	for (int i = 0; i < query_nodes.size(); i++) {
+		nodes[i].distance = 0;
+		nodes[i].prev_edge = -1;
+		nodes[i].closed = false;
+	}
+
+	QueryNode &begin_node = nodes[begin_poly->id];
+	begin_node.entry = p_start;
+	begin_node.closed = true;
 
-	List<Polygon *> open_list;
+	bool found_route = false;
 
-	begin_poly->entry = p_start;
+	//binary heap on cost, entries left behind by a cheaper push are skipped when popped
+	Vector<QueryOpen> open_list;
+	SortArray<QueryOpen, QueryOpenSort> sorter;
 
 	for (int i = 0; i < begin_poly->edges.size(); i++) {
 
-		if (begin_poly->edges[i].C) {
+		Polygon *c = begin_poly->edges[i].C;
+		if (c) {
 
-			begin_poly->edges[i].C->prev_edge = begin_poly->edges[i].C_edge;
+			QueryNode &cn = nodes[c->id];
+			cn.prev_edge = begin_poly->edges[i].C_edge;
 #ifdef USE_ENTRY_POINT
 			Vector2 edge[2] = {
 				_get_vertex(begin_poly->edges[i].point),
 				_get_vertex(begin_poly->edges[(i + 1) % begin_poly->edges.size()].point)
 			};
 
-			Vector2 entry = Geometry::get_closest_point_to_segment_2d(begin_poly->entry, edge);
-			begin_poly->edges[i].C->distance = begin_poly->entry.distance_to(entry);
-			begin_poly->edges[i].C->entry = entry;
+			Vector2 entry = Geometry::get_closest_point_to_segment_2d(begin_node.entry, edge);
+			cn.distance = begin_node.entry.distance_to(entry);
+			cn.entry = entry;
 #else
-			begin_poly->edges[i].C->distance = begin_poly->center.distance_to(begin_poly->edges[i].C->center);
+			cn.distance = begin_poly->center.distance_to(c->center);
 #endif
-			open_list.push_back(begin_poly->edges[i].C);
+			QueryOpen open;
+			open.polygon = c->id;
+			open.cost = cn.distance + _get_cost_estimate(c, cn.entry, end_point);
+			open_list.push_back(open);
+			sorter.push_heap(0, open_list.size() - 1, 0, open, open_list.ptrw());
 
-			if (begin_poly->edges[i].C == end_poly) {
+			if (c == end_poly) {
 				found_route = true;
 			}
 		}
 	}
 
-	while (!found_route) {
+	while (!found_route && open_list.size()) {
 
-		if (open_list.size() == 0) {
-			break;
-		}
-		//check open list
-
-		List<Polygon *>::Element *least_cost_poly = NULL;
-		float least_cost = 1e30;
-
-		//this could be faster (cache previous results)
-		for (List<Polygon *>::Element *E = open_list.front(); E; E = E->next()) {
-
-			Polygon *p = E->get();
-
-			float cost = p->distance;
-
-#ifdef USE_ENTRY_POINT
-			int es = p->edges.size();
+		sorter.pop_heap(0, open_list.size(), open_list.ptrw());
+		int least_cost_poly = open_list[open_list.size() - 1].polygon;
+		open_list.remove(open_list.size() - 1);
 
-			float shortest_distance = 1e30;
+		QueryNode &pn = nodes[least_cost_poly];
+		if (pn.closed)
+			continue; //already expanded with a lower cost
 
-			for (int i = 0; i < es; i++) {
-				Polygon::Edge &e = p->edges.write[i];
+		pn.closed = true;
 
-				if (!e.C)
-					continue;
-
-				Vector2 edge[2] = {
-					_get_vertex(p->edges[i].point),
-					_get_vertex(p->edges[(i + 1) % es].point)
-				};
-
-				Vector2 edge_point = Geometry::get_closest_point_to_segment_2d(p->entry, edge);
-				float dist = p->entry.distance_to(edge_point);
-				if (dist < shortest_distance)
-					shortest_distance = dist;
-			}
-
-			cost += shortest_distance;
-#else
-			cost += p->center.distance_to(end_point);
-#endif
-			if (cost < least_cost) {
-				least_cost_poly = E;
-				least_cost = cost;
-			}
-		}
-
-		Polygon *p = least_cost_poly->get();
+		Polygon *p = polygons[least_cost_poly];
 		//open the neighbours for search
 		int es = p->edges.size();
 
 		for (int i = 0; i < es; i++) {
 
-			Polygon::Edge &e = p->edges.write[i];
+			const Polygon::Edge &e = p->edges[i];
 
 			if (!e.C)
 				continue;
 
+			QueryNode &cn = nodes[e.C->id];
+
 #ifdef USE_ENTRY_POINT
 			Vector2 edge[2] = {
 				_get_vertex(p->edges[i].point),
 				_get_vertex(p->edges[(i + 1) % es].point)
 			};
 
-			Vector2 edge_entry = Geometry::get_closest_point_to_segment_2d(p->entry, edge);
-			float distance = p->entry.distance_to(edge_entry) + p->distance;
+			Vector2 edge_entry = Geometry::get_closest_point_to_segment_2d(pn.entry, edge);
+			float distance = pn.entry.distance_to(edge_entry) + pn.distance;
 
 #else
 
-			float distance = p->center.distance_to(e.C->center) + p->distance;
+			float distance = p->center.distance_to(e.C->center) + pn.distance;
 
 #endif
 
-			if (e.C->prev_edge != -1) {
-				//oh this was visited already, can we win the cost?
+			bool visited = cn.prev_edge != -1 || cn.closed;
 
-				if (e.C->distance > distance) {
+			if (visited && cn.distance <= distance)
+				continue; //oh this was visited already, and we can't win the cost
 
-					e.C->prev_edge = e.C_edge;
-					e.C->distance = distance;
+			cn.prev_edge = e.C_edge;
+			cn.distance = distance;
 #ifdef USE_ENTRY_POINT
-					e.C->entry = edge_entry;
+			cn.entry = edge_entry;
 #endif
-				}
-			} else {
-				//add to open neighbours
+			if (cn.closed)
+				continue;
 
-				e.C->prev_edge = e.C_edge;
-				e.C->distance = distance;
-#ifdef USE_ENTRY_POINT
-				e.C->entry = edge_entry;
-#endif
+			//add to open neighbours, or push again with the lower cost
 
-				open_list.push_back(e.C);
+			QueryOpen open;
+			open.polygon = e.C->id;
+			open.cost = distance + _get_cost_estimate(e.C, cn.entry, end_point);
+			open_list.push_back(open);
+			sorter.push_heap(0, open_list.size() - 1, 0, open, open_list.ptrw());
 
-				if (e.C == end_poly) {
-					//oh my reached end! stop algorithm
-					found_route = true;
-					break;
-				}
+			if (!visited && e.C == end_poly) {
+				//oh my reached end! stop algorithm
+				found_route = true;
+				break;
 			}
 		}
-
-		if (found_route)
-			break;
-
-		open_list.erase(least_cost_poly);
 	}
 
 	if (found_route) {
@@ -508,8 +624,8 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 					left = begin_point;
 					right = begin_point;
 				} else {
-					int prev = p->prev_edge;
-					int prev_n = (p->prev_edge + 1) % p->edges.size();
+					int prev = nodes[p->id].prev_edge;
+					int prev_n = (prev + 1) % p->edges.size();
 					left = _get_vertex(p->edges[prev].point);
 					right = _get_vertex(p->edges[prev_n].point);
 
@@ -575,7 +691,7 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 				}
 
 				if (p != begin_poly)
-					p = p->edges[p->prev_edge].C;
+					p = p->edges[nodes[p->id].prev_edge].C;
 				else
 					p = NULL;
 			}
@@ -585,8 +701,8 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 			Polygon *p = end_poly;
 
 			while (true) {
-				int prev = p->prev_edge;
-				int prev_n = (p->prev_edge + 1) % p->edges.size();
+				int prev = nodes[p->id].prev_edge;
+				int prev_n = (prev + 1) % p->edges.size();
 				Vector2 point = (_get_vertex(p->edges[prev].point) + _get_vertex(p->edges[prev_n].point)) * 0.5;
 				path.push_back(point);
 				p = p->edges[prev].C;
@@ -615,106 +731,203 @@ Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vect
 	return Vector<Vector2>();
 }
 
-Vector2 Navigation2D::get_closest_point(const Vector2 &p_point) {
+Vector<Vector2> Navigation2D::get_simple_path(const Vector2 &p_start, const Vector2 &p_end, bool p_optimize) {
 
-	Vector2 closest_point = Vector2();
-	float closest_point_d = 1e20;
+	_read_lock_index();
+	Vector<Vector2> path = _get_path(p_start, p_end, p_optimize);
+	lock->read_unlock();
 
-	for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
+	return path;
+}
 
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+int Navigation2D::request_path(const Vector2 &p_start, const Vector2 &p_end, bool p_optimize) {
 
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
+	PoolVector2Array starts;
+	starts.push_back(p_start);
+	PoolVector2Array ends;
+	ends.push_back(p_end);
 
-				if (Geometry::is_point_in_triangle(p_point, _get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point))) {
+	return request_paths(starts, ends, p_optimize)[0];
+}
 
-					return p_point; //inside triangle, nothing else to discuss
-				}
-			}
+PoolIntArray Navigation2D::request_paths(const PoolVector2Array &p_starts, const PoolVector2Array &p_ends, bool p_optimize) {
+
+	ERR_FAIL_COND_V(p_starts.size() != p_ends.size(), PoolIntArray());
+
+	int count = p_starts.size();
+	PoolIntArray ids;
+	ids.resize(count);
+
+	{
+		PoolVector2Array::Read starts = p_starts.read();
+		PoolVector2Array::Read ends = p_ends.read();
+		PoolIntArray::Write w = ids.write();
+
+		request_mutex->lock();
+		for (int i = 0; i < count; i++) {
+
+			PathRequest request;
+			request.id = last_request_id++;
+			request.start = starts[i];
+			request.end = ends[i];
+			request.optimize = p_optimize;
+			request.completed = false;
+			path_requests[request.id] = request;
+			pending_requests.push_back(request.id);
+			w[i] = request.id;
 		}
+		request_mutex->unlock();
 	}
 
-	for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
+#ifdef NO_THREADS
+	_process_path_requests();
+#else
+	if (!request_thread) {
+		request_pool = memnew(ThreadWorkPool);
+		request_pool->init();
+		exit_request_thread = false;
+		request_thread = Thread::create(&Navigation2D::_request_thread_function, this);
+	}
+	request_semaphore->post();
+#endif
 
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+	return ids;
+}
 
-			Polygon &p = F->get();
-			int es = p.edges.size();
-			for (int i = 0; i < es; i++) {
+bool Navigation2D::is_path_request_completed(int p_id) const {
 
-				Vector2 edge[2] = {
-					_get_vertex(p.edges[i].point),
-					_get_vertex(p.edges[(i + 1) % es].point)
-				};
+	request_mutex->lock();
+	const Map<int, PathRequest>::Element *E = path_requests.find(p_id);
+	bool completed = E && E->get().completed;
+	request_mutex->unlock();
 
-				Vector2 spoint = Geometry::get_closest_point_to_segment_2d(p_point, edge);
-				float d = spoint.distance_squared_to(p_point);
-				if (d < closest_point_d) {
+	return completed;
+}
 
-					closest_point = spoint;
-					closest_point_d = d;
-				}
-			}
-		}
+Vector<Vector2> Navigation2D::get_path_request_result(int p_id) {
+
+	request_mutex->lock();
+	Map<int, PathRequest>::Element *E = path_requests.find(p_id);
+	if (!E || !E->get().completed) {
+		request_mutex->unlock();
+		ERR_EXPLAIN("Path request " + itos(p_id) + " does not exist or is not completed.");
+		ERR_FAIL_V(Vector<Vector2>());
 	}
 
-	return closest_point;
+	Vector<Vector2> path = E->get().path;
+	path_requests.erase(E);
+	request_mutex->unlock();
+
+	return path;
 }
 
-Object *Navigation2D::get_closest_point_owner(const Vector2 &p_point) {
+void Navigation2D::cancel_path_request(int p_id) {
 
-	Object *owner = NULL;
-	Vector2 closest_point = Vector2();
-	float closest_point_d = 1e20;
+	request_mutex->lock();
+	path_requests.erase(p_id);
+	request_mutex->unlock();
+}
 
-	for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
+void Navigation2D::_request_thread_function(void *p_user) {
 
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+	Navigation2D *navigation = (Navigation2D *)p_user;
 
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
+	while (true) {
 
-				if (Geometry::is_point_in_triangle(p_point, _get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point))) {
+		navigation->request_semaphore->wait();
+		if (navigation->exit_request_thread)
+			break;
 
-					return E->get().owner;
-				}
-			}
+		navigation->_process_path_requests();
+	}
+}
+
+void Navigation2D::_path_request_process(uint32_t p_index, PathRequest *p_requests) {
+
+	PathRequest &request = p_requests[p_index];
+
+	_read_lock_index();
+	request.path = _get_path(request.start, request.end, request.optimize);
+	lock->read_unlock();
+}
+
+void Navigation2D::_process_path_requests() {
+
+	Vector<PathRequest> batch;
+
+	request_mutex->lock();
+	for (int i = 0; i < pending_requests.size(); i++) {
+
+		Map<int, PathRequest>::Element *E = path_requests.find(pending_requests[i]);
+		if (E) { //may have been cancelled
+			batch.push_back(E->get());
 		}
 	}
+	pending_requests.clear();
+	request_mutex->unlock();
 
-	for (Map<int, NavMesh>::Element *E = navpoly_map.front(); E; E = E->next()) {
+	if (batch.empty())
+		return;
 
-		if (!E->get().linked)
+	//each query takes the read lock on its own, so navpoly changes are never blocked for the whole batch
+	if (request_pool) {
+		request_pool->do_work(batch.size(), this, &Navigation2D::_path_request_process, batch.ptrw());
+	} else {
+		for (int i = 0; i < batch.size(); i++) {
+			_path_request_process(i, batch.ptrw());
+		}
+	}
+
+	PoolIntArray completed;
+
+	request_mutex->lock();
+	for (int i = 0; i < batch.size(); i++) {
+
+		Map<int, PathRequest>::Element *E = path_requests.find(batch[i].id);
+		if (!E)
 			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
 
-			Polygon &p = F->get();
-			int es = p.edges.size();
-			for (int i = 0; i < es; i++) {
+		E->get().path = batch[i].path;
+		E->get().completed = true;
+		completed.push_back(batch[i].id);
+	}
+	request_mutex->unlock();
+
+	if (completed.size()) {
+		call_deferred("_path_requests_completed", completed);
+	}
+}
 
-				Vector2 edge[2] = {
-					_get_vertex(p.edges[i].point),
-					_get_vertex(p.edges[(i + 1) % es].point)
-				};
+void Navigation2D::_path_requests_completed(const PoolIntArray &p_ids) {
 
-				Vector2 spoint = Geometry::get_closest_point_to_segment_2d(p_point, edge);
-				float d = spoint.distance_squared_to(p_point);
-				if (d < closest_point_d) {
+	PoolIntArray::Read r = p_ids.read();
+	for (int i = 0; i < p_ids.size(); i++) {
+		emit_signal("path_request_completed", r[i]);
+	}
+}
 
-					closest_point = spoint;
-					closest_point_d = d;
-					owner = E->get().owner;
-				}
-			}
-		}
+Vector2 Navigation2D::get_closest_point(const Vector2 &p_point) {
+
+	Vector2 closest_point = Vector2();
+
+	_read_lock_index();
+	_get_closest_polygon(p_point, &closest_point);
+	lock->read_unlock();
+
+	return closest_point;
+}
+
+Object *Navigation2D::get_closest_point_owner(const Vector2 &p_point) {
+
+	Object *owner = NULL;
+	Vector2 closest_point = Vector2();
+
+	_read_lock_index();
+	Polygon *closest = _get_closest_polygon(p_point, &closest_point);
+	if (closest) {
+		owner = closest->owner->owner;
 	}
+	lock->read_unlock();
 
 	return owner;
 }
@@ -728,6 +941,15 @@ void Navigation2D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_simple_path", "start", "end", "optimize"), &Navigation2D::get_simple_path, DEFVAL(true));
 	ClassDB::bind_method(D_METHOD("get_closest_point", "to_point"), &Navigation2D::get_closest_point);
 	ClassDB::bind_method(D_METHOD("get_closest_point_owner", "to_point"), &Navigation2D::get_closest_point_owner);
+
+	ClassDB::bind_method(D_METHOD("request_path", "start", "end", "optimize"), &Navigation2D::request_path, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("request_paths", "starts", "ends", "optimize"), &Navigation2D::request_paths, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("is_path_request_completed", "id"), &Navigation2D::is_path_request_completed);
+	ClassDB::bind_method(D_METHOD("get_path_request_result", "id"), &Navigation2D::get_path_request_result);
+	ClassDB::bind_method(D_METHOD("cancel_path_request", "id"), &Navigation2D::cancel_path_request);
+	ClassDB::bind_method(D_METHOD("_path_requests_completed"), &Navigation2D::_path_requests_completed);
+
+	ADD_SIGNAL(MethodInfo("path_request_completed", PropertyInfo(Variant::INT, "id")));
 }
 
 Navigation2D::Navigation2D() {
@@ -735,4 +957,31 @@ Navigation2D::Navigation2D() {
 	ERR_FAIL_COND(sizeof(Point) != 8);
 	cell_size = 1; // one pixel
 	last_id = 1;
+
+	index_dirty = false;
+	lock = RWLock::create();
+
+	last_request_id = 1;
+	request_mutex = Mutex::create();
+	request_semaphore = Semaphore::create();
+	request_thread = NULL;
+	request_pool = NULL;
+	exit_request_thread = false;
+}
+
+Navigation2D::~Navigation2D() {
+
+	if (request_thread) {
+		exit_request_thread = true;
+		request_semaphore->post();
+		Thread::wait_to_finish(request_thread);
+		memdelete(request_thread);
+	}
+	if (request_pool) {
+		memdelete(request_pool);
+	}
+
+	memdelete(request_semaphore);
+	memdelete(request_mutex);
+	memdelete(lock);
 }
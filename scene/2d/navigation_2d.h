@@ -31,9 +31,15 @@
 #ifndef NAVIGATION_2D_H
 #define NAVIGATION_2D_H
 
+#include "core/os/mutex.h"
+#include "core/os/rw_lock.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
 #include "scene/2d/navigation_polygon.h"
 #include "scene/2d/node_2d.h"
 
+class ThreadWorkPool;
+
 class Navigation2D : public Node2D {
 
 	GDCLASS(Navigation2D, Node2D);
@@ -93,10 +99,8 @@ class Navigation2D : public Node2D {
 		Vector<Edge> edges;
 
 		Vector2 center;
-		Vector2 entry;
-
-		float distance;
-		int prev_edge;
+		Rect2 aabb;
+		int id; // index in polygons, valid while the index is up to date
 
 		bool clockwise;
 
@@ -155,6 +159,83 @@ class Navigation2D : public Node2D {
 	Map<int, NavMesh> navpoly_map;
 	int last_id;
 
+	// Flat list of all linked polygons, and a bounding volume hierarchy over it
+	// for point location. Both are rebuilt lazily after navpolys change.
+
+	enum {
+		BVH_LEAF_SIZE = 4,
+		BVH_STACK_MAX = 64
+	};
+
+	struct BVHNode {
+		Rect2 aabb;
+		int children[2]; // -1 on leaves
+		int from; // range of polygons, on leaves
+		int count;
+	};
+
+	struct BVHSort {
+		int axis;
+		_FORCE_INLINE_ bool operator()(const Polygon *A, const Polygon *B) const { return A->center[axis] < B->center[axis]; }
+	};
+
+	Vector<Polygon *> polygons;
+	Vector<BVHNode> bvh;
+	bool index_dirty;
+	RWLock *lock; // navpoly changes write, queries read
+
+	int _build_bvh(int p_from, int p_count);
+	void _update_index();
+	void _read_lock_index();
+	Polygon *_get_closest_polygon(const Vector2 &p_point, Vector2 *r_point) const;
+
+	// A* state of a polygon during one query, kept outside of the polygons so queries can run concurrently.
+
+	struct QueryNode {
+		float distance;
+		int prev_edge;
+		Vector2 entry;
+		bool closed;
+	};
+
+	struct QueryOpen {
+		int polygon;
+		float cost;
+	};
+
+	struct QueryOpenSort {
+		_FORCE_INLINE_ bool operator()(const QueryOpen &A, const QueryOpen &B) const { return A.cost > B.cost; }
+	};
+
+	float _get_cost_estimate(const Polygon *p_poly, const Vector2 &p_entry, const Vector2 &p_end_point) const;
+	Vector<Vector2> _get_path(const Vector2 &p_start, const Vector2 &p_end, bool p_optimize);
+
+	// Path requests, solved in batches on a background thread.
+
+	struct PathRequest {
+		int id;
+		Vector2 start;
+		Vector2 end;
+		bool optimize;
+		bool completed;
+		Vector<Vector2> path;
+	};
+
+	Map<int, PathRequest> path_requests; // requests and results not yet fetched
+	Vector<int> pending_requests;
+	int last_request_id;
+
+	Mutex *request_mutex;
+	Semaphore *request_semaphore;
+	Thread *request_thread;
+	ThreadWorkPool *request_pool; // the request thread can't use the shared pool without serializing the main thread users
+	volatile bool exit_request_thread;
+
+	static void _request_thread_function(void *p_user);
+	void _process_path_requests();
+	void _path_request_process(uint32_t p_index, PathRequest *p_requests);
+	void _path_requests_completed(const PoolIntArray &p_ids);
+
 protected:
 	static void _bind_methods();
 
@@ -165,10 +246,18 @@ public:
 	void navpoly_remove(int p_id);
 
 	Vector<Vector2> get_simple_path(const Vector2 &p_start, const Vector2 &p_end, bool p_optimize = true);
+
+	int request_path(const Vector2 &p_start, const Vector2 &p_end, bool p_optimize = true);
+	PoolIntArray request_paths(const PoolVector2Array &p_starts, const PoolVector2Array &p_ends, bool p_optimize = true);
+	bool is_path_request_completed(int p_id) const;
+	Vector<Vector2> get_path_request_result(int p_id);
+	void cancel_path_request(int p_id);
+
 	Vector2 get_closest_point(const Vector2 &p_point);
 	Object *get_closest_point_owner(const Vector2 &p_point);
 
 	Navigation2D();
+	~Navigation2D();
 };
 
 #endif // NAVIGATION_2D_H
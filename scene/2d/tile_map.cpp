@@ -367,25 +367,67 @@ void TileMap::update_dirty_quadrants() {
 
 		q.canvas_items.clear();
 
-		if (!use_parent) {
-			ps->body_clear_shapes(q.body);
-		} else if (collision_parent) {
-			collision_parent->shape_owner_clear_shapes(q.shape_owner_id);
-		}
-		int shape_idx = 0;
+		// Canvas items are always redrawn for the whole quadrant, but physics shapes,
+		// navigation polygons and occluders are only rebuilt for the cells that changed.
+		if (q.dirty_all) {
+
+			if (!use_parent) {
+				ps->body_clear_shapes(q.body);
+			} else if (collision_parent) {
+				collision_parent->shape_owner_clear_shapes(q.shape_owner_id);
+			}
+			q.shape_cells.clear();
 
-		if (navigation) {
-			for (Map<PosKey, Quadrant::NavPoly>::Element *E = q.navpoly_ids.front(); E; E = E->next()) {
+			if (navigation) {
+				for (Map<PosKey, Quadrant::NavPoly>::Element *E = q.navpoly_ids.front(); E; E = E->next()) {
 
-				navigation->navpoly_remove(E->get().id);
+					navigation->navpoly_remove(E->get().id);
+				}
+				q.navpoly_ids.clear();
 			}
-			q.navpoly_ids.clear();
-		}
 
-		for (Map<PosKey, Quadrant::Occluder>::Element *E = q.occluder_instances.front(); E; E = E->next()) {
-			VS::get_singleton()->free(E->get().id);
+			for (Map<PosKey, Quadrant::Occluder>::Element *E = q.occluder_instances.front(); E; E = E->next()) {
+				VS::get_singleton()->free(E->get().id);
+			}
+			q.occluder_instances.clear();
+
+		} else {
+
+			// Remove back to front, so the indices of the shapes still to visit don't shift.
+			for (int i = q.shape_cells.size() - 1; i >= 0; i--) {
+
+				if (!q.dirty_cells.has(q.shape_cells[i]))
+					continue;
+
+				if (!use_parent) {
+					ps->body_remove_shape(q.body, i);
+				} else if (collision_parent) {
+					collision_parent->shape_owner_remove_shape(q.shape_owner_id, i);
+				}
+				q.shape_cells.remove(i);
+			}
+
+			for (int i = 0; i < q.dirty_cells.size(); i++) {
+
+				const PosKey &pk = q.dirty_cells[i];
+
+				if (navigation) {
+					Map<PosKey, Quadrant::NavPoly>::Element *N = q.navpoly_ids.find(pk);
+					if (N) {
+						navigation->navpoly_remove(N->get().id);
+						q.navpoly_ids.erase(N);
+					}
+				}
+
+				Map<PosKey, Quadrant::Occluder>::Element *O = q.occluder_instances.find(pk);
+				if (O) {
+					VS::get_singleton()->free(O->get().id);
+					q.occluder_instances.erase(O);
+				}
+			}
 		}
-		q.occluder_instances.clear();
+
+		int shape_idx = q.shape_cells.size();
 		Ref<ShaderMaterial> prev_material;
 		int prev_z_index = 0;
 		RID prev_canvas_item;
@@ -395,6 +437,7 @@ void TileMap::update_dirty_quadrants() {
 
 			Map<PosKey, Cell>::Element *E = tile_map.find(q.cells[i]);
 			Cell &c = E->get();
+			bool rebuild_cell = q.dirty_all || q.dirty_cells.has(E->key());
 			//moment of truth
 			if (!tile_set->has_tile(c.id))
 				continue;
@@ -574,18 +617,20 @@ void TileMap::update_dirty_quadrants() {
 
 						if (shape->has_meta("decomposed")) {
 							Array _shapes = shape->get_meta("decomposed");
-							for (int k = 0; k < _shapes.size(); k++) {
+							for (int k = 0; k < _shapes.size() && rebuild_cell; k++) {
 								Ref<ConvexPolygonShape2D> convex = _shapes[k];
 								if (convex.is_valid()) {
 									_add_shape(shape_idx, q, convex, shapes[j], xform, Vector2(E->key().x, E->key().y));
+									q.shape_cells.push_back(E->key());
 #ifdef DEBUG_ENABLED
 								} else {
 									print_error("The TileSet assigned to the TileMap " + get_name() + " has an invalid convex shape.");
 #endif
 								}
 							}
-						} else {
+						} else if (rebuild_cell) {
 							_add_shape(shape_idx, q, shape, shapes[j], xform, Vector2(E->key().x, E->key().y));
+							q.shape_cells.push_back(E->key());
 						}
 					}
 				}
@@ -611,16 +656,19 @@ void TileMap::update_dirty_quadrants() {
 					xform.set_origin(offset.floor() + q.pos);
 					_fix_cell_transform(xform, c, npoly_ofs, s);
 
-					int pid = navigation->navpoly_add(navpoly, nav_rel * xform);
+					if (rebuild_cell) {
+						int pid = navigation->navpoly_add(navpoly, nav_rel * xform);
 
-					Quadrant::NavPoly np;
-					np.id = pid;
-					np.xform = xform;
-					q.navpoly_ids[E->key()] = np;
+						Quadrant::NavPoly np;
+						np.id = pid;
+						np.xform = xform;
+						q.navpoly_ids[E->key()] = np;
+					}
 
 					if (debug_navigation) {
 						RID debug_navigation_item = vs->canvas_item_create();
 						vs->canvas_item_set_parent(debug_navigation_item, canvas_item);
+						q.canvas_items.push_back(debug_navigation_item);
 						vs->canvas_item_set_z_as_relative_to_parent(debug_navigation_item, false);
 						vs->canvas_item_set_z_index(debug_navigation_item, VS::CANVAS_ITEM_Z_MAX - 2); // Display one below collision debug
 
@@ -675,7 +723,7 @@ void TileMap::update_dirty_quadrants() {
 			} else {
 				occluder = tile_set->tile_get_light_occluder(c.id);
 			}
-			if (occluder.is_valid()) {
+			if (occluder.is_valid() && rebuild_cell) {
 				Vector2 occluder_ofs = tile_set->tile_get_occluder_offset(c.id);
 				Transform2D xform;
 				xform.set_origin(offset.floor() + q.pos);
@@ -693,6 +741,9 @@ void TileMap::update_dirty_quadrants() {
 			}
 		}
 
+		q.dirty_cells.clear();
+		q.dirty_all = false;
+
 		dirty_quadrant_list.remove(dirty_quadrant_list.first());
 		quadrant_order_dirty = true;
 	}
@@ -786,7 +837,9 @@ Map<TileMap::PosKey, TileMap::Quadrant>::Element *TileMap::_create_quadrant(cons
 
 	rect_cache_dirty = true;
 	quadrant_order_dirty = true;
-	return quadrant_map.insert(p_qk, q);
+	Map<PosKey, Quadrant>::Element *Q = quadrant_map.insert(p_qk, q);
+	quadrant_index.set(p_qk, Q);
+	return Q;
 }
 
 void TileMap::_erase_quadrant(Map<PosKey, Quadrant>::Element *Q) {
@@ -819,13 +872,22 @@ void TileMap::_erase_quadrant(Map<PosKey, Quadrant>::Element *Q) {
 	}
 	q.occluder_instances.clear();
 
+	quadrant_index.erase(Q->key());
 	quadrant_map.erase(Q);
 	rect_cache_dirty = true;
 }
 
 void TileMap::_make_quadrant_dirty(Map<PosKey, Quadrant>::Element *Q, bool update) {
 
+	Q->get().dirty_all = true;
+	_make_quadrant_dirty(Q, PosKey(), update);
+}
+
+void TileMap::_make_quadrant_dirty(Map<PosKey, Quadrant>::Element *Q, const PosKey &p_cell, bool update) {
+
 	Quadrant &q = Q->get();
+	if (!q.dirty_all)
+		q.dirty_cells.insert(p_cell);
 	if (!q.dirty_list.in_list())
 		dirty_quadrant_list.add(&q.dirty_list);
 
@@ -865,20 +927,20 @@ void TileMap::set_cell(int p_x, int p_y, int p_tile, bool p_flip_x, bool p_flip_
 	if (p_tile == INVALID_CELL) {
 		//erase existing
 		tile_map.erase(pk);
-		Map<PosKey, Quadrant>::Element *Q = quadrant_map.find(qk);
+		Map<PosKey, Quadrant>::Element *Q = _find_quadrant(qk);
 		ERR_FAIL_COND(!Q);
 		Quadrant &q = Q->get();
 		q.cells.erase(pk);
 		if (q.cells.size() == 0)
 			_erase_quadrant(Q);
 		else
-			_make_quadrant_dirty(Q);
+			_make_quadrant_dirty(Q, pk);
 
 		used_size_cache_dirty = true;
 		return;
 	}
 
-	Map<PosKey, Quadrant>::Element *Q = quadrant_map.find(qk);
+	Map<PosKey, Quadrant>::Element *Q = _find_quadrant(qk);
 
 	if (!E) {
 		E = tile_map.insert(pk, Cell());
@@ -903,10 +965,25 @@ void TileMap::set_cell(int p_x, int p_y, int p_tile, bool p_flip_x, bool p_flip_
 	c.autotile_coord_x = (uint16_t)p_autotile_coord.x;
 	c.autotile_coord_y = (uint16_t)p_autotile_coord.y;
 
-	_make_quadrant_dirty(Q);
+	_make_quadrant_dirty(Q, pk);
 	used_size_cache_dirty = true;
 }
 
+void TileMap::set_cells(const PoolVector2Array &p_cells, const PoolIntArray &p_tiles) {
+
+	int count = p_cells.size();
+	ERR_FAIL_COND(p_tiles.size() != 1 && p_tiles.size() != count);
+
+	// All quadrants touched here are rebuilt once, on the next update_dirty_quadrants().
+	PoolVector2Array::Read r = p_cells.read();
+	PoolIntArray::Read t = p_tiles.read();
+	bool single_tile = p_tiles.size() == 1;
+
+	for (int i = 0; i < count; i++) {
+		set_cell(r[i].x, r[i].y, single_tile ? t[0] : t[i]);
+	}
+}
+
 int TileMap::get_cellv(const Vector2 &p_pos) const {
 
 	return get_cell(p_pos.x, p_pos.y);
@@ -1021,8 +1098,8 @@ void TileMap::update_cell_bitmask(int p_x, int p_y) {
 			E->get().autotile_coord_y = (int)coord.y;
 
 			PosKey qk = p.to_quadrant(_get_quadrant_size());
-			Map<PosKey, Quadrant>::Element *Q = quadrant_map.find(qk);
-			_make_quadrant_dirty(Q);
+			Map<PosKey, Quadrant>::Element *Q = _find_quadrant(qk);
+			_make_quadrant_dirty(Q, p);
 
 		} else if (tile_set->tile_get_tile_mode(id) == TileSet::SINGLE_TILE) {
 
@@ -1118,12 +1195,12 @@ void TileMap::set_cell_autotile_coord(int p_x, int p_y, const Vector2 &p_coord)
 	tile_map[pk] = c;
 
 	PosKey qk = pk.to_quadrant(_get_quadrant_size());
-	Map<PosKey, Quadrant>::Element *Q = quadrant_map.find(qk);
+	Map<PosKey, Quadrant>::Element *Q = _find_quadrant(qk);
 
 	if (!Q)
 		return;
 
-	_make_quadrant_dirty(Q);
+	_make_quadrant_dirty(Q, pk);
 }
 
 Vector2 TileMap::get_cell_autotile_coord(int p_x, int p_y) const {
@@ -1146,7 +1223,7 @@ void TileMap::_recreate_quadrants() {
 
 		PosKey qk = PosKey(E->key().x, E->key().y).to_quadrant(_get_quadrant_size());
 
-		Map<PosKey, Quadrant>::Element *Q = quadrant_map.find(qk);
+		Map<PosKey, Quadrant>::Element *Q = _find_quadrant(qk);
 		if (!Q) {
 			Q = _create_quadrant(qk);
 			dirty_quadrant_list.add(&Q->get().dirty_list);
@@ -1855,6 +1932,7 @@ void TileMap::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("set_cell", "x", "y", "tile", "flip_x", "flip_y", "transpose", "autotile_coord"), &TileMap::set_cell, DEFVAL(false), DEFVAL(false), DEFVAL(false), DEFVAL(Vector2()));
 	ClassDB::bind_method(D_METHOD("set_cellv", "position", "tile", "flip_x", "flip_y", "transpose"), &TileMap::set_cellv, DEFVAL(false), DEFVAL(false), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("set_cells", "cells", "tiles"), &TileMap::set_cells);
 	ClassDB::bind_method(D_METHOD("_set_celld", "position", "data"), &TileMap::_set_celld);
 	ClassDB::bind_method(D_METHOD("get_cell", "x", "y"), &TileMap::get_cell);
 	ClassDB::bind_method(D_METHOD("get_cellv", "position"), &TileMap::get_cellv);
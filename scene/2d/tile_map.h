@@ -31,6 +31,7 @@
 #ifndef TILE_MAP_H
 #define TILE_MAP_H
 
+#include "core/hash_map.h"
 #include "core/self_list.h"
 #include "core/vset.h"
 #include "scene/2d/navigation_2d.h"
@@ -111,6 +112,10 @@ private:
 		}
 	};
 
+	struct PosKeyHasher {
+		static _FORCE_INLINE_ uint32_t hash(const PosKey &p_key) { return hash_djb2_one_32(p_key.key); }
+	};
+
 	union Cell {
 
 		struct {
@@ -135,6 +140,7 @@ private:
 		List<RID> canvas_items;
 		RID body;
 		uint32_t shape_owner_id;
+		Vector<PosKey> shape_cells; // owning cell of each shape, in shape index order
 
 		SelfList<Quadrant> dirty_list;
 
@@ -153,14 +159,22 @@ private:
 
 		VSet<PosKey> cells;
 
+		// Cells whose physics, navigation and occluders must be rebuilt.
+		// When dirty_all is set, the whole quadrant is rebuilt instead.
+		VSet<PosKey> dirty_cells;
+		bool dirty_all;
+
 		void operator=(const Quadrant &q) {
 			pos = q.pos;
 			canvas_items = q.canvas_items;
 			body = q.body;
 			shape_owner_id = q.shape_owner_id;
+			shape_cells = q.shape_cells;
 			cells = q.cells;
 			navpoly_ids = q.navpoly_ids;
 			occluder_instances = q.occluder_instances;
+			dirty_cells = q.dirty_cells;
+			dirty_all = q.dirty_all;
 		}
 		Quadrant(const Quadrant &q) :
 				dirty_list(this) {
@@ -168,15 +182,22 @@ private:
 			canvas_items = q.canvas_items;
 			body = q.body;
 			shape_owner_id = q.shape_owner_id;
+			shape_cells = q.shape_cells;
 			cells = q.cells;
 			occluder_instances = q.occluder_instances;
 			navpoly_ids = q.navpoly_ids;
+			dirty_cells = q.dirty_cells;
+			dirty_all = q.dirty_all;
 		}
 		Quadrant() :
-				dirty_list(this) {}
+				dirty_list(this) {
+			dirty_all = true;
+		}
 	};
 
+	// quadrant_map keeps quadrants sorted for draw ordering, quadrant_index gives constant time lookup.
 	Map<PosKey, Quadrant> quadrant_map;
+	HashMap<PosKey, Map<PosKey, Quadrant>::Element *, PosKeyHasher> quadrant_index;
 
 	SelfList<Quadrant>::List dirty_quadrant_list;
 
@@ -206,9 +227,14 @@ private:
 
 	void _add_shape(int &shape_idx, const Quadrant &p_q, const Ref<Shape2D> &p_shape, const TileSet::ShapeData &p_shape_data, const Transform2D &p_xform, const Vector2 &p_metadata);
 
+	_FORCE_INLINE_ Map<PosKey, Quadrant>::Element *_find_quadrant(const PosKey &p_qk) const {
+		Map<PosKey, Quadrant>::Element *const *Q = quadrant_index.getptr(p_qk);
+		return Q ? *Q : NULL;
+	}
 	Map<PosKey, Quadrant>::Element *_create_quadrant(const PosKey &p_qk);
 	void _erase_quadrant(Map<PosKey, Quadrant>::Element *Q);
 	void _make_quadrant_dirty(Map<PosKey, Quadrant>::Element *Q, bool update = true);
+	void _make_quadrant_dirty(Map<PosKey, Quadrant>::Element *Q, const PosKey &p_cell, bool update = true);
 	void _recreate_quadrants();
 	void _clear_quadrants();
 	void _update_quadrant_space(const RID &p_space);
@@ -265,6 +291,7 @@ public:
 
 	void _set_celld(const Vector2 &p_pos, const Dictionary &p_data);
 	void set_cellv(const Vector2 &p_pos, int p_tile, bool p_flip_x = false, bool p_flip_y = false, bool p_transpose = false);
+	void set_cells(const PoolVector2Array &p_cells, const PoolIntArray &p_tiles);
 	int get_cellv(const Vector2 &p_pos) const;
 
 	void make_bitmask_area_dirty(const Vector2 &p_pos);
@@ -140,31 +140,80 @@ void AudioStreamPlayer3D::_mix_audio() {
 		stream_playback->start(setseek);
 		setseek = -1.0; //reset seek
 		started = true;
+		virtual_time = 0;
 	}
 
 	//get data
 	AudioFrame *buffer = mix_buffer.ptrw();
 	int buffer_size = mix_buffer.size();
 
-	if (stream_paused_fade_out) {
-		// Short fadeout ramp
-		buffer_size = MIN(buffer_size, 128);
+	// Playback only moves while in range, or out of range in mix mode
+	bool advance = output_count > 0 || out_of_range_mode == OUT_OF_RANGE_MIX;
+
+	float output_pitch_scale = 0.0;
+	if (output_count) {
+		//used for doppler, not realistic but good enough
+		for (int i = 0; i < output_count; i++) {
+			output_pitch_scale += outputs[i].pitch_scale;
+		}
+		output_pitch_scale /= float(output_count);
+	} else {
+		output_pitch_scale = 1.0;
 	}
 
-	// Mix if we're not paused or we're fading out
-	if ((output_count > 0 || out_of_range_mode == OUT_OF_RANGE_MIX)) {
+	float frame_time = pitch_scale * output_pitch_scale / AudioServer::get_singleton()->get_mix_rate();
+
+	bool fade_in = stream_paused_fade_in;
+	bool fade_out = stream_paused_fade_out;
+
+	if (voice && voice->virtualized && !stream_paused_fade_out) {
+
+		if (virtualized || started) {
+			//nobody hears this voice, keep time without decoding or mixing
+			virtualized = true;
+			if (advance) {
+				virtual_time += buffer_size * frame_time;
+				float length = stream->get_length();
+				if (length > 0 && stream_playback->get_playback_position() + virtual_time >= length) {
+					//let the playback loop or finish
+					stream_playback->advance(virtual_time);
+					virtual_time = 0;
+				}
+			}
 
-		float output_pitch_scale = 0.0;
-		if (output_count) {
-			//used for doppler, not realistic but good enough
-			for (int i = 0; i < output_count; i++) {
-				output_pitch_scale += outputs[i].pitch_scale;
+			prev_output_count = 0;
+			if (!stream_playback->is_playing()) {
+				active = false;
 			}
-			output_pitch_scale /= float(output_count);
-		} else {
-			output_pitch_scale = 1.0;
+
+			output_ready = false;
+			stream_paused_fade_in = false;
+			return;
+		}
+
+		//fade out what is being heard, skip the rest of the block
+		virtualized = true;
+		fade_out = true;
+		if (advance) {
+			virtual_time += (buffer_size - MIN(buffer_size, 128)) * frame_time;
+		}
+
+	} else if (virtualized) {
+
+		virtualized = false;
+		fade_in = true;
+		if (virtual_time > 0) {
+			stream_playback->advance(virtual_time);
+			virtual_time = 0;
 		}
+	}
 
+	if (fade_out) {
+		// Short fadeout ramp
+		buffer_size = MIN(buffer_size, 128);
+	}
+
+	if (advance) {
 		stream_playback->mix(buffer, pitch_scale * output_pitch_scale, buffer_size);
 	}
 
@@ -202,10 +251,10 @@ void AudioStreamPlayer3D::_mix_audio() {
 		int buffers = AudioServer::get_singleton()->get_channel_count();
 
 		for (int k = 0; k < buffers; k++) {
-			AudioFrame target_volume = stream_paused_fade_out ? AudioFrame(0.f, 0.f) : current.vol[k];
-			AudioFrame vol_prev = stream_paused_fade_in ? AudioFrame(0.f, 0.f) : prev_outputs[i].vol[k];
+			AudioFrame target_volume = fade_out ? AudioFrame(0.f, 0.f) : current.vol[k];
+			AudioFrame vol_prev = fade_in ? AudioFrame(0.f, 0.f) : prev_outputs[i].vol[k];
 			AudioFrame vol_inc = (target_volume - vol_prev) / float(buffer_size);
-			AudioFrame vol = stream_paused_fade_in ? AudioFrame(0.f, 0.f) : current.vol[k];
+			AudioFrame vol = fade_in ? AudioFrame(0.f, 0.f) : current.vol[k];
 
 			if (!AudioServer::get_singleton()->thread_has_channel_mix_buffer(current.bus_index, k))
 				continue; //may have been deleted, will be updated on process
@@ -334,6 +383,7 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 	if (p_what == NOTIFICATION_ENTER_TREE) {
 
 		velocity_tracker->reset(get_global_transform().origin);
+		voice = AudioServer::get_singleton()->voice_create();
 		AudioServer::get_singleton()->add_callback(_mix_audios, this);
 		if (autoplay && !Engine::get_singleton()->is_editor_hint()) {
 			play();
@@ -343,6 +393,8 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 	if (p_what == NOTIFICATION_EXIT_TREE) {
 
 		AudioServer::get_singleton()->remove_callback(_mix_audios, this);
+		AudioServer::get_singleton()->voice_free(voice);
+		voice = NULL;
 	}
 
 	if (p_what == NOTIFICATION_PAUSED) {
@@ -380,6 +432,7 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 			ERR_FAIL_COND(world.is_null());
 
 			int new_output_count = 0;
+			float audibility = 0;
 
 			Vector3 global_pos = get_global_transform().origin;
 
@@ -605,6 +658,11 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 					}
 				}
 
+				for (int i = 0; i < vol_index_max; i++) {
+					audibility = MAX(audibility, MAX(output.vol[i].l, output.vol[i].r));
+					audibility = MAX(audibility, MAX(output.reverb_vol[i].l, output.reverb_vol[i].r));
+				}
+
 				outputs[new_output_count] = output;
 				new_output_count++;
 				if (new_output_count == MAX_OUTPUTS)
@@ -613,6 +671,11 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 
 			output_count = new_output_count;
 			output_ready = true;
+
+			if (voice) {
+				voice->audibility = audibility;
+				voice->priority = priority;
+			}
 		}
 
 		//start playing if requested
@@ -624,6 +687,10 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 			///_change_notify("playing"); //update property in editor
 		}
 
+		if (voice) {
+			voice->playing = active && !stream_paused;
+		}
+
 		//stop playing if no longer active
 		if (!active) {
 			set_physics_process_internal(false);
@@ -722,6 +789,9 @@ void AudioStreamPlayer3D::stop() {
 		active = false;
 		set_physics_process_internal(false);
 		setplay = -1;
+		if (voice) {
+			voice->playing = false;
+		}
 	}
 }
 
@@ -927,6 +997,21 @@ bool AudioStreamPlayer3D::get_stream_paused() const {
 	return stream_paused;
 }
 
+void AudioStreamPlayer3D::set_priority(int p_priority) {
+
+	priority = p_priority;
+}
+
+int AudioStreamPlayer3D::get_priority() const {
+
+	return priority;
+}
+
+bool AudioStreamPlayer3D::is_virtual() const {
+
+	return active && virtualized;
+}
+
 Ref<AudioStreamPlayback> AudioStreamPlayer3D::get_stream_playback() {
 	return stream_playback;
 }
@@ -997,6 +1082,11 @@ void AudioStreamPlayer3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_stream_paused", "pause"), &AudioStreamPlayer3D::set_stream_paused);
 	ClassDB::bind_method(D_METHOD("get_stream_paused"), &AudioStreamPlayer3D::get_stream_paused);
 
+	ClassDB::bind_method(D_METHOD("set_priority", "priority"), &AudioStreamPlayer3D::set_priority);
+	ClassDB::bind_method(D_METHOD("get_priority"), &AudioStreamPlayer3D::get_priority);
+
+	ClassDB::bind_method(D_METHOD("is_virtual"), &AudioStreamPlayer3D::is_virtual);
+
 	ClassDB::bind_method(D_METHOD("get_stream_playback"), &AudioStreamPlayer3D::get_stream_playback);
 
 	ClassDB::bind_method(D_METHOD("_bus_layout_changed"), &AudioStreamPlayer3D::_bus_layout_changed);
@@ -1014,6 +1104,7 @@ void AudioStreamPlayer3D::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "out_of_range_mode", PROPERTY_HINT_ENUM, "Mix,Pause"), "set_out_of_range_mode", "get_out_of_range_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "bus", PROPERTY_HINT_ENUM, ""), "set_bus", "get_bus");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "area_mask", PROPERTY_HINT_LAYERS_2D_PHYSICS), "set_area_mask", "get_area_mask");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "priority", PROPERTY_HINT_RANGE, "-128,127,1"), "set_priority", "get_priority");
 	ADD_GROUP("Emission Angle", "emission_angle");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "emission_angle_enabled"), "set_emission_angle_enabled", "is_emission_angle_enabled");
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "emission_angle_degrees", PROPERTY_HINT_RANGE, "0.1,90,0.1"), "set_emission_angle", "get_emission_angle");
@@ -1065,6 +1156,10 @@ AudioStreamPlayer3D::AudioStreamPlayer3D() {
 	stream_paused = false;
 	stream_paused_fade_in = false;
 	stream_paused_fade_out = false;
+	voice = NULL;
+	priority = 0;
+	virtualized = false;
+	virtual_time = 0;
 
 	velocity_tracker.instance();
 	AudioServer::get_singleton()->connect("bus_layout_changed", this, "_bus_layout_changed");
@@ -115,6 +115,11 @@ private:
 	bool stream_paused_fade_out;
 	StringName bus;
 
+	AudioServer::Voice *voice;
+	int priority;
+	bool virtualized; //audio thread side, true while only the playback position is advanced
+	float virtual_time; //time to skip when the voice becomes real again
+
 	static void _calc_output_vol(const Vector3 &source_dir, real_t tightness, Output &output);
 	void _mix_audio();
 	static void _mix_audios(void *self) { reinterpret_cast<AudioStreamPlayer3D *>(self)->_mix_audio(); }
@@ -208,6 +213,11 @@ public:
 	void set_stream_paused(bool p_pause);
 	bool get_stream_paused() const;
 
+	void set_priority(int p_priority);
+	int get_priority() const;
+
+	bool is_virtual() const;
+
 	Ref<AudioStreamPlayback> get_stream_playback();
 
 	AudioStreamPlayer3D();
@@ -30,6 +30,8 @@
 
 #include "cpu_particles.h"
 
+#include "core/math/random_pcg.h"
+#include "core/os/thread_work_pool.h"
 #include "scene/3d/camera.h"
 #include "scene/3d/particles.h"
 #include "scene/resources/particles_material.h"
@@ -515,8 +517,6 @@ void CPUParticles::_particles_process(float p_delta) {
 	int pcount = particles.size();
 	PoolVector<Particle>::Write w = particles.write();
 
-	Particle *parray = w.ptr();
-
 	float prev_time = time;
 	time += p_delta;
 	if (time > lifetime) {
@@ -537,14 +537,82 @@ void CPUParticles::_particles_process(float p_delta) {
 
 	float system_phase = time / lifetime;
 
-	for (int i = 0; i < pcount; i++) {
+	ProcessData data;
+	data.particles = w.ptr();
+	data.particle_count = pcount;
+	data.delta = p_delta;
+	data.prev_time = prev_time;
+	data.system_phase = system_phase;
+	data.emission_xform = emission_xform;
+	data.velocity_xform = velocity_xform;
+	data.seed = Math::rand();
+
+	if (color_ramp.is_valid()) {
+		color_ramp->get_color_at_offset(0.0); // sorts the ramp points here, jobs only read them
+	}
+
+	PoolVector<Vector3>::Read emission_points_r = emission_points.read();
+	PoolVector<Vector3>::Read emission_normals_r = emission_normals.read();
+	PoolVector<Color>::Read emission_colors_r = emission_colors.read();
+	data.emission_points = emission_points_r.ptr();
+	data.emission_points_size = emission_points.size();
+	data.emission_normals = emission_normals_r.ptr();
+	data.emission_normals_size = emission_normals.size();
+	data.emission_colors = emission_colors_r.ptr();
+	data.emission_colors_size = emission_colors.size();
+
+	// Render data only needs sorting for other draw orders, otherwise it is written while the chunk is still in cache.
+	bool write_data = draw_order == DRAW_ORDER_INDEX;
+
+#ifndef NO_THREADS
+	if (write_data)
+		update_mutex->lock();
+#endif
+
+	{
+		PoolVector<float>::Write dw;
+		data.particle_data = NULL;
+		if (write_data) {
+			dw = particle_data.write();
+			data.particle_data = dw.ptr();
+		}
+
+		int chunk_count = (pcount + PROCESS_CHUNK_SIZE - 1) / PROCESS_CHUNK_SIZE;
+		ThreadWorkPool::get_singleton()->do_work(chunk_count, this, &CPUParticles::_particles_process_chunk, &data);
+	}
+
+#ifndef NO_THREADS
+	if (write_data)
+		update_mutex->unlock();
+#endif
+}
+
+// A step touches nearly every field of a particle through branches and curve lookups,
+// so particles are split across threads in chunks rather than across vector lanes.
+void CPUParticles::_particles_process_chunk(uint32_t p_chunk, ProcessData *p_data) {
+
+	int from = p_chunk * PROCESS_CHUNK_SIZE;
+	int to = MIN(from + PROCESS_CHUNK_SIZE, p_data->particle_count);
+
+	// Math::rand() is not thread safe, so each chunk draws from its own stream.
+	RandomPCG rng(p_data->seed, p_chunk);
+
+	Particle *parray = p_data->particles;
+	int pcount = p_data->particle_count;
+	float delta = p_data->delta;
+	float prev_time = p_data->prev_time;
+	float system_phase = p_data->system_phase;
+	const Transform &emission_xform = p_data->emission_xform;
+	const Basis &velocity_xform = p_data->velocity_xform;
+
+	for (int i = from; i < to; i++) {
 
 		Particle &p = parray[i];
 
 		if (!emitting && !p.active)
 			continue;
 
-		float local_delta = p_delta;
+		float local_delta = delta;
 
 		// The phase is a ratio between 0 (birth) and 1 (end of life) for each particle.
 		// While we use time in tests later on, for randomness we use the phase as done in the
@@ -618,28 +686,28 @@ void CPUParticles::_particles_process(float p_delta) {
 				tex_anim_offset = curve_parameters[PARAM_ANGLE]->interpolate(0);
 			}
 
-			p.seed = Math::rand();
+			p.seed = rng.rand();
 
-			p.angle_rand = Math::randf();
-			p.scale_rand = Math::randf();
-			p.hue_rot_rand = Math::randf();
-			p.anim_offset_rand = Math::randf();
+			p.angle_rand = rng.randf();
+			p.scale_rand = rng.randf();
+			p.hue_rot_rand = rng.randf();
+			p.anim_offset_rand = rng.randf();
 
 			if (flags[FLAG_DISABLE_Z]) {
-				float angle1_rad = Math::atan2(direction.y, direction.x) + (Math::randf() * 2.0 - 1.0) * Math_PI * spread / 180.0;
+				float angle1_rad = Math::atan2(direction.y, direction.x) + (rng.randf() * 2.0 - 1.0) * Math_PI * spread / 180.0;
 				Vector3 rot = Vector3(Math::cos(angle1_rad), Math::sin(angle1_rad), 0.0);
-				p.velocity = rot * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, float(Math::randf()), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
+				p.velocity = rot * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, float(rng.randf()), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
 			} else {
 				//initiate velocity spread in 3D
-				float angle1_rad = Math::atan2(direction.x, direction.z) + (Math::randf() * 2.0 - 1.0) * Math_PI * spread / 180.0;
-				float angle2_rad = Math::atan2(direction.y, Math::abs(direction.z)) + (Math::randf() * 2.0 - 1.0) * (1.0 - flatness) * Math_PI * spread / 180.0;
+				float angle1_rad = Math::atan2(direction.x, direction.z) + (rng.randf() * 2.0 - 1.0) * Math_PI * spread / 180.0;
+				float angle2_rad = Math::atan2(direction.y, Math::abs(direction.z)) + (rng.randf() * 2.0 - 1.0) * (1.0 - flatness) * Math_PI * spread / 180.0;
 
 				Vector3 direction_xz = Vector3(Math::sin(angle1_rad), 0, Math::cos(angle1_rad));
 				Vector3 direction_yz = Vector3(0, Math::sin(angle2_rad), Math::cos(angle2_rad));
 				direction_yz.z = direction_yz.z / MAX(0.0001, Math::sqrt(ABS(direction_yz.z))); //better uniform distribution
 				Vector3 direction = Vector3(direction_xz.x * direction_yz.z, direction_yz.y, direction_xz.z * direction_yz.z);
 				direction.normalize();
-				p.velocity = direction * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, float(Math::randf()), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
+				p.velocity = direction * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, float(rng.randf()), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
 			}
 
 			float base_angle = (parameters[PARAM_ANGLE] + tex_angle) * Math::lerp(1.0f, p.angle_rand, randomness[PARAM_ANGLE]);
@@ -648,7 +716,7 @@ void CPUParticles::_particles_process(float p_delta) {
 			p.custom[2] = (parameters[PARAM_ANIM_OFFSET] + tex_anim_offset) * Math::lerp(1.0f, p.anim_offset_rand, randomness[PARAM_ANIM_OFFSET]); //animation offset (0-1)
 			p.transform = Transform();
 			p.time = 0;
-			p.lifetime = lifetime * (1.0 - Math::randf() * lifetime_randomness);
+			p.lifetime = lifetime * (1.0 - rng.randf() * lifetime_randomness);
 			p.base_color = Color(1, 1, 1, 1);
 
 			switch (emission_shape) {
@@ -656,25 +724,25 @@ void CPUParticles::_particles_process(float p_delta) {
 					//do none
 				} break;
 				case EMISSION_SHAPE_SPHERE: {
-					float s = 2.0 * Math::randf() - 1.0, t = 2.0 * Math_PI * Math::randf();
+					float s = 2.0 * rng.randf() - 1.0, t = 2.0 * Math_PI * rng.randf();
 					float radius = emission_sphere_radius * Math::sqrt(1.0 - s * s);
 					p.transform.origin = Vector3(radius * Math::cos(t), radius * Math::sin(t), emission_sphere_radius * s);
 				} break;
 				case EMISSION_SHAPE_BOX: {
-					p.transform.origin = Vector3(Math::randf() * 2.0 - 1.0, Math::randf() * 2.0 - 1.0, Math::randf() * 2.0 - 1.0) * emission_box_extents;
+					p.transform.origin = Vector3(rng.randf() * 2.0 - 1.0, rng.randf() * 2.0 - 1.0, rng.randf() * 2.0 - 1.0) * emission_box_extents;
 				} break;
 				case EMISSION_SHAPE_POINTS:
 				case EMISSION_SHAPE_DIRECTED_POINTS: {
 
-					int pc = emission_points.size();
+					int pc = p_data->emission_points_size;
 					if (pc == 0)
 						break;
 
-					int random_idx = Math::rand() % pc;
+					int random_idx = rng.rand() % pc;
 
-					p.transform.origin = emission_points.get(random_idx);
+					p.transform.origin = p_data->emission_points[random_idx];
 
-					if (emission_shape == EMISSION_SHAPE_DIRECTED_POINTS && emission_normals.size() == pc) {
+					if (emission_shape == EMISSION_SHAPE_DIRECTED_POINTS && p_data->emission_normals_size == pc) {
 						if (flags[FLAG_DISABLE_Z]) {
 							/*
 							mat2 rotm;
@@ -684,7 +752,7 @@ void CPUParticles::_particles_process(float p_delta) {
 							VELOCITY.xy = rotm * VELOCITY.xy;
 							*/
 						} else {
-							Vector3 normal = emission_normals.get(random_idx);
+							Vector3 normal = p_data->emission_normals[random_idx];
 							Vector3 v0 = Math::abs(normal.z) < 0.999 ? Vector3(0.0, 0.0, 1.0) : Vector3(0, 1.0, 0.0);
 							Vector3 tangent = v0.cross(normal).normalized();
 							Vector3 bitangent = tangent.cross(normal).normalized();
@@ -696,8 +764,8 @@ void CPUParticles::_particles_process(float p_delta) {
 						}
 					}
 
-					if (emission_colors.size() == pc) {
-						p.base_color = emission_colors.get(random_idx);
+					if (p_data->emission_colors_size == pc) {
+						p.base_color = p_data->emission_colors[random_idx];
 					}
 				} break;
 			}
@@ -927,6 +995,53 @@ void CPUParticles::_particles_process(float p_delta) {
 
 		p.transform.origin += p.velocity * local_delta;
 	}
+
+	if (p_data->particle_data) {
+
+		float *ptr = p_data->particle_data + from * 17;
+		for (int i = from; i < to; i++) {
+			_fill_particle_data(parray[i], ptr);
+			ptr += 17;
+		}
+	}
+}
+
+void CPUParticles::_fill_particle_data(const Particle &p_particle, float *r_ptr) const {
+
+	Transform t = p_particle.transform;
+
+	if (!local_coords) {
+		t = inv_emission_transform * t;
+	}
+
+	if (p_particle.active) {
+		r_ptr[0] = t.basis.elements[0][0];
+		r_ptr[1] = t.basis.elements[0][1];
+		r_ptr[2] = t.basis.elements[0][2];
+		r_ptr[3] = t.origin.x;
+		r_ptr[4] = t.basis.elements[1][0];
+		r_ptr[5] = t.basis.elements[1][1];
+		r_ptr[6] = t.basis.elements[1][2];
+		r_ptr[7] = t.origin.y;
+		r_ptr[8] = t.basis.elements[2][0];
+		r_ptr[9] = t.basis.elements[2][1];
+		r_ptr[10] = t.basis.elements[2][2];
+		r_ptr[11] = t.origin.z;
+	} else {
+		zeromem(r_ptr, sizeof(float) * 12);
+	}
+
+	Color c = p_particle.color;
+	uint8_t *data8 = (uint8_t *)&r_ptr[12];
+	data8[0] = CLAMP(c.r * 255.0, 0, 255);
+	data8[1] = CLAMP(c.g * 255.0, 0, 255);
+	data8[2] = CLAMP(c.b * 255.0, 0, 255);
+	data8[3] = CLAMP(c.a * 255.0, 0, 255);
+
+	r_ptr[13] = p_particle.custom[0];
+	r_ptr[14] = p_particle.custom[1];
+	r_ptr[15] = p_particle.custom[2];
+	r_ptr[16] = p_particle.custom[3];
 }
 
 void CPUParticles::_update_particle_data_buffer() {
@@ -934,89 +1049,52 @@ void CPUParticles::_update_particle_data_buffer() {
 	update_mutex->lock();
 #endif
 
-	{
+	if (draw_order == DRAW_ORDER_INDEX) {
+		// already written by _particles_process()
+		can_update = true;
+
+	} else {
 
 		int pc = particles.size();
 
-		PoolVector<int>::Write ow;
-		int *order = NULL;
+		PoolVector<int>::Write ow = particle_order.write();
+		int *order = ow.ptr();
 
 		PoolVector<float>::Write w = particle_data.write();
 		PoolVector<Particle>::Read r = particles.read();
 		float *ptr = w.ptr();
 
-		if (draw_order != DRAW_ORDER_INDEX) {
-			ow = particle_order.write();
-			order = ow.ptr();
+		for (int i = 0; i < pc; i++) {
+			order[i] = i;
+		}
+		if (draw_order == DRAW_ORDER_LIFETIME) {
+			SortArray<int, SortLifetime> sorter;
+			sorter.compare.particles = r.ptr();
+			sorter.sort(order, pc);
+		} else if (draw_order == DRAW_ORDER_VIEW_DEPTH) {
+			Camera *c = get_viewport()->get_camera();
+			if (c) {
+				Vector3 dir = c->get_global_transform().basis.get_axis(2); //far away to close
+
+				if (local_coords) {
+
+					// will look different from Particles in editor as this is based on the camera in the scenetree
+					// and not the editor camera
+					dir = inv_emission_transform.xform(dir).normalized();
+				} else {
+					dir = dir.normalized();
+				}
 
-			for (int i = 0; i < pc; i++) {
-				order[i] = i;
-			}
-			if (draw_order == DRAW_ORDER_LIFETIME) {
-				SortArray<int, SortLifetime> sorter;
+				SortArray<int, SortAxis> sorter;
 				sorter.compare.particles = r.ptr();
+				sorter.compare.axis = dir;
 				sorter.sort(order, pc);
-			} else if (draw_order == DRAW_ORDER_VIEW_DEPTH) {
-				Camera *c = get_viewport()->get_camera();
-				if (c) {
-					Vector3 dir = c->get_global_transform().basis.get_axis(2); //far away to close
-
-					if (local_coords) {
-
-						// will look different from Particles in editor as this is based on the camera in the scenetree
-						// and not the editor camera
-						dir = inv_emission_transform.xform(dir).normalized();
-					} else {
-						dir = dir.normalized();
-					}
-
-					SortArray<int, SortAxis> sorter;
-					sorter.compare.particles = r.ptr();
-					sorter.compare.axis = dir;
-					sorter.sort(order, pc);
-				}
 			}
 		}
 
 		for (int i = 0; i < pc; i++) {
 
-			int idx = order ? order[i] : i;
-
-			Transform t = r[idx].transform;
-
-			if (!local_coords) {
-				t = inv_emission_transform * t;
-			}
-
-			if (r[idx].active) {
-				ptr[0] = t.basis.elements[0][0];
-				ptr[1] = t.basis.elements[0][1];
-				ptr[2] = t.basis.elements[0][2];
-				ptr[3] = t.origin.x;
-				ptr[4] = t.basis.elements[1][0];
-				ptr[5] = t.basis.elements[1][1];
-				ptr[6] = t.basis.elements[1][2];
-				ptr[7] = t.origin.y;
-				ptr[8] = t.basis.elements[2][0];
-				ptr[9] = t.basis.elements[2][1];
-				ptr[10] = t.basis.elements[2][2];
-				ptr[11] = t.origin.z;
-			} else {
-				zeromem(ptr, sizeof(float) * 12);
-			}
-
-			Color c = r[idx].color;
-			uint8_t *data8 = (uint8_t *)&ptr[12];
-			data8[0] = CLAMP(c.r * 255.0, 0, 255);
-			data8[1] = CLAMP(c.g * 255.0, 0, 255);
-			data8[2] = CLAMP(c.b * 255.0, 0, 255);
-			data8[3] = CLAMP(c.a * 255.0, 0, 255);
-
-			ptr[13] = r[idx].custom[0];
-			ptr[14] = r[idx].custom[1];
-			ptr[15] = r[idx].custom[2];
-			ptr[16] = r[idx].custom[3];
-
+			_fill_particle_data(r[order[i]], ptr);
 			ptr += 17;
 		}
 
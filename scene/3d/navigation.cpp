@@ -30,6 +30,9 @@
 
 #include "navigation.h"
 
+#include "core/os/thread_work_pool.h"
+#include "core/sort_array.h"
+
 #define USE_ENTRY_POINT
 
 void Navigation::_navmesh_link(int p_id) {
@@ -74,6 +77,10 @@ void Navigation::_navmesh_link(int p_id) {
 			Polygon::Edge e;
 			Vector3 ep = nm.xform.xform(r[idx]);
 			center += ep;
+			if (j == 0)
+				p.aabb.position = ep;
+			else
+				p.aabb.expand_to(ep);
 			e.point = _get_point(ep);
 			p.edges.write[j] = e;
 
@@ -135,6 +142,7 @@ void Navigation::_navmesh_link(int p_id) {
 	}
 
 	nm.linked = true;
+	index_dirty = true;
 }
 
 void Navigation::_navmesh_unlink(int p_id) {
@@ -201,10 +209,152 @@ void Navigation::_navmesh_unlink(int p_id) {
 	nm.polygons.clear();
 
 	nm.linked = false;
+	index_dirty = true;
+}
+
+int Navigation::_build_bvh(int p_from, int p_count) {
+
+	Polygon **polys = polygons.ptrw() + p_from;
+
+	BVHNode node;
+	node.aabb = polys[0]->aabb;
+	for (int i = 1; i < p_count; i++) {
+		node.aabb.merge_with(polys[i]->aabb);
+	}
+	node.from = p_from;
+	node.count = p_count;
+	node.children[0] = -1;
+	node.children[1] = -1;
+
+	int index = bvh.size();
+	bvh.push_back(node);
+
+	if (p_count > BVH_LEAF_SIZE) {
+		//split at the median of the longest axis, so the tree stays balanced
+		SortArray<Polygon *, BVHSort> sorter;
+		sorter.compare.axis = node.aabb.get_longest_axis_index();
+		int half = p_count / 2;
+		sorter.nth_element(0, p_count, half, polys);
+
+		int left = _build_bvh(p_from, half);
+		int right = _build_bvh(p_from + half, p_count - half);
+		bvh.write[index].children[0] = left;
+		bvh.write[index].children[1] = right;
+	}
+
+	return index;
+}
+
+void Navigation::_update_index() {
+
+	polygons.clear();
+	bvh.clear();
+
+	for (Map<int, NavMesh>::Element *E = navmesh_map.front(); E; E = E->next()) {
+
+		if (!E->get().linked)
+			continue;
+		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
+			polygons.push_back(&F->get());
+		}
+	}
+
+	if (polygons.size()) {
+		_build_bvh(0, polygons.size());
+	}
+
+	for (int i = 0; i < polygons.size(); i++) {
+		polygons[i]->id = i;
+	}
+
+	index_dirty = false;
+}
+
+void Navigation::_read_lock_index() {
+
+	lock->read_lock();
+
+	while (index_dirty) {
+		lock->read_unlock();
+		lock->write_lock();
+		if (index_dirty) {
+			_update_index();
+		}
+		lock->write_unlock();
+		lock->read_lock();
+	}
+}
+
+static _FORCE_INLINE_ float _aabb_distance_squared(const AABB &p_aabb, const Vector3 &p_point) {
+
+	Vector3 end = p_aabb.position + p_aabb.size;
+	Vector3 closest(CLAMP(p_point.x, p_aabb.position.x, end.x), CLAMP(p_point.y, p_aabb.position.y, end.y), CLAMP(p_point.z, p_aabb.position.z, end.z));
+	return closest.distance_squared_to(p_point);
+}
+
+Navigation::Polygon *Navigation::_get_closest_polygon(const Vector3 &p_point, Vector3 *r_point, Vector3 *r_normal) const {
+
+	if (bvh.empty())
+		return NULL;
+
+	Polygon *closest = NULL;
+	float closest_d = 1e20;
+
+	int stack[BVH_STACK_MAX];
+	int stack_size = 0;
+	stack[stack_size++] = 0;
+
+	while (stack_size) {
+
+		const BVHNode &node = bvh[stack[--stack_size]];
+		if (_aabb_distance_squared(node.aabb, p_point) >= closest_d)
+			continue;
+
+		if (node.children[0] == -1) {
+
+			for (int i = 0; i < node.count; i++) {
+
+				Polygon *p = polygons[node.from + i];
+				if (_aabb_distance_squared(p->aabb, p_point) >= closest_d)
+					continue;
+
+				for (int j = 2; j < p->edges.size(); j++) {
+
+					Face3 f(_get_vertex(p->edges[0].point), _get_vertex(p->edges[j - 1].point), _get_vertex(p->edges[j].point));
+					Vector3 spoint = f.get_closest_point_to(p_point);
+					float d = spoint.distance_squared_to(p_point);
+					if (d < closest_d) {
+						closest_d = d;
+						closest = p;
+						*r_point = spoint;
+						if (r_normal) {
+							*r_normal = f.get_plane().normal;
+						}
+					}
+				}
+			}
+			continue;
+		}
+
+		ERR_CONTINUE(stack_size + 2 > BVH_STACK_MAX);
+
+		//visit the nearest child first, it is the most likely to shrink the search
+		int near_child = node.children[0];
+		int far_child = node.children[1];
+		if (_aabb_distance_squared(bvh[far_child].aabb, p_point) < _aabb_distance_squared(bvh[near_child].aabb, p_point)) {
+			SWAP(near_child, far_child);
+		}
+		stack[stack_size++] = far_child;
+		stack[stack_size++] = near_child;
+	}
+
+	return closest;
 }
 
 int Navigation::navmesh_add(const Ref<NavigationMesh> &p_mesh, const Transform &p_xform, Object *p_owner) {
 
+	RWLockWrite write_lock(lock);
+
 	int id = last_id++;
 	NavMesh nm;
 	nm.linked = false;
@@ -220,6 +370,8 @@ int Navigation::navmesh_add(const Ref<NavigationMesh> &p_mesh, const Transform &
 
 void Navigation::navmesh_set_transform(int p_id, const Transform &p_xform) {
 
+	RWLockWrite write_lock(lock);
+
 	ERR_FAIL_COND(!navmesh_map.has(p_id));
 	NavMesh &nm = navmesh_map[p_id];
 	if (nm.xform == p_xform)
@@ -230,12 +382,14 @@ void Navigation::navmesh_set_transform(int p_id, const Transform &p_xform) {
 }
 void Navigation::navmesh_remove(int p_id) {
 
+	RWLockWrite write_lock(lock);
+
 	ERR_FAIL_COND(!navmesh_map.has(p_id));
 	_navmesh_unlink(p_id);
 	navmesh_map.erase(p_id);
 }
 
-void Navigation::_clip_path(Vector<Vector3> &path, Polygon *from_poly, const Vector3 &p_to_point, Polygon *p_to_poly) {
+void Navigation::_clip_path(const QueryNode *p_nodes, Vector<Vector3> &path, Polygon *from_poly, const Vector3 &p_to_point, Polygon *p_to_poly) {
 
 	Vector3 from = path[path.size() - 1];
 
@@ -250,7 +404,7 @@ void Navigation::_clip_path(Vector<Vector3> &path, Polygon *from_poly, const Vec
 
 	while (from_poly != p_to_poly) {
 
-		int pe = from_poly->prev_edge;
+		int pe = p_nodes[from_poly->id].prev_edge;
 		Vector3 a = _get_vertex(from_poly->edges[pe].point);
 		Vector3 b = _get_vertex(from_poly->edges[(pe + 1) % from_poly->edges.size()].point);
 
@@ -269,45 +423,12 @@ void Navigation::_clip_path(Vector<Vector3> &path, Polygon *from_poly, const Vec
 	}
 }
 
-Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector3 &p_end, bool p_optimize) {
+Vector<Vector3> Navigation::_get_path(const Vector3 &p_start, const Vector3 &p_end, bool p_optimize) {
 
-	Polygon *begin_poly = NULL;
-	Polygon *end_poly = NULL;
 	Vector3 begin_point;
 	Vector3 end_point;
-	float begin_d = 1e20;
-	float end_d = 1e20;
-
-	for (Map<int, NavMesh>::Element *E = navmesh_map.front(); E; E = E->next()) {
-
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
-
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
-
-				Face3 f(_get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point));
-				Vector3 spoint = f.get_closest_point_to(p_start);
-				float dpoint = spoint.distance_to(p_start);
-				if (dpoint < begin_d) {
-					begin_d = dpoint;
-					begin_poly = &p;
-					begin_point = spoint;
-				}
-
-				spoint = f.get_closest_point_to(p_end);
-				dpoint = spoint.distance_to(p_end);
-				if (dpoint < end_d) {
-					end_d = dpoint;
-					end_poly = &p;
-					end_point = spoint;
-				}
-			}
-
-			p.prev_edge = -1;
-		}
-	}
+	Polygon *begin_poly = _get_closest_polygon(p_start, &begin_point);
+	Polygon *end_poly = _get_closest_polygon(p_end, &end_point);
 
 	if (!begin_poly || !end_poly) {
 
@@ -323,59 +444,67 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 		return path;
 	}
 
+	Vector<QueryNode> query_nodes;
+	query_nodes.resize(polygons.size());
+	QueryNode *nodes = query_nodes.ptrw();
+	for (int i = 0; i < query_nodes.size(); i++) {
+		nodes[i].distance = 0;
+		nodes[i].prev_edge = -1;
+		nodes[i].closed = false;
+	}
+
+	QueryNode &begin_node = nodes[begin_poly->id];
+	begin_node.entry = begin_point;
+	begin_node.closed = true;
+
 	bool found_route = false;
 
-	List<Polygon *> open_list;
+	//binary heap on cost, entries left behind by a cheaper push are skipped when popped
+	Vector<QueryOpen> open_list;
+	SortArray<QueryOpen, QueryOpenSort> sorter;
 
 	for (int i = 0; i < begin_poly->edges.size(); i++) {
 
-		if (begin_poly->edges[i].C) {
+		Polygon *c = begin_poly->edges[i].C;
+		if (c) {
 
-			begin_poly->edges[i].C->prev_edge = begin_poly->edges[i].C_edge;
+			QueryNode &cn = nodes[c->id];
+			cn.prev_edge = begin_poly->edges[i].C_edge;
 #ifdef USE_ENTRY_POINT
 			Vector3 edge[2] = {
 				_get_vertex(begin_poly->edges[i].point),
 				_get_vertex(begin_poly->edges[(i + 1) % begin_poly->edges.size()].point)
 			};
 
-			Vector3 entry = Geometry::get_closest_point_to_segment(begin_poly->entry, edge);
-			begin_poly->edges[i].C->distance = begin_point.distance_to(entry);
-			begin_poly->edges[i].C->entry = entry;
+			Vector3 entry = Geometry::get_closest_point_to_segment(begin_point, edge);
+			cn.distance = begin_point.distance_to(entry);
+			cn.entry = entry;
+#else
+			cn.distance = begin_poly->center.distance_to(c->center);
+#endif
+			QueryOpen open;
+			open.polygon = c->id;
+#ifdef USE_ENTRY_POINT
+			open.cost = cn.distance + cn.entry.distance_to(end_point);
 #else
-			begin_poly->edges[i].C->distance = begin_poly->center.distance_to(begin_poly->edges[i].C->center);
+			open.cost = cn.distance + c->center.distance_to(end_point);
 #endif
-			open_list.push_back(begin_poly->edges[i].C);
+			open_list.push_back(open);
+			sorter.push_heap(0, open_list.size() - 1, 0, open, open_list.ptrw());
 		}
 	}
 
-	while (!found_route) {
-
-		if (open_list.size() == 0) {
-			break;
-		}
-		//check open list
-
-		List<Polygon *>::Element *least_cost_poly = NULL;
-		float least_cost = 1e30;
-
-		//this could be faster (cache previous results)
-		for (List<Polygon *>::Element *E = open_list.front(); E; E = E->next()) {
+	while (open_list.size()) {
 
-			Polygon *p = E->get();
+		sorter.pop_heap(0, open_list.size(), open_list.ptrw());
+		int least_cost_poly = open_list[open_list.size() - 1].polygon;
+		open_list.remove(open_list.size() - 1);
 
-			float cost = p->distance;
-#ifdef USE_ENTRY_POINT
-			cost += p->entry.distance_to(end_point);
-#else
-			cost += p->center.distance_to(end_point);
-#endif
-			if (cost < least_cost) {
-				least_cost_poly = E;
-				least_cost = cost;
-			}
-		}
+		QueryNode &pn = nodes[least_cost_poly];
+		if (pn.closed)
+			continue; //already expanded with a lower cost
 
-		Polygon *p = least_cost_poly->get();
+		Polygon *p = polygons[least_cost_poly];
 		//open the neighbours for search
 
 		if (p == end_poly) {
@@ -384,49 +513,56 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 			break;
 		}
 
+		pn.closed = true;
+
 		for (int i = 0; i < p->edges.size(); i++) {
 
-			Polygon::Edge &e = p->edges.write[i];
+			const Polygon::Edge &e = p->edges[i];
 
 			if (!e.C)
 				continue;
 
+			QueryNode &cn = nodes[e.C->id];
+
 #ifdef USE_ENTRY_POINT
 			Vector3 edge[2] = {
 				_get_vertex(p->edges[i].point),
 				_get_vertex(p->edges[(i + 1) % p->edges.size()].point)
 			};
 
-			Vector3 entry = Geometry::get_closest_point_to_segment(p->entry, edge);
-			float distance = p->entry.distance_to(entry) + p->distance;
+			Vector3 entry = Geometry::get_closest_point_to_segment(pn.entry, edge);
+			float distance = pn.entry.distance_to(entry) + pn.distance;
 #else
-			float distance = p->center.distance_to(e.C->center) + p->distance;
+			float distance = p->center.distance_to(e.C->center) + pn.distance;
 #endif
 
-			if (e.C->prev_edge != -1) {
+			if (cn.prev_edge != -1 || cn.closed) {
 				//oh this was visited already, can we win the cost?
 
-				if (e.C->distance > distance) {
+				if (cn.distance <= distance)
+					continue;
+			}
 
-					e.C->prev_edge = e.C_edge;
-					e.C->distance = distance;
+			cn.prev_edge = e.C_edge;
+			cn.distance = distance;
 #ifdef USE_ENTRY_POINT
-					e.C->entry = entry;
+			cn.entry = entry;
 #endif
-				}
-			} else {
-				//add to open neighbours
+			if (cn.closed)
+				continue;
+
+			//add to open neighbours, or push again with the lower cost
 
-				e.C->prev_edge = e.C_edge;
-				e.C->distance = distance;
+			QueryOpen open;
+			open.polygon = e.C->id;
 #ifdef USE_ENTRY_POINT
-				e.C->entry = entry;
+			open.cost = distance + entry.distance_to(end_point);
+#else
+			open.cost = distance + e.C->center.distance_to(end_point);
 #endif
-				open_list.push_back(e.C);
-			}
+			open_list.push_back(open);
+			sorter.push_heap(0, open_list.size() - 1, 0, open, open_list.ptrw());
 		}
-
-		open_list.erase(least_cost_poly);
 	}
 
 	if (found_route) {
@@ -456,8 +592,8 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 					left = begin_point;
 					right = begin_point;
 				} else {
-					int prev = p->prev_edge;
-					int prev_n = (p->prev_edge + 1) % p->edges.size();
+					int prev = nodes[p->id].prev_edge;
+					int prev_n = (prev + 1) % p->edges.size();
 					left = _get_vertex(p->edges[prev].point);
 					right = _get_vertex(p->edges[prev_n].point);
 
@@ -476,7 +612,7 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 						portal_left = left;
 					} else {
 
-						_clip_path(path, apex_poly, portal_right, right_poly);
+						_clip_path(nodes, path, apex_poly, portal_right, right_poly);
 
 						apex_point = portal_right;
 						p = right_poly;
@@ -496,7 +632,7 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 						portal_right = right;
 					} else {
 
-						_clip_path(path, apex_poly, portal_left, left_poly);
+						_clip_path(nodes, path, apex_poly, portal_left, left_poly);
 
 						apex_point = portal_left;
 						p = left_poly;
@@ -509,7 +645,7 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 				}
 
 				if (p != begin_poly)
-					p = p->edges[p->prev_edge].C;
+					p = p->edges[nodes[p->id].prev_edge].C;
 				else
 					p = NULL;
 			}
@@ -525,11 +661,11 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 
 			path.push_back(end_point);
 			while (true) {
-				int prev = p->prev_edge;
+				int prev = nodes[p->id].prev_edge;
 #ifdef USE_ENTRY_POINT
-				Vector3 point = p->entry;
+				Vector3 point = nodes[p->id].entry;
 #else
-				int prev_n = (p->prev_edge + 1) % p->edges.size();
+				int prev_n = (prev + 1) % p->edges.size();
 				Vector3 point = (_get_vertex(p->edges[prev].point) + _get_vertex(p->edges[prev_n].point)) * 0.5;
 #endif
 				path.push_back(point);
@@ -549,8 +685,185 @@ Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector
 	return Vector<Vector3>();
 }
 
+Vector<Vector3> Navigation::get_simple_path(const Vector3 &p_start, const Vector3 &p_end, bool p_optimize) {
+
+	_read_lock_index();
+	Vector<Vector3> path = _get_path(p_start, p_end, p_optimize);
+	lock->read_unlock();
+
+	return path;
+}
+
+int Navigation::request_path(const Vector3 &p_start, const Vector3 &p_end, bool p_optimize) {
+
+	PoolVector3Array starts;
+	starts.push_back(p_start);
+	PoolVector3Array ends;
+	ends.push_back(p_end);
+
+	return request_paths(starts, ends, p_optimize)[0];
+}
+
+PoolIntArray Navigation::request_paths(const PoolVector3Array &p_starts, const PoolVector3Array &p_ends, bool p_optimize) {
+
+	ERR_FAIL_COND_V(p_starts.size() != p_ends.size(), PoolIntArray());
+
+	int count = p_starts.size();
+	PoolIntArray ids;
+	ids.resize(count);
+
+	{
+		PoolVector3Array::Read starts = p_starts.read();
+		PoolVector3Array::Read ends = p_ends.read();
+		PoolIntArray::Write w = ids.write();
+
+		request_mutex->lock();
+		for (int i = 0; i < count; i++) {
+
+			PathRequest request;
+			request.id = last_request_id++;
+			request.start = starts[i];
+			request.end = ends[i];
+			request.optimize = p_optimize;
+			request.completed = false;
+			path_requests[request.id] = request;
+			pending_requests.push_back(request.id);
+			w[i] = request.id;
+		}
+		request_mutex->unlock();
+	}
+
+#ifdef NO_THREADS
+	_process_path_requests();
+#else
+	if (!request_thread) {
+		request_pool = memnew(ThreadWorkPool);
+		request_pool->init();
+		exit_request_thread = false;
+		request_thread = Thread::create(&Navigation::_request_thread_function, this);
+	}
+	request_semaphore->post();
+#endif
+
+	return ids;
+}
+
+bool Navigation::is_path_request_completed(int p_id) const {
+
+	request_mutex->lock();
+	const Map<int, PathRequest>::Element *E = path_requests.find(p_id);
+	bool completed = E && E->get().completed;
+	request_mutex->unlock();
+
+	return completed;
+}
+
+Vector<Vector3> Navigation::get_path_request_result(int p_id) {
+
+	request_mutex->lock();
+	Map<int, PathRequest>::Element *E = path_requests.find(p_id);
+	if (!E || !E->get().completed) {
+		request_mutex->unlock();
+		ERR_EXPLAIN("Path request " + itos(p_id) + " does not exist or is not completed.");
+		ERR_FAIL_V(Vector<Vector3>());
+	}
+
+	Vector<Vector3> path = E->get().path;
+	path_requests.erase(E);
+	request_mutex->unlock();
+
+	return path;
+}
+
+void Navigation::cancel_path_request(int p_id) {
+
+	request_mutex->lock();
+	path_requests.erase(p_id);
+	request_mutex->unlock();
+}
+
+void Navigation::_request_thread_function(void *p_user) {
+
+	Navigation *navigation = (Navigation *)p_user;
+
+	while (true) {
+
+		navigation->request_semaphore->wait();
+		if (navigation->exit_request_thread)
+			break;
+
+		navigation->_process_path_requests();
+	}
+}
+
+void Navigation::_path_request_process(uint32_t p_index, PathRequest *p_requests) {
+
+	PathRequest &request = p_requests[p_index];
+
+	_read_lock_index();
+	request.path = _get_path(request.start, request.end, request.optimize);
+	lock->read_unlock();
+}
+
+void Navigation::_process_path_requests() {
+
+	Vector<PathRequest> batch;
+
+	request_mutex->lock();
+	for (int i = 0; i < pending_requests.size(); i++) {
+
+		Map<int, PathRequest>::Element *E = path_requests.find(pending_requests[i]);
+		if (E) { //may have been cancelled
+			batch.push_back(E->get());
+		}
+	}
+	pending_requests.clear();
+	request_mutex->unlock();
+
+	if (batch.empty())
+		return;
+
+	//each query takes the read lock on its own, so navmesh changes are never blocked for the whole batch
+	if (request_pool) {
+		request_pool->do_work(batch.size(), this, &Navigation::_path_request_process, batch.ptrw());
+	} else {
+		for (int i = 0; i < batch.size(); i++) {
+			_path_request_process(i, batch.ptrw());
+		}
+	}
+
+	PoolIntArray completed;
+
+	request_mutex->lock();
+	for (int i = 0; i < batch.size(); i++) {
+
+		Map<int, PathRequest>::Element *E = path_requests.find(batch[i].id);
+		if (!E)
+			continue;
+
+		E->get().path = batch[i].path;
+		E->get().completed = true;
+		completed.push_back(batch[i].id);
+	}
+	request_mutex->unlock();
+
+	if (completed.size()) {
+		call_deferred("_path_requests_completed", completed);
+	}
+}
+
+void Navigation::_path_requests_completed(const PoolIntArray &p_ids) {
+
+	PoolIntArray::Read r = p_ids.read();
+	for (int i = 0; i < p_ids.size(); i++) {
+		emit_signal("path_request_completed", r[i]);
+	}
+}
+
 Vector3 Navigation::get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, const bool &p_use_collision) {
 
+	RWLockRead read_lock(lock);
+
 	bool use_collision = p_use_collision;
 	Vector3 closest_point;
 	float closest_point_d = 1e20;
@@ -605,27 +918,10 @@ Vector3 Navigation::get_closest_point_to_segment(const Vector3 &p_from, const Ve
 Vector3 Navigation::get_closest_point(const Vector3 &p_point) {
 
 	Vector3 closest_point;
-	float closest_point_d = 1e20;
 
-	for (Map<int, NavMesh>::Element *E = navmesh_map.front(); E; E = E->next()) {
-
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
-
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
-
-				Face3 f(_get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point));
-				Vector3 inters = f.get_closest_point_to(p_point);
-				float d = inters.distance_to(p_point);
-				if (d < closest_point_d) {
-					closest_point = inters;
-					closest_point_d = d;
-				}
-			}
-		}
-	}
+	_read_lock_index();
+	_get_closest_polygon(p_point, &closest_point);
+	lock->read_unlock();
 
 	return closest_point;
 }
@@ -634,28 +930,10 @@ Vector3 Navigation::get_closest_point_normal(const Vector3 &p_point) {
 
 	Vector3 closest_point;
 	Vector3 closest_normal;
-	float closest_point_d = 1e20;
-
-	for (Map<int, NavMesh>::Element *E = navmesh_map.front(); E; E = E->next()) {
-
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
-
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
 
-				Face3 f(_get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point));
-				Vector3 inters = f.get_closest_point_to(p_point);
-				float d = inters.distance_to(p_point);
-				if (d < closest_point_d) {
-					closest_point = inters;
-					closest_point_d = d;
-					closest_normal = f.get_plane().normal;
-				}
-			}
-		}
-	}
+	_read_lock_index();
+	_get_closest_polygon(p_point, &closest_point, &closest_normal);
+	lock->read_unlock();
 
 	return closest_normal;
 }
@@ -664,28 +942,13 @@ Object *Navigation::get_closest_point_owner(const Vector3 &p_point) {
 
 	Vector3 closest_point;
 	Object *owner = NULL;
-	float closest_point_d = 1e20;
-
-	for (Map<int, NavMesh>::Element *E = navmesh_map.front(); E; E = E->next()) {
-
-		if (!E->get().linked)
-			continue;
-		for (List<Polygon>::Element *F = E->get().polygons.front(); F; F = F->next()) {
-
-			Polygon &p = F->get();
-			for (int i = 2; i < p.edges.size(); i++) {
 
-				Face3 f(_get_vertex(p.edges[0].point), _get_vertex(p.edges[i - 1].point), _get_vertex(p.edges[i].point));
-				Vector3 inters = f.get_closest_point_to(p_point);
-				float d = inters.distance_to(p_point);
-				if (d < closest_point_d) {
-					closest_point = inters;
-					closest_point_d = d;
-					owner = E->get().owner;
-				}
-			}
-		}
+	_read_lock_index();
+	Polygon *closest = _get_closest_polygon(p_point, &closest_point);
+	if (closest) {
+		owner = closest->owner->owner;
 	}
+	lock->read_unlock();
 
 	return owner;
 }
@@ -712,10 +975,19 @@ void Navigation::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_closest_point_normal", "to_point"), &Navigation::get_closest_point_normal);
 	ClassDB::bind_method(D_METHOD("get_closest_point_owner", "to_point"), &Navigation::get_closest_point_owner);
 
+	ClassDB::bind_method(D_METHOD("request_path", "start", "end", "optimize"), &Navigation::request_path, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("request_paths", "starts", "ends", "optimize"), &Navigation::request_paths, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("is_path_request_completed", "id"), &Navigation::is_path_request_completed);
+	ClassDB::bind_method(D_METHOD("get_path_request_result", "id"), &Navigation::get_path_request_result);
+	ClassDB::bind_method(D_METHOD("cancel_path_request", "id"), &Navigation::cancel_path_request);
+	ClassDB::bind_method(D_METHOD("_path_requests_completed"), &Navigation::_path_requests_completed);
+
 	ClassDB::bind_method(D_METHOD("set_up_vector", "up"), &Navigation::set_up_vector);
 	ClassDB::bind_method(D_METHOD("get_up_vector"), &Navigation::get_up_vector);
 
 	ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "up_vector"), "set_up_vector", "get_up_vector");
+
+	ADD_SIGNAL(MethodInfo("path_request_completed", PropertyInfo(Variant::INT, "id")));
 }
 
 Navigation::Navigation() {
@@ -724,4 +996,31 @@ Navigation::Navigation() {
 	cell_size = 0.01; //one centimeter
 	last_id = 1;
 	up = Vector3(0, 1, 0);
+
+	index_dirty = false;
+	lock = RWLock::create();
+
+	last_request_id = 1;
+	request_mutex = Mutex::create();
+	request_semaphore = Semaphore::create();
+	request_thread = NULL;
+	request_pool = NULL;
+	exit_request_thread = false;
+}
+
+Navigation::~Navigation() {
+
+	if (request_thread) {
+		exit_request_thread = true;
+		request_semaphore->post();
+		Thread::wait_to_finish(request_thread);
+		memdelete(request_thread);
+	}
+	if (request_pool) {
+		memdelete(request_pool);
+	}
+
+	memdelete(request_semaphore);
+	memdelete(request_mutex);
+	memdelete(lock);
 }
@@ -31,9 +31,15 @@
 #ifndef NAVIGATION_H
 #define NAVIGATION_H
 
+#include "core/os/mutex.h"
+#include "core/os/rw_lock.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
 #include "scene/3d/navigation_mesh.h"
 #include "scene/3d/spatial.h"
 
+class ThreadWorkPool;
+
 class Navigation : public Spatial {
 
 	GDCLASS(Navigation, Spatial);
@@ -94,10 +100,8 @@ class Navigation : public Spatial {
 		Vector<Edge> edges;
 
 		Vector3 center;
-		Vector3 entry;
-
-		float distance;
-		int prev_edge;
+		AABB aabb;
+		int id; // index in polygons, valid while the index is up to date
 		bool clockwise;
 
 		NavMesh *owner;
@@ -158,7 +162,83 @@ class Navigation : public Spatial {
 	int last_id;
 
 	Vector3 up;
-	void _clip_path(Vector<Vector3> &path, Polygon *from_poly, const Vector3 &p_to_point, Polygon *p_to_poly);
+
+	// Flat list of all linked polygons, and a bounding volume hierarchy over it
+	// for point location. Both are rebuilt lazily after navmeshes change.
+
+	enum {
+		BVH_LEAF_SIZE = 4,
+		BVH_STACK_MAX = 64
+	};
+
+	struct BVHNode {
+		AABB aabb;
+		int children[2]; // -1 on leaves
+		int from; // range of polygons, on leaves
+		int count;
+	};
+
+	struct BVHSort {
+		int axis;
+		_FORCE_INLINE_ bool operator()(const Polygon *A, const Polygon *B) const { return A->center[axis] < B->center[axis]; }
+	};
+
+	Vector<Polygon *> polygons;
+	Vector<BVHNode> bvh;
+	bool index_dirty;
+	RWLock *lock; // navmesh changes write, queries read
+
+	int _build_bvh(int p_from, int p_count);
+	void _update_index();
+	void _read_lock_index();
+	Polygon *_get_closest_polygon(const Vector3 &p_point, Vector3 *r_point, Vector3 *r_normal = NULL) const;
+
+	// A* state of a polygon during one query, kept outside of the polygons so queries can run concurrently.
+
+	struct QueryNode {
+		float distance;
+		int prev_edge;
+		Vector3 entry;
+		bool closed;
+	};
+
+	struct QueryOpen {
+		int polygon;
+		float cost;
+	};
+
+	struct QueryOpenSort {
+		_FORCE_INLINE_ bool operator()(const QueryOpen &A, const QueryOpen &B) const { return A.cost > B.cost; }
+	};
+
+	void _clip_path(const QueryNode *p_nodes, Vector<Vector3> &path, Polygon *from_poly, const Vector3 &p_to_point, Polygon *p_to_poly);
+	Vector<Vector3> _get_path(const Vector3 &p_start, const Vector3 &p_end, bool p_optimize);
+
+	// Path requests, solved in batches on a background thread.
+
+	struct PathRequest {
+		int id;
+		Vector3 start;
+		Vector3 end;
+		bool optimize;
+		bool completed;
+		Vector<Vector3> path;
+	};
+
+	Map<int, PathRequest> path_requests; // requests and results not yet fetched
+	Vector<int> pending_requests;
+	int last_request_id;
+
+	Mutex *request_mutex;
+	Semaphore *request_semaphore;
+	Thread *request_thread;
+	ThreadWorkPool *request_pool; // the request thread can't use the shared pool without serializing the main thread users
+	volatile bool exit_request_thread;
+
+	static void _request_thread_function(void *p_user);
+	void _process_path_requests();
+	void _path_request_process(uint32_t p_index, PathRequest *p_requests);
+	void _path_requests_completed(const PoolIntArray &p_ids);
 
 protected:
 	static void _bind_methods();
@@ -173,12 +253,20 @@ public:
 	void navmesh_remove(int p_id);
 
 	Vector<Vector3> get_simple_path(const Vector3 &p_start, const Vector3 &p_end, bool p_optimize = true);
+
+	int request_path(const Vector3 &p_start, const Vector3 &p_end, bool p_optimize = true);
+	PoolIntArray request_paths(const PoolVector3Array &p_starts, const PoolVector3Array &p_ends, bool p_optimize = true);
+	bool is_path_request_completed(int p_id) const;
+	Vector<Vector3> get_path_request_result(int p_id);
+	void cancel_path_request(int p_id);
+
 	Vector3 get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, const bool &p_use_collision = false);
 	Vector3 get_closest_point(const Vector3 &p_point);
 	Vector3 get_closest_point_normal(const Vector3 &p_point);
 	Object *get_closest_point_owner(const Vector3 &p_point);
 
 	Navigation();
+	~Navigation();
 };
 
 #endif // NAVIGATION_H
@@ -136,7 +136,7 @@ void NavigationMesh::set_agent_radius(float p_value) {
 	agent_radius = p_value;
 }
 
-float NavigationMesh::get_agent_radius() {
+float NavigationMesh::get_agent_radius() const {
 	return agent_radius;
 }
 
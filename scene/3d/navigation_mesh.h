@@ -124,7 +124,7 @@ public:
 	float get_agent_height() const;
 
 	void set_agent_radius(float p_value);
-	float get_agent_radius();
+	float get_agent_radius() const;
 
 	void set_agent_max_climb(float p_value);
 	float get_agent_max_climb() const;
@@ -32,10 +32,13 @@
 
 #include "core/message_queue.h"
 
+#include "core/os/thread_work_pool.h"
 #include "core/project_settings.h"
 #include "scene/3d/physics_body.h"
 #include "scene/resources/surface_tool.h"
 
+SelfList<Skeleton>::List Skeleton::dirty_skeletons;
+
 bool Skeleton::_set(const StringName &p_path, const Variant &p_value) {
 
 	String path = p_path;
@@ -210,109 +213,182 @@ void Skeleton::_notification(int p_what) {
 		} break;
 		case NOTIFICATION_UPDATE_SKELETON: {
 
-			VisualServer *vs = VisualServer::get_singleton();
-			Bone *bonesptr = bones.ptrw();
-			int len = bones.size();
+			if (dirty) {
+				// Also poses every other skeleton waiting for an update, their own notification will find them clean.
+				update_dirty_skeletons();
+			} else {
+				_update_process_order();
+				_update_bone_poses();
+				_apply_bone_poses();
+			}
+		} break;
+	}
+}
 
-			vs->skeleton_allocate(skeleton, len); // if same size, nothing really happens
+void Skeleton::_update_bone_poses() {
 
-			_update_process_order();
+	// Only touches this skeleton's bones, so it is safe to run for several skeletons at once.
 
-			const int *order = process_order.ptr();
+	Bone *bonesptr = bones.ptrw();
+	int len = bones.size();
 
-			// pose changed, rebuild cache of inverses
-			if (rest_global_inverse_dirty) {
+	const int *order = process_order.ptr();
 
-				// calculate global rests and invert them
-				for (int i = 0; i < len; i++) {
-					Bone &b = bonesptr[order[i]];
-					if (b.parent >= 0)
-						b.rest_global_inverse = bonesptr[b.parent].rest_global_inverse * b.rest;
-					else
-						b.rest_global_inverse = b.rest;
-				}
-				for (int i = 0; i < len; i++) {
-					Bone &b = bonesptr[order[i]];
-					b.rest_global_inverse.affine_invert();
-				}
+	// pose changed, rebuild cache of inverses
+	if (rest_global_inverse_dirty) {
 
-				rest_global_inverse_dirty = false;
-			}
+		// calculate global rests and invert them
+		for (int i = 0; i < len; i++) {
+			Bone &b = bonesptr[order[i]];
+			if (b.parent >= 0)
+				b.rest_global_inverse = bonesptr[b.parent].rest_global_inverse * b.rest;
+			else
+				b.rest_global_inverse = b.rest;
+		}
+		for (int i = 0; i < len; i++) {
+			Bone &b = bonesptr[order[i]];
+			b.rest_global_inverse.affine_invert();
+			b.pose_global_dirty = true;
+		}
 
-			for (int i = 0; i < len; i++) {
+		rest_global_inverse_dirty = false;
+	}
 
-				Bone &b = bonesptr[order[i]];
+	for (int i = 0; i < len; i++) {
 
-				if (b.disable_rest) {
-					if (b.enabled) {
+		Bone &b = bonesptr[order[i]];
 
-						Transform pose = b.pose;
-						if (b.custom_pose_enable) {
+		// parents come first in process order, so a dirty parent is already flagged here
+		if (b.parent >= 0 && bonesptr[b.parent].pose_global_dirty) {
+			b.pose_global_dirty = true;
+		}
 
-							pose = b.custom_pose * pose;
-						}
+		if (!b.pose_global_dirty)
+			continue;
 
-						if (b.parent >= 0) {
+		if (b.disable_rest) {
+			if (b.enabled) {
 
-							b.pose_global = bonesptr[b.parent].pose_global * pose;
-						} else {
+				Transform pose = b.pose;
+				if (b.custom_pose_enable) {
 
-							b.pose_global = pose;
-						}
-					} else {
+					pose = b.custom_pose * pose;
+				}
 
-						if (b.parent >= 0) {
+				if (b.parent >= 0) {
 
-							b.pose_global = bonesptr[b.parent].pose_global;
-						} else {
+					b.pose_global = bonesptr[b.parent].pose_global * pose;
+				} else {
 
-							b.pose_global = Transform();
-						}
-					}
+					b.pose_global = pose;
+				}
+			} else {
 
-				} else {
-					if (b.enabled) {
+				if (b.parent >= 0) {
 
-						Transform pose = b.pose;
-						if (b.custom_pose_enable) {
+					b.pose_global = bonesptr[b.parent].pose_global;
+				} else {
 
-							pose = b.custom_pose * pose;
-						}
+					b.pose_global = Transform();
+				}
+			}
 
-						if (b.parent >= 0) {
+		} else {
+			if (b.enabled) {
 
-							b.pose_global = bonesptr[b.parent].pose_global * (b.rest * pose);
-						} else {
+				Transform pose = b.pose;
+				if (b.custom_pose_enable) {
 
-							b.pose_global = b.rest * pose;
-						}
-					} else {
+					pose = b.custom_pose * pose;
+				}
 
-						if (b.parent >= 0) {
+				if (b.parent >= 0) {
 
-							b.pose_global = bonesptr[b.parent].pose_global * b.rest;
-						} else {
+					b.pose_global = bonesptr[b.parent].pose_global * (b.rest * pose);
+				} else {
 
-							b.pose_global = b.rest;
-						}
-					}
+					b.pose_global = b.rest * pose;
 				}
+			} else {
 
-				b.transform_final = b.pose_global * b.rest_global_inverse;
-				vs->skeleton_bone_set_transform(skeleton, order[i], b.transform_final);
+				if (b.parent >= 0) {
 
-				for (List<uint32_t>::Element *E = b.nodes_bound.front(); E; E = E->next()) {
+					b.pose_global = bonesptr[b.parent].pose_global * b.rest;
+				} else {
 
-					Object *obj = ObjectDB::get_instance(E->get());
-					ERR_CONTINUE(!obj);
-					Spatial *sp = Object::cast_to<Spatial>(obj);
-					ERR_CONTINUE(!sp);
-					sp->set_transform(b.pose_global);
+					b.pose_global = b.rest;
 				}
 			}
+		}
 
-			dirty = false;
-		} break;
+		b.transform_final = b.pose_global * b.rest_global_inverse;
+	}
+}
+
+void Skeleton::_update_bone_poses_thread(uint32_t p_index, Skeleton **p_skeletons) {
+
+	p_skeletons[p_index]->_update_bone_poses();
+}
+
+void Skeleton::_apply_bone_poses() {
+
+	// Main thread only, sends the bones recomputed by _update_bone_poses() to the server and bound nodes.
+
+	VisualServer *vs = VisualServer::get_singleton();
+	Bone *bonesptr = bones.ptrw();
+	int len = bones.size();
+
+	vs->skeleton_allocate(skeleton, len); // if same size, nothing really happens
+
+	const int *order = process_order.ptr();
+
+	for (int i = 0; i < len; i++) {
+
+		Bone &b = bonesptr[order[i]];
+
+		if (!b.pose_global_dirty)
+			continue;
+
+		vs->skeleton_bone_set_transform(skeleton, order[i], b.transform_final);
+
+		for (List<uint32_t>::Element *E = b.nodes_bound.front(); E; E = E->next()) {
+
+			Object *obj = ObjectDB::get_instance(E->get());
+			ERR_CONTINUE(!obj);
+			Spatial *sp = Object::cast_to<Spatial>(obj);
+			ERR_CONTINUE(!sp);
+			sp->set_transform(b.pose_global);
+		}
+	}
+
+	// cleared only once all children have seen the flag
+	for (int i = 0; i < len; i++) {
+		bonesptr[i].pose_global_dirty = false;
+	}
+
+	dirty = false;
+}
+
+void Skeleton::update_dirty_skeletons() {
+
+	Vector<Skeleton *> skeletons;
+
+	while (dirty_skeletons.first()) {
+
+		Skeleton *sk = dirty_skeletons.first()->self();
+		dirty_skeletons.remove(dirty_skeletons.first());
+
+		sk->_update_process_order(); // may reorder bones, keep it out of the threads
+		skeletons.push_back(sk);
+	}
+
+	if (skeletons.empty())
+		return;
+
+	ThreadWorkPool::get_singleton()->do_work(skeletons.size(), skeletons[0], &Skeleton::_update_bone_poses_thread, skeletons.ptrw());
+
+	for (int i = 0; i < skeletons.size(); i++) {
+		skeletons[i]->_apply_bone_poses();
 	}
 }
 
@@ -427,6 +503,7 @@ void Skeleton::unparent_bone_and_rest(int p_bone) {
 
 	bones.write[p_bone].parent = -1;
 	bones.write[p_bone].rest_global_inverse = bones[p_bone].rest.affine_inverse(); //same thing
+	bones.write[p_bone].pose_global_dirty = true;
 	process_order_dirty = true;
 
 	_make_dirty();
@@ -447,6 +524,7 @@ void Skeleton::set_bone_disable_rest(int p_bone, bool p_disable) {
 
 	ERR_FAIL_INDEX(p_bone, bones.size());
 	bones.write[p_bone].disable_rest = p_disable;
+	bones.write[p_bone].pose_global_dirty = true;
 }
 
 bool Skeleton::is_bone_rest_disabled(int p_bone) const {
@@ -505,6 +583,12 @@ void Skeleton::bind_child_node_to_bone(int p_bone, Node *p_node) {
 	}
 
 	bones.write[p_bone].nodes_bound.push_back(id);
+
+	// the node only gets a transform when the bone is posed, so pose it
+	bones.write[p_bone].pose_global_dirty = true;
+	if (is_inside_tree()) {
+		_make_dirty();
+	}
 }
 void Skeleton::unbind_child_node_from_bone(int p_bone, Node *p_node) {
 
@@ -542,6 +626,7 @@ void Skeleton::set_bone_pose(int p_bone, const Transform &p_pose) {
 	ERR_FAIL_INDEX(p_bone, bones.size());
 
 	bones.write[p_bone].pose = p_pose;
+	bones.write[p_bone].pose_global_dirty = true;
 	if (is_inside_tree()) {
 		_make_dirty();
 	}
@@ -559,6 +644,7 @@ void Skeleton::set_bone_custom_pose(int p_bone, const Transform &p_custom_pose)
 
 	bones.write[p_bone].custom_pose_enable = (p_custom_pose != Transform());
 	bones.write[p_bone].custom_pose = p_custom_pose;
+	bones.write[p_bone].pose_global_dirty = true;
 
 	_make_dirty();
 }
@@ -575,6 +661,7 @@ void Skeleton::_make_dirty() {
 		return;
 
 	MessageQueue::get_singleton()->push_notification(this, NOTIFICATION_UPDATE_SKELETON);
+	dirty_skeletons.add(&dirty_list);
 	dirty = true;
 }
 
@@ -813,7 +900,8 @@ void Skeleton::_bind_methods() {
 	BIND_CONSTANT(NOTIFICATION_UPDATE_SKELETON);
 }
 
-Skeleton::Skeleton() {
+Skeleton::Skeleton() :
+		dirty_list(this) {
 
 	rest_global_inverse_dirty = true;
 	dirty = false;
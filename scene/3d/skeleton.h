@@ -32,6 +32,7 @@
 #define SKELETON_H
 
 #include "core/rid.h"
+#include "core/self_list.h"
 #include "scene/3d/spatial.h"
 
 /**
@@ -70,6 +71,8 @@ class Skeleton : public Spatial {
 
 		Transform transform_final;
 
+		bool pose_global_dirty; // pose_global must be recomputed, also for all children
+
 #ifndef _3D_DISABLED
 		PhysicalBone *physical_bone;
 		PhysicalBone *cache_parent_physical_bone;
@@ -83,6 +86,7 @@ class Skeleton : public Spatial {
 			ignore_animation = false;
 			custom_pose_enable = false;
 			disable_rest = false;
+			pose_global_dirty = true;
 #ifndef _3D_DISABLED
 			physical_bone = NULL;
 			cache_parent_physical_bone = NULL;
@@ -102,6 +106,9 @@ class Skeleton : public Spatial {
 	bool dirty;
 	bool use_bones_in_world_transform;
 
+	SelfList<Skeleton> dirty_list;
+	static SelfList<Skeleton>::List dirty_skeletons;
+
 	// bind helpers
 	Array _get_bound_child_nodes_to_bone(int p_bone) const {
 
@@ -118,6 +125,10 @@ class Skeleton : public Spatial {
 
 	void _update_process_order();
 
+	void _update_bone_poses();
+	void _update_bone_poses_thread(uint32_t p_index, Skeleton **p_skeletons);
+	void _apply_bone_poses();
+
 protected:
 	bool _get(const StringName &p_path, Variant &r_ret) const;
 	bool _set(const StringName &p_path, const Variant &p_value);
@@ -183,6 +194,8 @@ public:
 	void set_use_bones_in_world_transform(bool p_enable);
 	bool is_using_bones_in_world_transform() const;
 
+	static void update_dirty_skeletons(); // poses all dirty skeletons at once, in parallel
+
 #ifndef _3D_DISABLED
 	// Physical bone API
 
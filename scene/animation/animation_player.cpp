@@ -32,6 +32,10 @@
 
 #include "core/engine.h"
 #include "core/message_queue.h"
+#include "core/os/thread_work_pool.h"
+#include "scene/3d/camera.h"
+#include "scene/3d/visual_instance.h"
+#include "scene/main/viewport.h"
 #include "scene/scene_string_names.h"
 #include "servers/audio/audio_stream.h"
 
@@ -56,6 +60,177 @@ void AnimatedValuesBackup::update_skeletons() {
 }
 #endif
 
+Map<RID, AnimationVisibilityPolicy::VisibleInstance> AnimationVisibilityPolicy::visible_instances;
+uint64_t AnimationVisibilityPolicy::visible_query_frame = 0;
+bool AnimationVisibilityPolicy::visible_query_dirty = true;
+
+void AnimationVisibilityPolicy::_gather_instances(Node *p_node) {
+
+	VisualInstance *vi = Object::cast_to<VisualInstance>(p_node);
+	if (vi) {
+		instances.push_back(vi->get_instance_id());
+		instance_rids.push_back(vi->get_instance());
+
+		Map<RID, VisibleInstance>::Element *E = visible_instances.find(vi->get_instance());
+		if (E) {
+			E->get().refcount++;
+		} else {
+			VisibleInstance v;
+			v.refcount = 1;
+			v.frames_since_visible = -1;
+			visible_instances.insert(vi->get_instance(), v);
+			visible_query_dirty = true;
+		}
+	}
+
+	for (int i = 0; i < p_node->get_child_count(); i++) {
+		_gather_instances(p_node->get_child(i));
+	}
+}
+
+void AnimationVisibilityPolicy::_clear_instances() {
+
+	for (int i = 0; i < instance_rids.size(); i++) {
+
+		Map<RID, VisibleInstance>::Element *E = visible_instances.find(instance_rids[i]);
+		ERR_CONTINUE(!E);
+		E->get().refcount--;
+		if (E->get().refcount == 0) {
+			visible_instances.erase(E);
+		}
+	}
+
+	instances.clear();
+	instance_rids.clear();
+	instances_from = 0;
+}
+
+int AnimationVisibilityPolicy::_get_frames_since_visible(RID p_instance) {
+
+	// Asking the server syncs with the render thread, so every registered instance is
+	// asked for at once, the first time any policy needs one in a frame.
+	uint64_t frame = Engine::get_singleton()->get_idle_frames();
+	if (frame != visible_query_frame || visible_query_dirty) {
+
+		Vector<RID> rids;
+		rids.resize(visible_instances.size());
+		int idx = 0;
+		for (Map<RID, VisibleInstance>::Element *E = visible_instances.front(); E; E = E->next()) {
+			rids.write[idx++] = E->key();
+		}
+
+		Vector<int> frames = VS::get_singleton()->instances_get_frames_since_visible(rids);
+		ERR_FAIL_COND_V(frames.size() != rids.size(), -1);
+
+		idx = 0;
+		for (Map<RID, VisibleInstance>::Element *E = visible_instances.front(); E; E = E->next()) {
+			E->get().frames_since_visible = frames[idx++];
+		}
+
+		visible_query_frame = frame;
+		visible_query_dirty = false;
+	}
+
+	Map<RID, VisibleInstance>::Element *E = visible_instances.find(p_instance);
+	return E ? E->get().frames_since_visible : -1;
+}
+
+AnimationVisibilityPolicy::Action AnimationVisibilityPolicy::process(Node *p_visibility_node, float p_delta, float &r_delta) {
+
+	if (mode == MODE_ALWAYS || !p_visibility_node || !p_visibility_node->is_inside_tree() || Engine::get_singleton()->is_editor_hint()) {
+		r_delta = accum_delta + p_delta;
+		accum_delta = 0;
+		return ACTION_EVALUATE;
+	}
+
+	if (instances_from != p_visibility_node->get_instance_id()) {
+		_clear_instances();
+		_gather_instances(p_visibility_node);
+		instances_from = p_visibility_node->get_instance_id();
+	}
+
+	// nothing to cull against counts as visible
+	bool visible = instances.empty();
+
+	for (int i = 0; i < instances.size(); i++) {
+
+		VisualInstance *vi = Object::cast_to<VisualInstance>(ObjectDB::get_instance(instances[i]));
+		if (!vi) {
+			instances_from = 0; // an instance went away, gather again next step
+			continue;
+		}
+
+		if (!vi->is_visible_in_tree())
+			continue;
+
+		// drawn in one of the last two frames, tolerates a frame where nothing was drawn
+		int frames = _get_frames_since_visible(vi->get_instance());
+		if (frames >= 0 && frames <= 1) {
+			visible = true;
+			break;
+		}
+	}
+
+	bool far = false;
+	Spatial *spatial = Object::cast_to<Spatial>(p_visibility_node);
+	if (visible && max_distance > 0 && spatial) {
+		Camera *camera = spatial->get_viewport()->get_camera();
+		if (camera) {
+			far = camera->get_global_transform().origin.distance_squared_to(spatial->get_global_transform().origin) > max_distance * max_distance;
+		}
+	}
+
+	accum_delta += p_delta;
+
+	if (visible && !far) {
+		r_delta = accum_delta;
+		accum_delta = 0;
+		return ACTION_EVALUATE;
+	}
+
+	if (!visible && mode == MODE_PAUSED) {
+		r_delta = accum_delta;
+		accum_delta = 0;
+		return ACTION_ADVANCE;
+	}
+
+	if (reduced_fps > 0 && accum_delta * reduced_fps < 1.0) {
+		return ACTION_WAIT;
+	}
+
+	r_delta = accum_delta;
+	accum_delta = 0;
+	return ACTION_EVALUATE;
+}
+
+void AnimationVisibilityPolicy::reset() {
+
+	_clear_instances();
+	accum_delta = 0;
+}
+
+void AnimationVisibilityPolicy::count_tracks(int p_evaluated, int p_skipped) {
+
+	SceneTree *tree = SceneTree::get_singleton();
+	if (tree) {
+		tree->count_animation_tracks(p_evaluated, p_skipped);
+	}
+}
+
+AnimationVisibilityPolicy::AnimationVisibilityPolicy() {
+
+	mode = MODE_ALWAYS;
+	max_distance = 0;
+	reduced_fps = 10;
+	instances_from = 0;
+	accum_delta = 0;
+}
+
+AnimationVisibilityPolicy::~AnimationVisibilityPolicy() {
+
+	_clear_instances();
+}
+
 bool AnimationPlayer::_set(const StringName &p_name, const Variant &p_value) {
 
 	String name = p_name;
@@ -179,6 +354,8 @@ void AnimationPlayer::_get_property_list(List<PropertyInfo> *p_list) const {
 	p_list->push_back(PropertyInfo(Variant::ARRAY, "blend_times", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL));
 }
 
+SelfList<AnimationPlayer>::List AnimationPlayer::sample_pending;
+
 void AnimationPlayer::advance(float p_time) {
 
 	_animation_process(p_time);
@@ -210,16 +387,23 @@ void AnimationPlayer::_notification(int p_what) {
 			if (animation_process_mode == ANIMATION_PROCESS_PHYSICS)
 				break;
 
-			if (processing)
-				_animation_process(get_process_delta_time());
+			if (processing) {
+				_animation_process_visible(get_process_delta_time());
+			}
 		} break;
 		case NOTIFICATION_INTERNAL_PHYSICS_PROCESS: {
 
 			if (animation_process_mode == ANIMATION_PROCESS_IDLE)
 				break;
 
-			if (processing)
-				_animation_process(get_physics_process_delta_time());
+			if (processing) {
+				_animation_process_visible(get_physics_process_delta_time());
+			}
+		} break;
+		case NOTIFICATION_SAMPLE_TRANSFORMS: {
+
+			// also samples every other waiting player, their own notification will find nothing left
+			sample_pending_transforms();
 		} break;
 		case NOTIFICATION_EXIT_TREE: {
 
@@ -241,10 +425,12 @@ void AnimationPlayer::_ensure_node_caches(AnimationData *p_anim) {
 	Animation *a = p_anim->animation.operator->();
 
 	p_anim->node_cache.resize(a->get_track_count());
+	p_anim->key_cursors.resize(a->get_track_count());
 
 	for (int i = 0; i < a->get_track_count(); i++) {
 
 		p_anim->node_cache.write[i] = NULL;
+		p_anim->key_cursors.write[i] = -1;
 		RES resource;
 		Vector<StringName> leftover_path;
 		Node *child = parent->get_node_and_resource(a->track_get_path(i), resource, leftover_path);
@@ -344,6 +530,107 @@ void AnimationPlayer::_ensure_node_caches(AnimationData *p_anim) {
 	}
 }
 
+void AnimationPlayer::_animation_process_transform(AnimationData *p_anim, int p_track, float p_time, float p_interp) {
+
+	// Only touches this player's caches, so it is safe to run for several players at once.
+
+	TrackNodeCache *nc = p_anim->node_cache[p_track];
+	if (!nc || !nc->spatial)
+		return;
+
+	Vector3 loc;
+	Quat rot;
+	Vector3 scale;
+
+	Error err = p_anim->animation->transform_track_interpolate(p_track, p_time, &loc, &rot, &scale, &p_anim->key_cursors.write[p_track]);
+	//ERR_CONTINUE(err!=OK); //used for testing, should be removed
+
+	if (err != OK)
+		return;
+
+	if (nc->accum_pass != accum_pass) {
+		ERR_FAIL_COND(cache_update_size >= NODE_CACHE_UPDATE_MAX);
+		cache_update[cache_update_size++] = nc;
+		nc->accum_pass = accum_pass;
+		nc->loc_accum = loc;
+		nc->rot_accum = rot;
+		nc->scale_accum = scale;
+
+	} else {
+
+		nc->loc_accum = nc->loc_accum.linear_interpolate(loc, p_interp);
+		nc->rot_accum = nc->rot_accum.slerp(rot, p_interp);
+		nc->scale_accum = nc->scale_accum.linear_interpolate(scale, p_interp);
+	}
+}
+
+void AnimationPlayer::_animation_sample_transforms() {
+
+	for (int i = 0; i < transform_samples.size(); i++) {
+
+		const TransformSample &ts = transform_samples[i];
+		Animation *a = ts.anim->animation.operator->();
+
+		if (ts.anim->node_cache.size() != a->get_track_count())
+			continue; // caches are only rebuilt on the main thread
+
+		for (int j = 0; j < a->get_track_count(); j++) {
+
+			if (a->track_get_type(j) != Animation::TYPE_TRANSFORM || !a->track_is_enabled(j) || a->track_get_key_count(j) == 0)
+				continue;
+
+			_animation_process_transform(ts.anim, j, ts.time, ts.interp);
+		}
+	}
+}
+
+void AnimationPlayer::_animation_sample_transforms_thread(uint32_t p_index, AnimationPlayer **p_players) {
+
+	p_players[p_index]->_animation_sample_transforms();
+}
+
+void AnimationPlayer::sample_pending_transforms() {
+
+	Vector<AnimationPlayer *> players;
+
+	while (sample_pending.first()) {
+
+		players.push_back(sample_pending.first()->self());
+		sample_pending.remove(sample_pending.first());
+	}
+
+	if (players.empty())
+		return;
+
+	ThreadWorkPool::get_singleton()->do_work(players.size(), players[0], &AnimationPlayer::_animation_sample_transforms_thread, players.ptrw());
+
+	for (int i = 0; i < players.size(); i++) {
+
+		players[i]->transform_samples.clear();
+		players[i]->_animation_apply_transforms();
+	}
+}
+
+void AnimationPlayer::_animation_flush_transforms() {
+
+	// samples still waiting from an earlier pass must land before anything newer
+	if (transform_samples.empty())
+		return;
+
+	if (sample_list.in_list())
+		sample_pending.remove(&sample_list);
+	_animation_sample_transforms();
+	transform_samples.clear();
+	_animation_apply_transforms();
+}
+
+void AnimationPlayer::_animation_discard_transforms() {
+
+	if (sample_list.in_list())
+		sample_pending.remove(&sample_list);
+	transform_samples.clear();
+}
+
 void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, float p_time, float p_delta, float p_interp, bool p_is_current, bool p_seeked, bool p_started) {
 
 	_ensure_node_caches(p_anim);
@@ -352,6 +639,17 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, float
 	Animation *a = p_anim->animation.operator->();
 	bool can_call = is_inside_tree() && !Engine::get_singleton()->is_editor_hint();
 
+	int tracks_evaluated = 0;
+	int tracks_skipped = 0;
+
+	if (defer_transforms && !skip_tracks) {
+		TransformSample ts;
+		ts.anim = p_anim;
+		ts.time = p_time;
+		ts.interp = p_interp;
+		transform_samples.push_back(ts);
+	}
+
 	for (int i = 0; i < a->get_track_count(); i++) {
 
 		// If an animation changes this animation (or it animates itself)
@@ -371,37 +669,21 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, float
 		if (a->track_get_key_count(i) == 0)
 			continue; // do nothing if track is empty
 
-		switch (a->track_get_type(i)) {
-
-			case Animation::TYPE_TRANSFORM: {
-
-				if (!nc->spatial)
-					continue;
-
-				Vector3 loc;
-				Quat rot;
-				Vector3 scale;
+		if (skip_tracks && a->track_get_type(i) != Animation::TYPE_METHOD) {
+			tracks_skipped++;
+			continue; // not visible, only method calls still happen
+		}
 
-				Error err = a->transform_track_interpolate(i, p_time, &loc, &rot, &scale);
-				//ERR_CONTINUE(err!=OK); //used for testing, should be removed
+		tracks_evaluated++;
 
-				if (err != OK)
-					continue;
+		switch (a->track_get_type(i)) {
 
-				if (nc->accum_pass != accum_pass) {
-					ERR_CONTINUE(cache_update_size >= NODE_CACHE_UPDATE_MAX);
-					cache_update[cache_update_size++] = nc;
-					nc->accum_pass = accum_pass;
-					nc->loc_accum = loc;
-					nc->rot_accum = rot;
-					nc->scale_accum = scale;
+			case Animation::TYPE_TRANSFORM: {
 
-				} else {
+				if (defer_transforms)
+					continue; // sampled later, see sample_pending_transforms()
 
-					nc->loc_accum = nc->loc_accum.linear_interpolate(loc, p_interp);
-					nc->rot_accum = nc->rot_accum.slerp(rot, p_interp);
-					nc->scale_accum = nc->scale_accum.linear_interpolate(scale, p_interp);
-				}
+				_animation_process_transform(p_anim, i, p_time, p_interp);
 
 			} break;
 			case Animation::TYPE_VALUE: {
@@ -769,6 +1051,8 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, float
 			} break;
 		}
 	}
+
+	AnimationVisibilityPolicy::count_tracks(tracks_evaluated, tracks_skipped);
 }
 
 void AnimationPlayer::_animation_process_data(PlaybackData &cd, float p_delta, float p_blend, bool p_seeked, bool p_started) {
@@ -850,7 +1134,7 @@ void AnimationPlayer::_animation_process2(float p_delta, bool p_started) {
 	}
 }
 
-void AnimationPlayer::_animation_update_transforms() {
+void AnimationPlayer::_animation_apply_transforms() {
 	{
 		Transform t;
 		for (int i = 0; i < cache_update_size; i++) {
@@ -873,6 +1157,11 @@ void AnimationPlayer::_animation_update_transforms() {
 	}
 
 	cache_update_size = 0;
+}
+
+void AnimationPlayer::_animation_update_transforms() {
+
+	_animation_apply_transforms();
 
 	for (int i = 0; i < cache_update_prop_size; i++) {
 
@@ -934,8 +1223,31 @@ void AnimationPlayer::_animation_update_transforms() {
 	cache_update_bezier_size = 0;
 }
 
+void AnimationPlayer::_animation_process_visible(float p_delta) {
+
+	Node *visibility_node_ptr = visibility_node.is_empty() ? NULL : get_node_or_null(visibility_node);
+
+	float delta = p_delta;
+	AnimationVisibilityPolicy::Action action = visibility.process(visibility_node_ptr, p_delta, delta);
+
+	if (action == AnimationVisibilityPolicy::ACTION_WAIT) {
+		if (playback.current.from) {
+			AnimationVisibilityPolicy::count_tracks(0, playback.current.from->animation->get_track_count());
+		}
+		return;
+	}
+
+	skip_tracks = action == AnimationVisibilityPolicy::ACTION_ADVANCE;
+	defer_transforms = true;
+	_animation_process(delta);
+	defer_transforms = false;
+	skip_tracks = false;
+}
+
 void AnimationPlayer::_animation_process(float p_delta) {
 
+	_animation_flush_transforms();
+
 	if (playback.current.from) {
 
 		end_reached = false;
@@ -947,6 +1259,11 @@ void AnimationPlayer::_animation_process(float p_delta) {
 		}
 
 		_animation_update_transforms();
+
+		if (!transform_samples.empty() && !sample_list.in_list()) {
+			sample_pending.add(&sample_list);
+			MessageQueue::get_singleton()->push_notification(this, NOTIFICATION_SAMPLE_TRANSFORMS);
+		}
 		if (end_reached) {
 			if (queued.size()) {
 				String old = playback.assigned;
@@ -1411,6 +1728,7 @@ void AnimationPlayer::_node_removed(Node *p_node) {
 
 void AnimationPlayer::clear_caches() {
 
+	_animation_discard_transforms();
 	_stop_playing_caches();
 
 	node_cache_map.clear();
@@ -1539,6 +1857,47 @@ NodePath AnimationPlayer::get_root() const {
 	return root;
 }
 
+void AnimationPlayer::set_visibility_update_mode(VisibilityUpdateMode p_mode) {
+
+	visibility.mode = AnimationVisibilityPolicy::Mode(p_mode);
+}
+
+AnimationPlayer::VisibilityUpdateMode AnimationPlayer::get_visibility_update_mode() const {
+
+	return VisibilityUpdateMode(visibility.mode);
+}
+
+void AnimationPlayer::set_visibility_node(const NodePath &p_node) {
+
+	visibility_node = p_node;
+	visibility.reset();
+}
+
+NodePath AnimationPlayer::get_visibility_node() const {
+
+	return visibility_node;
+}
+
+void AnimationPlayer::set_visibility_max_distance(float p_distance) {
+
+	visibility.max_distance = p_distance;
+}
+
+float AnimationPlayer::get_visibility_max_distance() const {
+
+	return visibility.max_distance;
+}
+
+void AnimationPlayer::set_visibility_reduced_fps(float p_fps) {
+
+	visibility.reduced_fps = p_fps;
+}
+
+float AnimationPlayer::get_visibility_reduced_fps() const {
+
+	return visibility.reduced_fps;
+}
+
 void AnimationPlayer::get_argument_options(const StringName &p_function, int p_idx, List<String> *r_options) const {
 
 #ifdef TOOLS_ENABLED
@@ -1680,6 +2039,18 @@ void AnimationPlayer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_method_call_mode", "mode"), &AnimationPlayer::set_method_call_mode);
 	ClassDB::bind_method(D_METHOD("get_method_call_mode"), &AnimationPlayer::get_method_call_mode);
 
+	ClassDB::bind_method(D_METHOD("set_visibility_update_mode", "mode"), &AnimationPlayer::set_visibility_update_mode);
+	ClassDB::bind_method(D_METHOD("get_visibility_update_mode"), &AnimationPlayer::get_visibility_update_mode);
+
+	ClassDB::bind_method(D_METHOD("set_visibility_node", "path"), &AnimationPlayer::set_visibility_node);
+	ClassDB::bind_method(D_METHOD("get_visibility_node"), &AnimationPlayer::get_visibility_node);
+
+	ClassDB::bind_method(D_METHOD("set_visibility_max_distance", "distance"), &AnimationPlayer::set_visibility_max_distance);
+	ClassDB::bind_method(D_METHOD("get_visibility_max_distance"), &AnimationPlayer::get_visibility_max_distance);
+
+	ClassDB::bind_method(D_METHOD("set_visibility_reduced_fps", "fps"), &AnimationPlayer::set_visibility_reduced_fps);
+	ClassDB::bind_method(D_METHOD("get_visibility_reduced_fps"), &AnimationPlayer::get_visibility_reduced_fps);
+
 	ClassDB::bind_method(D_METHOD("get_current_animation_position"), &AnimationPlayer::get_current_animation_position);
 	ClassDB::bind_method(D_METHOD("get_current_animation_length"), &AnimationPlayer::get_current_animation_length);
 
@@ -1700,6 +2071,12 @@ void AnimationPlayer::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "playback_speed", PROPERTY_HINT_RANGE, "-64,64,0.01"), "set_speed_scale", "get_speed_scale");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "method_call_mode", PROPERTY_HINT_ENUM, "Deferred,Immediate"), "set_method_call_mode", "get_method_call_mode");
 
+	ADD_GROUP("Visibility", "visibility_");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "visibility_update_mode", PROPERTY_HINT_ENUM, "Always,Reduced,Paused"), "set_visibility_update_mode", "get_visibility_update_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "visibility_node"), "set_visibility_node", "get_visibility_node");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "visibility_max_distance", PROPERTY_HINT_RANGE, "0,4096,0.1,or_greater"), "set_visibility_max_distance", "get_visibility_max_distance");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "visibility_reduced_fps", PROPERTY_HINT_RANGE, "0,60,0.1,or_greater"), "set_visibility_reduced_fps", "get_visibility_reduced_fps");
+
 	ADD_SIGNAL(MethodInfo("animation_finished", PropertyInfo(Variant::STRING, "anim_name")));
 	ADD_SIGNAL(MethodInfo("animation_changed", PropertyInfo(Variant::STRING, "old_name"), PropertyInfo(Variant::STRING, "new_name")));
 	ADD_SIGNAL(MethodInfo("animation_started", PropertyInfo(Variant::STRING, "anim_name")));
@@ -1711,9 +2088,14 @@ void AnimationPlayer::_bind_methods() {
 
 	BIND_ENUM_CONSTANT(ANIMATION_METHOD_CALL_DEFERRED);
 	BIND_ENUM_CONSTANT(ANIMATION_METHOD_CALL_IMMEDIATE);
+
+	BIND_ENUM_CONSTANT(VISIBILITY_UPDATE_ALWAYS);
+	BIND_ENUM_CONSTANT(VISIBILITY_UPDATE_REDUCED);
+	BIND_ENUM_CONSTANT(VISIBILITY_UPDATE_PAUSED);
 }
 
-AnimationPlayer::AnimationPlayer() {
+AnimationPlayer::AnimationPlayer() :
+		sample_list(this) {
 
 	accum_pass = 1;
 	cache_update_size = 0;
@@ -1731,6 +2113,8 @@ AnimationPlayer::AnimationPlayer() {
 	active = true;
 	playback.seeked = false;
 	playback.started = false;
+	defer_transforms = false;
+	skip_tracks = false;
 }
 
 AnimationPlayer::~AnimationPlayer() {
@@ -31,6 +31,7 @@
 #ifndef ANIMATION_PLAYER_H
 #define ANIMATION_PLAYER_H
 
+#include "core/self_list.h"
 #include "scene/2d/node_2d.h"
 #include "scene/3d/skeleton.h"
 #include "scene/3d/spatial.h"
@@ -57,6 +58,58 @@ public:
 };
 #endif
 
+// Decides, every process step, whether an animated character that is hidden or far
+// from the camera is evaluated in full, at a reduced rate or only advanced in time.
+// Visibility comes from the VisualInstance nodes under the visibility node, as culled
+// by the VisualServer in the last drawn frame, queried for all policies together once
+// per frame. Shared by AnimationPlayer and AnimationTree.
+class AnimationVisibilityPolicy {
+public:
+	enum Mode {
+		MODE_ALWAYS,
+		MODE_REDUCED,
+		MODE_PAUSED,
+	};
+
+	enum Action {
+		ACTION_EVALUATE, // process with the returned delta
+		ACTION_WAIT, // skip this step, the delta is accumulated
+		ACTION_ADVANCE, // advance time only, skip the tracks that have no side effects
+	};
+
+	Mode mode;
+	float max_distance;
+	float reduced_fps;
+
+private:
+	struct VisibleInstance {
+		int refcount;
+		int frames_since_visible;
+	};
+
+	Vector<ObjectID> instances;
+	Vector<RID> instance_rids;
+	ObjectID instances_from;
+	float accum_delta;
+
+	static Map<RID, VisibleInstance> visible_instances;
+	static uint64_t visible_query_frame;
+	static bool visible_query_dirty;
+
+	void _gather_instances(Node *p_node);
+	void _clear_instances();
+	static int _get_frames_since_visible(RID p_instance);
+
+public:
+	Action process(Node *p_visibility_node, float p_delta, float &r_delta);
+	void reset();
+
+	static void count_tracks(int p_evaluated, int p_skipped);
+
+	AnimationVisibilityPolicy();
+	~AnimationVisibilityPolicy();
+};
+
 class AnimationPlayer : public Node {
 	GDCLASS(AnimationPlayer, Node);
 	OBJ_CATEGORY("Animation Nodes");
@@ -73,11 +126,18 @@ public:
 		ANIMATION_METHOD_CALL_IMMEDIATE,
 	};
 
+	enum VisibilityUpdateMode {
+		VISIBILITY_UPDATE_ALWAYS,
+		VISIBILITY_UPDATE_REDUCED,
+		VISIBILITY_UPDATE_PAUSED,
+	};
+
 private:
 	enum {
 
 		NODE_CACHE_UPDATE_MAX = 1024,
-		BLEND_FROM_MAX = 3
+		BLEND_FROM_MAX = 3,
+		NOTIFICATION_SAMPLE_TRANSFORMS = 50
 	};
 
 	enum SpecialProperty {
@@ -194,6 +254,7 @@ private:
 		String name;
 		StringName next;
 		Vector<TrackNodeCache *> node_cache;
+		Vector<int> key_cursors; // last key sampled per track, lets sequential playback skip the key search
 		Ref<Animation> animation;
 	};
 
@@ -246,6 +307,20 @@ private:
 
 	List<StringName> queued;
 
+	// Transform tracks of a processing frame are not sampled right away, all players
+	// waiting in 'sample_pending' sample them together in parallel when the message queue flushes.
+	struct TransformSample {
+
+		AnimationData *anim;
+		float time;
+		float interp;
+	};
+
+	Vector<TransformSample> transform_samples;
+	bool defer_transforms;
+	SelfList<AnimationPlayer> sample_list;
+	static SelfList<AnimationPlayer>::List sample_pending;
+
 	bool end_reached;
 	bool end_notify;
 
@@ -257,13 +332,25 @@ private:
 
 	NodePath root;
 
+	AnimationVisibilityPolicy visibility;
+	NodePath visibility_node;
+	bool skip_tracks;
+
 	void _animation_process_animation(AnimationData *p_anim, float p_time, float p_delta, float p_interp, bool p_is_current = true, bool p_seeked = false, bool p_started = false);
 
+	void _animation_process_transform(AnimationData *p_anim, int p_track, float p_time, float p_interp);
+	void _animation_sample_transforms();
+	void _animation_sample_transforms_thread(uint32_t p_index, AnimationPlayer **p_players);
+	void _animation_flush_transforms();
+	void _animation_discard_transforms();
+
 	void _ensure_node_caches(AnimationData *p_anim);
 	void _animation_process_data(PlaybackData &cd, float p_delta, float p_blend, bool p_seeked, bool p_started);
 	void _animation_process2(float p_delta, bool p_started);
+	void _animation_apply_transforms();
 	void _animation_update_transforms();
 	void _animation_process(float p_delta);
+	void _animation_process_visible(float p_delta);
 
 	void _node_removed(Node *p_node);
 	void _stop_playing_caches();
@@ -357,8 +444,22 @@ public:
 	void set_root(const NodePath &p_root);
 	NodePath get_root() const;
 
+	void set_visibility_update_mode(VisibilityUpdateMode p_mode);
+	VisibilityUpdateMode get_visibility_update_mode() const;
+
+	void set_visibility_node(const NodePath &p_node);
+	NodePath get_visibility_node() const;
+
+	void set_visibility_max_distance(float p_distance);
+	float get_visibility_max_distance() const;
+
+	void set_visibility_reduced_fps(float p_fps);
+	float get_visibility_reduced_fps() const;
+
 	void clear_caches(); ///< must be called by hand if an animation was modified after added
 
+	static void sample_pending_transforms(); // samples and applies the transform tracks of all waiting players
+
 	void get_argument_options(const StringName &p_function, int p_idx, List<String> *r_options) const;
 
 #ifdef TOOLS_ENABLED
@@ -373,5 +474,6 @@ public:
 
 VARIANT_ENUM_CAST(AnimationPlayer::AnimationProcessMode);
 VARIANT_ENUM_CAST(AnimationPlayer::AnimationMethodCallMode);
+VARIANT_ENUM_CAST(AnimationPlayer::VisibilityUpdateMode);
 
 #endif
@@ -32,7 +32,9 @@
 
 #include "animation_blend_tree.h"
 #include "core/engine.h"
+#include "core/message_queue.h"
 #include "core/method_bind_ext.gen.inc"
+#include "core/os/thread_work_pool.h"
 #include "scene/scene_string_names.h"
 #include "servers/audio/audio_stream.h"
 
@@ -535,6 +537,7 @@ AnimationTree::AnimationProcessMode AnimationTree::get_process_mode() const {
 }
 
 void AnimationTree::_node_removed(Node *p_node) {
+	_discard_transforms(); // pending samples are applied through the cached node pointers
 	cache_valid = false;
 }
 
@@ -733,6 +736,8 @@ bool AnimationTree::_update_caches(AnimationPlayer *player) {
 
 void AnimationTree::_clear_caches() {
 
+	_discard_transforms();
+
 	const NodePath *K = NULL;
 	while ((K = track_cache.next(K))) {
 		memdelete(track_cache[*K]);
@@ -743,8 +748,31 @@ void AnimationTree::_clear_caches() {
 	cache_valid = false;
 }
 
+void AnimationTree::_process_graph_visible(float p_delta) {
+
+	Node *visibility_node_ptr = visibility_node.is_empty() ? NULL : get_node_or_null(visibility_node);
+
+	float delta = p_delta;
+	AnimationVisibilityPolicy::Action action = visibility.process(visibility_node_ptr, p_delta, delta);
+
+	if (action == AnimationVisibilityPolicy::ACTION_WAIT) {
+		// the motion of the skipped steps is returned with the next evaluated one
+		root_motion_transform = Transform();
+		AnimationVisibilityPolicy::count_tracks(0, track_cache.size());
+		return;
+	}
+
+	root_motion_only = action == AnimationVisibilityPolicy::ACTION_ADVANCE;
+	defer_transforms = true;
+	_process_graph(delta);
+	defer_transforms = false;
+	root_motion_only = false;
+}
+
 void AnimationTree::_process_graph(float p_delta) {
 
+	_flush_transforms();
+
 	_update_properties(); //if properties need updating, update them
 
 	//check all tracks, see if they need modification
@@ -844,6 +872,8 @@ void AnimationTree::_process_graph(float p_delta) {
 	{
 
 		bool can_call = is_inside_tree() && !Engine::get_singleton()->is_editor_hint();
+		int tracks_evaluated = 0;
+		int tracks_skipped = 0;
 
 		for (List<AnimationNode::AnimationState>::Element *E = state.animation_states.front(); E; E = E->next()) {
 
@@ -854,6 +884,10 @@ void AnimationTree::_process_graph(float p_delta) {
 			float delta = as.delta;
 			bool seeked = as.seeked;
 
+			if (defer_transforms) {
+				sampled_animations.push_back(a);
+			}
+
 			for (int i = 0; i < a->get_track_count(); i++) {
 
 				NodePath path = a->track_get_path(i);
@@ -877,6 +911,13 @@ void AnimationTree::_process_graph(float p_delta) {
 				if (blend < CMP_EPSILON)
 					continue; //nothing to blend
 
+				if (root_motion_only && !track->root_motion && track->type != Animation::TYPE_METHOD) {
+					tracks_skipped++;
+					continue; // not visible, root motion and method calls still happen
+				}
+
+				tracks_evaluated++;
+
 				switch (track->type) {
 
 					case Animation::TYPE_TRANSFORM: {
@@ -938,36 +979,19 @@ void AnimationTree::_process_graph(float p_delta) {
 
 							prev_time = 0;
 
-						} else {
-							Vector3 loc;
-							Quat rot;
-							Vector3 scale;
-
-							Error err = a->transform_track_interpolate(i, time, &loc, &rot, &scale);
-							//ERR_CONTINUE(err!=OK); //used for testing, should be removed
+						} else if (defer_transforms) {
 
-							if (t->process_pass != process_pass) {
-
-								t->process_pass = process_pass;
-								t->loc = loc;
-								t->rot = rot;
-								t->rot_blend_accum = 0;
-								t->scale = scale;
-							}
+							TransformSample ts;
+							ts.animation = a.ptr();
+							ts.track = t;
+							ts.index = i;
+							ts.time = time;
+							ts.blend = blend;
+							transform_samples.push_back(ts);
 
-							if (err != OK)
-								continue;
+						} else {
 
-							t->loc = t->loc.linear_interpolate(loc, blend);
-							if (t->rot_blend_accum == 0) {
-								t->rot = rot;
-								t->rot_blend_accum = blend;
-							} else {
-								float rot_total = t->rot_blend_accum + blend;
-								t->rot = rot.slerp(t->rot, t->rot_blend_accum / rot_total).normalized();
-								t->rot_blend_accum = rot_total;
-							}
-							t->scale = t->scale.linear_interpolate(scale, blend);
+							_process_transform(a.ptr(), t, i, time, blend);
 						}
 
 					} break;
@@ -1220,6 +1244,13 @@ void AnimationTree::_process_graph(float p_delta) {
 				}
 			}
 		}
+
+		AnimationVisibilityPolicy::count_tracks(tracks_evaluated, tracks_skipped);
+	}
+
+	if (!transform_samples.empty() && !sample_list.in_list()) {
+		sample_pending.add(&sample_list);
+		MessageQueue::get_singleton()->push_notification(this, NOTIFICATION_SAMPLE_TRANSFORMS);
 	}
 
 	{
@@ -1279,6 +1310,124 @@ void AnimationTree::_process_graph(float p_delta) {
 	}
 }
 
+void AnimationTree::_process_transform(Animation *p_animation, TrackCacheTransform *p_track, int p_index, float p_time, float p_blend) {
+
+	// Only touches this tree's caches, so it is safe to run for several trees at once.
+
+	Vector3 loc;
+	Quat rot;
+	Vector3 scale;
+
+	Error err = p_animation->transform_track_interpolate(p_index, p_time, &loc, &rot, &scale);
+	//ERR_CONTINUE(err!=OK); //used for testing, should be removed
+
+	if (p_track->process_pass != process_pass) {
+
+		p_track->process_pass = process_pass;
+		p_track->loc = loc;
+		p_track->rot = rot;
+		p_track->rot_blend_accum = 0;
+		p_track->scale = scale;
+	}
+
+	if (err != OK)
+		return;
+
+	p_track->loc = p_track->loc.linear_interpolate(loc, p_blend);
+	if (p_track->rot_blend_accum == 0) {
+		p_track->rot = rot;
+		p_track->rot_blend_accum = p_blend;
+	} else {
+		float rot_total = p_track->rot_blend_accum + p_blend;
+		p_track->rot = rot.slerp(p_track->rot, p_track->rot_blend_accum / rot_total).normalized();
+		p_track->rot_blend_accum = rot_total;
+	}
+	p_track->scale = p_track->scale.linear_interpolate(scale, p_blend);
+}
+
+void AnimationTree::_sample_transforms() {
+
+	for (int i = 0; i < transform_samples.size(); i++) {
+
+		const TransformSample &ts = transform_samples[i];
+		_process_transform(ts.animation, ts.track, ts.index, ts.time, ts.blend);
+	}
+}
+
+void AnimationTree::_sample_transforms_thread(uint32_t p_index, AnimationTree **p_trees) {
+
+	p_trees[p_index]->_sample_transforms();
+}
+
+void AnimationTree::_apply_transforms() {
+
+	const NodePath *K = NULL;
+	while ((K = track_cache.next(K))) {
+
+		TrackCache *track = track_cache[*K];
+		if (track->type != Animation::TYPE_TRANSFORM || track->root_motion || track->process_pass != process_pass)
+			continue;
+
+		TrackCacheTransform *t = static_cast<TrackCacheTransform *>(track);
+
+		Transform xform;
+		xform.origin = t->loc;
+		xform.basis.set_quat_scale(t->rot, t->scale);
+
+		if (t->skeleton && t->bone_idx >= 0) {
+
+			t->skeleton->set_bone_pose(t->bone_idx, xform);
+
+		} else {
+
+			t->spatial->set_transform(xform);
+		}
+	}
+
+	transform_samples.clear();
+	sampled_animations.clear();
+}
+
+void AnimationTree::sample_pending_transforms() {
+
+	Vector<AnimationTree *> trees;
+
+	while (sample_pending.first()) {
+
+		trees.push_back(sample_pending.first()->self());
+		sample_pending.remove(sample_pending.first());
+	}
+
+	if (trees.empty())
+		return;
+
+	ThreadWorkPool::get_singleton()->do_work(trees.size(), trees[0], &AnimationTree::_sample_transforms_thread, trees.ptrw());
+
+	for (int i = 0; i < trees.size(); i++) {
+		trees[i]->_apply_transforms();
+	}
+}
+
+void AnimationTree::_flush_transforms() {
+
+	// samples still waiting from an earlier pass must land before anything newer
+	if (transform_samples.empty())
+		return;
+
+	if (sample_list.in_list())
+		sample_pending.remove(&sample_list);
+	_sample_transforms();
+	_apply_transforms();
+}
+
+void AnimationTree::_discard_transforms() {
+
+	if (sample_list.in_list())
+		sample_pending.remove(&sample_list);
+	transform_samples.clear();
+	sampled_animations.clear();
+}
+
 void AnimationTree::advance(float p_time) {
 
 	_process_graph(p_time);
@@ -1287,11 +1436,16 @@ void AnimationTree::advance(float p_time) {
 void AnimationTree::_notification(int p_what) {
 
 	if (active && p_what == NOTIFICATION_INTERNAL_PHYSICS_PROCESS && process_mode == ANIMATION_PROCESS_PHYSICS) {
-		_process_graph(get_physics_process_delta_time());
+		_process_graph_visible(get_physics_process_delta_time());
 	}
 
 	if (active && p_what == NOTIFICATION_INTERNAL_PROCESS && process_mode == ANIMATION_PROCESS_IDLE) {
-		_process_graph(get_process_delta_time());
+		_process_graph_visible(get_process_delta_time());
+	}
+
+	if (p_what == NOTIFICATION_SAMPLE_TRANSFORMS) {
+		// also samples every other waiting tree, their own notification will find nothing left
+		sample_pending_transforms();
 	}
 
 	if (p_what == NOTIFICATION_EXIT_TREE) {
@@ -1392,6 +1546,39 @@ Transform AnimationTree::get_root_motion_transform() const {
 	return root_motion_transform;
 }
 
+void AnimationTree::set_visibility_update_mode(VisibilityUpdateMode p_mode) {
+	visibility.mode = AnimationVisibilityPolicy::Mode(p_mode);
+}
+
+AnimationTree::VisibilityUpdateMode AnimationTree::get_visibility_update_mode() const {
+	return VisibilityUpdateMode(visibility.mode);
+}
+
+void AnimationTree::set_visibility_node(const NodePath &p_node) {
+	visibility_node = p_node;
+	visibility.reset();
+}
+
+NodePath AnimationTree::get_visibility_node() const {
+	return visibility_node;
+}
+
+void AnimationTree::set_visibility_max_distance(float p_distance) {
+	visibility.max_distance = p_distance;
+}
+
+float AnimationTree::get_visibility_max_distance() const {
+	return visibility.max_distance;
+}
+
+void AnimationTree::set_visibility_reduced_fps(float p_fps) {
+	visibility.reduced_fps = p_fps;
+}
+
+float AnimationTree::get_visibility_reduced_fps() const {
+	return visibility.reduced_fps;
+}
+
 void AnimationTree::_tree_changed() {
 	if (properties_dirty) {
 		return;
@@ -1552,6 +1739,18 @@ void AnimationTree::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_root_motion_transform"), &AnimationTree::get_root_motion_transform);
 
+	ClassDB::bind_method(D_METHOD("set_visibility_update_mode", "mode"), &AnimationTree::set_visibility_update_mode);
+	ClassDB::bind_method(D_METHOD("get_visibility_update_mode"), &AnimationTree::get_visibility_update_mode);
+
+	ClassDB::bind_method(D_METHOD("set_visibility_node", "path"), &AnimationTree::set_visibility_node);
+	ClassDB::bind_method(D_METHOD("get_visibility_node"), &AnimationTree::get_visibility_node);
+
+	ClassDB::bind_method(D_METHOD("set_visibility_max_distance", "distance"), &AnimationTree::set_visibility_max_distance);
+	ClassDB::bind_method(D_METHOD("get_visibility_max_distance"), &AnimationTree::get_visibility_max_distance);
+
+	ClassDB::bind_method(D_METHOD("set_visibility_reduced_fps", "fps"), &AnimationTree::set_visibility_reduced_fps);
+	ClassDB::bind_method(D_METHOD("get_visibility_reduced_fps"), &AnimationTree::get_visibility_reduced_fps);
+
 	ClassDB::bind_method(D_METHOD("_tree_changed"), &AnimationTree::_tree_changed);
 	ClassDB::bind_method(D_METHOD("_update_properties"), &AnimationTree::_update_properties);
 
@@ -1568,13 +1767,25 @@ void AnimationTree::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "process_mode", PROPERTY_HINT_ENUM, "Physics,Idle,Manual"), "set_process_mode", "get_process_mode");
 	ADD_GROUP("Root Motion", "root_motion_");
 	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "root_motion_track"), "set_root_motion_track", "get_root_motion_track");
+	ADD_GROUP("Visibility", "visibility_");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "visibility_update_mode", PROPERTY_HINT_ENUM, "Always,Reduced,Paused"), "set_visibility_update_mode", "get_visibility_update_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "visibility_node"), "set_visibility_node", "get_visibility_node");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "visibility_max_distance", PROPERTY_HINT_RANGE, "0,4096,0.1,or_greater"), "set_visibility_max_distance", "get_visibility_max_distance");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "visibility_reduced_fps", PROPERTY_HINT_RANGE, "0,60,0.1,or_greater"), "set_visibility_reduced_fps", "get_visibility_reduced_fps");
 
 	BIND_ENUM_CONSTANT(ANIMATION_PROCESS_PHYSICS);
 	BIND_ENUM_CONSTANT(ANIMATION_PROCESS_IDLE);
 	BIND_ENUM_CONSTANT(ANIMATION_PROCESS_MANUAL);
+
+	BIND_ENUM_CONSTANT(VISIBILITY_UPDATE_ALWAYS);
+	BIND_ENUM_CONSTANT(VISIBILITY_UPDATE_REDUCED);
+	BIND_ENUM_CONSTANT(VISIBILITY_UPDATE_PAUSED);
 }
 
-AnimationTree::AnimationTree() {
+SelfList<AnimationTree>::List AnimationTree::sample_pending;
+
+AnimationTree::AnimationTree() :
+		sample_list(this) {
 
 	process_mode = ANIMATION_PROCESS_IDLE;
 	active = false;
@@ -1584,6 +1795,8 @@ AnimationTree::AnimationTree() {
 	started = true;
 	properties_dirty = true;
 	last_animation_player = 0;
+	defer_transforms = false;
+	root_motion_only = false;
 }
 
 AnimationTree::~AnimationTree() {
@@ -172,7 +172,17 @@ public:
 		ANIMATION_PROCESS_MANUAL,
 	};
 
+	enum VisibilityUpdateMode {
+		VISIBILITY_UPDATE_ALWAYS,
+		VISIBILITY_UPDATE_REDUCED,
+		VISIBILITY_UPDATE_PAUSED,
+	};
+
 private:
+	enum {
+		NOTIFICATION_SAMPLE_TRANSFORMS = 50
+	};
+
 	struct TrackCache {
 
 		bool root_motion;
@@ -258,12 +268,40 @@ private:
 	HashMap<NodePath, TrackCache *> track_cache;
 	Set<TrackCache *> playing_caches;
 
+	// Like AnimationPlayer, transform tracks of a processing frame are sampled and blended
+	// later, in parallel with every other tree waiting in 'sample_pending'.
+	struct TransformSample {
+
+		Animation *animation;
+		TrackCacheTransform *track;
+		int index;
+		float time;
+		float blend;
+	};
+
+	Vector<TransformSample> transform_samples;
+	Vector<Ref<Animation> > sampled_animations; // keeps the animations in transform_samples alive
+	bool defer_transforms;
+	SelfList<AnimationTree> sample_list;
+	static SelfList<AnimationTree>::List sample_pending;
+
+	void _process_transform(Animation *p_animation, TrackCacheTransform *p_track, int p_index, float p_time, float p_blend);
+	void _sample_transforms();
+	void _sample_transforms_thread(uint32_t p_index, AnimationTree **p_trees);
+	void _apply_transforms();
+	void _flush_transforms();
+	void _discard_transforms();
+
 	Ref<AnimationNode> root;
 
 	AnimationProcessMode process_mode;
 	bool active;
 	NodePath animation_player;
 
+	AnimationVisibilityPolicy visibility;
+	NodePath visibility_node;
+	bool root_motion_only;
+
 	AnimationNode::State state;
 	bool cache_valid;
 	void _node_removed(Node *p_node);
@@ -272,6 +310,7 @@ private:
 	void _clear_caches();
 	bool _update_caches(AnimationPlayer *player);
 	void _process_graph(float p_delta);
+	void _process_graph_visible(float p_delta);
 
 	uint64_t setup_pass;
 	uint64_t process_pass;
@@ -332,16 +371,31 @@ public:
 
 	Transform get_root_motion_transform() const;
 
+	void set_visibility_update_mode(VisibilityUpdateMode p_mode);
+	VisibilityUpdateMode get_visibility_update_mode() const;
+
+	void set_visibility_node(const NodePath &p_node);
+	NodePath get_visibility_node() const;
+
+	void set_visibility_max_distance(float p_distance);
+	float get_visibility_max_distance() const;
+
+	void set_visibility_reduced_fps(float p_fps);
+	float get_visibility_reduced_fps() const;
+
 	float get_connection_activity(const StringName &p_path, int p_connection) const;
 	void advance(float p_time);
 
 	void rename_parameter(const String &p_base, const String &p_new_base);
 
 	uint64_t get_last_process_pass() const;
+
+	static void sample_pending_transforms(); // samples, blends and applies the transform tracks of all waiting trees
 	AnimationTree();
 	~AnimationTree();
 };
 
 VARIANT_ENUM_CAST(AnimationTree::AnimationProcessMode)
+VARIANT_ENUM_CAST(AnimationTree::VisibilityUpdateMode)
 
 #endif // ANIMATION_GRAPH_PLAYER_H
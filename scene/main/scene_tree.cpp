@@ -565,6 +565,12 @@ bool SceneTree::idle(float p_time) {
 
 	_call_idle_callbacks();
 
+	// physics steps come before idle, so this closes the frame for both
+	animation_tracks_evaluated[1] = animation_tracks_evaluated[0];
+	animation_tracks_skipped[1] = animation_tracks_skipped[0];
+	animation_tracks_evaluated[0] = 0;
+	animation_tracks_skipped[0] = 0;
+
 #ifdef TOOLS_ENABLED
 
 	if (Engine::get_singleton()->is_editor_hint()) {
@@ -1122,6 +1128,12 @@ int SceneTree::get_node_count() const {
 	return node_count;
 }
 
+void SceneTree::count_animation_tracks(int p_evaluated, int p_skipped) {
+
+	animation_tracks_evaluated[0] += p_evaluated;
+	animation_tracks_skipped[0] += p_skipped;
+}
+
 void SceneTree::_update_root_rect() {
 
 	if (stretch_mode == STRETCH_MODE_DISABLED) {
@@ -1985,6 +1997,8 @@ SceneTree::SceneTree() {
 	call_lock = 0;
 	root_lock = 0;
 	node_count = 0;
+	animation_tracks_evaluated[0] = animation_tracks_evaluated[1] = 0;
+	animation_tracks_skipped[0] = animation_tracks_skipped[1] = 0;
 
 	//create with mainloop
 
@@ -133,6 +133,10 @@ private:
 	int64_t current_event;
 	int node_count;
 
+	// [0] counts the current frame, [1] holds the last complete one
+	int animation_tracks_evaluated[2];
+	int animation_tracks_skipped[2];
+
 #ifdef TOOLS_ENABLED
 	Node *edited_scene_root;
 #endif
@@ -381,6 +385,10 @@ public:
 
 	int get_node_count() const;
 
+	void count_animation_tracks(int p_evaluated, int p_skipped);
+	int get_animation_tracks_evaluated() const { return animation_tracks_evaluated[1]; }
+	int get_animation_tracks_skipped() const { return animation_tracks_skipped[1]; }
+
 	void queue_delete(Object *p_object);
 
 	void get_nodes_in_group(const StringName &p_group, List<Node *> *p_list);
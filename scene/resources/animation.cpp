@@ -31,6 +31,7 @@
 #include "animation.h"
 #include "scene/scene_string_names.h"
 
+#include "core/io/marshalls.h"
 #include "core/math/geometry.h"
 
 #define ANIM_MIN_LENGTH 0.001
@@ -91,6 +92,26 @@ bool Animation::_set(const StringName &p_name, const Variant &p_value) {
 			if (track_get_type(track) == TYPE_TRANSFORM) {
 
 				TransformTrack *tt = static_cast<TransformTrack *>(tracks[track]);
+
+				if (p_value.get_type() == Variant::DICTIONARY) {
+					// compressed keys, see compress()
+					CompressedTransforms *ct = memnew(CompressedTransforms);
+					if (!ct->deserialize(p_value)) {
+						memdelete(ct);
+						ERR_FAIL_V(false);
+					}
+					if (tt->compressed)
+						memdelete(tt->compressed);
+					tt->compressed = ct;
+					tt->transforms.clear();
+					return true;
+				}
+
+				if (tt->compressed) {
+					memdelete(tt->compressed);
+					tt->compressed = NULL;
+				}
+
 				PoolVector<float> values = p_value;
 				int vcount = values.size();
 				ERR_FAIL_COND_V(vcount % 12, false); // should be multiple of 11
@@ -373,6 +394,12 @@ bool Animation::_get(const StringName &p_name, Variant &r_ret) const {
 
 			if (track_get_type(track) == TYPE_TRANSFORM) {
 
+				const TransformTrack *tt = static_cast<const TransformTrack *>(tracks[track]);
+				if (tt->compressed) {
+					r_ret = tt->compressed->serialize();
+					return true;
+				}
+
 				PoolVector<real_t> keys;
 				int kk = track_get_key_count(track);
 				keys.resize(kk * 12);
@@ -851,6 +878,22 @@ Error Animation::transform_track_get_key(int p_track, int p_key, Vector3 *r_loc,
 
 	TransformTrack *tt = static_cast<TransformTrack *>(t);
 	ERR_FAIL_COND_V(t->type != TYPE_TRANSFORM, ERR_INVALID_PARAMETER);
+
+	if (tt->compressed) {
+
+		ERR_FAIL_INDEX_V(p_key, tt->compressed->size(), ERR_INVALID_PARAMETER);
+		TransformKey tk = tt->compressed->get_value(p_key);
+
+		if (r_loc)
+			*r_loc = tk.loc;
+		if (r_rot)
+			*r_rot = tk.rot;
+		if (r_scale)
+			*r_scale = tk.scale;
+
+		return OK;
+	}
+
 	ERR_FAIL_INDEX_V(p_key, tt->transforms.size(), ERR_INVALID_PARAMETER);
 
 	if (r_loc)
@@ -870,6 +913,7 @@ int Animation::transform_track_insert_key(int p_track, float p_time, const Vecto
 	ERR_FAIL_COND_V(t->type != TYPE_TRANSFORM, -1);
 
 	TransformTrack *tt = static_cast<TransformTrack *>(t);
+	_transform_track_decompress(tt);
 
 	TKey<TransformKey> tkey;
 	tkey.time = p_time;
@@ -898,6 +942,7 @@ void Animation::track_remove_key(int p_track, int p_idx) {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			_transform_track_decompress(tt);
 			ERR_FAIL_INDEX(p_idx, tt->transforms.size());
 			tt->transforms.remove(p_idx);
 
@@ -951,6 +996,15 @@ int Animation::track_find_key(int p_track, float p_time, bool p_exact) const {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			if (tt->compressed) {
+				int k = _find(*tt->compressed, p_time);
+				if (k < 0 || k >= tt->compressed->size())
+					return -1;
+				if (tt->compressed->get_time(k) != p_time && p_exact)
+					return -1;
+				return k;
+			}
+
 			int k = _find(tt->transforms, p_time);
 			if (k < 0 || k >= tt->transforms.size())
 				return -1;
@@ -1136,6 +1190,8 @@ int Animation::track_get_key_count(int p_track) const {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			if (tt->compressed)
+				return tt->compressed->size();
 			return tt->transforms.size();
 		} break;
 		case TYPE_VALUE: {
@@ -1179,6 +1235,17 @@ Variant Animation::track_get_key_value(int p_track, int p_key_idx) const {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			if (tt->compressed) {
+				ERR_FAIL_INDEX_V(p_key_idx, tt->compressed->size(), Variant());
+				TransformKey tk = tt->compressed->get_value(p_key_idx);
+
+				Dictionary d;
+				d["location"] = tk.loc;
+				d["rotation"] = tk.rot;
+				d["scale"] = tk.scale;
+				return d;
+			}
+
 			ERR_FAIL_INDEX_V(p_key_idx, tt->transforms.size(), Variant());
 
 			Dictionary d;
@@ -1255,6 +1322,10 @@ float Animation::track_get_key_time(int p_track, int p_key_idx) const {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			if (tt->compressed) {
+				ERR_FAIL_INDEX_V(p_key_idx, tt->compressed->size(), -1);
+				return tt->compressed->get_time(p_key_idx);
+			}
 			ERR_FAIL_INDEX_V(p_key_idx, tt->transforms.size(), -1);
 			return tt->transforms[p_key_idx].time;
 		} break;
@@ -1308,6 +1379,7 @@ void Animation::track_set_key_time(int p_track, int p_key_idx, float p_time) {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			_transform_track_decompress(tt);
 			ERR_FAIL_INDEX(p_key_idx, tt->transforms.size());
 			TKey<TransformKey> key = tt->transforms[p_key_idx];
 			key.time = p_time;
@@ -1380,6 +1452,10 @@ float Animation::track_get_key_transition(int p_track, int p_key_idx) const {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			if (tt->compressed) {
+				ERR_FAIL_INDEX_V(p_key_idx, tt->compressed->size(), -1);
+				return tt->compressed->get_transition(p_key_idx);
+			}
 			ERR_FAIL_INDEX_V(p_key_idx, tt->transforms.size(), -1);
 			return tt->transforms[p_key_idx].transition;
 		} break;
@@ -1424,6 +1500,7 @@ void Animation::track_set_key_value(int p_track, int p_key_idx, const Variant &p
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			_transform_track_decompress(tt);
 			ERR_FAIL_INDEX(p_key_idx, tt->transforms.size());
 
 			Dictionary d = p_value;
@@ -1510,6 +1587,7 @@ void Animation::track_set_key_transition(int p_track, int p_key_idx, float p_tra
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			_transform_track_decompress(tt);
 			ERR_FAIL_INDEX(p_key_idx, tt->transforms.size());
 			tt->transforms.write[p_key_idx].transition = p_transition;
 		} break;
@@ -1538,7 +1616,7 @@ void Animation::track_set_key_transition(int p_track, int p_key_idx, float p_tra
 }
 
 template <class K>
-int Animation::_find(const Vector<K> &p_keys, float p_time) const {
+int Animation::_find(const Vector<K> &p_keys, float p_time, int p_hint) const {
 
 	int len = p_keys.size();
 	if (len == 0)
@@ -1555,6 +1633,17 @@ int Animation::_find(const Vector<K> &p_keys, float p_time) const {
 
 	const K *keys = &p_keys[0];
 
+	if (p_hint >= 0) {
+		// sequential playback stays on the hinted key or moves to the next one
+		for (int i = p_hint; i <= p_hint + 1 && i < len; i++) {
+
+			if (p_time < keys[i].time)
+				break;
+			if (i == len - 1 || (p_time < keys[i + 1].time && !Math::is_equal_approx(p_time, keys[i + 1].time)))
+				return i;
+		}
+	}
+
 	while (low <= high) {
 
 		middle = (low + high) / 2;
@@ -1573,6 +1662,67 @@ int Animation::_find(const Vector<K> &p_keys, float p_time) const {
 	return middle;
 }
 
+int Animation::_find(const CompressedTransforms &p_keys, float p_time, int p_hint) const {
+
+	int len = p_keys.size();
+	if (len == 0)
+		return -2;
+
+	if (p_hint >= 0) {
+
+		for (int i = p_hint; i <= p_hint + 1 && i < len; i++) {
+
+			if (p_time < p_keys.get_time(i))
+				break;
+			if (i == len - 1)
+				return i;
+			float next = p_keys.get_time(i + 1);
+			if (p_time < next && !Math::is_equal_approx(p_time, next))
+				return i;
+		}
+	}
+
+	// locate the page first, the keys inside it are searched the same way as uncompressed ones
+	const float *page_times = p_keys.page_times.ptr();
+	int page_count = p_keys.page_times.size() - 1;
+
+	int page = 0;
+	int low = 1;
+	int high = page_count - 1;
+	while (low <= high) {
+
+		int middle = (low + high) / 2;
+		if (page_times[middle] <= p_time || Math::is_equal_approx(page_times[middle], p_time)) {
+			page = middle;
+			low = middle + 1;
+		} else {
+			high = middle - 1;
+		}
+	}
+
+	low = page * CompressedTransforms::PAGE_SIZE;
+	high = MIN(low + CompressedTransforms::PAGE_SIZE, len) - 1;
+	int middle = low;
+
+	while (low <= high) {
+
+		middle = (low + high) / 2;
+		float time = p_keys.get_time(middle);
+
+		if (Math::is_equal_approx(p_time, time)) { //match
+			return middle;
+		} else if (p_time < time)
+			high = middle - 1;
+		else
+			low = middle + 1;
+	}
+
+	if (p_keys.get_time(middle) > p_time)
+		middle--;
+
+	return middle;
+}
+
 Animation::TransformKey Animation::_interpolate(const Animation::TransformKey &p_a, const Animation::TransformKey &p_b, float p_c) const {
 
 	TransformKey ret;
@@ -1719,10 +1869,12 @@ float Animation::_cubic_interpolate(const float &p_pre_a, const float &p_a, cons
 	return _interpolate(p_a, p_b, p_c);
 }
 
-template <class T>
-T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, InterpolationType p_interp, bool p_loop_wrap, bool *p_ok) const {
+template <class T, class K>
+T Animation::_interpolate(const K &p_keys, float p_time, InterpolationType p_interp, bool p_loop_wrap, bool *p_ok, int *p_cursor) const {
 
-	int len = _find(p_keys, length) + 1; // try to find last key (there may be more past the end)
+	int len = p_keys.size();
+	if (len > 0 && _key_time(p_keys, len - 1) > length)
+		len = _find(p_keys, length) + 1; // try to find last key (there may be more past the end)
 
 	if (len <= 0) {
 		// (-1 or -2 returned originally) (plus one above)
@@ -1734,13 +1886,16 @@ T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, Interpol
 
 		if (p_ok)
 			*p_ok = true;
-		return p_keys[0].value;
+		return _key_value(p_keys, 0);
 	}
 
-	int idx = _find(p_keys, p_time);
+	int idx = _find(p_keys, p_time, p_cursor ? *p_cursor : -1);
 
 	ERR_FAIL_COND_V(idx == -2, T());
 
+	if (p_cursor)
+		*p_cursor = idx;
+
 	bool result = true;
 	int next = 0;
 	float c = 0;
@@ -1753,8 +1908,8 @@ T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, Interpol
 			if ((idx + 1) < len) {
 
 				next = idx + 1;
-				float delta = p_keys[next].time - p_keys[idx].time;
-				float from = p_time - p_keys[idx].time;
+				float delta = _key_time(p_keys, next) - _key_time(p_keys, idx);
+				float from = p_time - _key_time(p_keys, idx);
 
 				if (Math::is_zero_approx(delta))
 					c = 0;
@@ -1764,8 +1919,8 @@ T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, Interpol
 			} else {
 
 				next = 0;
-				float delta = (length - p_keys[idx].time) + p_keys[next].time;
-				float from = p_time - p_keys[idx].time;
+				float delta = (length - _key_time(p_keys, idx)) + _key_time(p_keys, next);
+				float from = p_time - _key_time(p_keys, idx);
 
 				if (Math::is_zero_approx(delta))
 					c = 0;
@@ -1777,10 +1932,10 @@ T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, Interpol
 			// on loop, behind first key
 			idx = len - 1;
 			next = 0;
-			float endtime = (length - p_keys[idx].time);
+			float endtime = (length - _key_time(p_keys, idx));
 			if (endtime < 0) // may be keys past the end
 				endtime = 0;
-			float delta = endtime + p_keys[next].time;
+			float delta = endtime + _key_time(p_keys, next);
 			float from = endtime + p_time;
 
 			if (Math::is_zero_approx(delta))
@@ -1796,8 +1951,8 @@ T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, Interpol
 			if ((idx + 1) < len) {
 
 				next = idx + 1;
-				float delta = p_keys[next].time - p_keys[idx].time;
-				float from = p_time - p_keys[idx].time;
+				float delta = _key_time(p_keys, next) - _key_time(p_keys, idx);
+				float from = p_time - _key_time(p_keys, idx);
 
 				if (Math::is_zero_approx(delta))
 					c = 0;
@@ -1824,11 +1979,11 @@ T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, Interpol
 	if (!result)
 		return T();
 
-	float tr = p_keys[idx].transition;
+	float tr = _key_transition(p_keys, idx);
 
 	if (tr == 0 || idx == next) {
 		// don't interpolate if not needed
-		return p_keys[idx].value;
+		return _key_value(p_keys, idx);
 	}
 
 	if (tr != 1.0) {
@@ -1840,11 +1995,11 @@ T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, Interpol
 
 		case INTERPOLATION_NEAREST: {
 
-			return p_keys[idx].value;
+			return _key_value(p_keys, idx);
 		} break;
 		case INTERPOLATION_LINEAR: {
 
-			return _interpolate(p_keys[idx].value, p_keys[next].value, c);
+			return _interpolate(_key_value(p_keys, idx), _key_value(p_keys, next), c);
 		} break;
 		case INTERPOLATION_CUBIC: {
 			int pre = idx - 1;
@@ -1854,16 +2009,16 @@ T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, Interpol
 			if (post >= len)
 				post = next;
 
-			return _cubic_interpolate(p_keys[pre].value, p_keys[idx].value, p_keys[next].value, p_keys[post].value, c);
+			return _cubic_interpolate(_key_value(p_keys, pre), _key_value(p_keys, idx), _key_value(p_keys, next), _key_value(p_keys, post), c);
 
 		} break;
-		default: return p_keys[idx].value;
+		default: return _key_value(p_keys, idx);
 	}
 
 	// do a barrel roll
 }
 
-Error Animation::transform_track_interpolate(int p_track, float p_time, Vector3 *r_loc, Quat *r_rot, Vector3 *r_scale) const {
+Error Animation::transform_track_interpolate(int p_track, float p_time, Vector3 *r_loc, Quat *r_rot, Vector3 *r_scale, int *r_cursor) const {
 
 	ERR_FAIL_INDEX_V(p_track, tracks.size(), ERR_INVALID_PARAMETER);
 	Track *t = tracks[p_track];
@@ -1873,7 +2028,11 @@ Error Animation::transform_track_interpolate(int p_track, float p_time, Vector3
 
 	bool ok = false;
 
-	TransformKey tk = _interpolate(tt->transforms, p_time, tt->interpolation, tt->loop_wrap, &ok);
+	TransformKey tk;
+	if (tt->compressed)
+		tk = _interpolate<TransformKey>(*tt->compressed, p_time, tt->interpolation, tt->loop_wrap, &ok, r_cursor);
+	else
+		tk = _interpolate<TransformKey>(tt->transforms, p_time, tt->interpolation, tt->loop_wrap, &ok, r_cursor);
 
 	if (!ok)
 		return ERR_UNAVAILABLE;
@@ -1899,7 +2058,7 @@ Variant Animation::value_track_interpolate(int p_track, float p_time) const {
 
 	bool ok = false;
 
-	Variant res = _interpolate(vt->values, p_time, (vt->update_mode == UPDATE_CONTINUOUS || vt->update_mode == UPDATE_CAPTURE) ? vt->interpolation : INTERPOLATION_NEAREST, vt->loop_wrap, &ok);
+	Variant res = _interpolate<Variant>(vt->values, p_time, (vt->update_mode == UPDATE_CONTINUOUS || vt->update_mode == UPDATE_CAPTURE) ? vt->interpolation : INTERPOLATION_NEAREST, vt->loop_wrap, &ok);
 
 	if (ok) {
 
@@ -2006,8 +2165,8 @@ Animation::UpdateMode Animation::value_track_get_update_mode(int p_track) const
 	return vt->update_mode;
 }
 
-template <class T>
-void Animation::_track_get_key_indices_in_range(const Vector<T> &p_array, float from_time, float to_time, List<int> *p_indices) const {
+template <class K>
+void Animation::_track_get_key_indices_in_range(const K &p_array, float from_time, float to_time, List<int> *p_indices) const {
 
 	if (from_time != length && to_time == length)
 		to_time = length * 1.01; //include a little more if at the end
@@ -2017,7 +2176,7 @@ void Animation::_track_get_key_indices_in_range(const Vector<T> &p_array, float
 	// can't really send the events == time, will be sent in the next frame.
 	// if event>=len then it will probably never be requested by the anim player.
 
-	if (to >= 0 && p_array[to].time >= to_time)
+	if (to >= 0 && _key_time(p_array, to) >= to_time)
 		to--;
 
 	if (to < 0)
@@ -2026,7 +2185,7 @@ void Animation::_track_get_key_indices_in_range(const Vector<T> &p_array, float
 	int from = _find(p_array, from_time);
 
 	// position in the right first event.+
-	if (from < 0 || p_array[from].time < from_time)
+	if (from < 0 || _key_time(p_array, from) < from_time)
 		from++;
 
 	int max = p_array.size();
@@ -2065,8 +2224,13 @@ void Animation::track_get_key_indices_in_range(int p_track, float p_time, float
 				case TYPE_TRANSFORM: {
 
 					const TransformTrack *tt = static_cast<const TransformTrack *>(t);
-					_track_get_key_indices_in_range(tt->transforms, from_time, length, p_indices);
-					_track_get_key_indices_in_range(tt->transforms, 0, to_time, p_indices);
+					if (tt->compressed) {
+						_track_get_key_indices_in_range(*tt->compressed, from_time, length, p_indices);
+						_track_get_key_indices_in_range(*tt->compressed, 0, to_time, p_indices);
+					} else {
+						_track_get_key_indices_in_range(tt->transforms, from_time, length, p_indices);
+						_track_get_key_indices_in_range(tt->transforms, 0, to_time, p_indices);
+					}
 
 				} break;
 				case TYPE_VALUE: {
@@ -2125,7 +2289,10 @@ void Animation::track_get_key_indices_in_range(int p_track, float p_time, float
 		case TYPE_TRANSFORM: {
 
 			const TransformTrack *tt = static_cast<const TransformTrack *>(t);
-			_track_get_key_indices_in_range(tt->transforms, from_time, to_time, p_indices);
+			if (tt->compressed)
+				_track_get_key_indices_in_range(*tt->compressed, from_time, to_time, p_indices);
+			else
+				_track_get_key_indices_in_range(tt->transforms, from_time, to_time, p_indices);
 
 		} break;
 		case TYPE_VALUE: {
@@ -2825,6 +2992,9 @@ void Animation::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("clear"), &Animation::clear);
 	ClassDB::bind_method(D_METHOD("copy_track", "track", "to_animation"), &Animation::copy_track);
 
+	ClassDB::bind_method(D_METHOD("compress"), &Animation::compress);
+	ClassDB::bind_method(D_METHOD("track_is_compressed", "idx"), &Animation::track_is_compressed);
+
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "length", PROPERTY_HINT_RANGE, "0.001,99999,0.001"), "set_length", "get_length");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "loop"), "set_loop", "has_loop");
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "step", PROPERTY_HINT_RANGE, "0,4096,0.001"), "set_step", "get_step");
@@ -3034,6 +3204,7 @@ void Animation::_transform_track_optimize(int p_idx, float p_allowed_linear_err,
 	ERR_FAIL_INDEX(p_idx, tracks.size());
 	ERR_FAIL_COND(tracks[p_idx]->type != TYPE_TRANSFORM);
 	TransformTrack *tt = static_cast<TransformTrack *>(tracks[p_idx]);
+	_transform_track_decompress(tt);
 	bool prev_erased = false;
 	TKey<TransformKey> first_erased;
 
@@ -3081,6 +3252,341 @@ void Animation::optimize(float p_allowed_linear_err, float p_allowed_angular_err
 	}
 }
 
+void Animation::_transform_track_decompress(TransformTrack *p_track) {
+
+	if (!p_track->compressed)
+		return;
+
+	p_track->compressed->decompress(p_track->transforms);
+	memdelete(p_track->compressed);
+	p_track->compressed = NULL;
+}
+
+void Animation::compress() {
+
+	for (int i = 0; i < tracks.size(); i++) {
+
+		if (tracks[i]->type != TYPE_TRANSFORM)
+			continue;
+
+		TransformTrack *tt = static_cast<TransformTrack *>(tracks[i]);
+		if (tt->compressed || tt->transforms.empty())
+			continue;
+
+		tt->compressed = memnew(CompressedTransforms);
+		tt->compressed->compress(tt->transforms);
+		tt->transforms.clear();
+	}
+
+	emit_changed();
+}
+
+bool Animation::track_is_compressed(int p_track) const {
+
+	ERR_FAIL_INDEX_V(p_track, tracks.size(), false);
+	const Track *t = tracks[p_track];
+	if (t->type != TYPE_TRANSFORM)
+		return false;
+
+	return static_cast<const TransformTrack *>(t)->compressed != NULL;
+}
+
+/* COMPRESSED TRANSFORM KEYS */
+
+static _FORCE_INLINE_ uint16_t _quantize_unit(real_t p_value, int p_max) {
+
+	return (uint16_t)CLAMP(Math::fast_ftoi(p_value * p_max), 0, p_max);
+}
+
+static void _encode_quat(const Quat &p_quat, uint16_t *r_data) {
+
+	Quat q = p_quat.normalized();
+	real_t c[4] = { q.x, q.y, q.z, q.w };
+
+	int largest = 0;
+	for (int i = 1; i < 4; i++) {
+		if (Math::abs(c[i]) > Math::abs(c[largest]))
+			largest = i;
+	}
+
+	// q and -q are the same rotation, flip so the dropped component is positive
+	real_t sign = c[largest] < 0 ? -1.0 : 1.0;
+
+	int j = 0;
+	for (int i = 0; i < 4; i++) {
+		if (i == largest)
+			continue;
+		// the other components are within [-sqrt(1/2), sqrt(1/2)], 15 bits each
+		r_data[j++] = _quantize_unit(c[i] * sign * Math_SQRT2 * 0.5 + 0.5, 0x7FFF);
+	}
+
+	r_data[0] |= (largest & 1) << 15;
+	r_data[1] |= (largest >> 1) << 15;
+}
+
+static Quat _decode_quat(const uint16_t *p_data) {
+
+	int largest = (p_data[0] >> 15) | ((p_data[1] >> 15) << 1);
+	real_t c[4];
+	real_t sum = 0;
+
+	int j = 0;
+	for (int i = 0; i < 4; i++) {
+		if (i == largest)
+			continue;
+		real_t v = ((p_data[j++] & 0x7FFF) * (2.0 / 0x7FFF) - 1.0) * Math_SQRT12;
+		c[i] = v;
+		sum += v * v;
+	}
+
+	c[largest] = Math::sqrt(MAX(0.0, 1.0 - sum));
+
+	return Quat(c[0], c[1], c[2], c[3]);
+}
+
+static void _encode_vector3(const Vector3 &p_vec, const Vector3 &p_min, const Vector3 &p_step, uint16_t *r_data) {
+
+	for (int i = 0; i < 3; i++)
+		r_data[i] = p_step[i] > 0 ? _quantize_unit((p_vec[i] - p_min[i]) / p_step[i] / 0xFFFF, 0xFFFF) : 0;
+}
+
+static _FORCE_INLINE_ Vector3 _decode_vector3(const uint16_t *p_data, const Vector3 &p_min, const Vector3 &p_step) {
+
+	return Vector3(p_min.x + p_data[0] * p_step.x, p_min.y + p_data[1] * p_step.y, p_min.z + p_data[2] * p_step.z);
+}
+
+float Animation::CompressedTransforms::get_time(int p_idx) const {
+
+	int page = p_idx / PAGE_SIZE;
+	const float *times = &page_times[page];
+	return times[0] + (times[1] - times[0]) * (data[p_idx * stride] * (1.0 / 0xFFFF));
+}
+
+Animation::TransformKey Animation::CompressedTransforms::get_value(int p_idx) const {
+
+	TransformKey ret = constant;
+	const uint16_t *r = &data[p_idx * stride + 1];
+
+	if (channels & CHANNEL_LOC) {
+		ret.loc = _decode_vector3(r, loc_min, loc_step);
+		r += 3;
+	}
+	if (channels & CHANNEL_ROT) {
+		ret.rot = _decode_quat(r);
+		r += 3;
+	}
+	if (channels & CHANNEL_SCALE) {
+		ret.scale = _decode_vector3(r, scale_min, scale_step);
+	}
+
+	return ret;
+}
+
+void Animation::CompressedTransforms::compress(const Vector<TKey<TransformKey> > &p_keys) {
+
+	key_count = p_keys.size();
+	ERR_FAIL_COND(key_count == 0);
+
+	const TKey<TransformKey> *keys = p_keys.ptr();
+
+	constant = keys[0].value;
+	channels = 0;
+
+	AABB loc_bounds(constant.loc, Vector3());
+	AABB scale_bounds(constant.scale, Vector3());
+	bool default_transitions = true;
+
+	for (int i = 0; i < key_count; i++) {
+
+		const TransformKey &tk = keys[i].value;
+
+		if (tk.loc != constant.loc)
+			channels |= CHANNEL_LOC;
+		if (!Math::is_equal_approx(tk.rot.x, constant.rot.x) || !Math::is_equal_approx(tk.rot.y, constant.rot.y) || !Math::is_equal_approx(tk.rot.z, constant.rot.z) || !Math::is_equal_approx(tk.rot.w, constant.rot.w))
+			channels |= CHANNEL_ROT;
+		if (tk.scale != constant.scale)
+			channels |= CHANNEL_SCALE;
+
+		loc_bounds.expand_to(tk.loc);
+		scale_bounds.expand_to(tk.scale);
+
+		if (keys[i].transition != 1.0)
+			default_transitions = false;
+	}
+
+	loc_min = loc_bounds.position;
+	loc_step = loc_bounds.size / 0xFFFF;
+	scale_min = scale_bounds.position;
+	scale_step = scale_bounds.size / 0xFFFF;
+
+	stride = 1;
+	if (channels & CHANNEL_LOC)
+		stride += 3;
+	if (channels & CHANNEL_ROT)
+		stride += 3;
+	if (channels & CHANNEL_SCALE)
+		stride += 3;
+
+	int page_count = (key_count + PAGE_SIZE - 1) / PAGE_SIZE;
+	page_times.resize(page_count + 1);
+	for (int i = 0; i < page_count; i++)
+		page_times.write[i] = keys[i * PAGE_SIZE].time;
+	page_times.write[page_count] = keys[key_count - 1].time;
+
+	data.resize(key_count * stride);
+	uint16_t *w = data.ptrw();
+
+	for (int i = 0; i < key_count; i++) {
+
+		const TransformKey &tk = keys[i].value;
+		int page = i / PAGE_SIZE;
+		float page_len = page_times[page + 1] - page_times[page];
+
+		*w++ = page_len > 0 ? _quantize_unit((keys[i].time - page_times[page]) / page_len, 0xFFFF) : 0;
+
+		if (channels & CHANNEL_LOC) {
+			_encode_vector3(tk.loc, loc_min, loc_step, w);
+			w += 3;
+		}
+		if (channels & CHANNEL_ROT) {
+			_encode_quat(tk.rot, w);
+			w += 3;
+		}
+		if (channels & CHANNEL_SCALE) {
+			_encode_vector3(tk.scale, scale_min, scale_step, w);
+			w += 3;
+		}
+	}
+
+	transitions.clear();
+	if (!default_transitions) {
+		transitions.resize(key_count);
+		for (int i = 0; i < key_count; i++)
+			transitions.write[i] = keys[i].transition;
+	}
+}
+
+void Animation::CompressedTransforms::decompress(Vector<TKey<TransformKey> > &r_keys) const {
+
+	r_keys.resize(key_count);
+
+	for (int i = 0; i < key_count; i++) {
+
+		TKey<TransformKey> &tk = r_keys.write[i];
+		tk.time = get_time(i);
+		tk.transition = get_transition(i);
+		tk.value = get_value(i);
+	}
+}
+
+Dictionary Animation::CompressedTransforms::serialize() const {
+
+	Dictionary d;
+	d["count"] = key_count;
+	d["channels"] = channels;
+
+	Array constants;
+	constants.push_back(constant.loc);
+	constants.push_back(constant.rot);
+	constants.push_back(constant.scale);
+	d["constant"] = constants;
+
+	Array bounds;
+	bounds.push_back(loc_min);
+	bounds.push_back(loc_step);
+	bounds.push_back(scale_min);
+	bounds.push_back(scale_step);
+	d["bounds"] = bounds;
+
+	PoolVector<float> times;
+	times.resize(page_times.size());
+	{
+		PoolVector<float>::Write w = times.write();
+		for (int i = 0; i < page_times.size(); i++)
+			w[i] = page_times[i];
+	}
+	d["pages"] = times;
+
+	PoolVector<uint8_t> bytes;
+	bytes.resize(data.size() * 2);
+	{
+		PoolVector<uint8_t>::Write w = bytes.write();
+		for (int i = 0; i < data.size(); i++)
+			encode_uint16(data[i], &w[i * 2]);
+	}
+	d["data"] = bytes;
+
+	PoolVector<float> trans;
+	trans.resize(transitions.size());
+	{
+		PoolVector<float>::Write w = trans.write();
+		for (int i = 0; i < transitions.size(); i++)
+			w[i] = transitions[i];
+	}
+	d["transitions"] = trans;
+
+	return d;
+}
+
+bool Animation::CompressedTransforms::deserialize(const Dictionary &p_data) {
+
+	ERR_FAIL_COND_V(!p_data.has("count") || !p_data.has("channels") || !p_data.has("data"), false);
+
+	key_count = p_data["count"];
+	channels = p_data["channels"];
+	ERR_FAIL_COND_V(key_count <= 0, false);
+
+	Array constants = p_data["constant"];
+	ERR_FAIL_COND_V(constants.size() != 3, false);
+	constant.loc = constants[0];
+	constant.rot = constants[1];
+	constant.scale = constants[2];
+
+	Array bounds = p_data["bounds"];
+	ERR_FAIL_COND_V(bounds.size() != 4, false);
+	loc_min = bounds[0];
+	loc_step = bounds[1];
+	scale_min = bounds[2];
+	scale_step = bounds[3];
+
+	stride = 1;
+	if (channels & CHANNEL_LOC)
+		stride += 3;
+	if (channels & CHANNEL_ROT)
+		stride += 3;
+	if (channels & CHANNEL_SCALE)
+		stride += 3;
+
+	PoolVector<float> times = p_data["pages"];
+	ERR_FAIL_COND_V(times.size() != (key_count + PAGE_SIZE - 1) / PAGE_SIZE + 1, false);
+	page_times.resize(times.size());
+	{
+		PoolVector<float>::Read r = times.read();
+		for (int i = 0; i < times.size(); i++)
+			page_times.write[i] = r[i];
+	}
+
+	PoolVector<uint8_t> bytes = p_data["data"];
+	ERR_FAIL_COND_V(bytes.size() != key_count * stride * 2, false);
+	data.resize(key_count * stride);
+	{
+		PoolVector<uint8_t>::Read r = bytes.read();
+		for (int i = 0; i < data.size(); i++)
+			data.write[i] = decode_uint16(&r[i * 2]);
+	}
+
+	PoolVector<float> trans = p_data["transitions"];
+	ERR_FAIL_COND_V(trans.size() != 0 && trans.size() != key_count, false);
+	transitions.resize(trans.size());
+	{
+		PoolVector<float>::Read r = trans.read();
+		for (int i = 0; i < trans.size(); i++)
+			transitions.write[i] = r[i];
+	}
+
+	return true;
+}
+
 Animation::Animation() {
 
 	step = 0.1;
@@ -103,13 +103,65 @@ private:
 		Vector3 scale;
 	};
 
+	/* COMPRESSED TRANSFORM KEYS */
+
+	// Read-only key storage produced by compress(). Every key is a fixed size record of 16 bit values: the time
+	// relative to its page, then location and scale quantized against the track bounds and the rotation as the
+	// three smallest quaternion components. Channels that never change are stored once in 'constant'.
+	struct CompressedTransforms {
+
+		enum {
+			PAGE_SIZE = 64, // keys per page, each page has its own time range
+			CHANNEL_LOC = 1,
+			CHANNEL_ROT = 2,
+			CHANNEL_SCALE = 4,
+		};
+
+		int key_count;
+		uint32_t channels;
+		int stride;
+		TransformKey constant;
+		Vector3 loc_min;
+		Vector3 loc_step;
+		Vector3 scale_min;
+		Vector3 scale_step;
+		Vector<float> page_times; // start time of each page, followed by the time of the last key
+		Vector<uint16_t> data;
+		Vector<float> transitions; // empty if all keys use a transition of 1
+
+		_FORCE_INLINE_ int size() const { return key_count; }
+		_FORCE_INLINE_ float get_transition(int p_idx) const { return transitions.empty() ? 1.0 : transitions[p_idx]; }
+		float get_time(int p_idx) const;
+		TransformKey get_value(int p_idx) const;
+
+		void compress(const Vector<TKey<TransformKey> > &p_keys);
+		void decompress(Vector<TKey<TransformKey> > &r_keys) const;
+
+		Dictionary serialize() const;
+		bool deserialize(const Dictionary &p_data);
+
+		CompressedTransforms() {
+			key_count = 0;
+			channels = 0;
+			stride = 1;
+		}
+	};
+
 	/* TRANSFORM TRACK */
 
 	struct TransformTrack : public Track {
 
 		Vector<TKey<TransformKey> > transforms;
+		CompressedTransforms *compressed; // when set, 'transforms' is empty
 
-		TransformTrack() { type = TYPE_TRANSFORM; }
+		TransformTrack() {
+			type = TYPE_TRANSFORM;
+			compressed = NULL;
+		}
+		~TransformTrack() {
+			if (compressed)
+				memdelete(compressed);
+		}
 	};
 
 	/* PROPERTY VALUE TRACK */
@@ -202,7 +254,19 @@ private:
 	int _insert(float p_time, T &p_keys, const V &p_value);
 
 	template <class K>
-	inline int _find(const Vector<K> &p_keys, float p_time) const;
+	inline int _find(const Vector<K> &p_keys, float p_time, int p_hint = -1) const;
+	inline int _find(const CompressedTransforms &p_keys, float p_time, int p_hint = -1) const;
+
+	template <class K>
+	_FORCE_INLINE_ static float _key_time(const Vector<K> &p_keys, int p_idx) { return p_keys[p_idx].time; }
+	template <class K>
+	_FORCE_INLINE_ static float _key_transition(const Vector<K> &p_keys, int p_idx) { return p_keys[p_idx].transition; }
+	template <class T>
+	_FORCE_INLINE_ static const T &_key_value(const Vector<TKey<T> > &p_keys, int p_idx) { return p_keys[p_idx].value; }
+
+	_FORCE_INLINE_ static float _key_time(const CompressedTransforms &p_keys, int p_idx) { return p_keys.get_time(p_idx); }
+	_FORCE_INLINE_ static float _key_transition(const CompressedTransforms &p_keys, int p_idx) { return p_keys.get_transition(p_idx); }
+	_FORCE_INLINE_ static TransformKey _key_value(const CompressedTransforms &p_keys, int p_idx) { return p_keys.get_value(p_idx); }
 
 	_FORCE_INLINE_ Animation::TransformKey _interpolate(const Animation::TransformKey &p_a, const Animation::TransformKey &p_b, float p_c) const;
 
@@ -217,11 +281,11 @@ private:
 	_FORCE_INLINE_ Variant _cubic_interpolate(const Variant &p_pre_a, const Variant &p_a, const Variant &p_b, const Variant &p_post_b, float p_c) const;
 	_FORCE_INLINE_ float _cubic_interpolate(const float &p_pre_a, const float &p_a, const float &p_b, const float &p_post_b, float p_c) const;
 
-	template <class T>
-	_FORCE_INLINE_ T _interpolate(const Vector<TKey<T> > &p_keys, float p_time, InterpolationType p_interp, bool p_loop_wrap, bool *p_ok) const;
+	template <class T, class K>
+	_FORCE_INLINE_ T _interpolate(const K &p_keys, float p_time, InterpolationType p_interp, bool p_loop_wrap, bool *p_ok, int *p_cursor = NULL) const;
 
-	template <class T>
-	_FORCE_INLINE_ void _track_get_key_indices_in_range(const Vector<T> &p_array, float from_time, float to_time, List<int> *p_indices) const;
+	template <class K>
+	_FORCE_INLINE_ void _track_get_key_indices_in_range(const K &p_array, float from_time, float to_time, List<int> *p_indices) const;
 
 	_FORCE_INLINE_ void _value_track_get_key_indices_in_range(const ValueTrack *vt, float from_time, float to_time, List<int> *p_indices) const;
 	_FORCE_INLINE_ void _method_track_get_key_indices_in_range(const MethodTrack *mt, float from_time, float to_time, List<int> *p_indices) const;
@@ -271,6 +335,7 @@ private:
 
 	bool _transform_track_optimize_key(const TKey<TransformKey> &t0, const TKey<TransformKey> &t1, const TKey<TransformKey> &t2, float p_alowed_linear_err, float p_alowed_angular_err, float p_max_optimizable_angle, const Vector3 &p_norm);
 	void _transform_track_optimize(int p_idx, float p_allowed_linear_err = 0.05, float p_allowed_angular_err = 0.01, float p_max_optimizable_angle = Math_PI * 0.125);
+	void _transform_track_decompress(TransformTrack *p_track);
 
 protected:
 	bool _set(const StringName &p_name, const Variant &p_value);
@@ -344,7 +409,7 @@ public:
 	void track_set_interpolation_loop_wrap(int p_track, bool p_enable);
 	bool track_get_interpolation_loop_wrap(int p_track) const;
 
-	Error transform_track_interpolate(int p_track, float p_time, Vector3 *r_loc, Quat *r_rot, Vector3 *r_scale) const;
+	Error transform_track_interpolate(int p_track, float p_time, Vector3 *r_loc, Quat *r_rot, Vector3 *r_scale, int *r_cursor = NULL) const;
 
 	Variant value_track_interpolate(int p_track, float p_time) const;
 	void value_track_get_key_indices(int p_track, float p_time, float p_delta, List<int> *p_indices) const;
@@ -371,6 +436,8 @@ public:
 	void clear();
 
 	void optimize(float p_allowed_linear_err = 0.05, float p_allowed_angular_err = 0.01, float p_max_optimizable_angle = Math_PI * 0.125);
+	void compress();
+	bool track_is_compressed(int p_track) const;
 
 	Animation();
 	~Animation();
@@ -35,7 +35,6 @@
 void AudioStreamPlaybackSample::start(float p_from_pos) {
 
 	if (base->format == AudioStreamSample::FORMAT_IMA_ADPCM) {
-		//no seeking in IMA_ADPCM
 		for (int i = 0; i < 2; i++) {
 			ima_adpcm[i].step_index = 0;
 			ima_adpcm[i].predictor = 0;
@@ -45,12 +44,10 @@ void AudioStreamPlaybackSample::start(float p_from_pos) {
 			ima_adpcm[i].loop_pos = 0x7FFFFFFF;
 			ima_adpcm[i].window_ofs = 0;
 		}
-
-		offset = 0;
-	} else {
-		seek(p_from_pos);
 	}
 
+	seek(p_from_pos);
+
 	sign = 1;
 	active = true;
 }
@@ -74,10 +71,29 @@ float AudioStreamPlaybackSample::get_playback_position() const {
 
 	return float(offset >> MIX_FRAC_BITS) / base->mix_rate;
 }
-void AudioStreamPlaybackSample::seek(float p_time) {
+// The IMA-ADPCM decoder only runs forward, mix() decodes up to the offset on its own.
+// Going back, it restarts from the loop point if it was decoded already, else from the beginning.
+void AudioStreamPlaybackSample::_ima_adpcm_rewind(int64_t p_frame) {
 
-	if (base->format == AudioStreamSample::FORMAT_IMA_ADPCM)
-		return; //no seeking in ima-adpcm
+	if (p_frame >= ima_adpcm[0].last_nibble)
+		return;
+
+	bool from_loop = base->loop_mode != AudioStreamSample::LOOP_DISABLED && ima_adpcm[0].loop_pos <= p_frame && ima_adpcm[0].last_nibble >= ima_adpcm[0].loop_pos;
+
+	for (int i = 0; i < 2; i++) {
+		if (from_loop) {
+			ima_adpcm[i].step_index = ima_adpcm[i].loop_step_index;
+			ima_adpcm[i].predictor = ima_adpcm[i].loop_predictor;
+			ima_adpcm[i].last_nibble = ima_adpcm[i].loop_pos;
+		} else {
+			ima_adpcm[i].step_index = 0;
+			ima_adpcm[i].predictor = 0;
+			ima_adpcm[i].last_nibble = -1;
+		}
+	}
+}
+
+void AudioStreamPlaybackSample::seek(float p_time) {
 
 	float max = base->get_length();
 	if (p_time < 0) {
@@ -87,6 +103,40 @@ void AudioStreamPlaybackSample::seek(float p_time) {
 	}
 
 	offset = uint64_t(p_time * base->mix_rate) << MIX_FRAC_BITS;
+
+	if (base->format == AudioStreamSample::FORMAT_IMA_ADPCM) {
+		_ima_adpcm_rewind(offset >> MIX_FRAC_BITS);
+	}
+}
+
+void AudioStreamPlaybackSample::advance(float p_time) {
+
+	if (!active)
+		return;
+
+	int64_t len = int64_t(base->get_length() * base->mix_rate);
+	int64_t pos = (offset >> MIX_FRAC_BITS) + int64_t(p_time * base->mix_rate) * sign;
+
+	if (base->loop_mode == AudioStreamSample::LOOP_DISABLED || base->loop_end <= base->loop_begin) {
+		if (pos < 0 || pos >= len) {
+			active = false;
+			return;
+		}
+	} else {
+		//ping-pong is approximated as forward, position is all that matters while nothing is heard
+		int64_t loop_len = base->loop_end - base->loop_begin;
+		if (pos >= base->loop_end) {
+			pos = base->loop_begin + (pos - base->loop_begin) % loop_len;
+		} else if (pos < base->loop_begin && sign < 0) {
+			pos = base->loop_end - (base->loop_begin - pos) % loop_len;
+		}
+	}
+
+	if (base->format == AudioStreamSample::FORMAT_IMA_ADPCM) {
+		_ima_adpcm_rewind(pos); // only wrapped loops go back, ahead is decoded on the next mix
+	}
+
+	offset = (pos << MIX_FRAC_BITS) | (offset & MIX_FRAC_MASK);
 }
 
 template <class Depth, bool is_stereo, bool is_ima_adpcm>
@@ -64,6 +64,7 @@ class AudioStreamPlaybackSample : public AudioStreamPlayback {
 
 	template <class Depth, bool is_stereo, bool is_ima_adpcm>
 	void do_resample(const Depth *p_src, AudioFrame *p_dst, int64_t &offset, int32_t &increment, uint32_t amount, IMA_ADPCM_State *ima_adpcm);
+	void _ima_adpcm_rewind(int64_t p_frame);
 
 public:
 	virtual void start(float p_from_pos = 0.0);
@@ -74,6 +75,7 @@ public:
 
 	virtual float get_playback_position() const;
 	virtual void seek(float p_time);
+	virtual void advance(float p_time);
 
 	virtual void mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames);
 
@@ -793,13 +793,24 @@ void SurfaceTool::append_from(const Ref<Mesh> &p_existing, int p_surface, const
 
 	if (vertex_array.size() == 0) {
 		primitive = p_existing->surface_get_primitive_type(p_surface);
+	}
+
+	Array arr = p_existing->surface_get_arrays(p_surface);
+	ERR_FAIL_COND(arr.size() != VS::ARRAY_MAX);
+	append_from_arrays(arr, p_xform);
+}
+
+// Does not touch any server, so it can be used from threads with arrays fetched beforehand.
+void SurfaceTool::append_from_arrays(const Array &p_arrays, const Transform &p_xform) {
+
+	if (vertex_array.size() == 0) {
 		format = 0;
 	}
 
-	int nformat;
+	int nformat = 0;
 	List<Vertex> nvertices;
 	List<int> nindices;
-	_create_list(p_existing, p_surface, &nvertices, &nindices, nformat);
+	_create_list_from_arrays(p_arrays, &nvertices, &nindices, nformat);
 	format |= nformat;
 	int vfrom = vertex_array.size();
 
@@ -1045,6 +1056,116 @@ void SurfaceTool::generate_normals(bool p_flip) {
 	}
 }
 
+void SurfaceTool::simplify(float p_cell_size) {
+
+	ERR_FAIL_COND(primitive != Mesh::PRIMITIVE_TRIANGLES);
+	ERR_FAIL_COND(p_cell_size <= 0);
+
+	bool was_indexed = index_array.size();
+
+	index();
+
+	if (vertex_array.empty())
+		return;
+
+	Vector<Vertex> varr;
+	varr.resize(vertex_array.size());
+	AABB aabb;
+	{
+		int idx = 0;
+		for (List<Vertex>::Element *E = vertex_array.front(); E; E = E->next()) {
+			if (idx == 0)
+				aabb.position = E->get().vertex;
+			else
+				aabb.expand_to(E->get().vertex);
+			varr.write[idx++] = E->get();
+		}
+	}
+
+	// Vertex clustering: every vertex in the same grid cell collapses into the cell average.
+	// Vertices facing different ways are kept apart, so the two sides of thin walls don't merge.
+
+	HashMap<uint64_t, int> cluster_map;
+	Vector<int> remap;
+	remap.resize(varr.size());
+	Vector<Vertex> clusters;
+	Vector<int> cluster_sizes;
+
+	const uint64_t cell_mask = (1 << 20) - 1;
+
+	for (int i = 0; i < varr.size(); i++) {
+
+		const Vertex &v = varr[i];
+		Vector3 cell = ((v.vertex - aabb.position) / p_cell_size).floor();
+
+		uint64_t key = (uint64_t(cell.x) & cell_mask) | ((uint64_t(cell.y) & cell_mask) << 20) | ((uint64_t(cell.z) & cell_mask) << 40);
+		if (format & Mesh::ARRAY_FORMAT_NORMAL) {
+			int axis = v.normal.abs().max_axis();
+			key |= uint64_t(axis * 2 + (v.normal[axis] < 0 ? 1 : 0)) << 60;
+		}
+
+		int *cluster = cluster_map.getptr(key);
+		if (!cluster) {
+			remap.write[i] = clusters.size();
+			cluster_map[key] = clusters.size();
+			clusters.push_back(v);
+			cluster_sizes.push_back(1);
+		} else {
+			remap.write[i] = *cluster;
+			Vertex &c = clusters.write[*cluster];
+			c.vertex += v.vertex;
+			c.normal += v.normal;
+			c.binormal += v.binormal;
+			c.tangent += v.tangent;
+			c.uv += v.uv;
+			c.uv2 += v.uv2;
+			c.color = c.color + v.color;
+			cluster_sizes.write[*cluster]++;
+		}
+	}
+
+	vertex_array.clear();
+	for (int i = 0; i < clusters.size(); i++) {
+
+		Vertex &c = clusters.write[i];
+		float inv = 1.0 / cluster_sizes[i];
+		c.vertex *= inv;
+		c.uv *= inv;
+		c.uv2 *= inv;
+		c.color = c.color * inv;
+		c.normal = c.normal.normalized();
+		c.binormal = c.binormal.normalized();
+		c.tangent = c.tangent.normalized();
+		// bones and weights are kept from the first vertex of the cluster
+		vertex_array.push_back(c);
+	}
+
+	List<int> new_indices;
+	for (List<int>::Element *E = index_array.front(); E;) {
+
+		int a = remap[E->get()];
+		E = E->next();
+		ERR_FAIL_COND(!E);
+		int b = remap[E->get()];
+		E = E->next();
+		ERR_FAIL_COND(!E);
+		int c = remap[E->get()];
+		E = E->next();
+
+		if (a == b || b == c || c == a)
+			continue; // collapsed
+
+		new_indices.push_back(a);
+		new_indices.push_back(b);
+		new_indices.push_back(c);
+	}
+	index_array = new_indices;
+
+	if (!was_indexed) {
+		deindex();
+	}
+}
+
 void SurfaceTool::set_material(const Ref<Material> &p_material) {
 
 	material = p_material;
@@ -1085,6 +1206,7 @@ void SurfaceTool::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("deindex"), &SurfaceTool::deindex);
 	ClassDB::bind_method(D_METHOD("generate_normals", "flip"), &SurfaceTool::generate_normals, DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("generate_tangents"), &SurfaceTool::generate_tangents);
+	ClassDB::bind_method(D_METHOD("simplify", "cell_size"), &SurfaceTool::simplify);
 
 	ClassDB::bind_method(D_METHOD("set_material", "material"), &SurfaceTool::set_material);
 
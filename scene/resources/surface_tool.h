@@ -125,6 +125,7 @@ public:
 	void deindex();
 	void generate_normals(bool p_flip = false);
 	void generate_tangents();
+	void simplify(float p_cell_size);
 
 	void set_material(const Ref<Material> &p_material);
 
@@ -138,6 +139,7 @@ public:
 	void create_from(const Ref<Mesh> &p_existing, int p_surface);
 	void create_from_blend_shape(const Ref<Mesh> &p_existing, int p_surface, const String &p_blend_shape_name);
 	void append_from(const Ref<Mesh> &p_existing, int p_surface, const Transform &p_xform);
+	void append_from_arrays(const Array &p_arrays, const Transform &p_xform);
 	Ref<ArrayMesh> commit(const Ref<ArrayMesh> &p_existing = Ref<ArrayMesh>(), uint32_t p_flags = Mesh::ARRAY_COMPRESS_DEFAULT);
 
 	SurfaceTool();
@@ -0,0 +1,214 @@
+/*************************************************************************/
+/*  audio_decode_pool.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "audio_decode_pool.h"
+
+#include "core/os/memory.h"
+#include "core/os/os.h"
+#include "core/safe_refcount.h"
+
+AudioDecodePool *AudioDecodePool::singleton = NULL;
+
+AudioDecodePool::Client *AudioDecodePool::_take_request() {
+
+	//mutex must be held, starts after the last client taken so every stream gets its turn
+	int count = clients.size();
+	for (int i = 0; i < count; i++) {
+
+		int idx = (next_client + i) % count;
+		Client *client = clients[idx];
+		if (client->running)
+			continue;
+
+		uint32_t requests = client->requests;
+		if (requests == 0)
+			continue;
+
+		// requests raised from now on are seen by the rescan after this one is done
+		atomic_sub(&client->requests, requests);
+		client->running = true;
+		next_client = idx + 1;
+		return client;
+	}
+
+	return NULL;
+}
+
+void AudioDecodePool::_thread_function(void *p_user) {
+
+	AudioDecodePool *pool = (AudioDecodePool *)p_user;
+
+	while (true) {
+		pool->semaphore->wait();
+		if (pool->exit_threads)
+			break;
+
+		// a request made while its client was busy does not wake anyone, so keep
+		// taking requests until there are none left before waiting again
+		while (true) {
+
+			pool->mutex->lock();
+			Client *client = pool->_take_request();
+			pool->mutex->unlock();
+
+			if (!client)
+				break;
+
+			client->decode_ahead();
+
+			pool->mutex->lock();
+			client->running = false;
+			pool->mutex->unlock();
+		}
+	}
+}
+
+int AudioDecodePool::get_thread_count() const {
+
+	return thread_count;
+}
+
+void AudioDecodePool::add_client(Client *p_client) {
+
+	if (thread_count == 0)
+		return;
+
+	mutex->lock();
+	if (clients.find(p_client) == -1) {
+		clients.push_back(p_client);
+	}
+	mutex->unlock();
+}
+
+void AudioDecodePool::remove_client(Client *p_client) {
+
+	if (thread_count == 0)
+		return;
+
+	while (true) {
+
+		mutex->lock();
+		bool running = p_client->running;
+		if (!running) {
+			clients.erase(p_client);
+			p_client->requests = 0;
+		}
+		mutex->unlock();
+
+		if (!running)
+			break;
+
+		OS::get_singleton()->delay_usec(100);
+	}
+}
+
+void AudioDecodePool::request(Client *p_client) {
+
+	// called from the audio thread, must not lock or allocate
+	if (thread_count == 0)
+		return;
+
+	// only the first request wakes a worker, later ones are picked up with it
+	if (atomic_increment(&p_client->requests) == 1) {
+		semaphore->post();
+	}
+}
+
+void AudioDecodePool::init(int p_thread_count) {
+
+	ERR_FAIL_COND(threads != NULL);
+
+#ifdef NO_THREADS
+	thread_count = 0;
+#else
+	thread_count = MAX(p_thread_count, 0);
+#endif
+
+	if (thread_count == 0)
+		return;
+
+	exit_threads = false;
+	threads = memnew_arr(Thread *, thread_count);
+
+	for (int i = 0; i < thread_count; i++) {
+		threads[i] = Thread::create(&AudioDecodePool::_thread_function, this);
+	}
+}
+
+void AudioDecodePool::finish() {
+
+	if (threads == NULL)
+		return;
+
+	exit_threads = true;
+	for (int i = 0; i < thread_count; i++) {
+		semaphore->post();
+	}
+
+	for (int i = 0; i < thread_count; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	memdelete_arr(threads);
+	threads = NULL;
+	thread_count = 0;
+
+	mutex->lock();
+	for (int i = 0; i < clients.size(); i++) {
+		clients[i]->requests = 0;
+	}
+	clients.clear();
+	mutex->unlock();
+}
+
+AudioDecodePool *AudioDecodePool::get_singleton() {
+
+	return singleton;
+}
+
+AudioDecodePool::AudioDecodePool() {
+
+	singleton = this;
+	threads = NULL;
+	thread_count = 0;
+	exit_threads = false;
+	next_client = 0;
+	mutex = Mutex::create();
+	semaphore = Semaphore::create();
+}
+
+AudioDecodePool::~AudioDecodePool() {
+
+	finish();
+	memdelete(mutex);
+	memdelete(semaphore);
+	singleton = NULL;
+}
@@ -0,0 +1,97 @@
+/*************************************************************************/
+/*  audio_decode_pool.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef AUDIO_DECODE_POOL_H
+#define AUDIO_DECODE_POOL_H
+
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/vector.h"
+
+/**
+	Worker threads shared by all streams that decode ahead of the mix.
+	A stream is added once, outside the audio thread. When its buffer runs
+	low the audio thread requests a refill, and a worker calls decode_ahead()
+	on it. A request only raises a counter on the client and wakes a worker,
+	so the audio thread never locks or allocates. remove_client() waits until
+	no worker is using the client anymore.
+*/
+
+class AudioDecodePool {
+public:
+	class Client {
+
+		friend class AudioDecodePool;
+		volatile uint32_t requests; // raised by the audio thread, taken by a worker
+		bool running; // guarded by the pool mutex
+
+	public:
+		virtual void decode_ahead() = 0; // called from a worker thread
+
+		Client() {
+			requests = 0;
+			running = false;
+		}
+		virtual ~Client() {}
+	};
+
+private:
+	Thread **threads;
+	int thread_count;
+	bool exit_threads;
+
+	Vector<Client *> clients;
+	int next_client;
+	Mutex *mutex; // workers, add_client() and remove_client() only
+	Semaphore *semaphore;
+
+	static AudioDecodePool *singleton;
+
+	Client *_take_request();
+	static void _thread_function(void *p_user);
+
+public:
+	int get_thread_count() const;
+
+	void add_client(Client *p_client);
+	void remove_client(Client *p_client);
+	void request(Client *p_client);
+
+	void init(int p_thread_count);
+	void finish();
+
+	static AudioDecodePool *get_singleton();
+
+	AudioDecodePool();
+	~AudioDecodePool();
+};
+
+#endif // AUDIO_DECODE_POOL_H
@@ -31,6 +31,7 @@
 #include "audio_rb_resampler.h"
 #include "core/math/math_funcs.h"
 #include "core/os/os.h"
+#include "servers/audio/audio_simd.h"
 #include "servers/audio_server.h"
 
 int AudioRBResampler::get_channel_count() const {
@@ -49,6 +50,30 @@ uint32_t AudioRBResampler::_resample(AudioFrame *p_dest, int p_todo, int32_t p_i
 
 	uint32_t read = offset & MIX_FRAC_MASK;
 
+	if (C == 2) {
+		// stereo, interpolate two frames at a time (see audio_simd.h)
+		const uint32_t offset_mask = (1 << (rb_bits + MIX_FRAC_BITS)) - 1;
+
+		for (; p_todo > 1; p_todo -= 2) {
+
+			uint32_t offset_a = (offset + p_increment) & offset_mask;
+			uint32_t offset_b = (offset_a + p_increment) & offset_mask;
+			offset = offset_b;
+			read += p_increment * 2;
+
+			uint32_t pos_a = offset_a >> MIX_FRAC_BITS;
+			uint32_t pos_b = offset_b >> MIX_FRAC_BITS;
+			ERR_FAIL_COND_V(pos_a >= rb_len || pos_b >= rb_len, 0);
+
+			AudioVec4 frac = AudioVec4::pairs(float(offset_a & MIX_FRAC_MASK) / float(MIX_FRAC_LEN), float(offset_b & MIX_FRAC_MASK) / float(MIX_FRAC_LEN));
+			AudioVec4 v = AudioVec4::load2(&rb[pos_a << 1], &rb[pos_b << 1]);
+			AudioVec4 vn = AudioVec4::load2(&rb[((pos_a + 1) & rb_mask) << 1], &rb[((pos_b + 1) & rb_mask) << 1]);
+
+			(v + (vn - v) * frac).store((float *)p_dest);
+			p_dest += 2;
+		}
+	}
+
 	for (int i = 0; i < p_todo; i++) {
 
 		offset = (offset + p_increment) & (((1 << (rb_bits + MIX_FRAC_BITS)) - 1));
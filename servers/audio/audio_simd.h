@@ -0,0 +1,165 @@
+/*************************************************************************/
+/*  audio_simd.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef AUDIO_SIMD_H
+#define AUDIO_SIMD_H
+
+#include "core/typedefs.h"
+
+// Four floats processed together: two stereo AudioFrames, or four
+// independent filters. Uses SSE or NEON when the compiler targets them,
+// plain floats otherwise. Define NO_AUDIO_SIMD to force the scalar version.
+
+#if !defined(NO_AUDIO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define AUDIO_SIMD_SSE
+#include <xmmintrin.h>
+#elif !defined(NO_AUDIO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define AUDIO_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// Smallest magnitude kept by undenormalise(), 2^-111, same as the scalar undenormalise().
+#define AUDIO_SIMD_DENORMAL_LIMIT 3.85185988877447170611e-34f
+
+struct AudioVec4 {
+
+#if defined(AUDIO_SIMD_SSE)
+
+	__m128 v;
+
+	static _ALWAYS_INLINE_ AudioVec4 make(__m128 p_v) {
+		AudioVec4 r;
+		r.v = p_v;
+		return r;
+	}
+
+	static _ALWAYS_INLINE_ AudioVec4 zero() { return make(_mm_setzero_ps()); }
+	static _ALWAYS_INLINE_ AudioVec4 splat(float p_value) { return make(_mm_set1_ps(p_value)); }
+	static _ALWAYS_INLINE_ AudioVec4 pairs(float p_lo, float p_hi) { return make(_mm_set_ps(p_hi, p_hi, p_lo, p_lo)); }
+	static _ALWAYS_INLINE_ AudioVec4 set(float p_a, float p_b, float p_c, float p_d) { return make(_mm_set_ps(p_d, p_c, p_b, p_a)); }
+	static _ALWAYS_INLINE_ AudioVec4 load(const float *p_src) { return make(_mm_loadu_ps(p_src)); }
+	static _ALWAYS_INLINE_ AudioVec4 load2(const float *p_lo, const float *p_hi) {
+		return make(_mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)p_lo), (const __m64 *)p_hi));
+	}
+	_ALWAYS_INLINE_ void store(float *p_dst) const { _mm_storeu_ps(p_dst, v); }
+
+	_ALWAYS_INLINE_ AudioVec4 operator+(const AudioVec4 &p_v) const { return make(_mm_add_ps(v, p_v.v)); }
+	_ALWAYS_INLINE_ AudioVec4 operator-(const AudioVec4 &p_v) const { return make(_mm_sub_ps(v, p_v.v)); }
+	_ALWAYS_INLINE_ AudioVec4 operator*(const AudioVec4 &p_v) const { return make(_mm_mul_ps(v, p_v.v)); }
+
+	_ALWAYS_INLINE_ AudioVec4 undenormalise() const {
+		__m128 keep = _mm_cmpge_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), v), _mm_set1_ps(AUDIO_SIMD_DENORMAL_LIMIT));
+		return make(_mm_and_ps(v, keep));
+	}
+
+	_ALWAYS_INLINE_ float sum() const {
+		__m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+		s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+		return _mm_cvtss_f32(s);
+	}
+
+#elif defined(AUDIO_SIMD_NEON)
+
+	float32x4_t v;
+
+	static _ALWAYS_INLINE_ AudioVec4 make(float32x4_t p_v) {
+		AudioVec4 r;
+		r.v = p_v;
+		return r;
+	}
+
+	static _ALWAYS_INLINE_ AudioVec4 zero() { return make(vdupq_n_f32(0)); }
+	static _ALWAYS_INLINE_ AudioVec4 splat(float p_value) { return make(vdupq_n_f32(p_value)); }
+	static _ALWAYS_INLINE_ AudioVec4 pairs(float p_lo, float p_hi) { return make(vcombine_f32(vdup_n_f32(p_lo), vdup_n_f32(p_hi))); }
+	static _ALWAYS_INLINE_ AudioVec4 set(float p_a, float p_b, float p_c, float p_d) {
+		const float values[4] = { p_a, p_b, p_c, p_d };
+		return make(vld1q_f32(values));
+	}
+	static _ALWAYS_INLINE_ AudioVec4 load(const float *p_src) { return make(vld1q_f32(p_src)); }
+	static _ALWAYS_INLINE_ AudioVec4 load2(const float *p_lo, const float *p_hi) { return make(vcombine_f32(vld1_f32(p_lo), vld1_f32(p_hi))); }
+	_ALWAYS_INLINE_ void store(float *p_dst) const { vst1q_f32(p_dst, v); }
+
+	_ALWAYS_INLINE_ AudioVec4 operator+(const AudioVec4 &p_v) const { return make(vaddq_f32(v, p_v.v)); }
+	_ALWAYS_INLINE_ AudioVec4 operator-(const AudioVec4 &p_v) const { return make(vsubq_f32(v, p_v.v)); }
+	_ALWAYS_INLINE_ AudioVec4 operator*(const AudioVec4 &p_v) const { return make(vmulq_f32(v, p_v.v)); }
+
+	_ALWAYS_INLINE_ AudioVec4 undenormalise() const {
+		uint32x4_t keep = vcgeq_f32(vabsq_f32(v), vdupq_n_f32(AUDIO_SIMD_DENORMAL_LIMIT));
+		return make(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), keep)));
+	}
+
+	_ALWAYS_INLINE_ float sum() const {
+		float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+		return vget_lane_f32(vpadd_f32(s, s), 0);
+	}
+
+#else
+
+	float v[4];
+
+	static _ALWAYS_INLINE_ AudioVec4 make(float p_a, float p_b, float p_c, float p_d) {
+		AudioVec4 r;
+		r.v[0] = p_a;
+		r.v[1] = p_b;
+		r.v[2] = p_c;
+		r.v[3] = p_d;
+		return r;
+	}
+
+	static _ALWAYS_INLINE_ AudioVec4 zero() { return make(0, 0, 0, 0); }
+	static _ALWAYS_INLINE_ AudioVec4 splat(float p_value) { return make(p_value, p_value, p_value, p_value); }
+	static _ALWAYS_INLINE_ AudioVec4 pairs(float p_lo, float p_hi) { return make(p_lo, p_lo, p_hi, p_hi); }
+	static _ALWAYS_INLINE_ AudioVec4 set(float p_a, float p_b, float p_c, float p_d) { return make(p_a, p_b, p_c, p_d); }
+	static _ALWAYS_INLINE_ AudioVec4 load(const float *p_src) { return make(p_src[0], p_src[1], p_src[2], p_src[3]); }
+	static _ALWAYS_INLINE_ AudioVec4 load2(const float *p_lo, const float *p_hi) { return make(p_lo[0], p_lo[1], p_hi[0], p_hi[1]); }
+	_ALWAYS_INLINE_ void store(float *p_dst) const {
+		for (int i = 0; i < 4; i++) {
+			p_dst[i] = v[i];
+		}
+	}
+
+	_ALWAYS_INLINE_ AudioVec4 operator+(const AudioVec4 &p_v) const { return make(v[0] + p_v.v[0], v[1] + p_v.v[1], v[2] + p_v.v[2], v[3] + p_v.v[3]); }
+	_ALWAYS_INLINE_ AudioVec4 operator-(const AudioVec4 &p_v) const { return make(v[0] - p_v.v[0], v[1] - p_v.v[1], v[2] - p_v.v[2], v[3] - p_v.v[3]); }
+	_ALWAYS_INLINE_ AudioVec4 operator*(const AudioVec4 &p_v) const { return make(v[0] * p_v.v[0], v[1] * p_v.v[1], v[2] * p_v.v[2], v[3] * p_v.v[3]); }
+
+	_ALWAYS_INLINE_ AudioVec4 undenormalise() const {
+		AudioVec4 r;
+		for (int i = 0; i < 4; i++) {
+			r.v[i] = ABS(v[i]) < AUDIO_SIMD_DENORMAL_LIMIT ? 0 : v[i];
+		}
+		return r;
+	}
+
+	_ALWAYS_INLINE_ float sum() const { return (v[0] + v[2]) + (v[1] + v[3]); }
+
+#endif
+};
+
+#endif // AUDIO_SIMD_H
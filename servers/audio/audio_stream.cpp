@@ -31,6 +31,14 @@
 #include "audio_stream.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
+#include "servers/audio/audio_simd.h"
+
+//////////////////////////////
+
+void AudioStreamPlayback::advance(float p_time) {
+
+	seek(get_playback_position() + p_time);
+}
 
 //////////////////////////////
 
@@ -53,26 +61,56 @@ void AudioStreamPlaybackResampled::mix(AudioFrame *p_buffer, float p_rate_scale,
 
 	uint64_t mix_increment = uint64_t(((get_stream_sampling_rate() * p_rate_scale) / double(target_rate * global_rate_scale)) * double(FP_LEN));
 
-	for (int i = 0; i < p_frames; i++) {
+	int i = 0;
+	while (i < p_frames) {
 
 		uint32_t idx = CUBIC_INTERP_HISTORY + uint32_t(mix_offset >> FP_BITS);
+		uint64_t next_offset = mix_offset + mix_increment;
+
 		//standard cubic interpolation (great quality/performance ratio)
 		//this used to be moved to a LUT for greater performance, but nowadays CPU speed is generally faster than memory.
-		float mu = (mix_offset & FP_MASK) / float(FP_LEN);
-		AudioFrame y0 = internal_buffer[idx - 3];
-		AudioFrame y1 = internal_buffer[idx - 2];
-		AudioFrame y2 = internal_buffer[idx - 1];
-		AudioFrame y3 = internal_buffer[idx - 0];
+		if (i + 1 < p_frames && (next_offset >> FP_BITS) < INTERNAL_BUFFER_LEN) {
+
+			// the next frame also reads from this buffer, interpolate both together (see audio_simd.h)
+			uint32_t next_idx = CUBIC_INTERP_HISTORY + uint32_t(next_offset >> FP_BITS);
+			const float *buf = (const float *)internal_buffer;
+
+			AudioVec4 mu = AudioVec4::pairs((mix_offset & FP_MASK) / float(FP_LEN), (next_offset & FP_MASK) / float(FP_LEN));
+			AudioVec4 y0 = AudioVec4::load2(buf + (idx - 3) * 2, buf + (next_idx - 3) * 2);
+			AudioVec4 y1 = AudioVec4::load2(buf + (idx - 2) * 2, buf + (next_idx - 2) * 2);
+			AudioVec4 y2 = AudioVec4::load2(buf + (idx - 1) * 2, buf + (next_idx - 1) * 2);
+			AudioVec4 y3 = AudioVec4::load2(buf + (idx - 0) * 2, buf + (next_idx - 0) * 2);
+
+			AudioVec4 mu2 = mu * mu;
+			AudioVec4 a0 = y3 - y2 - y0 + y1;
+			AudioVec4 a1 = y0 - y1 - a0;
+			AudioVec4 a2 = y2 - y0;
+			AudioVec4 a3 = y1;
 
-		float mu2 = mu * mu;
-		AudioFrame a0 = y3 - y2 - y0 + y1;
-		AudioFrame a1 = y0 - y1 - a0;
-		AudioFrame a2 = y2 - y0;
-		AudioFrame a3 = y1;
+			(a0 * mu * mu2 + a1 * mu2 + a2 * mu + a3).store((float *)&p_buffer[i]);
 
-		p_buffer[i] = (a0 * mu * mu2 + a1 * mu2 + a2 * mu + a3);
+			mix_offset = next_offset + mix_increment;
+			i += 2;
 
-		mix_offset += mix_increment;
+		} else {
+
+			float mu = (mix_offset & FP_MASK) / float(FP_LEN);
+			AudioFrame y0 = internal_buffer[idx - 3];
+			AudioFrame y1 = internal_buffer[idx - 2];
+			AudioFrame y2 = internal_buffer[idx - 1];
+			AudioFrame y3 = internal_buffer[idx - 0];
+
+			float mu2 = mu * mu;
+			AudioFrame a0 = y3 - y2 - y0 + y1;
+			AudioFrame a1 = y0 - y1 - a0;
+			AudioFrame a2 = y2 - y0;
+			AudioFrame a3 = y1;
+
+			p_buffer[i] = (a0 * mu * mu2 + a1 * mu2 + a2 * mu + a3);
+
+			mix_offset = next_offset;
+			i++;
+		}
 
 		while ((mix_offset >> FP_BITS) >= INTERNAL_BUFFER_LEN) {
 
@@ -353,6 +391,12 @@ void AudioStreamPlaybackRandomPitch::seek(float p_time) {
 	}
 }
 
+void AudioStreamPlaybackRandomPitch::advance(float p_time) {
+	if (playing.is_valid()) {
+		playing->advance(p_time * pitch_scale);
+	}
+}
+
 void AudioStreamPlaybackRandomPitch::mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) {
 	if (playing.is_valid()) {
 		playing->mix(p_buffer, p_rate_scale * pitch_scale, p_frames);
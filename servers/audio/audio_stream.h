@@ -49,6 +49,7 @@ public:
 
 	virtual float get_playback_position() const = 0;
 	virtual void seek(float p_time) = 0;
+	virtual void advance(float p_time); //move forward without decoding, used by virtual voices
 
 	virtual void mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) = 0;
 };
@@ -197,6 +198,7 @@ public:
 
 	virtual float get_playback_position() const;
 	virtual void seek(float p_time);
+	virtual void advance(float p_time);
 
 	virtual void mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames);
 
@@ -29,36 +29,59 @@
 /*************************************************************************/
 
 #include "audio_effect_eq.h"
+#include "servers/audio/audio_simd.h"
 #include "servers/audio_server.h"
 
 void AudioEffectEQInstance::process(const AudioFrame *p_src_frames, AudioFrame *p_dst_frames, int p_frame_count) {
 
-	int band_count = bands[0].size();
-	EQ::BandProcess *proc_l = bands[0].ptrw();
-	EQ::BandProcess *proc_r = bands[1].ptrw();
-	float *bgain = gains.ptrw();
-	for (int i = 0; i < band_count; i++) {
-		bgain[i] = Math::db2linear(base->gain[i]);
+	int band_count = base->gain.size();
+	int block_count = blocks.size();
+	BandBlock *bb = blocks.ptrw();
+
+	for (int i = 0; i < block_count; i++) {
+		for (int j = 0; j < 4; j++) {
+			int band = i * 4 + j;
+			bb[i].gain[j] = band < band_count ? Math::db2linear(base->gain[band]) : 0.0;
+		}
 	}
 
 	for (int i = 0; i < p_frame_count; i++) {
 
 		AudioFrame src = p_src_frames[i];
-		AudioFrame dst = AudioFrame(0, 0);
-
-		for (int j = 0; j < band_count; j++) {
-
-			float l = src.l;
-			float r = src.r;
-
-			proc_l[j].process_one(l);
-			proc_r[j].process_one(r);
 
-			dst.l += l * bgain[j];
-			dst.r += r * bgain[j];
+		// a1 - a3 of the band filters
+		AudioVec4 diff_l = AudioVec4::splat(src.l - input_history[0][1]);
+		AudioVec4 diff_r = AudioVec4::splat(src.r - input_history[1][1]);
+		input_history[0][1] = input_history[0][0];
+		input_history[0][0] = src.l;
+		input_history[1][1] = input_history[1][0];
+		input_history[1][0] = src.r;
+
+		AudioVec4 dst_l = AudioVec4::zero();
+		AudioVec4 dst_r = AudioVec4::zero();
+
+		for (int j = 0; j < block_count; j++) {
+
+			BandBlock &b = bb[j];
+			AudioVec4 c1 = AudioVec4::load(b.c1);
+			AudioVec4 c2 = AudioVec4::load(b.c2);
+			AudioVec4 c3 = AudioVec4::load(b.c3);
+			AudioVec4 gain = AudioVec4::load(b.gain);
+
+			AudioVec4 b2 = AudioVec4::load(b.b2[0]);
+			AudioVec4 out = c1 * diff_l + c3 * b2 - c2 * AudioVec4::load(b.b3[0]);
+			b2.store(b.b3[0]);
+			out.store(b.b2[0]);
+			dst_l = dst_l + out * gain;
+
+			b2 = AudioVec4::load(b.b2[1]);
+			out = c1 * diff_r + c3 * b2 - c2 * AudioVec4::load(b.b3[1]);
+			b2.store(b.b3[1]);
+			out.store(b.b2[1]);
+			dst_r = dst_r + out * gain;
 		}
 
-		p_dst_frames[i] = dst;
+		p_dst_frames[i] = AudioFrame(dst_l.sum(), dst_r.sum());
 	}
 }
 
@@ -66,14 +89,30 @@ Ref<AudioEffectInstance> AudioEffectEQ::instance() {
 	Ref<AudioEffectEQInstance> ins;
 	ins.instance();
 	ins->base = Ref<AudioEffectEQ>(this);
-	ins->gains.resize(eq.get_band_count());
-	for (int i = 0; i < 2; i++) {
-		ins->bands[i].resize(eq.get_band_count());
-		for (int j = 0; j < ins->bands[i].size(); j++) {
-			ins->bands[i].write[j] = eq.get_band_processor(j);
+
+	int band_count = eq.get_band_count();
+	ins->blocks.resize((band_count + 3) / 4);
+	for (int i = 0; i < ins->blocks.size(); i++) {
+		AudioEffectEQInstance::BandBlock &b = ins->blocks.write[i];
+		for (int j = 0; j < 4; j++) {
+			int band = i * 4 + j;
+			b.c1[j] = b.c2[j] = b.c3[j] = 0;
+			if (band < band_count) {
+				eq.get_band_coefficients(band, b.c1[j], b.c2[j], b.c3[j]);
+			}
+			b.gain[j] = 0;
+			for (int k = 0; k < 2; k++) {
+				b.b2[k][j] = 0;
+				b.b3[k][j] = 0;
+			}
 		}
 	}
 
+	for (int i = 0; i < 2; i++) {
+		ins->input_history[i][0] = 0;
+		ins->input_history[i][1] = 0;
+	}
+
 	return ins;
 }
 
@@ -41,8 +41,16 @@ class AudioEffectEQInstance : public AudioEffectInstance {
 	friend class AudioEffectEQ;
 	Ref<AudioEffectEQ> base;
 
-	Vector<EQ::BandProcess> bands[2];
-	Vector<float> gains;
+	// Every band filters the same input, so bands run four at a time (see audio_simd.h).
+	// Same math as EQ::BandProcess, unused lanes have zero coefficients and gain.
+	struct BandBlock {
+		float c1[4], c2[4], c3[4];
+		float gain[4];
+		float b2[2][4], b3[2][4]; // output history, per channel
+	};
+
+	Vector<BandBlock> blocks;
+	float input_history[2][2]; // last two input samples per channel
 
 public:
 	virtual void process(const AudioFrame *p_src_frames, AudioFrame *p_dst_frames, int p_frame_count);
@@ -29,35 +29,54 @@
 /*************************************************************************/
 
 #include "audio_effect_filter.h"
+#include "servers/audio/audio_simd.h"
 #include "servers/audio_server.h"
 
 template <int S>
 void AudioEffectFilterInstance::_process_filter(const AudioFrame *p_src_frames, AudioFrame *p_dst_frames, int p_frame_count) {
 
-	for (int i = 0; i < p_frame_count; i++) {
-		float f = p_src_frames[i].l;
-		filter_process[0][0].process_one(f);
-		if (S > 1)
-			filter_process[0][1].process_one(f);
-		if (S > 2)
-			filter_process[0][2].process_one(f);
-		if (S > 3)
-			filter_process[0][3].process_one(f);
-
-		p_dst_frames[i].l = f;
+	AudioFilterSW::Coeffs coeffs;
+	filter.prepare_coefficients(&coeffs);
+
+	AudioVec4 b0 = AudioVec4::splat(coeffs.b0);
+	AudioVec4 b1 = AudioVec4::splat(coeffs.b1);
+	AudioVec4 b2 = AudioVec4::splat(coeffs.b2);
+	AudioVec4 a1 = AudioVec4::splat(coeffs.a1);
+	AudioVec4 a2 = AudioVec4::splat(coeffs.a2);
+
+	AudioVec4 ha1[S], ha2[S], hb1[S], hb2[S];
+	for (int j = 0; j < S; j++) {
+		ha1[j] = AudioVec4::load(history[j].ha1);
+		ha2[j] = AudioVec4::load(history[j].ha2);
+		hb1[j] = AudioVec4::load(history[j].hb1);
+		hb2[j] = AudioVec4::load(history[j].hb2);
 	}
 
+	float out[4];
+
 	for (int i = 0; i < p_frame_count; i++) {
-		float f = p_src_frames[i].r;
-		filter_process[1][0].process_one(f);
-		if (S > 1)
-			filter_process[1][1].process_one(f);
-		if (S > 2)
-			filter_process[1][2].process_one(f);
-		if (S > 3)
-			filter_process[1][3].process_one(f);
-
-		p_dst_frames[i].r = f;
+
+		AudioVec4 f = AudioVec4::set(p_src_frames[i].l, p_src_frames[i].r, 0, 0);
+
+		for (int j = 0; j < S; j++) {
+
+			AudioVec4 pre = f;
+			f = f * b0 + hb1[j] * b1 + hb2[j] * b2 + ha1[j] * a1 + ha2[j] * a2;
+			ha2[j] = ha1[j];
+			hb2[j] = hb1[j];
+			hb1[j] = pre;
+			ha1[j] = f;
+		}
+
+		f.store(out);
+		p_dst_frames[i] = AudioFrame(out[0], out[1]);
+	}
+
+	for (int j = 0; j < S; j++) {
+		ha1[j].store(history[j].ha1);
+		ha2[j].store(history[j].ha2);
+		hb1[j].store(history[j].hb1);
+		hb2[j].store(history[j].hb2);
 	}
 }
 
@@ -71,12 +90,6 @@ void AudioEffectFilterInstance::process(const AudioFrame *p_src_frames, AudioFra
 	filter.set_stages(stages);
 	filter.set_sampling_rate(AudioServer::get_singleton()->get_mix_rate());
 
-	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 4; j++) {
-			filter_process[i][j].update_coeffs();
-		}
-	}
-
 	if (stages == 1) {
 		_process_filter<1>(p_src_frames, p_dst_frames, p_frame_count);
 	} else if (stages == 2) {
@@ -90,9 +103,9 @@ void AudioEffectFilterInstance::process(const AudioFrame *p_src_frames, AudioFra
 
 AudioEffectFilterInstance::AudioEffectFilterInstance() {
 
-	for (int i = 0; i < 2; i++) {
+	for (int i = 0; i < 4; i++) {
 		for (int j = 0; j < 4; j++) {
-			filter_process[i][j].set_filter(&filter);
+			history[i].ha1[j] = history[i].ha2[j] = history[i].hb1[j] = history[i].hb2[j] = 0;
 		}
 	}
 }
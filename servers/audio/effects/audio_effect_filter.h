@@ -43,7 +43,14 @@ class AudioEffectFilterInstance : public AudioEffectInstance {
 	Ref<AudioEffectFilter> base;
 
 	AudioFilterSW filter;
-	AudioFilterSW::Processor filter_process[2][4];
+
+	// Left and right run side by side in one vector (see audio_simd.h).
+	// Same math as AudioFilterSW::Processor, lane 0 is left, lane 1 is right.
+	struct StageHistory {
+		float ha1[4], ha2[4], hb1[4], hb2[4];
+	};
+
+	StageHistory history[4];
 
 	template <int S>
 	void _process_filter(const AudioFrame *p_src_frames, AudioFrame *p_dst_frames, int p_frame_count);
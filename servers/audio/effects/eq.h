@@ -87,6 +87,7 @@ public:
 	void set_preset_band_mode(Preset p_preset);
 	void set_bands(const Vector<float> &p_bands);
 	BandProcess get_band_processor(int p_band) const;
+	void get_band_coefficients(int p_band, float &r_c1, float &r_c2, float &r_c3) const;
 	float get_band_frequency(int p_band);
 
 	EQ();
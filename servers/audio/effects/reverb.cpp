@@ -32,6 +32,7 @@
 
 #include "reverb.h"
 #include "core/math/math_funcs.h"
+#include "servers/audio/audio_simd.h"
 #include <math.h>
 
 const float Reverb::comb_tunings[MAX_COMBS] = {
@@ -80,8 +81,6 @@ void Reverb::process(float *p_src, float *p_dst, int p_frames) {
 
 		input_buffer[i] = in;
 
-		p_dst[i] = 0; //take the chance and clear this
-
 		echo_buffer_pos++;
 	}
 
@@ -100,22 +99,50 @@ void Reverb::process(float *p_src, float *p_dst, int p_frames) {
 		}
 	}
 
-	for (int i = 0; i < MAX_COMBS; i++) {
+	// The combs are independent, so they run four at a time, one per lane.
+	// Each has its own delay, so reads and writes are still done one by one.
 
-		Comb &c = comb[i];
+	for (int i = 0; i < MAX_COMBS; i += 4) {
+
+		Comb *c = &comb[i];
+		int size_limit[4];
+		for (int k = 0; k < 4; k++) {
+			size_limit[k] = c[k].size - lrintf((float)c[k].extra_spread_frames * (1.0 - params.extra_spread));
+		}
+
+		AudioVec4 feedback = AudioVec4::set(c[0].feedback, c[1].feedback, c[2].feedback, c[3].feedback);
+		AudioVec4 damp = AudioVec4::set(c[0].damp, c[1].damp, c[2].damp, c[3].damp);
+		AudioVec4 damp_inv = AudioVec4::splat(1.0) - damp;
+		AudioVec4 damp_h = AudioVec4::set(c[0].damp_h, c[1].damp_h, c[2].damp_h, c[3].damp_h);
+		float lanes[4];
 
-		int size_limit = c.size - lrintf((float)c.extra_spread_frames * (1.0 - params.extra_spread));
 		for (int j = 0; j < p_frames; j++) {
 
-			if (c.pos >= size_limit) //reset this now just in case
-				c.pos = 0;
+			for (int k = 0; k < 4; k++) {
+				if (c[k].pos >= size_limit[k]) //reset this now just in case
+					c[k].pos = 0;
+			}
+
+			AudioVec4 out = AudioVec4::set(c[0].buffer[c[0].pos], c[1].buffer[c[1].pos], c[2].buffer[c[2].pos], c[3].buffer[c[3].pos]);
+			out = (out * feedback).undenormalise();
+			out = out * damp_inv + damp_h * damp; //lowpass
+			damp_h = out;
+
+			(AudioVec4::splat(input_buffer[j]) + out).store(lanes);
+			for (int k = 0; k < 4; k++) {
+				c[k].buffer[c[k].pos++] = lanes[k];
+			}
+
+			if (i == 0) {
+				p_dst[j] = out.sum();
+			} else {
+				p_dst[j] += out.sum();
+			}
+		}
 
-			float out = undenormalise(c.buffer[c.pos] * c.feedback);
-			out = out * (1.0 - c.damp) + c.damp_h * c.damp; //lowpass
-			c.damp_h = out;
-			c.buffer[c.pos] = input_buffer[j] + out;
-			p_dst[j] += out;
-			c.pos++;
+		damp_h.store(lanes);
+		for (int k = 0; k < 4; k++) {
+			c[k].damp_h = lanes[k];
 		}
 	}
 
@@ -154,26 +181,52 @@ void Reverb::process(float *p_src, float *p_dst, int p_frames) {
 	}
 	*/
 
+	// The allpasses are chained, but each delay is much longer than four frames,
+	// so four consecutive frames never read what the others write.
+	AudioVec4 allpass_feedback4 = AudioVec4::splat(allpass_feedback);
+
 	for (int i = 0; i < MAX_ALLPASS; i++) {
 
 		AllPass &a = allpass[i];
 		int size_limit = a.size - lrintf((float)a.extra_spread_frames * (1.0 - params.extra_spread));
 
-		for (int j = 0; j < p_frames; j++) {
+		int j = 0;
+		while (j < p_frames) {
 
 			if (a.pos >= size_limit)
 				a.pos = 0;
 
+			if (j + 4 <= p_frames && a.pos + 4 <= size_limit) {
+
+				AudioVec4 aux = AudioVec4::load(&a.buffer[a.pos]);
+				AudioVec4 buf = (allpass_feedback4 * aux + AudioVec4::load(&p_dst[j])).undenormalise();
+				buf.store(&a.buffer[a.pos]);
+				(aux - allpass_feedback4 * buf).store(&p_dst[j]);
+				a.pos += 4;
+				j += 4;
+				continue;
+			}
+
 			float aux = a.buffer[a.pos];
 			a.buffer[a.pos] = undenormalise(allpass_feedback * aux + p_dst[j]);
 			p_dst[j] = aux - allpass_feedback * a.buffer[a.pos];
 			a.pos++;
+			j++;
 		}
 	}
 
 	static const float wet_scale = 0.6;
 
-	for (int i = 0; i < p_frames; i++) {
+	AudioVec4 wet = AudioVec4::splat(params.wet);
+	AudioVec4 wet_scale4 = AudioVec4::splat(wet_scale);
+	AudioVec4 dry = AudioVec4::splat(params.dry);
+
+	int i = 0;
+	for (; i + 4 <= p_frames; i += 4) {
+
+		(AudioVec4::load(&p_dst[i]) * wet * wet_scale4 + AudioVec4::load(&p_src[i]) * dry).store(&p_dst[i]);
+	}
+	for (; i < p_frames; i++) {
 
 		p_dst[i] = p_dst[i] * params.wet * wet_scale + p_src[i] * params.dry;
 	}
@@ -32,8 +32,10 @@
 #include "core/io/resource_loader.h"
 #include "core/os/file_access.h"
 #include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
 #include "core/project_settings.h"
 #include "scene/resources/audio_stream_sample.h"
+#include "servers/audio/audio_decode_pool.h"
 #include "servers/audio/audio_driver_dummy.h"
 #include "servers/audio/effects/audio_effect_compressor.h"
 #ifdef TOOLS_ENABLED
@@ -293,7 +295,9 @@ void AudioServer::_driver_process(int p_frames, int32_t *p_buffer) {
 
 void AudioServer::_mix_step() {
 
-	bool solo_mode = false;
+	solo_mode = false;
+	mix_decode_usec = decode_usec;
+	decode_usec = 0;
 
 	for (int i = 0; i < buses.size(); i++) {
 		Bus *bus = buses[i];
@@ -332,139 +336,257 @@ void AudioServer::_mix_step() {
 		}
 	}
 
+	for (int i = 0; i < buses.size(); i++) {
+		Bus *bus = buses[i];
+		bus->mix_level = 0;
+		bus->send_index = -1;
+
+		if (i > 0) {
+			//everything has a send save for master bus
+			Map<StringName, Bus *>::Element *E = bus_map.find(bus->send);
+			if (!E || E->get()->index_cache >= i) { //invalid, send to master
+				bus->send_index = 0;
+			} else {
+				bus->send_index = E->get()->index_cache;
+			}
+		}
+	}
+
+	// sends always go to a lower index, so walking backwards finishes a bus
+	// before reaching the bus it sends to
+	int max_level = 0;
+	for (int i = buses.size() - 1; i > 0; i--) {
+		Bus *send = buses[buses[i]->send_index];
+		send->mix_level = MAX(send->mix_level, buses[i]->mix_level + 1);
+		max_level = MAX(max_level, send->mix_level);
+	}
+
+	_update_voices();
+
 	//make callbacks for mixing the audio
 	for (Set<CallbackItem>::Element *E = callbacks.front(); E; E = E->next()) {
 
 		E->get().callback(E->get().userdata);
 	}
 
-	for (int i = buses.size() - 1; i >= 0; i--) {
-		//go bus by bus
-		Bus *bus = buses[i];
-
-		for (int k = 0; k < bus->channels.size(); k++) {
+	mix_order.resize(buses.size());
+	int *order = mix_order.ptrw();
 
-			if (bus->channels[k].active && !bus->channels[k].used) {
-				//buffer was not used, but it's still active, so it must be cleaned
-				AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+	int from = 0;
+	for (int level = 0; level <= max_level; level++) {
 
-				for (uint32_t j = 0; j < buffer_size; j++) {
+		int count = 0;
+		for (int i = buses.size() - 1; i >= 0; i--) {
+			if (buses[i]->mix_level == level) {
+				order[from + count++] = i;
+			}
+		}
 
-					buf[j] = AudioFrame(0, 0);
-				}
+		if (mix_pool) {
+			mix_pool->do_work(count, this, &AudioServer::_mix_step_bus, (const int *)&order[from]);
+		} else {
+			for (int i = 0; i < count; i++) {
+				_mix_step_bus(i, &order[from]);
 			}
 		}
 
-		//process effects
-		if (!bus->bypass) {
-			for (int j = 0; j < bus->effects.size(); j++) {
+		from += count;
+	}
 
-				if (!bus->effects[j].enabled)
-					continue;
+	mix_frames += buffer_size;
+	to_mix = buffer_size;
+}
 
-#ifdef DEBUG_ENABLED
-				uint64_t ticks = OS::get_singleton()->get_ticks_usec();
-#endif
+void AudioServer::_update_voices() {
 
-				for (int k = 0; k < bus->channels.size(); k++) {
+	int real = 0;
+	int virt = 0;
+	int candidates = 0;
 
-					if (!(bus->channels[k].active || bus->channels[k].effect_instances[j]->process_silence()))
-						continue;
-					bus->channels.write[k].effect_instances.write[j]->process(bus->channels[k].buffer.ptr(), temp_buffer.write[k].ptrw(), buffer_size);
-				}
+	voice_sort.resize(voices.size());
+	Voice **sorted = voice_sort.ptrw();
 
-				//swap buffers, so internal buffer always has the right data
-				for (int k = 0; k < bus->channels.size(); k++) {
+	for (int i = 0; i < voices.size(); i++) {
 
-					if (!(buses[i]->channels[k].active || bus->channels[k].effect_instances[j]->process_silence()))
-						continue;
-					SWAP(bus->channels.write[k].buffer, temp_buffer.write[k]);
-				}
+		Voice *v = voices[i];
+		if (!v->playing) {
+			v->virtualized = false;
+			continue;
+		}
 
-#ifdef DEBUG_ENABLED
-				bus->effects.write[j].prof_time += OS::get_singleton()->get_ticks_usec() - ticks;
-#endif
+		if (v->audibility < virtual_voice_threshold) {
+			v->virtualized = true;
+			virt++;
+			continue;
+		}
+
+		// favor voices that are already real, so similar ones don't keep swapping
+		v->score = v->virtualized ? v->audibility : v->audibility * 1.5;
+		sorted[candidates++] = v;
+	}
+
+	if (max_real_voices > 0 && candidates > max_real_voices) {
+		SortArray<Voice *, VoiceSort> sorter;
+		sorter.nth_element(0, candidates, max_real_voices, sorted);
+	}
+
+	for (int i = 0; i < candidates; i++) {
+
+		bool is_real = max_real_voices <= 0 || i < max_real_voices;
+		sorted[i]->virtualized = !is_real;
+		if (is_real) {
+			real++;
+		} else {
+			virt++;
+		}
+	}
+
+	real_voice_count = real;
+	virtual_voice_count = virt;
+}
+
+void AudioServer::_mix_step_bus(uint32_t p_index, const int *p_buses) {
+
+	uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+
+	int i = p_buses[p_index];
+	Bus *bus = buses[i];
+
+	//gather the buses sending here, they were all mixed in a previous level
+	for (int j = i + 1; j < buses.size(); j++) {
+
+		Bus *source = buses[j];
+		if (source->send_index != i)
+			continue;
+
+		for (int k = 0; k < source->channels.size(); k++) {
+
+			if (!source->channels[k].active)
+				continue;
+
+			const AudioFrame *buf = source->channels[k].buffer.ptr();
+			AudioFrame *target_buf = _get_bus_channel_mix_buffer(bus, k);
+
+			for (uint32_t l = 0; l < buffer_size; l++) {
+				target_buf[l] += buf[l];
 			}
 		}
+	}
 
-		//process send
+	for (int k = 0; k < bus->channels.size(); k++) {
 
-		Bus *send = NULL;
+		if (bus->channels[k].active && !bus->channels[k].used) {
+			//buffer was not used, but it's still active, so it must be cleaned
+			AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
 
-		if (i > 0) {
-			//everything has a send save for master bus
-			if (!bus_map.has(bus->send)) {
-				send = buses[0];
-			} else {
-				send = bus_map[bus->send];
-				if (send->index_cache >= bus->index_cache) { //invalid, send to master
-					send = buses[0];
-				}
+			for (uint32_t j = 0; j < buffer_size; j++) {
+
+				buf[j] = AudioFrame(0, 0);
 			}
 		}
+	}
 
-		for (int k = 0; k < bus->channels.size(); k++) {
+	//process effects
+	if (!bus->bypass) {
+		for (int j = 0; j < bus->effects.size(); j++) {
 
-			if (!bus->channels[k].active)
+			if (!bus->effects[j].enabled)
 				continue;
 
-			AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+#ifdef DEBUG_ENABLED
+			uint64_t effect_ticks = OS::get_singleton()->get_ticks_usec();
+#endif
 
-			AudioFrame peak = AudioFrame(0, 0);
+			for (int k = 0; k < bus->channels.size(); k++) {
 
-			float volume = Math::db2linear(bus->volume_db);
+				if (!(bus->channels[k].active || bus->channels[k].effect_instances[j]->process_silence()))
+					continue;
+				bus->channels.write[k].effect_instances.write[j]->process(bus->channels[k].buffer.ptr(), bus->channels.write[k].temp_buffer.ptrw(), buffer_size);
+			}
 
-			if (solo_mode) {
-				if (!bus->soloed) {
-					volume = 0.0;
-				}
-			} else {
-				if (bus->mute) {
-					volume = 0.0;
-				}
+			//swap buffers, so internal buffer always has the right data
+			for (int k = 0; k < bus->channels.size(); k++) {
+
+				if (!(bus->channels[k].active || bus->channels[k].effect_instances[j]->process_silence()))
+					continue;
+				SWAP(bus->channels.write[k].buffer, bus->channels.write[k].temp_buffer);
 			}
 
-			//apply volume and compute peak
-			for (uint32_t j = 0; j < buffer_size; j++) {
+#ifdef DEBUG_ENABLED
+			bus->effects.write[j].prof_time += OS::get_singleton()->get_ticks_usec() - effect_ticks;
+#endif
+		}
+	}
 
-				buf[j] *= volume;
+	float volume = Math::db2linear(bus->volume_db);
 
-				float l = ABS(buf[j].l);
-				if (l > peak.l) {
-					peak.l = l;
-				}
-				float r = ABS(buf[j].r);
-				if (r > peak.r) {
-					peak.r = r;
-				}
-			}
+	if (solo_mode) {
+		if (!bus->soloed) {
+			volume = 0.0;
+		}
+	} else {
+		if (bus->mute) {
+			volume = 0.0;
+		}
+	}
 
-			bus->channels.write[k].peak_volume = AudioFrame(Math::linear2db(peak.l + 0.0000000001), Math::linear2db(peak.r + 0.0000000001));
+	for (int k = 0; k < bus->channels.size(); k++) {
 
-			if (!bus->channels[k].used) {
-				//see if any audio is contained, because channel was not used
+		if (!bus->channels[k].active)
+			continue;
 
-				if (MAX(peak.r, peak.l) > Math::db2linear(channel_disable_threshold_db)) {
-					bus->channels.write[k].last_mix_with_audio = mix_frames;
-				} else if (mix_frames - bus->channels[k].last_mix_with_audio > channel_disable_frames) {
-					bus->channels.write[k].active = false;
-					continue; //went inactive, don't mix.
-				}
+		AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+
+		AudioFrame peak = AudioFrame(0, 0);
+
+		//apply volume and compute peak
+		for (uint32_t j = 0; j < buffer_size; j++) {
+
+			buf[j] *= volume;
+
+			float l = ABS(buf[j].l);
+			if (l > peak.l) {
+				peak.l = l;
+			}
+			float r = ABS(buf[j].r);
+			if (r > peak.r) {
+				peak.r = r;
 			}
+		}
 
-			if (send) {
-				//if not master bus, send
-				AudioFrame *target_buf = thread_get_channel_mix_buffer(send->index_cache, k);
+		bus->channels.write[k].peak_volume = AudioFrame(Math::linear2db(peak.l + 0.0000000001), Math::linear2db(peak.r + 0.0000000001));
 
-				for (uint32_t j = 0; j < buffer_size; j++) {
-					target_buf[j] += buf[j];
-				}
+		if (!bus->channels[k].used) {
+			//see if any audio is contained, because channel was not used
+
+			if (MAX(peak.r, peak.l) > Math::db2linear(channel_disable_threshold_db)) {
+				bus->channels.write[k].last_mix_with_audio = mix_frames;
+			} else if (mix_frames - bus->channels[k].last_mix_with_audio > channel_disable_frames) {
+				bus->channels.write[k].active = false; //went inactive, won't be sent
 			}
 		}
 	}
 
-	mix_frames += buffer_size;
-	to_mix = buffer_size;
+	bus->process_usec = OS::get_singleton()->get_ticks_usec() - ticks;
+#ifdef DEBUG_ENABLED
+	bus->prof_time += bus->process_usec;
+#endif
+}
+
+AudioFrame *AudioServer::_get_bus_channel_mix_buffer(Bus *p_bus, int p_channel) {
+
+	AudioFrame *data = p_bus->channels.write[p_channel].buffer.ptrw();
+
+	if (!p_bus->channels[p_channel].used) {
+		p_bus->channels.write[p_channel].used = true;
+		p_bus->channels.write[p_channel].active = true;
+		p_bus->channels.write[p_channel].last_mix_with_audio = mix_frames;
+		for (uint32_t i = 0; i < buffer_size; i++) {
+			data[i] = AudioFrame(0, 0);
+		}
+	}
+
+	return data;
 }
 
 bool AudioServer::thread_has_channel_mix_buffer(int p_bus, int p_buffer) const {
@@ -480,18 +602,7 @@ AudioFrame *AudioServer::thread_get_channel_mix_buffer(int p_bus, int p_buffer)
 	ERR_FAIL_INDEX_V(p_bus, buses.size(), NULL);
 	ERR_FAIL_INDEX_V(p_buffer, buses[p_bus]->channels.size(), NULL);
 
-	AudioFrame *data = buses.write[p_bus]->channels.write[p_buffer].buffer.ptrw();
-
-	if (!buses[p_bus]->channels[p_buffer].used) {
-		buses.write[p_bus]->channels.write[p_buffer].used = true;
-		buses.write[p_bus]->channels.write[p_buffer].active = true;
-		buses.write[p_bus]->channels.write[p_buffer].last_mix_with_audio = mix_frames;
-		for (uint32_t i = 0; i < buffer_size; i++) {
-			data[i] = AudioFrame(0, 0);
-		}
-	}
-
-	return data;
+	return _get_bus_channel_mix_buffer(buses[p_bus], p_buffer);
 }
 
 int AudioServer::thread_get_mix_buffer_size() const {
@@ -554,6 +665,7 @@ void AudioServer::set_bus_count(int p_count) {
 		buses.write[i]->channels.resize(channel_count);
 		for (int j = 0; j < channel_count; j++) {
 			buses.write[i]->channels.write[j].buffer.resize(buffer_size);
+			buses.write[i]->channels.write[j].temp_buffer.resize(buffer_size);
 		}
 		buses[i]->name = attempt;
 		buses[i]->solo = false;
@@ -626,6 +738,7 @@ void AudioServer::add_bus(int p_at_pos) {
 	bus->channels.resize(channel_count);
 	for (int j = 0; j < channel_count; j++) {
 		bus->channels.write[j].buffer.resize(buffer_size);
+		bus->channels.write[j].temp_buffer.resize(buffer_size);
 	}
 	bus->name = attempt;
 	bus->solo = false;
@@ -936,6 +1049,23 @@ float AudioServer::get_bus_peak_volume_right_db(int p_bus, int p_channel) const
 	return buses[p_bus]->channels[p_channel].peak_volume.r;
 }
 
+float AudioServer::get_bus_process_time(int p_bus) const {
+
+	ERR_FAIL_INDEX_V(p_bus, buses.size(), 0);
+
+	return USEC_TO_SEC(buses[p_bus]->process_usec);
+}
+
+void AudioServer::thread_add_decode_time(uint64_t p_usec) {
+
+	decode_usec += p_usec;
+}
+
+float AudioServer::get_mix_decode_time() const {
+
+	return USEC_TO_SEC(mix_decode_usec);
+}
+
 bool AudioServer::is_bus_channel_active(int p_bus, int p_channel) const {
 
 	ERR_FAIL_INDEX_V(p_bus, buses.size(), false);
@@ -955,16 +1085,12 @@ float AudioServer::get_global_rate_scale() const {
 
 void AudioServer::init_channels_and_buffers() {
 	channel_count = get_channel_count();
-	temp_buffer.resize(channel_count);
-
-	for (int i = 0; i < temp_buffer.size(); i++) {
-		temp_buffer.write[i].resize(buffer_size);
-	}
 
 	for (int i = 0; i < buses.size(); i++) {
 		buses[i]->channels.resize(channel_count);
 		for (int j = 0; j < channel_count; j++) {
 			buses.write[i]->channels.write[j].buffer.resize(buffer_size);
+			buses.write[i]->channels.write[j].temp_buffer.resize(buffer_size);
 		}
 	}
 }
@@ -978,6 +1104,26 @@ void AudioServer::init() {
 
 	init_channels_and_buffers();
 
+	max_real_voices = GLOBAL_DEF("audio/max_real_voices", 64);
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/max_real_voices", PropertyInfo(Variant::INT, "audio/max_real_voices", PROPERTY_HINT_RANGE, "0,1024,1,or_greater"));
+	virtual_voice_threshold = Math::db2linear(float(GLOBAL_DEF("audio/virtual_voice_threshold_db", -60.0)));
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/virtual_voice_threshold_db", PropertyInfo(Variant::REAL, "audio/virtual_voice_threshold_db", PROPERTY_HINT_RANGE, "-80,0,0.1"));
+
+	int mix_threads = GLOBAL_DEF_RST("audio/mix_threads", 2);
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/mix_threads", PropertyInfo(Variant::INT, "audio/mix_threads", PROPERTY_HINT_RANGE, "0,16,1"));
+#ifndef NO_THREADS
+	if (mix_threads > 0 && OS::get_singleton()->get_processor_count() > 1) {
+		// own pool, the mix callback must not wait on jobs queued by the main thread
+		mix_pool = memnew(ThreadWorkPool);
+		mix_pool->init(mix_threads);
+	}
+#endif
+
+	int decode_threads = GLOBAL_DEF_RST("audio/decode_threads", 1);
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/decode_threads", PropertyInfo(Variant::INT, "audio/decode_threads", PROPERTY_HINT_RANGE, "0,8,1"));
+	decode_pool = memnew(AudioDecodePool);
+	decode_pool->init(decode_threads);
+
 	mix_count = 0;
 	set_bus_count(1);
 	set_bus_name(0, "Master");
@@ -1009,6 +1155,11 @@ void AudioServer::update() {
 
 		for (int i = buses.size() - 1; i >= 0; i--) {
 			Bus *bus = buses[i];
+
+			// whole bus DSP (sends, effects, volume), buses of the same level run in parallel
+			values.push_back(String(bus->name) + " (bus)");
+			values.push_back(USEC_TO_SEC(bus->prof_time));
+
 			if (bus->bypass)
 				continue;
 
@@ -1038,6 +1189,7 @@ void AudioServer::update() {
 	// Reset profiling times
 	for (int i = buses.size() - 1; i >= 0; i--) {
 		Bus *bus = buses[i];
+		bus->prof_time = 0;
 		if (bus->bypass)
 			continue;
 
@@ -1077,6 +1229,16 @@ void AudioServer::finish() {
 		AudioDriverManager::get_driver(i)->finish();
 	}
 
+	if (mix_pool) {
+		memdelete(mix_pool);
+		mix_pool = NULL;
+	}
+
+	if (decode_pool) {
+		memdelete(decode_pool);
+		decode_pool = NULL;
+	}
+
 	for (int i = 0; i < buses.size(); i++) {
 		memdelete(buses[i]);
 	}
@@ -1209,6 +1371,45 @@ void AudioServer::remove_update_callback(AudioCallback p_callback, void *p_userd
 	unlock();
 }
 
+AudioServer::Voice *AudioServer::voice_create() {
+
+	Voice *voice = memnew(Voice);
+	lock();
+	voices.push_back(voice);
+	unlock();
+	return voice;
+}
+
+void AudioServer::voice_free(Voice *p_voice) {
+
+	ERR_FAIL_COND(!p_voice);
+	lock();
+	voices.erase(p_voice);
+	unlock();
+	memdelete(p_voice);
+}
+
+void AudioServer::set_max_real_voices(int p_count) {
+
+	ERR_FAIL_COND(p_count < 0);
+	max_real_voices = p_count;
+}
+
+int AudioServer::get_max_real_voices() const {
+
+	return max_real_voices;
+}
+
+int AudioServer::get_real_voice_count() const {
+
+	return real_voice_count;
+}
+
+int AudioServer::get_virtual_voice_count() const {
+
+	return virtual_voice_count;
+}
+
 void AudioServer::set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout) {
 
 	ERR_FAIL_COND(p_bus_layout.is_null() || p_bus_layout->buses.size() == 0);
@@ -1252,6 +1453,7 @@ void AudioServer::set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout) {
 		buses[i]->channels.resize(channel_count);
 		for (int j = 0; j < channel_count; j++) {
 			buses.write[i]->channels.write[j].buffer.resize(buffer_size);
+			buses.write[i]->channels.write[j].temp_buffer.resize(buffer_size);
 		}
 		_update_bus_effects(i);
 	}
@@ -1360,10 +1562,17 @@ void AudioServer::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_bus_peak_volume_left_db", "bus_idx", "channel"), &AudioServer::get_bus_peak_volume_left_db);
 	ClassDB::bind_method(D_METHOD("get_bus_peak_volume_right_db", "bus_idx", "channel"), &AudioServer::get_bus_peak_volume_right_db);
+	ClassDB::bind_method(D_METHOD("get_bus_process_time", "bus_idx"), &AudioServer::get_bus_process_time);
+	ClassDB::bind_method(D_METHOD("get_mix_decode_time"), &AudioServer::get_mix_decode_time);
 
 	ClassDB::bind_method(D_METHOD("set_global_rate_scale", "scale"), &AudioServer::set_global_rate_scale);
 	ClassDB::bind_method(D_METHOD("get_global_rate_scale"), &AudioServer::get_global_rate_scale);
 
+	ClassDB::bind_method(D_METHOD("set_max_real_voices", "count"), &AudioServer::set_max_real_voices);
+	ClassDB::bind_method(D_METHOD("get_max_real_voices"), &AudioServer::get_max_real_voices);
+	ClassDB::bind_method(D_METHOD("get_real_voice_count"), &AudioServer::get_real_voice_count);
+	ClassDB::bind_method(D_METHOD("get_virtual_voice_count"), &AudioServer::get_virtual_voice_count);
+
 	ClassDB::bind_method(D_METHOD("lock"), &AudioServer::lock);
 	ClassDB::bind_method(D_METHOD("unlock"), &AudioServer::unlock);
 
@@ -1387,6 +1596,7 @@ void AudioServer::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "bus_count"), "set_bus_count", "get_bus_count");
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "device"), "set_device", "get_device");
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "global_rate_scale"), "set_global_rate_scale", "get_global_rate_scale");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_real_voices"), "set_max_real_voices", "get_max_real_voices");
 
 	ADD_SIGNAL(MethodInfo("bus_layout_changed"));
 
@@ -1413,6 +1623,15 @@ AudioServer::AudioServer() {
 	mix_time = 0;
 	mix_size = 0;
 	global_rate_scale = 1;
+	solo_mode = false;
+	mix_pool = NULL;
+	decode_pool = NULL;
+	decode_usec = 0;
+	mix_decode_usec = 0;
+	max_real_voices = 64;
+	virtual_voice_threshold = 0;
+	real_voice_count = 0;
+	virtual_voice_count = 0;
 }
 
 AudioServer::~AudioServer() {
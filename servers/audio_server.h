@@ -37,9 +37,11 @@
 #include "core/variant.h"
 #include "servers/audio/audio_effect.h"
 
+class AudioDecodePool;
 class AudioDriverDummy;
 class AudioStream;
 class AudioStreamSample;
+class ThreadWorkPool;
 
 class AudioDriver {
 
@@ -180,6 +182,7 @@ private:
 
 	int channel_count;
 	int to_mix;
+	bool solo_mode;
 
 	float global_rate_scale;
 
@@ -198,6 +201,7 @@ private:
 			bool active;
 			AudioFrame peak_volume;
 			Vector<AudioFrame> buffer;
+			Vector<AudioFrame> temp_buffer; // effects write here, then it is swapped with buffer
 			Vector<Ref<AudioEffectInstance> > effect_instances;
 			uint64_t last_mix_with_audio;
 			Channel() {
@@ -222,12 +226,33 @@ private:
 		float volume_db;
 		StringName send;
 		int index_cache;
+		int send_index; // resolved send of the current mix step, -1 for master
+		int mix_level; // buses of the same level don't send to each other, so they mix in parallel
+		uint64_t process_usec;
+#ifdef DEBUG_ENABLED
+		uint64_t prof_time;
+#endif
+
+		Bus() {
+			send_index = -1;
+			mix_level = 0;
+			process_usec = 0;
+#ifdef DEBUG_ENABLED
+			prof_time = 0;
+#endif
+		}
 	};
 
-	Vector<Vector<AudioFrame> > temp_buffer; //temp_buffer for each level
 	Vector<Bus *> buses;
 	Map<StringName, Bus *> bus_map;
 
+	ThreadWorkPool *mix_pool;
+	Vector<int> mix_order; // bus indices sorted by mix level
+
+	AudioDecodePool *decode_pool;
+	uint64_t decode_usec; // decoding done on the audio thread during the current mix step
+	uint64_t mix_decode_usec;
+
 	void _update_bus_effects(int p_bus);
 
 	static AudioServer *singleton;
@@ -246,6 +271,8 @@ private:
 	void init_channels_and_buffers();
 
 	void _mix_step();
+	void _mix_step_bus(uint32_t p_index, const int *p_buses);
+	AudioFrame *_get_bus_channel_mix_buffer(Bus *p_bus, int p_channel);
 
 #if 0
 	struct AudioInBlock {
@@ -272,6 +299,41 @@ private:
 	Set<CallbackItem> callbacks;
 	Set<CallbackItem> update_callbacks;
 
+public:
+	// A voice is a playing sound whose owner may be told to stop decoding and
+	// mixing it (virtualize it) when it is inaudible or lost on priority.
+	struct Voice {
+		volatile float audibility; // peak linear gain the owner will output with
+		volatile int priority;
+		volatile bool playing;
+		volatile bool virtualized; // written by the audio thread
+		float score;
+
+		Voice() {
+			audibility = 0;
+			priority = 0;
+			playing = false;
+			virtualized = false;
+			score = 0;
+		}
+	};
+
+private:
+	struct VoiceSort {
+		_FORCE_INLINE_ bool operator()(const Voice *p_a, const Voice *p_b) const {
+			return p_a->priority == p_b->priority ? p_a->score > p_b->score : p_a->priority > p_b->priority;
+		}
+	};
+
+	Vector<Voice *> voices;
+	Vector<Voice *> voice_sort;
+	int max_real_voices;
+	float virtual_voice_threshold;
+	int real_voice_count;
+	int virtual_voice_count;
+
+	void _update_voices();
+
 	friend class AudioDriver;
 	void _driver_process(int p_frames, int32_t *p_buffer);
 
@@ -341,6 +403,11 @@ public:
 
 	bool is_bus_channel_active(int p_bus, int p_channel) const;
 
+	float get_bus_process_time(int p_bus) const;
+
+	void thread_add_decode_time(uint64_t p_usec);
+	float get_mix_decode_time() const;
+
 	void set_global_rate_scale(float p_scale);
 	float get_global_rate_scale() const;
 
@@ -377,6 +444,15 @@ public:
 	void add_update_callback(AudioCallback p_callback, void *p_userdata);
 	void remove_update_callback(AudioCallback p_callback, void *p_userdata);
 
+	Voice *voice_create();
+	void voice_free(Voice *p_voice);
+
+	void set_max_real_voices(int p_count);
+	int get_max_real_voices() const;
+
+	int get_real_voice_count() const;
+	int get_virtual_voice_count() const;
+
 	void set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout);
 	Ref<AudioBusLayout> generate_bus_layout() const;
 
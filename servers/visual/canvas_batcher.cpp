@@ -0,0 +1,134 @@
+/*************************************************************************/
+/*  canvas_batcher.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "canvas_batcher.h"
+
+bool CanvasBatcher::can_batch(const RasterizerCanvas::Item::Command *p_command) {
+
+	if (p_command->type != RasterizerCanvas::Item::Command::TYPE_RECT)
+		return false;
+
+	const RasterizerCanvas::Item::CommandRect *rect = static_cast<const RasterizerCanvas::Item::CommandRect *>(p_command);
+
+	// tiling changes texture wrap state, and normal maps need the flip signs of the single rect path
+	if (rect->flags & (RasterizerCanvas::CANVAS_RECT_TILE | RasterizerCanvas::CANVAS_RECT_CLIP_UV))
+		return false;
+
+	return !rect->normal_map.is_valid();
+}
+
+void CanvasBatcher::clear() {
+
+	quad_count = 0;
+	batch_count = 0;
+}
+
+bool CanvasBatcher::add_rect(const RasterizerCanvas::Item::CommandRect *p_rect, const Size2 &p_texpixel_size) {
+
+	if (quad_count == MAX_QUADS)
+		return false;
+
+	if (batch_count == 0 || batches[batch_count - 1].texture != p_rect->texture) {
+
+		if (batch_count == batches.size()) {
+			batches.resize(MAX(16, batch_count * 2));
+		}
+
+		Batch &b = batches.write[batch_count++];
+		b.texture = p_rect->texture;
+		b.texpixel_size = p_texpixel_size;
+		b.first_quad = quad_count;
+		b.quad_count = 0;
+	}
+
+	batches.write[batch_count - 1].quad_count++;
+
+	if ((quad_count + 1) * 4 > vertices.size()) {
+		vertices.resize(MIN(MAX_QUADS, MAX(256, quad_count * 2)) * 4);
+	}
+
+	// same mapping as the single textured rect path in the canvas shader
+
+	Rect2 dst_rect = p_rect->rect;
+	if (dst_rect.size.width < 0) {
+		dst_rect.position.x += dst_rect.size.width;
+		dst_rect.size.width *= -1;
+	}
+	if (dst_rect.size.height < 0) {
+		dst_rect.position.y += dst_rect.size.height;
+		dst_rect.size.height *= -1;
+	}
+
+	Rect2 src_rect(0, 0, 1, 1);
+	bool transpose = false;
+
+	if (p_texpixel_size != Size2()) {
+
+		if (p_rect->flags & RasterizerCanvas::CANVAS_RECT_REGION) {
+			src_rect = Rect2(p_rect->source.position * p_texpixel_size, p_rect->source.size * p_texpixel_size);
+		}
+		if (p_rect->flags & RasterizerCanvas::CANVAS_RECT_FLIP_H) {
+			src_rect.size.x *= -1;
+		}
+		if (p_rect->flags & RasterizerCanvas::CANVAS_RECT_FLIP_V) {
+			src_rect.size.y *= -1;
+		}
+		transpose = p_rect->flags & RasterizerCanvas::CANVAS_RECT_TRANSPOSE;
+	}
+
+	static const Vector2 corners[4] = {
+		Vector2(0, 0),
+		Vector2(1, 0),
+		Vector2(1, 1),
+		Vector2(0, 1),
+	};
+
+	Vertex *v = &vertices.write[quad_count * 4];
+
+	for (int i = 0; i < 4; i++) {
+
+		Vector2 c = corners[i];
+		Vector2 flipped(src_rect.size.x < 0 ? 1.0 - c.x : c.x, src_rect.size.y < 0 ? 1.0 - c.y : c.y);
+
+		v[i].position = dst_rect.position + dst_rect.size * flipped;
+		v[i].uv = src_rect.position + src_rect.size.abs() * (transpose ? Vector2(c.y, c.x) : c);
+		v[i].color = p_rect->modulate;
+	}
+
+	quad_count++;
+
+	return true;
+}
+
+CanvasBatcher::CanvasBatcher() {
+
+	quad_count = 0;
+	batch_count = 0;
+}
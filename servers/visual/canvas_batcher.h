@@ -0,0 +1,88 @@
+/*************************************************************************/
+/*  canvas_batcher.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef CANVAS_BATCHER_H
+#define CANVAS_BATCHER_H
+
+#include "servers/visual/rasterizer.h"
+
+/**
+	Builds vertex data for runs of consecutive canvas rect commands, so a
+	renderer can upload them at once and draw them with one call per
+	texture change instead of one call per rect. It only does CPU work
+	and doesn't know about any graphics API.
+
+	Quads are written in the item's local space, as four vertices in the
+	order top-left, top-right, bottom-right, bottom-left, to be drawn as
+	two indexed triangles each.
+*/
+
+class CanvasBatcher {
+public:
+	enum {
+		MAX_QUADS = 4096, // per upload, also keeps vertex indices in 16 bits
+	};
+
+	struct Vertex {
+
+		Vector2 position;
+		Vector2 uv;
+		Color color;
+	};
+
+	struct Batch {
+
+		RID texture;
+		Size2 texpixel_size;
+		int first_quad;
+		int quad_count;
+	};
+
+private:
+	Vector<Vertex> vertices;
+	Vector<Batch> batches;
+	int quad_count;
+	int batch_count;
+
+public:
+	static bool can_batch(const RasterizerCanvas::Item::Command *p_command);
+
+	void clear();
+	bool add_rect(const RasterizerCanvas::Item::CommandRect *p_rect, const Size2 &p_texpixel_size);
+
+	_FORCE_INLINE_ int get_quad_count() const { return quad_count; }
+	_FORCE_INLINE_ const Vertex *get_vertices() const { return vertices.ptr(); }
+	_FORCE_INLINE_ int get_batch_count() const { return batch_count; }
+	_FORCE_INLINE_ const Batch &get_batch(int p_index) const { return batches[p_index]; }
+
+	CanvasBatcher();
+};
+
+#endif // CANVAS_BATCHER_H
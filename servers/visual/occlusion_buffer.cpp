@@ -0,0 +1,301 @@
+/*************************************************************************/
+/*  occlusion_buffer.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "occlusion_buffer.h"
+
+#include "core/os/thread_work_pool.h"
+
+void OcclusionBuffer::begin(const CameraMatrix &p_projection, const Transform &p_cam_transform) {
+
+	view_projection = p_projection * CameraMatrix(p_cam_transform.affine_inverse());
+	triangle_count = 0;
+}
+
+void OcclusionBuffer::_add_triangle(const Plane *p_clip) {
+
+	// clip against the near plane (z >= -w), the other planes are handled by clamping to the buffer
+
+	Plane poly[4];
+	int count = 0;
+
+	for (int i = 0; i < 3; i++) {
+
+		const Plane &a = p_clip[i];
+		const Plane &b = p_clip[(i + 1) % 3];
+		float da = a.normal.z + a.d;
+		float db = b.normal.z + b.d;
+
+		if (da >= 0) {
+			poly[count++] = a;
+		}
+		if ((da >= 0) != (db >= 0)) {
+			float t = da / (da - db);
+			poly[count++] = Plane(a.normal.linear_interpolate(b.normal, t), a.d + (b.d - a.d) * t);
+		}
+	}
+
+	if (count < 3)
+		return;
+
+	Vector3 screen[4];
+	for (int i = 0; i < count; i++) {
+
+		if (poly[i].d <= CMP_EPSILON)
+			return;
+
+		float inv_w = 1.0 / poly[i].d;
+		screen[i] = Vector3((poly[i].normal.x * inv_w * 0.5 + 0.5) * WIDTH, (poly[i].normal.y * inv_w * 0.5 + 0.5) * HEIGHT, poly[i].normal.z * inv_w);
+	}
+
+	for (int i = 1; i < count - 1; i++) {
+
+		if (triangle_count == triangles.size()) {
+			triangles.resize(MAX(256, triangle_count * 2));
+		}
+
+		Triangle &t = triangles.write[triangle_count++];
+		t.v[0] = screen[0];
+		t.v[1] = screen[i];
+		t.v[2] = screen[i + 1];
+		t.min_y = MIN(t.v[0].y, MIN(t.v[1].y, t.v[2].y));
+		t.max_y = MAX(t.v[0].y, MAX(t.v[1].y, t.v[2].y));
+	}
+}
+
+void OcclusionBuffer::add_occluder(const Transform &p_xform, const PoolVector<Vector3> &p_faces) {
+
+	CameraMatrix mvp = view_projection * CameraMatrix(p_xform);
+
+	int face_count = p_faces.size() / 3;
+	PoolVector<Vector3>::Read r = p_faces.read();
+
+	for (int i = 0; i < face_count; i++) {
+
+		Plane clip[3];
+		for (int j = 0; j < 3; j++) {
+			const Vector3 &v = r[i * 3 + j];
+			clip[j] = mvp.xform4(Plane(v.x, v.y, v.z, 1.0));
+		}
+
+		// trivially reject faces fully outside one of the side or far planes
+		if (clip[0].normal.x > clip[0].d && clip[1].normal.x > clip[1].d && clip[2].normal.x > clip[2].d)
+			continue;
+		if (clip[0].normal.x < -clip[0].d && clip[1].normal.x < -clip[1].d && clip[2].normal.x < -clip[2].d)
+			continue;
+		if (clip[0].normal.y > clip[0].d && clip[1].normal.y > clip[1].d && clip[2].normal.y > clip[2].d)
+			continue;
+		if (clip[0].normal.y < -clip[0].d && clip[1].normal.y < -clip[1].d && clip[2].normal.y < -clip[2].d)
+			continue;
+		if (clip[0].normal.z > clip[0].d && clip[1].normal.z > clip[1].d && clip[2].normal.z > clip[2].d)
+			continue;
+
+		_add_triangle(clip);
+	}
+}
+
+void OcclusionBuffer::_rasterize_triangle(const Triangle &p_triangle, int p_from_y, int p_to_y) {
+
+	Vector3 a = p_triangle.v[0];
+	Vector3 b = p_triangle.v[1];
+	Vector3 c = p_triangle.v[2];
+
+	float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (Math::absf(area) < CMP_EPSILON)
+		return;
+
+	if (area < 0) {
+		// occluders are double sided
+		SWAP(b, c);
+		area = -area;
+	}
+
+	int min_x = MAX(0, int(Math::floor(MIN(a.x, MIN(b.x, c.x)))));
+	int max_x = MIN(WIDTH - 1, int(Math::ceil(MAX(a.x, MAX(b.x, c.x)))));
+	int min_y = MAX(p_from_y, int(Math::floor(p_triangle.min_y)));
+	int max_y = MIN(p_to_y - 1, int(Math::ceil(p_triangle.max_y)));
+
+	if (min_x > max_x || min_y > max_y)
+		return;
+
+	// edge functions e(x, y) = A * x + B * y + C, positive inside; depth is a plane over the same terms
+
+	float a0 = b.y - c.y, b0 = c.x - b.x, c0 = b.x * c.y - b.y * c.x; // weight of a
+	float a1 = c.y - a.y, b1 = a.x - c.x, c1 = c.x * a.y - c.y * a.x; // weight of b
+	float a2 = a.y - b.y, b2 = b.x - a.x, c2 = a.x * b.y - a.y * b.x; // weight of c
+
+	float inv_area = 1.0 / area;
+	float za = (a.z * a0 + b.z * a1 + c.z * a2) * inv_area;
+	float zb = (a.z * b0 + b.z * b1 + c.z * b2) * inv_area;
+	float zc = (a.z * c0 + b.z * c1 + c.z * c2) * inv_area;
+
+	float start_x = min_x + 0.5;
+
+	for (int y = min_y; y <= max_y; y++) {
+
+		float py = y + 0.5;
+		float e0 = a0 * start_x + b0 * py + c0;
+		float e1 = a1 * start_x + b1 * py + c1;
+		float e2 = a2 * start_x + b2 * py + c2;
+		float z = za * start_x + zb * py + zc;
+
+		float *row = &depth[y * WIDTH];
+
+		// branchless on purpose, so the compiler can vectorize the span
+		for (int x = min_x; x <= max_x; x++) {
+
+			bool inside = (e0 >= 0) & (e1 >= 0) & (e2 >= 0);
+			float d = row[x];
+			row[x] = (inside & (z < d)) ? z : d;
+
+			e0 += a0;
+			e1 += a1;
+			e2 += a2;
+			z += za;
+		}
+	}
+}
+
+void OcclusionBuffer::_rasterize_band(uint32_t p_band, void *p_userdata) {
+
+	int from_y = p_band * BAND_HEIGHT;
+	int to_y = from_y + BAND_HEIGHT;
+
+	float *band_depth = &depth[from_y * WIDTH];
+	for (int i = 0; i < BAND_HEIGHT * WIDTH; i++) {
+		band_depth[i] = 1.0;
+	}
+
+	const Triangle *t = triangles.ptr();
+	for (int i = 0; i < triangle_count; i++) {
+
+		if (t[i].max_y < from_y || t[i].min_y >= to_y)
+			continue;
+
+		_rasterize_triangle(t[i], from_y, to_y);
+	}
+
+	// farthest depth per tile, for the hierarchical test
+
+	for (int ty = from_y / TILE_SIZE; ty < to_y / TILE_SIZE; ty++) {
+		for (int tx = 0; tx < TILES_X; tx++) {
+
+			float max_depth = -1.0;
+			for (int y = 0; y < TILE_SIZE; y++) {
+				const float *row = &depth[(ty * TILE_SIZE + y) * WIDTH + tx * TILE_SIZE];
+				for (int x = 0; x < TILE_SIZE; x++) {
+					max_depth = MAX(max_depth, row[x]);
+				}
+			}
+			tile_max_depth[ty * TILES_X + tx] = max_depth;
+		}
+	}
+}
+
+void OcclusionBuffer::rasterize() {
+
+	ThreadWorkPool::get_singleton()->do_work(BAND_COUNT, this, &OcclusionBuffer::_rasterize_band, (void *)NULL);
+}
+
+bool OcclusionBuffer::is_occluded(const AABB &p_aabb) const {
+
+	float min_x = 1e20, min_y = 1e20, min_z = 1e20;
+	float max_x = -1e20, max_y = -1e20;
+
+	for (int i = 0; i < 8; i++) {
+
+		Vector3 p = p_aabb.get_endpoint(i);
+		Plane c = view_projection.xform4(Plane(p.x, p.y, p.z, 1.0));
+
+		if (c.d <= CMP_EPSILON || c.normal.z < -c.d)
+			return false; // touches the near plane, can't be hidden
+
+		float inv_w = 1.0 / c.d;
+		float x = (c.normal.x * inv_w * 0.5 + 0.5) * WIDTH;
+		float y = (c.normal.y * inv_w * 0.5 + 0.5) * HEIGHT;
+
+		min_x = MIN(min_x, x);
+		max_x = MAX(max_x, x);
+		min_y = MIN(min_y, y);
+		max_y = MAX(max_y, y);
+		min_z = MIN(min_z, c.normal.z * inv_w);
+	}
+
+	int x0 = MAX(0, int(Math::floor(min_x)));
+	int x1 = MIN(WIDTH - 1, int(Math::floor(max_x)));
+	int y0 = MAX(0, int(Math::floor(min_y)));
+	int y1 = MIN(HEIGHT - 1, int(Math::floor(max_y)));
+
+	if (x0 > x1 || y0 > y1)
+		return false; // off screen, frustum culling decides
+
+	for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++) {
+		for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++) {
+
+			if (tile_max_depth[ty * TILES_X + tx] <= min_z)
+				continue; // everything in this tile is in front of the AABB
+
+			int from_y = MAX(y0, ty * TILE_SIZE);
+			int to_y = MIN(y1, ty * TILE_SIZE + TILE_SIZE - 1);
+			int from_x = MAX(x0, tx * TILE_SIZE);
+			int to_x = MIN(x1, tx * TILE_SIZE + TILE_SIZE - 1);
+
+			for (int y = from_y; y <= to_y; y++) {
+				const float *row = &depth[y * WIDTH];
+				for (int x = from_x; x <= to_x; x++) {
+					if (row[x] > min_z)
+						return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+OcclusionBuffer::OcclusionBuffer() {
+
+	triangle_count = 0;
+
+	depth = memnew_arr(float, WIDTH * HEIGHT);
+	for (int i = 0; i < WIDTH * HEIGHT; i++) {
+		depth[i] = 1.0;
+	}
+
+	tile_max_depth = memnew_arr(float, TILES_X * TILES_Y);
+	for (int i = 0; i < TILES_X * TILES_Y; i++) {
+		tile_max_depth[i] = 1.0;
+	}
+}
+
+OcclusionBuffer::~OcclusionBuffer() {
+
+	memdelete_arr(depth);
+	memdelete_arr(tile_max_depth);
+}
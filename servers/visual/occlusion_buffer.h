@@ -0,0 +1,95 @@
+/*************************************************************************/
+/*  occlusion_buffer.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef OCCLUSION_BUFFER_H
+#define OCCLUSION_BUFFER_H
+
+#include "core/math/aabb.h"
+#include "core/math/camera_matrix.h"
+#include "core/math/transform.h"
+#include "core/pool_vector.h"
+#include "core/vector.h"
+
+/**
+	Low resolution software depth buffer, used to cull instances hidden
+	behind occluder geometry before they reach the rasterizer.
+
+	Occluder triangles are transformed and near-clipped on the calling
+	thread, then rasterized in horizontal bands on the ThreadWorkPool.
+	Each band also keeps the farthest depth of every TILE_SIZE tile, so
+	most AABB tests are resolved without touching single pixels.
+	Testing is read-only and can run from several threads at once.
+*/
+
+class OcclusionBuffer {
+public:
+	enum {
+		WIDTH = 256,
+		HEIGHT = 128,
+		TILE_SIZE = 8,
+		TILES_X = WIDTH / TILE_SIZE,
+		TILES_Y = HEIGHT / TILE_SIZE,
+		BAND_HEIGHT = TILE_SIZE * 2,
+		BAND_COUNT = HEIGHT / BAND_HEIGHT,
+	};
+
+private:
+	struct Triangle {
+
+		// x and y in pixels, z in normalized device depth (smaller is closer)
+		Vector3 v[3];
+		float min_y;
+		float max_y;
+	};
+
+	CameraMatrix view_projection;
+	Vector<Triangle> triangles; // grows as needed but is never shrunk, to avoid reallocating every frame
+	int triangle_count;
+
+	float *depth;
+	float *tile_max_depth;
+
+	void _add_triangle(const Plane *p_clip);
+	void _rasterize_triangle(const Triangle &p_triangle, int p_from_y, int p_to_y);
+	void _rasterize_band(uint32_t p_band, void *p_userdata);
+
+public:
+	void begin(const CameraMatrix &p_projection, const Transform &p_cam_transform);
+	void add_occluder(const Transform &p_xform, const PoolVector<Vector3> &p_faces);
+	bool is_empty() const { return triangle_count == 0; }
+	void rasterize();
+
+	bool is_occluded(const AABB &p_aabb) const;
+
+	OcclusionBuffer();
+	~OcclusionBuffer();
+};
+
+#endif // OCCLUSION_BUFFER_H
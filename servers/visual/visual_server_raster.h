@@ -553,6 +553,8 @@ public:
 
 	BIND2(instance_set_extra_visibility_margin, RID, real_t)
 
+	BIND1R(Vector<int>, instances_get_frames_since_visible, const Vector<RID> &)
+
 	// don't use these in a game!
 	BIND2RC(Vector<ObjectID>, instances_cull_aabb, const AABB &, RID)
 	BIND3RC(Vector<ObjectID>, instances_cull_ray, const Vector3 &, const Vector3 &, RID)
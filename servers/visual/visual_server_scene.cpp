@@ -30,6 +30,7 @@
 
 #include "visual_server_scene.h"
 #include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
 #include "visual_server_globals.h"
 #include "visual_server_raster.h"
 #include <new>
@@ -494,6 +495,8 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 		VSG::storage->instance_add_dependency(p_base, instance);
 
 		instance->base = p_base;
+		instance->occluder_faces_dirty = true;
+		instance->occluder_faces = PoolVector<Vector3>();
 
 		if (scenario)
 			_instance_queue_update(instance, true, true);
@@ -775,6 +778,26 @@ void VisualServerScene::instance_set_extra_visibility_margin(RID p_instance, rea
 	_instance_queue_update(instance, true, false);
 }
 
+Vector<int> VisualServerScene::instances_get_frames_since_visible(const Vector<RID> &p_instances) {
+
+	Vector<int> frames;
+	frames.resize(p_instances.size());
+
+	for (int i = 0; i < p_instances.size(); i++) {
+
+		// freed instances are expected here, callers may hold on to them for a frame
+		Instance *instance = instance_owner.owns(p_instances[i]) ? instance_owner.getptr(p_instances[i]) : NULL;
+		if (!instance || instance->last_frame_pass == 0) {
+			frames.write[i] = -1; // never drawn by a camera
+			continue;
+		}
+
+		frames.write[i] = int(MIN(frame_pass - instance->last_frame_pass, (uint64_t)0x7FFFFFFF));
+	}
+
+	return frames;
+}
+
 Vector<ObjectID> VisualServerScene::instances_cull_aabb(const AABB &p_aabb, RID p_scenario) const {
 
 	Vector<ObjectID> instances;
@@ -862,6 +885,11 @@ void VisualServerScene::instance_geometry_set_flag(RID p_instance, VS::InstanceF
 
 			instance->redraw_if_visible = p_enabled;
 
+		} break;
+		case VS::INSTANCE_FLAG_OCCLUDER: {
+
+			instance->occluder = p_enabled;
+
 		} break;
 		default: {
 		}
@@ -892,6 +920,15 @@ void VisualServerScene::instance_geometry_set_material_override(RID p_instance,
 }
 
 void VisualServerScene::instance_geometry_set_draw_range(RID p_instance, float p_min, float p_max, float p_min_margin, float p_max_margin) {
+
+	Instance *instance = instance_owner.get(p_instance);
+	ERR_FAIL_COND(!instance);
+
+	instance->lod_begin = MAX(p_min, 0);
+	instance->lod_end = MAX(p_max, 0);
+	instance->lod_begin_hysteresis = MAX(p_min_margin, 0);
+	instance->lod_end_hysteresis = MAX(p_max_margin, 0);
+	instance->lod_visible = true;
 }
 void VisualServerScene::instance_geometry_set_as_instance_lod(RID p_instance, RID p_as_lod_of_instance) {
 }
@@ -1337,7 +1374,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 				for (int i = 0; i < cull_count; i++) {
 
 					Instance *instance = instance_shadow_cull_result[i];
-					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows || !_instance_in_draw_range(instance, p_cam_transform.origin)) {
 						continue;
 					}
 
@@ -1534,7 +1571,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 					float min, max;
 					Instance *instance = instance_shadow_cull_result[j];
-					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows || !_instance_in_draw_range(instance, p_cam_transform.origin)) {
 						cull_count--;
 						SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
 						j--;
@@ -1594,7 +1631,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 					for (int j = 0; j < cull_count; j++) {
 
 						Instance *instance = instance_shadow_cull_result[j];
-						if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+						if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows || !_instance_in_draw_range(instance, p_cam_transform.origin)) {
 							cull_count--;
 							SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
 							j--;
@@ -1648,7 +1685,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 					for (int j = 0; j < cull_count; j++) {
 
 						Instance *instance = instance_shadow_cull_result[j];
-						if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+						if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows || !_instance_in_draw_range(instance, p_cam_transform.origin)) {
 							cull_count--;
 							SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
 							j--;
@@ -1685,7 +1722,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			for (int j = 0; j < cull_count; j++) {
 
 				Instance *instance = instance_shadow_cull_result[j];
-				if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+				if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows || !_instance_in_draw_range(instance, p_cam_transform.origin)) {
 					cull_count--;
 					SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
 					j--;
@@ -1842,6 +1879,89 @@ void VisualServerScene::render_camera(Ref<ARVRInterface> &p_interface, ARVRInter
 	_render_scene(cam_transform, camera_matrix, false, camera->env, p_scenario, p_shadow_atlas, RID(), -1);
 };
 
+void VisualServerScene::_update_occluder_faces(Instance *p_instance) {
+
+	p_instance->occluder_faces = PoolVector<Vector3>();
+	p_instance->occluder_faces_dirty = false;
+
+	for (int i = 0; i < VSG::storage->mesh_get_surface_count(p_instance->base); i++) {
+
+		if (VSG::storage->mesh_surface_get_primitive_type(p_instance->base, i) != VS::PRIMITIVE_TRIANGLES)
+			continue;
+		if (VSG::storage->mesh_surface_get_format(p_instance->base, i) & VS::ARRAY_FLAG_USE_2D_VERTICES)
+			continue;
+
+		Array arrays = VS::get_singleton()->mesh_surface_get_arrays(p_instance->base, i);
+		PoolVector<Vector3> vertices = arrays[VS::ARRAY_VERTEX];
+		PoolVector<int> indices = arrays[VS::ARRAY_INDEX];
+
+		PoolVector<Vector3>::Read vr = vertices.read();
+
+		if (indices.size()) {
+			int count = indices.size() - indices.size() % 3;
+			int from = p_instance->occluder_faces.size();
+			p_instance->occluder_faces.resize(from + count);
+			PoolVector<Vector3>::Write w = p_instance->occluder_faces.write();
+			PoolVector<int>::Read ir = indices.read();
+			for (int j = 0; j < count; j++) {
+				ERR_FAIL_INDEX(ir[j], vertices.size());
+				w[from + j] = vr[ir[j]];
+			}
+		} else {
+			int count = vertices.size() - vertices.size() % 3;
+			int from = p_instance->occluder_faces.size();
+			p_instance->occluder_faces.resize(from + count);
+			PoolVector<Vector3>::Write w = p_instance->occluder_faces.write();
+			for (int j = 0; j < count; j++) {
+				w[from + j] = vr[j];
+			}
+		}
+	}
+}
+
+void VisualServerScene::_occlusion_test_instance(uint32_t p_index, void *p_userdata) {
+
+	Instance *ins = instance_cull_result[p_index];
+
+	// only plain geometry can be hidden, lights and probes still affect what is visible.
+	// occluders are in the buffer themselves, so they would hide themselves and their coplanar neighbours
+	instance_occluded[p_index] = !ins->occluder && ((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) && occlusion_buffer.is_occluded(ins->transformed_aabb);
+}
+
+void VisualServerScene::_occlusion_cull(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, uint32_t p_visible_layers) {
+
+	occlusion_buffer.begin(p_cam_projection, p_cam_transform);
+
+	for (int i = 0; i < instance_cull_count; i++) {
+
+		Instance *ins = instance_cull_result[i];
+
+		if (!ins->occluder || !ins->visible || ins->base_type != VS::INSTANCE_MESH || (p_visible_layers & ins->layer_mask) == 0)
+			continue;
+
+		if (ins->occluder_faces_dirty) {
+			_update_occluder_faces(ins);
+		}
+
+		occlusion_buffer.add_occluder(ins->transform, ins->occluder_faces);
+	}
+
+	if (occlusion_buffer.is_empty())
+		return;
+
+	occlusion_buffer.rasterize();
+
+	ThreadWorkPool::get_singleton()->do_work(instance_cull_count, this, &VisualServerScene::_occlusion_test_instance, (void *)NULL);
+
+	int count = 0;
+	for (int i = 0; i < instance_cull_count; i++) {
+		if (!instance_occluded[i]) {
+			instance_cull_result[count++] = instance_cull_result[i];
+		}
+	}
+	instance_cull_count = count;
+}
+
 void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe) {
 	// Note, in stereo rendering:
 	// - p_cam_transform will be a transform in the middle of our two eyes
@@ -1876,8 +1996,9 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 	print_line("OTP: "+itos(p_scenario->octree.get_pair_count()));
 	*/
 
-	/* STEP 3 - PROCESS PORTALS, VALIDATE ROOMS */
-	//removed, will replace with culling
+	/* STEP 3 - OCCLUSION CULLING */
+
+	_occlusion_cull(p_cam_transform, p_cam_projection, camera_layer_mask);
 
 	/* STEP 4 - REMOVE FURTHER CULLED OBJECTS, ADD LIGHTS */
 
@@ -1943,7 +2064,7 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 				gi_probe_update_list.add(&gi_probe->update_element);
 			}
 
-		} else if (((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) && ins->visible && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
+		} else if (((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) && ins->visible && _instance_in_draw_range(ins, p_cam_transform.origin, !p_reflection_probe.is_valid()) && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
 
 			keep = true;
 
@@ -2023,6 +2144,9 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 		} else {
 
 			ins->last_render_pass = render_pass;
+			if (!p_reflection_probe.is_valid()) {
+				ins->last_frame_pass = frame_pass;
+			}
 		}
 	}
 
@@ -3519,6 +3643,7 @@ VisualServerScene::VisualServerScene() {
 #endif
 
 	render_pass = 1;
+	frame_pass = 1;
 	singleton = this;
 }
 
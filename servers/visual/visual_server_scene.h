@@ -39,6 +39,7 @@
 #include "core/os/thread.h"
 #include "core/self_list.h"
 #include "servers/arvr/arvr_interface.h"
+#include "servers/visual/occlusion_buffer.h"
 
 class VisualServerScene {
 public:
@@ -52,6 +53,7 @@ public:
 	};
 
 	uint64_t render_pass;
+	uint64_t frame_pass;
 
 	static VisualServerScene *singleton;
 
@@ -180,6 +182,10 @@ public:
 		float lod_end;
 		float lod_begin_hysteresis;
 		float lod_end_hysteresis;
+		bool lod_visible; // last draw range test result, used for hysteresis
+		bool occluder;
+		bool occluder_faces_dirty;
+		PoolVector<Vector3> occluder_faces; // mesh triangles in local space, fetched on first use as occluder
 		RID lod_instance;
 
 		uint64_t last_render_pass;
@@ -196,6 +202,9 @@ public:
 
 		virtual void base_changed(bool p_aabb, bool p_materials) {
 
+			if (p_aabb) {
+				occluder_faces_dirty = true;
+			}
 			singleton->_instance_queue_update(this, p_aabb, p_materials);
 		}
 
@@ -218,6 +227,9 @@ public:
 			lod_end = 0;
 			lod_begin_hysteresis = 0;
 			lod_end_hysteresis = 0;
+			lod_visible = true;
+			occluder = false;
+			occluder_faces_dirty = true;
 
 			last_render_pass = 0;
 			last_frame_pass = 0;
@@ -448,6 +460,9 @@ public:
 	RID reflection_probe_instance_cull_result[MAX_REFLECTION_PROBES_CULLED];
 	int reflection_probe_cull_count;
 
+	OcclusionBuffer occlusion_buffer;
+	bool instance_occluded[MAX_INSTANCE_CULL];
+
 	RID_Owner<Instance> instance_owner;
 
 	// from can be mesh, light,  area and portal so far.
@@ -470,6 +485,8 @@ public:
 
 	virtual void instance_set_extra_visibility_margin(RID p_instance, real_t p_margin);
 
+	virtual Vector<int> instances_get_frames_since_visible(const Vector<RID> &p_instances);
+
 	// don't use these in a game!
 	virtual Vector<ObjectID> instances_cull_aabb(const AABB &p_aabb, RID p_scenario = RID()) const;
 	virtual Vector<ObjectID> instances_cull_ray(const Vector3 &p_from, const Vector3 &p_to, RID p_scenario = RID()) const;
@@ -487,6 +504,33 @@ public:
 	_FORCE_INLINE_ void _update_dirty_instance(Instance *p_instance);
 	_FORCE_INLINE_ void _update_instance_lightmap_captures(Instance *p_instance);
 
+	// Only the camera cull updates the hysteresis state, shadow and reflection probe passes use it as is.
+	_FORCE_INLINE_ bool _instance_in_draw_range(Instance *p_instance, const Vector3 &p_cam_pos, bool p_update_hysteresis = false) {
+
+		if (p_instance->lod_begin <= 0 && p_instance->lod_end <= 0)
+			return true;
+
+		float distance = p_cam_pos.distance_to(p_instance->transformed_aabb.position + p_instance->transformed_aabb.size * 0.5);
+
+		// once visible, stay visible until the margins are crossed, so instances don't flicker at the boundaries
+		float begin = p_instance->lod_begin;
+		float end = p_instance->lod_end;
+		if (p_instance->lod_visible) {
+			begin -= p_instance->lod_begin_hysteresis;
+			end += p_instance->lod_end_hysteresis;
+		}
+
+		bool visible = distance >= begin && (p_instance->lod_end <= 0 || distance < end);
+		if (p_update_hysteresis) {
+			p_instance->lod_visible = visible;
+		}
+		return visible;
+	}
+
+	void _update_occluder_faces(Instance *p_instance);
+	void _occlusion_test_instance(uint32_t p_index, void *p_userdata);
+	void _occlusion_cull(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, uint32_t p_visible_layers);
+
 	_FORCE_INLINE_ bool _light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario);
 
 	void _prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe);
@@ -475,6 +475,8 @@ public:
 
 	FUNC2(instance_set_extra_visibility_margin, RID, real_t)
 
+	FUNC1R(Vector<int>, instances_get_frames_since_visible, const Vector<RID> &)
+
 	// don't use these in a game!
 	FUNC2RC(Vector<ObjectID>, instances_cull_aabb, const AABB &, RID)
 	FUNC3RC(Vector<ObjectID>, instances_cull_ray, const Vector3 &, const Vector3 &, RID)
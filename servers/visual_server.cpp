@@ -124,6 +124,24 @@ Array VisualServer::_instances_cull_convex_bind(const Array &p_convex, RID p_sce
 	return to_array(ids);
 }
 
+Array VisualServer::_instances_get_frames_since_visible_bind(const Array &p_instances) {
+
+	Vector<RID> instances;
+	for (int i = 0; i < p_instances.size(); i++) {
+		Variant v = p_instances[i];
+		ERR_FAIL_COND_V(v.get_type() != Variant::_RID, Array());
+		instances.push_back(v);
+	}
+
+	Vector<int> frames = instances_get_frames_since_visible(instances);
+	Array result;
+	result.resize(frames.size());
+	for (int i = 0; i < frames.size(); i++) {
+		result[i] = frames[i];
+	}
+	return result;
+}
+
 RID VisualServer::get_test_texture() {
 
 	if (test_texture.is_valid()) {
@@ -1945,6 +1963,7 @@ void VisualServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("instance_attach_skeleton", "instance", "skeleton"), &VisualServer::instance_attach_skeleton);
 	ClassDB::bind_method(D_METHOD("instance_set_exterior", "instance", "enabled"), &VisualServer::instance_set_exterior);
 	ClassDB::bind_method(D_METHOD("instance_set_extra_visibility_margin", "instance", "margin"), &VisualServer::instance_set_extra_visibility_margin);
+	ClassDB::bind_method(D_METHOD("instances_get_frames_since_visible", "instances"), &VisualServer::_instances_get_frames_since_visible_bind);
 	ClassDB::bind_method(D_METHOD("instance_geometry_set_flag", "instance", "flag", "enabled"), &VisualServer::instance_geometry_set_flag);
 	ClassDB::bind_method(D_METHOD("instance_geometry_set_cast_shadows_setting", "instance", "shadow_casting_setting"), &VisualServer::instance_geometry_set_cast_shadows_setting);
 	ClassDB::bind_method(D_METHOD("instance_geometry_set_material_override", "instance", "material"), &VisualServer::instance_geometry_set_material_override);
@@ -2215,6 +2234,7 @@ void VisualServer::_bind_methods() {
 
 	BIND_ENUM_CONSTANT(INSTANCE_FLAG_USE_BAKED_LIGHT);
 	BIND_ENUM_CONSTANT(INSTANCE_FLAG_DRAW_NEXT_FRAME_IF_VISIBLE);
+	BIND_ENUM_CONSTANT(INSTANCE_FLAG_OCCLUDER);
 	BIND_ENUM_CONSTANT(INSTANCE_FLAG_MAX);
 
 	BIND_ENUM_CONSTANT(SHADOW_CASTING_SETTING_OFF);
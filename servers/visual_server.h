@@ -832,6 +832,9 @@ public:
 
 	virtual void instance_set_extra_visibility_margin(RID p_instance, real_t p_margin) = 0;
 
+	virtual Vector<int> instances_get_frames_since_visible(const Vector<RID> &p_instances) = 0;
+	Array _instances_get_frames_since_visible_bind(const Array &p_instances);
+
 	// don't use these in a game!
 	virtual Vector<ObjectID> instances_cull_aabb(const AABB &p_aabb, RID p_scenario = RID()) const = 0;
 	virtual Vector<ObjectID> instances_cull_ray(const Vector3 &p_from, const Vector3 &p_to, RID p_scenario = RID()) const = 0;
@@ -844,6 +847,7 @@ public:
 	enum InstanceFlags {
 		INSTANCE_FLAG_USE_BAKED_LIGHT,
 		INSTANCE_FLAG_DRAW_NEXT_FRAME_IF_VISIBLE,
+		INSTANCE_FLAG_OCCLUDER,
 		INSTANCE_FLAG_MAX
 	};
 